@@ -25,7 +25,20 @@
 
 # originally generated with the command:
 # find opm -name '*.c*' -printf '\t%p\n' | sort
-#list (APPEND MAIN_SOURCE_FILES)
+#
+# these are the explicit instantiations of the commonly used templates. the headers
+# declare them as extern templates if OPM_MATERIAL_EXTERN_TEMPLATES is enabled,
+# otherwise opm-material is header-only.
+if (OPM_MATERIAL_EXTERN_TEMPLATES)
+  list (APPEND MAIN_SOURCE_FILES
+	opm/material/densead/Evaluation.cpp
+	opm/material/fluidmatrixinteractions/EclMaterialLawManager.cpp
+	opm/material/fluidsystems/BlackOilFluidSystem.cpp
+	opm/material/fluidsystems/blackoilpvt/GasPvtMultiplexer.cpp
+	opm/material/fluidsystems/blackoilpvt/OilPvtMultiplexer.cpp
+	opm/material/fluidsystems/blackoilpvt/WaterPvtMultiplexer.cpp
+	)
+endif ()
 
 # originally generated with the command:
 # find tests -name '*.cpp' -a ! -wholename '*/not-unit/*' -printf '\t%p\n' | sort
@@ -0,0 +1,281 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief A minimalistic, self-contained timing harness for the benchmarks of
+ *        opm-material.
+ *
+ * Each benchmark program creates a Suite, registers its benchmarks using
+ * Suite::run() and returns the result of Suite::finish() from main(). The
+ * following command line arguments are understood by all benchmark programs:
+ *
+ * - <tt>--json=FILE</tt>: write the results to FILE in JSON format
+ * - <tt>--filter=STRING</tt>: only run the benchmarks whose name contains STRING
+ * - <tt>--min-time=SECONDS</tt>: minimum duration of a single sample (default: 0.05)
+ * - <tt>--samples=N</tt>: number of samples taken for each benchmark (default: 5)
+ */
+#ifndef OPM_BENCHMARK_HARNESS_HPP
+#define OPM_BENCHMARK_HARNESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+namespace Benchmark {
+
+/*!
+ * \brief Prevent the compiler from optimizing away the computation of a value.
+ */
+template <class T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+/*!
+ * \brief The timings of a single benchmark.
+ */
+struct Result
+{
+    std::string name;
+    // number of items (e.g., function evaluations) processed by one iteration
+    std::size_t itemsPerIteration;
+    // number of iterations per sample
+    std::size_t iterations;
+    // the time per item of each sample in nanoseconds
+    std::vector<double> nsPerItem;
+
+    double minimum() const
+    { return *std::min_element(nsPerItem.begin(), nsPerItem.end()); }
+
+    double median() const
+    {
+        std::vector<double> tmp(nsPerItem);
+        std::sort(tmp.begin(), tmp.end());
+        const std::size_t n = tmp.size();
+        return (n % 2 == 1) ? tmp[n/2] : (tmp[n/2 - 1] + tmp[n/2])/2;
+    }
+
+    double mean() const
+    {
+        double sum = 0.0;
+        for (double t : nsPerItem)
+            sum += t;
+        return sum/nsPerItem.size();
+    }
+};
+
+/*!
+ * \brief A set of benchmarks which are run by the same program.
+ */
+class Suite
+{
+    using Clock = std::chrono::steady_clock;
+
+public:
+    Suite(const std::string& name, int argc, char** argv)
+        : name_(name)
+        , minTime_(0.05)
+        , numSamples_(5)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg(argv[i]);
+            if (hasPrefix_(arg, "--json="))
+                jsonFile_ = arg.substr(7);
+            else if (hasPrefix_(arg, "--filter="))
+                filter_ = arg.substr(9);
+            else if (hasPrefix_(arg, "--min-time="))
+                minTime_ = std::atof(arg.c_str() + 11);
+            else if (hasPrefix_(arg, "--samples="))
+                numSamples_ = std::max(1, std::atoi(arg.c_str() + 10));
+            else
+                throw std::invalid_argument("Unknown argument '" + arg + "'. Usage: " + argv[0]
+                                            + " [--json=FILE] [--filter=STRING]"
+                                            + " [--min-time=SECONDS] [--samples=N]");
+        }
+
+        std::cout << std::left << std::setw(60) << "benchmark"
+                  << std::right << std::setw(14) << "ns/item (min)"
+                  << std::setw(14) << "ns/item (med)"
+                  << std::setw(14) << "iterations" << "\n";
+    }
+
+    /*!
+     * \brief Time a benchmark.
+     *
+     * \param name The name of the benchmark
+     * \param itemsPerIteration The number of items processed by a single call of \c fn
+     * \param fn The callable which contains the code to be timed
+     */
+    template <class Fn>
+    void run(const std::string& name, std::size_t itemsPerIteration, Fn&& fn)
+    {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos)
+            return;
+
+        // warm up the caches and find the number of iterations which are required to
+        // exceed the minimum duration of a sample
+        std::size_t iterations = 1;
+        while (true) {
+            const double t = time_(iterations, fn);
+            if (t >= minTime_ || iterations >= (std::size_t(1) << 40))
+                break;
+
+            const double scale = (t > 0.0) ? 1.4*minTime_/t : 10.0;
+            iterations = static_cast<std::size_t>(iterations*std::min(std::max(scale, 2.0), 10.0));
+        }
+
+        Result result;
+        result.name = name;
+        result.itemsPerIteration = itemsPerIteration;
+        result.iterations = iterations;
+        for (int sampleIdx = 0; sampleIdx < numSamples_; ++sampleIdx) {
+            const double t = time_(iterations, fn);
+            result.nsPerItem.push_back(t*1e9/(double(iterations)*itemsPerIteration));
+        }
+
+        std::cout << std::left << std::setw(60) << name
+                  << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << result.minimum()
+                  << std::setw(14) << result.median()
+                  << std::setw(14) << iterations << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+        results_.push_back(result);
+    }
+
+    /*!
+     * \brief Write the results to the JSON file if one was requested.
+     *
+     * The return value is meant to be returned from main().
+     */
+    int finish() const
+    {
+        if (jsonFile_.empty())
+            return 0;
+
+        std::ofstream os(jsonFile_);
+        if (!os) {
+            std::cerr << "Could not open '" << jsonFile_ << "' for writing\n";
+            return 1;
+        }
+        writeJson(os);
+        return os.good() ? 0 : 1;
+    }
+
+    /*!
+     * \brief Write the results of all benchmarks in JSON format.
+     */
+    void writeJson(std::ostream& os) const
+    {
+        os << "{\n"
+           << "  \"suite\": " << quoted_(name_) << ",\n"
+           << "  \"context\": {\n"
+#if defined(__VERSION__)
+           << "    \"compiler\": " << quoted_(__VERSION__) << ",\n"
+#endif
+#ifdef NDEBUG
+           << "    \"ndebug\": true,\n"
+#else
+           << "    \"ndebug\": false,\n"
+#endif
+           << "    \"min_time_s\": " << minTime_ << ",\n"
+           << "    \"samples\": " << numSamples_ << "\n"
+           << "  },\n"
+           << "  \"benchmarks\": [";
+
+        os << std::setprecision(6);
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            os << (i == 0 ? "\n" : ",\n")
+               << "    {\n"
+               << "      \"name\": " << quoted_(r.name) << ",\n"
+               << "      \"items_per_iteration\": " << r.itemsPerIteration << ",\n"
+               << "      \"iterations\": " << r.iterations << ",\n"
+               << "      \"ns_per_item_min\": " << r.minimum() << ",\n"
+               << "      \"ns_per_item_median\": " << r.median() << ",\n"
+               << "      \"ns_per_item_mean\": " << r.mean() << ",\n"
+               << "      \"ns_per_item_samples\": [";
+            for (std::size_t j = 0; j < r.nsPerItem.size(); ++j)
+                os << (j == 0 ? "" : ", ") << r.nsPerItem[j];
+            os << "]\n"
+               << "    }";
+        }
+        os << "\n  ]\n"
+           << "}\n";
+    }
+
+    const std::vector<Result>& results() const
+    { return results_; }
+
+private:
+    template <class Fn>
+    static double time_(std::size_t iterations, Fn& fn)
+    {
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+            fn();
+        const auto end = Clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    static bool hasPrefix_(const std::string& s, const std::string& prefix)
+    { return s.compare(0, prefix.size(), prefix) == 0; }
+
+    static std::string quoted_(const std::string& s)
+    {
+        std::string result = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result + "\"";
+    }
+
+    std::string name_;
+    std::string jsonFile_;
+    std::string filter_;
+    double minTime_;
+    int numSamples_;
+    std::vector<Result> results_;
+};
+
+} // namespace Benchmark
+} // namespace Opm
+
+#endif
@@ -0,0 +1,298 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmarks for the density and viscosity of BlackOilFluidSystem.
+ *
+ * The fluid system is initialized from a synthetic deck with live oil (PVTO), wet gas
+ * (PVTG) and water (PVTW) in several PVT regions.
+ */
+#include "config.h"
+
+#if !HAVE_ECL_INPUT
+#error "The benchmark for the black oil fluid system requires ecl input support in opm-common"
+#endif
+
+#include "BenchmarkHarness.hpp"
+
+#include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
+#include <opm/material/fluidsystems/PvtRegionSchedule.hpp>
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+#include <opm/material/densead/Evaluation.hpp>
+
+#include <opm/input/eclipse/Parser/Parser.hpp>
+#include <opm/input/eclipse/Deck/Deck.hpp>
+#include <opm/input/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/input/eclipse/Python/Python.hpp>
+#include <opm/input/eclipse/Schedule/Schedule.hpp>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using Scalar = double;
+using FluidSystem = Opm::BlackOilFluidSystem<Scalar>;
+
+constexpr unsigned numRegions = 3;
+constexpr std::size_t numCells = 1024;
+
+// create a deck with synthetic but physically plausible PVT tables in METRIC units
+std::string syntheticDeck()
+{
+    std::ostringstream deck;
+    deck << "RUNSPEC\n"
+         << "DIMENS\n 1 1 1 /\n"
+         << "METRIC\n"
+         << "TABDIMS\n * " << numRegions << " /\n"
+         << "OIL\nGAS\nWATER\nDISGAS\nVAPOIL\n"
+         << "GRID\n"
+         << "DX\n 1*100 /\nDY\n 1*100 /\nDZ\n 1*10 /\nTOPS\n 1*2000 /\nPORO\n 1*0.2 /\n"
+         << "PROPS\n";
+
+    deck << "PVTO\n";
+    for (unsigned regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+        const Scalar shift = 5.0*regionIdx;
+        for (unsigned i = 0; i < 25; ++i) {
+            const Scalar Rs = 10.0 + 8.0*i + shift;
+            const Scalar pSat = 20.0 + 1.8*Rs;
+            const Scalar BoSat = 1.05 + 4e-3*Rs;
+            const Scalar muSat = 1.5/(1.0 + 0.01*Rs);
+            deck << Rs;
+            for (unsigned j = 0; j < 5; ++j) {
+                const Scalar p = pSat + 30.0*j;
+                deck << "  " << p
+                     << "  " << BoSat*(1.0 - 1.5e-4*(p - pSat))
+                     << "  " << muSat*(1.0 + 5e-4*(p - pSat)) << "\n";
+            }
+            deck << "/\n";
+        }
+        deck << "/\n";
+    }
+
+    deck << "PVTG\n";
+    for (unsigned regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+        const Scalar shift = 1.0 + 0.05*regionIdx;
+        for (unsigned i = 0; i < 25; ++i) {
+            const Scalar p = 20.0 + 20.0*i;
+            const Scalar RvSat = shift*1e-6*(1.0 + 0.1*p + 1e-3*p*p);
+            const Scalar Bg = 1.0/(0.9*p);
+            const Scalar mu = 0.012 + 5e-5*p;
+            deck << p;
+            for (unsigned j = 0; j < 3; ++j) {
+                const Scalar Rv = RvSat*(2 - j)/2;
+                deck << "  " << Rv
+                     << "  " << Bg*(1.0 + 10.0*Rv)
+                     << "  " << mu*(1.0 + 100.0*Rv) << "\n";
+            }
+            deck << "/\n";
+        }
+        deck << "/\n";
+    }
+
+    deck << "PVTW\n";
+    for (unsigned regionIdx = 0; regionIdx < numRegions; ++regionIdx)
+        deck << " 250.0  1.03  4.5E-5  0.32  0.0 /\n";
+
+    deck << "DENSITY\n";
+    for (unsigned regionIdx = 0; regionIdx < numRegions; ++regionIdx)
+        deck << " " << 850.0 + 5.0*regionIdx << "  1030.0  0.85 /\n";
+
+    return deck.str();
+}
+
+void initFluidSystem()
+{
+    Opm::Parser parser;
+    const auto deck = parser.parseString(syntheticDeck());
+    auto python = std::make_shared<Opm::Python>();
+    const Opm::EclipseState eclState(deck);
+    const Opm::Schedule schedule(deck, eclState, python);
+
+    FluidSystem::initFromState(eclState, schedule);
+}
+
+template <class Evaluation>
+using FluidState = Opm::BlackOilFluidState<Evaluation,
+                                           FluidSystem,
+                                           /*enableTemperature=*/false,
+                                           /*enableEnergy=*/false,
+                                           /*enableDissolution=*/true,
+                                           /*enableEvaporation=*/true>;
+
+template <class Evaluation>
+Evaluation makeVariable(Scalar value, unsigned varIdx)
+{
+    if constexpr (std::is_floating_point<Evaluation>::value)
+        return value;
+    else
+        return Evaluation::createVariable(value, varIdx);
+}
+
+// create undersaturated fluid states in random PVT regions
+template <class Evaluation>
+std::vector<FluidState<Evaluation>> createFluidStates()
+{
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<Scalar> pDist(60e5, 300e5);
+    std::uniform_real_distribution<Scalar> fracDist(0.5, 1.0);
+    std::uniform_int_distribution<unsigned> regionDist(0, numRegions - 1);
+
+    std::vector<FluidState<Evaluation>> fluidStates(numCells);
+    for (auto& fs : fluidStates) {
+        const unsigned regionIdx = regionDist(gen);
+        const Evaluation p = makeVariable<Evaluation>(pDist(gen), 0);
+        fs.setPvtRegionIndex(regionIdx);
+        for (unsigned phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx) {
+            fs.setPressure(phaseIdx, p);
+            fs.setSaturation(phaseIdx, 1.0/FluidSystem::numPhases);
+        }
+
+        const Evaluation RsSat =
+            FluidSystem::saturatedDissolutionFactor(fs, FluidSystem::oilPhaseIdx, regionIdx);
+        const Evaluation RvSat =
+            FluidSystem::saturatedDissolutionFactor(fs, FluidSystem::gasPhaseIdx, regionIdx);
+        fs.setRs(RsSat*fracDist(gen));
+        fs.setRv(RvSat*fracDist(gen));
+    }
+    return fluidStates;
+}
+
+template <class Evaluation>
+void benchFluidSystem(Opm::Benchmark::Suite& suite, const std::string& evalName)
+{
+    const auto fluidStates = createFluidStates<Evaluation>();
+    const char* phaseNames[] = { "water", "oil", "gas" };
+    const unsigned phaseIndices[] = { FluidSystem::waterPhaseIdx,
+                                      FluidSystem::oilPhaseIdx,
+                                      FluidSystem::gasPhaseIdx };
+
+    for (unsigned i = 0; i < 3; ++i) {
+        const unsigned phaseIdx = phaseIndices[i];
+        const std::string suffix = std::string(phaseNames[i]) + "/" + evalName;
+
+        suite.run("BlackOilFluidSystem/density/" + suffix, numCells, [&]() {
+            Evaluation sum = 0.0;
+            for (const auto& fs : fluidStates)
+                sum += FluidSystem::density(fs, phaseIdx, fs.pvtRegionIndex());
+            Opm::Benchmark::doNotOptimize(sum);
+        });
+
+        suite.run("BlackOilFluidSystem/viscosity/" + suffix, numCells, [&]() {
+            Evaluation sum = 0.0;
+            for (const auto& fs : fluidStates)
+                sum += FluidSystem::viscosity(fs, phaseIdx, fs.pvtRegionIndex());
+            Opm::Benchmark::doNotOptimize(sum);
+        });
+    }
+
+    suite.run("BlackOilFluidSystem/saturatedDissolutionFactor/oil/" + evalName, numCells, [&]() {
+        Evaluation sum = 0.0;
+        for (const auto& fs : fluidStates)
+            sum += FluidSystem::saturatedDissolutionFactor(fs, FluidSystem::oilPhaseIdx, fs.pvtRegionIndex());
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    // all quantities which are required by the intensive quantities of a cell: once
+    // using the per-phase methods and once using the batched method
+    suite.run("BlackOilFluidSystem/allPhases/perPhase/" + evalName, numCells, [&]() {
+        Evaluation sum = 0.0;
+        for (const auto& fs : fluidStates) {
+            const unsigned regionIdx = fs.pvtRegionIndex();
+            for (unsigned phaseIdx : phaseIndices) {
+                sum += FluidSystem::inverseFormationVolumeFactor(fs, phaseIdx, regionIdx);
+                sum += FluidSystem::density(fs, phaseIdx, regionIdx);
+                sum += FluidSystem::viscosity(fs, phaseIdx, regionIdx);
+            }
+            sum += FluidSystem::saturatedDissolutionFactor(fs, FluidSystem::oilPhaseIdx, regionIdx);
+            sum += FluidSystem::saturatedDissolutionFactor(fs, FluidSystem::gasPhaseIdx, regionIdx);
+        }
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    std::vector<FluidSystem::PhaseProperties<Evaluation>> phaseProps(numCells);
+    suite.run("BlackOilFluidSystem/allPhases/batched/" + evalName, numCells, [&]() {
+        FluidSystem::computePhaseProperties(phaseProps.data(), fluidStates.data(), fluidStates.size());
+        Evaluation sum = 0.0;
+        for (const auto& props : phaseProps) {
+            for (unsigned phaseIdx : phaseIndices)
+                sum += props.invB[phaseIdx] + props.density[phaseIdx] + props.viscosity[phaseIdx];
+            sum += props.saturatedRs + props.saturatedRv;
+        }
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    // the same, but the cells are processed grouped by PVT region
+    std::vector<unsigned> cellRegions;
+    for (const auto& fs : fluidStates)
+        cellRegions.push_back(fs.pvtRegionIndex());
+    const Opm::PvtRegionSchedule schedule(cellRegions);
+    suite.run("BlackOilFluidSystem/allPhases/regionSorted/" + evalName, numCells, [&]() {
+        FluidSystem::computePhaseProperties(phaseProps.data(), fluidStates.data(), schedule);
+        Evaluation sum = 0.0;
+        for (const auto& props : phaseProps) {
+            for (unsigned phaseIdx : phaseIndices)
+                sum += props.invB[phaseIdx] + props.density[phaseIdx] + props.viscosity[phaseIdx];
+            sum += props.saturatedRs + props.saturatedRv;
+        }
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    // the same, but using a fluid system which is specialized for the PVT classes of
+    // the deck, i.e., without the runtime dispatch of the PVT multiplexers
+    using SpecializedPvtTypes = Opm::BlackOilPvtTypes<Opm::LiveOilPvt<Scalar>,
+                                                      Opm::WetGasPvt<Scalar>,
+                                                      Opm::ConstantCompressibilityWaterPvt<Scalar>>;
+    Opm::dispatchBlackOilFluidSystem<SpecializedPvtTypes>(FluidSystem::defaultInstance(), [&](const auto& fluidSystem) {
+        suite.run("BlackOilFluidSystem/allPhases/specialized/" + evalName, numCells, [&]() {
+            fluidSystem.computePhaseProperties(phaseProps.data(), fluidStates.data(), schedule);
+            Evaluation sum = 0.0;
+            for (const auto& props : phaseProps) {
+                for (unsigned phaseIdx : phaseIndices)
+                    sum += props.invB[phaseIdx] + props.density[phaseIdx] + props.viscosity[phaseIdx];
+                sum += props.saturatedRs + props.saturatedRv;
+            }
+            Opm::Benchmark::doNotOptimize(sum);
+        });
+    });
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    Opm::Benchmark::Suite suite("blackoilfluidsystem", argc, argv);
+
+    initFluidSystem();
+
+    benchFluidSystem<Scalar>(suite, "scalar");
+    benchFluidSystem<Opm::DenseAd::Evaluation<Scalar, 3>>(suite, "ad3");
+
+    return suite.finish();
+}
@@ -0,0 +1,423 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmarks for the arithmetic of DenseAd::Evaluation objects with 1 to 12
+ *        derivatives, of dynamically sized evaluations, of DenseAd::SparseEvaluation,
+ *        of DenseAd::MixedPrecisionEvaluation and of DenseAd::EvaluationBlock.
+ */
+#include "config.h"
+
+#include "BenchmarkHarness.hpp"
+
+#include <opm/material/densead/Evaluation.hpp>
+#include <opm/material/densead/Math.hpp>
+#include <opm/material/densead/SparseEvaluation.hpp>
+#include <opm/material/densead/MixedPrecisionEvaluation.hpp>
+#include <opm/material/densead/EvaluationBlock.hpp>
+#include <opm/material/densead/BatchMath.hpp>
+#include <opm/material/common/FastSmallVector.hpp>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Scalar = double;
+
+constexpr std::size_t numPoints = 1024;
+
+template <int numDerivs>
+std::vector<Opm::DenseAd::Evaluation<Scalar, numDerivs>> randomEvaluations(unsigned seed)
+{
+    using Eval = Opm::DenseAd::Evaluation<Scalar, numDerivs>;
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<Scalar> dist(0.5, 2.0);
+    std::vector<Eval> result(numPoints);
+    for (auto& v : result) {
+        v = Eval::createVariable(dist(gen), seed % numDerivs);
+        for (int derivIdx = 0; derivIdx < numDerivs; ++derivIdx)
+            v.setDerivative(derivIdx, dist(gen));
+    }
+    return result;
+}
+
+template <int numDerivs>
+void benchEvaluation(Opm::Benchmark::Suite& suite)
+{
+    using Eval = Opm::DenseAd::Evaluation<Scalar, numDerivs>;
+
+    const auto a = randomEvaluations<numDerivs>(1);
+    const auto b = randomEvaluations<numDerivs>(2);
+    const auto c = randomEvaluations<numDerivs>(3);
+    std::vector<Eval> result(numPoints);
+
+    const std::string prefix = "DenseAd::Evaluation<" + std::to_string(numDerivs) + ">/";
+
+    suite.run(prefix + "add", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = a[k] + b[k];
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run(prefix + "mul", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = a[k] * b[k];
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run(prefix + "div", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = a[k] / b[k];
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    // a typical expression of a residual: a mobility times a potential difference
+    suite.run(prefix + "expression", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = (a[k]*b[k] + c[k])/(a[k] - 0.1*b[k]) - 2.0*c[k];
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run(prefix + "exp", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = Opm::exp(a[k]);
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run(prefix + "log", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = Opm::log(a[k]);
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run(prefix + "pow", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = Opm::pow(a[k], b[k]);
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run(prefix + "sqrt", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = Opm::sqrt(a[k]);
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+}
+
+// quantities which only depend on a single primary variable, like the functions of
+// pressure or temperature of the PVT relations. the same formula is evaluated using
+// dense and sparse evaluations.
+template <class Eval, int numDerivs>
+void benchSingleVariableFunction(Opm::Benchmark::Suite& suite, const std::string& name)
+{
+    std::mt19937 gen(4);
+    std::uniform_real_distribution<Scalar> dist(0.5, 2.0);
+    std::vector<Eval> p(numPoints);
+    for (auto& v : p)
+        v = Eval::createVariable(dist(gen), 0);
+    std::vector<Eval> T(numPoints);
+    for (auto& v : T)
+        v = Eval::createVariable(dist(gen), numDerivs - 1);
+    std::vector<Eval> result(numPoints);
+
+    suite.run(name + "<" + std::to_string(numDerivs) + ">/pvt-function", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = Opm::exp(0.1*p[k])*(1.0 + 0.01*p[k]) + Opm::log(T[k])/T[k];
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+}
+
+// reading cached per-cell quantities which do not fit into the CPU caches. this is
+// limited by the memory bandwidth, i.e., by the size of the evaluation objects.
+template <class Eval, int numDerivs>
+void benchCachedQuantities(Opm::Benchmark::Suite& suite, const std::string& name)
+{
+    constexpr std::size_t numCells = 1 << 20;
+
+    std::mt19937 gen(6);
+    std::uniform_real_distribution<Scalar> dist(0.5, 2.0);
+    std::vector<Eval> density(numCells);
+    std::vector<Eval> saturation(numCells);
+    for (std::size_t k = 0; k < numCells; ++k) {
+        density[k] = Eval::createVariable(dist(gen), 0);
+        saturation[k] = Eval::createVariable(dist(gen), numDerivs - 1);
+    }
+
+    suite.run(name + "<" + std::to_string(numDerivs) + ">/cached-accumulation", numCells, [&]() {
+        Eval result = 0.0;
+        for (std::size_t k = 0; k < numCells; ++k)
+            result += density[k]*saturation[k];
+        Opm::Benchmark::doNotOptimize(result);
+    });
+}
+
+// the same arithmetic for numPoints cells, once using one Evaluation per cell and
+// once using the structure-of-arrays layout of EvaluationBlock
+template <int numDerivs, int width>
+void benchEvaluationBlock(Opm::Benchmark::Suite& suite)
+{
+    using Block = Opm::DenseAd::EvaluationBlock<Scalar, numDerivs, width>;
+    constexpr std::size_t numBlocks = numPoints/width;
+
+    const auto a = randomEvaluations<numDerivs>(1);
+    const auto b = randomEvaluations<numDerivs>(2);
+    const auto c = randomEvaluations<numDerivs>(3);
+    std::vector<Block> aBlock(numBlocks), bBlock(numBlocks), cBlock(numBlocks), result(numBlocks);
+    for (std::size_t k = 0; k < numPoints; ++k) {
+        aBlock[k/width].setLane(k % width, a[k]);
+        bBlock[k/width].setLane(k % width, b[k]);
+        cBlock[k/width].setLane(k % width, c[k]);
+    }
+
+    const std::string prefix =
+        "DenseAd::EvaluationBlock<" + std::to_string(numDerivs) + ", " + std::to_string(width) + ">/";
+
+    suite.run(prefix + "expression", numPoints, [&]() {
+        for (std::size_t k = 0; k < numBlocks; ++k)
+            result[k] = (aBlock[k]*bBlock[k] + cBlock[k])/(aBlock[k] - 0.1*bBlock[k]) - 2.0*cBlock[k];
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run(prefix + "exp", numPoints, [&]() {
+        for (std::size_t k = 0; k < numBlocks; ++k)
+            result[k] = Opm::exp(aBlock[k]);
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+}
+
+// the per-call functions of the C library vs. the batched functions of
+// BatchMath.hpp, for arrays of scalars and of evaluations
+template <int numDerivs>
+void benchBatchMath(Opm::Benchmark::Suite& suite)
+{
+    typedef Opm::DenseAd::Evaluation<Scalar, numDerivs> Eval;
+    using Opm::DenseAd::BatchAccuracy;
+
+    std::mt19937 gen(6);
+    std::uniform_real_distribution<Scalar> dist(0.5, 2.0);
+    std::vector<Scalar> x(numPoints);
+    for (auto& v : x)
+        v = dist(gen);
+    std::vector<Scalar> y(numPoints);
+    std::vector<Eval> xEval(numPoints);
+    for (std::size_t k = 0; k < numPoints; ++k)
+        xEval[k] = Eval::createVariable(x[k], k % numDerivs);
+    std::vector<Eval> yEval(numPoints);
+
+    if (numDerivs == 1) {
+        suite.run("BatchMath/exp/libm", numPoints, [&]() {
+            for (std::size_t k = 0; k < numPoints; ++k)
+                y[k] = std::exp(x[k]);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+        suite.run("BatchMath/exp/full", numPoints, [&]() {
+            Opm::DenseAd::batchExp(x.data(), y.data(), numPoints);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+        suite.run("BatchMath/exp/reduced", numPoints, [&]() {
+            Opm::DenseAd::batchExp<BatchAccuracy::reduced>(x.data(), y.data(), numPoints);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+        suite.run("BatchMath/log/libm", numPoints, [&]() {
+            for (std::size_t k = 0; k < numPoints; ++k)
+                y[k] = std::log(x[k]);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+        suite.run("BatchMath/log/full", numPoints, [&]() {
+            Opm::DenseAd::batchLog(x.data(), y.data(), numPoints);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+        suite.run("BatchMath/log/reduced", numPoints, [&]() {
+            Opm::DenseAd::batchLog<BatchAccuracy::reduced>(x.data(), y.data(), numPoints);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+        suite.run("BatchMath/pow/libm", numPoints, [&]() {
+            for (std::size_t k = 0; k < numPoints; ++k)
+                y[k] = std::pow(x[k], 1.7);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+        suite.run("BatchMath/pow/full", numPoints, [&]() {
+            Opm::DenseAd::batchPow(x.data(), 1.7, y.data(), numPoints);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+        suite.run("BatchMath/pow/reduced", numPoints, [&]() {
+            Opm::DenseAd::batchPow<BatchAccuracy::reduced>(x.data(), 1.7, y.data(), numPoints);
+            Opm::Benchmark::doNotOptimize(y.front());
+        });
+    }
+
+    const std::string prefix = "BatchMath/Evaluation<" + std::to_string(numDerivs) + ">/";
+    suite.run(prefix + "exp/libm", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            yEval[k] = Opm::exp(xEval[k]);
+        Opm::Benchmark::doNotOptimize(yEval.front());
+    });
+    suite.run(prefix + "exp/full", numPoints, [&]() {
+        Opm::DenseAd::batchExp(xEval.data(), yEval.data(), numPoints);
+        Opm::Benchmark::doNotOptimize(yEval.front());
+    });
+    suite.run(prefix + "pow/libm", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            yEval[k] = Opm::pow(xEval[k], 1.7);
+        Opm::Benchmark::doNotOptimize(yEval.front());
+    });
+    suite.run(prefix + "pow/full", numPoints, [&]() {
+        Opm::DenseAd::batchPow(xEval.data(), 1.7, yEval.data(), numPoints);
+        Opm::Benchmark::doNotOptimize(yEval.front());
+    });
+}
+
+// residual evaluations for which only the values are needed, e.g. by line searches.
+// the "value-only" case uses a ValueOnlyScope, which only has an effect if
+// OPM_DENSEAD_VALUE_ONLY_MODE is enabled.
+template <int numDerivs>
+void benchValueOnlyMode(Opm::Benchmark::Suite& suite)
+{
+    typedef Opm::DenseAd::Evaluation<Scalar, numDerivs> Eval;
+
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<Scalar> dist(0.5, 2.0);
+    std::vector<Eval> p(numPoints);
+    std::vector<Eval> S(numPoints);
+    for (std::size_t k = 0; k < numPoints; ++k) {
+        p[k] = Eval::createVariable(dist(gen), 0);
+        S[k] = Eval::createVariable(dist(gen), numDerivs - 1);
+    }
+    std::vector<Eval> residual(numPoints);
+
+    const auto computeResiduals = [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k) {
+            const Eval b = Opm::exp(0.1*p[k])*(1.0 + 0.01*p[k]);
+            const Eval mob = S[k]*S[k]/(1e-3*(1.0 + 0.1*p[k]));
+            residual[k] = S[k]*b - 0.9*mob*b + Opm::sqrt(S[k]);
+        }
+        Opm::Benchmark::doNotOptimize(residual.front());
+    };
+
+    const std::string prefix = "DenseAd::Evaluation<" + std::to_string(numDerivs) + ">/residual/";
+    suite.run(prefix + "full", numPoints, computeResiduals);
+    suite.run(prefix + "value-only", numPoints, [&]() {
+        Opm::DenseAd::ValueOnlyScope valueOnly;
+        computeResiduals();
+    });
+}
+
+// dynamically sized evaluations with many derivatives, as used for compositional
+// problems. each expression creates several temporaries, so this measures the cost
+// of their storage. staticSize == 0 means that all derivatives are on the heap.
+template <unsigned staticSize>
+void benchDynamicEvaluation(Opm::Benchmark::Suite& suite, int numDerivs)
+{
+    using Eval = Opm::DenseAd::DynamicEvaluation<Scalar, staticSize>;
+
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<Scalar> dist(0.5, 2.0);
+    const auto randomEvals = [&]() {
+        std::vector<Eval> result(numPoints, Eval(numDerivs));
+        for (auto& v : result) {
+            v = Eval::createVariable(numDerivs, dist(gen), 0);
+            for (int derivIdx = 0; derivIdx < numDerivs; ++derivIdx)
+                v.setDerivative(derivIdx, dist(gen));
+        }
+        return result;
+    };
+    const auto a = randomEvals();
+    const auto b = randomEvals();
+    std::vector<Eval> result(numPoints, Eval(numDerivs));
+
+    const std::string prefix =
+        "DenseAd::DynamicEvaluation<" + std::to_string(numDerivs) + ", inline="
+        + std::to_string(Eval::inlineSize) + ">/";
+
+    suite.run(prefix + "copy", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k) {
+            Eval tmp(a[k]);
+            Opm::Benchmark::doNotOptimize(tmp);
+        }
+    });
+
+    suite.run(prefix + "expression", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k)
+            result[k] = (a[k]*b[k] + a[k])/(a[k] - 0.1*b[k]);
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+}
+
+// the heap fallback of FastSmallVector: recycled buffers vs. operator new/delete
+template <class Allocator>
+void benchFastSmallVector(Opm::Benchmark::Suite& suite, const std::string& name)
+{
+    using Vector = Opm::FastSmallVector<Scalar, 0, Allocator>;
+
+    const Vector source(25, 1.0);
+    suite.run("FastSmallVector<" + name + ">/copy", numPoints, [&]() {
+        for (std::size_t k = 0; k < numPoints; ++k) {
+            Vector tmp(source);
+            Opm::Benchmark::doNotOptimize(tmp);
+        }
+    });
+}
+
+template <int... numDerivs>
+void benchAllSizes(Opm::Benchmark::Suite& suite, std::integer_sequence<int, numDerivs...>)
+{ (benchEvaluation<numDerivs + 1>(suite), ...); }
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    Opm::Benchmark::Suite suite("densead", argc, argv);
+
+    benchAllSizes(suite, std::make_integer_sequence<int, 12>());
+
+    benchSingleVariableFunction<Opm::DenseAd::Evaluation<Scalar, 8>, 8>(suite, "DenseAd::Evaluation");
+    benchSingleVariableFunction<Opm::DenseAd::SparseEvaluation<Scalar, 8>, 8>(suite, "DenseAd::SparseEvaluation");
+    benchSingleVariableFunction<Opm::DenseAd::Evaluation<Scalar, 12>, 12>(suite, "DenseAd::Evaluation");
+    benchSingleVariableFunction<Opm::DenseAd::SparseEvaluation<Scalar, 12>, 12>(suite, "DenseAd::SparseEvaluation");
+
+    benchEvaluationBlock<3, 8>(suite);
+    benchEvaluationBlock<4, 8>(suite);
+    benchEvaluationBlock<6, 8>(suite);
+
+    benchCachedQuantities<Opm::DenseAd::Evaluation<Scalar, 8>, 8>(suite, "DenseAd::Evaluation");
+    benchCachedQuantities<Opm::DenseAd::MixedPrecisionEvaluation<Scalar, 8, float>, 8>(suite, "DenseAd::MixedPrecisionEvaluation");
+    benchCachedQuantities<Opm::DenseAd::Evaluation<Scalar, 12>, 12>(suite, "DenseAd::Evaluation");
+    benchCachedQuantities<Opm::DenseAd::MixedPrecisionEvaluation<Scalar, 12, float>, 12>(suite, "DenseAd::MixedPrecisionEvaluation");
+
+    benchBatchMath<1>(suite);
+    benchBatchMath<4>(suite);
+
+    benchValueOnlyMode<4>(suite);
+    benchValueOnlyMode<12>(suite);
+
+    benchDynamicEvaluation<0>(suite, 24);
+    benchDynamicEvaluation<25>(suite, 24);
+    benchFastSmallVector<Opm::FastSmallVectorHeapAllocator<Scalar>>(suite, "heap");
+    benchFastSmallVector<Opm::FastSmallVectorPoolAllocator<Scalar>>(suite, "pool");
+
+    return suite.finish();
+}
@@ -0,0 +1,216 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmarks for the relative permeabilities and capillary pressures of the
+ *        material laws created by EclMaterialLawManager.
+ *
+ * The saturation functions are read from a synthetic deck with Corey-type SWOF and SGOF
+ * tables in two saturation regions.
+ */
+#include "config.h"
+
+#if !HAVE_ECL_INPUT
+#error "The benchmark for EclMaterialLawManager requires ecl input support in opm-common"
+#endif
+
+#include "BenchmarkHarness.hpp"
+
+#include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
+#include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+#include <opm/material/densead/Evaluation.hpp>
+
+#include <opm/input/eclipse/Parser/Parser.hpp>
+#include <opm/input/eclipse/Deck/Deck.hpp>
+#include <opm/input/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/input/eclipse/EclipseState/Grid/EclipseGrid.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using Scalar = double;
+
+enum { numPhases = 3 };
+enum { waterPhaseIdx = 0 };
+enum { oilPhaseIdx = 1 };
+enum { gasPhaseIdx = 2 };
+
+using MaterialTraits = Opm::ThreePhaseMaterialTraits<Scalar,
+                                                     /*wettingPhaseIdx=*/waterPhaseIdx,
+                                                     /*nonWettingPhaseIdx=*/oilPhaseIdx,
+                                                     /*gasPhaseIdx=*/gasPhaseIdx>;
+using MaterialLawManager = Opm::EclMaterialLawManager<MaterialTraits>;
+using MaterialLaw = typename MaterialLawManager::MaterialLaw;
+
+template <class Evaluation>
+using FluidState = Opm::SimpleModularFluidState<Evaluation,
+                                                /*numPhases=*/3,
+                                                /*numComponents=*/3,
+                                                void,
+                                                /*storePressure=*/false,
+                                                /*storeTemperature=*/false,
+                                                /*storeComposition=*/false,
+                                                /*storeFugacity=*/false,
+                                                /*storeSaturation=*/true,
+                                                /*storeDensity=*/false,
+                                                /*storeViscosity=*/false,
+                                                /*storeEnthalpy=*/false>;
+
+constexpr unsigned numSatRegions = 2;
+
+// create a deck with Corey-type saturation functions in FIELD units
+std::string syntheticDeck()
+{
+    std::ostringstream deck;
+    deck << "RUNSPEC\n"
+         << "DIMENS\n 32 32 1 /\n"
+         << "TABDIMS\n " << numSatRegions << " /\n"
+         << "OIL\nGAS\nWATER\nDISGAS\n"
+         << "FIELD\n"
+         << "GRID\n"
+         << "DX\n 1024*100 /\nDY\n 1024*100 /\nDZ\n 1024*20 /\nTOPS\n 1024*8000 /\nPORO\n 1024*0.2 /\n"
+         << "PROPS\n";
+
+    const unsigned numSamples = 20;
+    deck << "SWOF\n";
+    for (unsigned regionIdx = 0; regionIdx < numSatRegions; ++regionIdx) {
+        const Scalar Swc = 0.1 + 0.05*regionIdx;
+        const Scalar Sorw = 0.15;
+        for (unsigned i = 0; i < numSamples; ++i) {
+            const Scalar Sw = Swc + (1.0 - Swc)*i/(numSamples - 1);
+            const Scalar SwEff = std::clamp((Sw - Swc)/(1.0 - Swc - Sorw), 0.0, 1.0);
+            deck << Sw << "  " << std::pow(SwEff, 3.0)
+                 << "  " << std::pow(1.0 - SwEff, 2.0)
+                 << "  " << 5.0*(1.0 - SwEff) << "\n";
+        }
+        deck << "/\n";
+    }
+
+    deck << "SGOF\n";
+    for (unsigned regionIdx = 0; regionIdx < numSatRegions; ++regionIdx) {
+        const Scalar Swc = 0.1 + 0.05*regionIdx;
+        const Scalar Sgmax = 1.0 - Swc;
+        const Scalar Sorg = 0.1;
+        for (unsigned i = 0; i < numSamples; ++i) {
+            const Scalar Sg = Sgmax*i/(numSamples - 1);
+            const Scalar SgEff = std::clamp(Sg/(Sgmax - Sorg), 0.0, 1.0);
+            deck << Sg << "  " << std::pow(SgEff, 2.0)
+                 << "  " << std::pow(1.0 - SgEff, 3.0)
+                 << "  " << 2.0*SgEff << "\n";
+        }
+        deck << "/\n";
+    }
+
+    deck << "REGIONS\n"
+         << "SATNUM\n 512*1 512*2 /\n";
+
+    return deck.str();
+}
+
+template <class Evaluation>
+Evaluation makeVariable(Scalar value, unsigned varIdx)
+{
+    if constexpr (std::is_floating_point<Evaluation>::value)
+        return value;
+    else
+        return Evaluation::createVariable(value, varIdx);
+}
+
+template <class Evaluation>
+std::vector<FluidState<Evaluation>> createFluidStates(std::size_t numCells)
+{
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<Scalar> dist(0.0, 1.0);
+
+    std::vector<FluidState<Evaluation>> fluidStates(numCells);
+    for (auto& fs : fluidStates) {
+        const Evaluation Sw = makeVariable<Evaluation>(0.1 + 0.8*dist(gen), 0);
+        const Evaluation Sg = makeVariable<Evaluation>((1.0 - Opm::getValue(Sw))*dist(gen), 1);
+        fs.setSaturation(waterPhaseIdx, Sw);
+        fs.setSaturation(gasPhaseIdx, Sg);
+        fs.setSaturation(oilPhaseIdx, 1.0 - Sw - Sg);
+    }
+    return fluidStates;
+}
+
+template <class Evaluation>
+void benchMaterialLaw(Opm::Benchmark::Suite& suite,
+                      const MaterialLawManager& materialLawManager,
+                      std::size_t numCells,
+                      const std::string& evalName)
+{
+    const auto fluidStates = createFluidStates<Evaluation>(numCells);
+
+    suite.run("EclMaterialLaw/relativePermeabilities/" + evalName, numCells, [&]() {
+        Evaluation sum = 0.0;
+        for (std::size_t elemIdx = 0; elemIdx < numCells; ++elemIdx) {
+            Evaluation kr[numPhases];
+            MaterialLaw::relativePermeabilities(kr,
+                                                materialLawManager.materialLawParams(elemIdx),
+                                                fluidStates[elemIdx]);
+            sum += kr[waterPhaseIdx] + kr[oilPhaseIdx] + kr[gasPhaseIdx];
+        }
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    suite.run("EclMaterialLaw/capillaryPressures/" + evalName, numCells, [&]() {
+        Evaluation sum = 0.0;
+        for (std::size_t elemIdx = 0; elemIdx < numCells; ++elemIdx) {
+            Evaluation pc[numPhases];
+            MaterialLaw::capillaryPressures(pc,
+                                            materialLawManager.materialLawParams(elemIdx),
+                                            fluidStates[elemIdx]);
+            sum += pc[waterPhaseIdx] + pc[oilPhaseIdx] + pc[gasPhaseIdx];
+        }
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    Opm::Benchmark::Suite suite("materiallaw", argc, argv);
+
+    Opm::Parser parser;
+    const auto deck = parser.parseString(syntheticDeck());
+    const Opm::EclipseState eclState(deck);
+    const std::size_t numCells = eclState.getInputGrid().getCartesianSize();
+
+    MaterialLawManager materialLawManager;
+    materialLawManager.initFromState(eclState);
+    materialLawManager.initParamsForElements(eclState, numCells);
+
+    benchMaterialLaw<Scalar>(suite, materialLawManager, numCells, "scalar");
+    benchMaterialLaw<Opm::DenseAd::Evaluation<Scalar, 3>>(suite, materialLawManager, numCells, "ad3");
+
+    return suite.finish();
+}
@@ -0,0 +1,155 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmarks for PTFlash::solve() using the three-component and the CO2-brine
+ *        fluid systems.
+ *
+ * The initial conditions are the same as the ones of the test_threecomponents_ptflash
+ * and test_co2brine_ptflash tests.
+ */
+#include "config.h"
+
+#include "BenchmarkHarness.hpp"
+
+#include <opm/material/constraintsolvers/PTFlash.hpp>
+#include <opm/material/fluidsystems/ThreeComponentFluidSystem.hh>
+#include <opm/material/fluidsystems/Co2BrineFluidSystem.hh>
+
+#include <opm/material/densead/Evaluation.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
+
+#include <dune/common/fvector.hh>
+
+#include <array>
+#include <string>
+
+namespace {
+
+using Scalar = double;
+
+template <class FluidSystem>
+struct FlashCase
+{
+    static constexpr int numComponents = FluidSystem::numComponents;
+    using Evaluation = Opm::DenseAd::Evaluation<Scalar, numComponents>;
+    using ComponentVector = Dune::FieldVector<Evaluation, numComponents>;
+    using FluidState = Opm::CompositionalFluidState<Evaluation, FluidSystem>;
+
+    FluidState fluidState;
+    ComponentVector z;
+
+    // set up the initial fluid state and the total mole fractions. the primary
+    // variables are the pressure and the mole fractions of all but the last component
+    FlashCase(Scalar p, const std::array<Scalar, numComponents - 1>& moleFractions, Scalar T)
+    {
+        const Evaluation pInit = Evaluation::createVariable(p, 0);
+        ComponentVector comp;
+        Evaluation compLast = 1.0;
+        for (int compIdx = 0; compIdx < numComponents - 1; ++compIdx) {
+            comp[compIdx] = Evaluation::createVariable(moleFractions[compIdx], compIdx + 1);
+            compLast -= comp[compIdx];
+        }
+        comp[numComponents - 1] = compLast;
+
+        // everything is in the oil phase initially
+        for (unsigned phaseIdx : { FluidSystem::oilPhaseIdx, FluidSystem::gasPhaseIdx }) {
+            fluidState.setPressure(phaseIdx, pInit);
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidState.setMoleFraction(phaseIdx, compIdx, comp[compIdx]);
+        }
+        fluidState.setSaturation(FluidSystem::oilPhaseIdx, 1.0);
+        fluidState.setSaturation(FluidSystem::gasPhaseIdx, 0.0);
+        fluidState.setTemperature(T);
+
+        {
+            typename FluidSystem::template ParameterCache<Evaluation> paramCache;
+            paramCache.updatePhase(fluidState, FluidSystem::oilPhaseIdx);
+            paramCache.updatePhase(fluidState, FluidSystem::gasPhaseIdx);
+            fluidState.setDensity(FluidSystem::oilPhaseIdx,
+                                  FluidSystem::density(fluidState, paramCache, FluidSystem::oilPhaseIdx));
+            fluidState.setDensity(FluidSystem::gasPhaseIdx,
+                                  FluidSystem::density(fluidState, paramCache, FluidSystem::gasPhaseIdx));
+        }
+
+        z = 0.0;
+        Scalar sumMoles = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx) {
+            for (int compIdx = 0; compIdx < numComponents; ++compIdx) {
+                const Scalar tmp = Opm::getValue(fluidState.molarity(phaseIdx, compIdx)
+                                                 * fluidState.saturation(phaseIdx));
+                z[compIdx] += Opm::max(tmp, 1e-8);
+                sumMoles += tmp;
+            }
+        }
+        z /= sumMoles;
+        Evaluation zLast = 1.0;
+        for (int compIdx = 0; compIdx < numComponents - 1; ++compIdx) {
+            z[compIdx] = Evaluation::createVariable(Opm::getValue(z[compIdx]), compIdx + 1);
+            zLast -= z[compIdx];
+        }
+        z[numComponents - 1] = zLast;
+
+        for (int compIdx = 0; compIdx < numComponents; ++compIdx)
+            fluidState.setKvalue(compIdx, fluidState.wilsonK_(compIdx));
+        fluidState.setLvalue(1.0);
+    }
+};
+
+template <class FluidSystem>
+void benchFlash(Opm::Benchmark::Suite& suite,
+                const std::string& systemName,
+                const FlashCase<FluidSystem>& flashCase)
+{
+    using Flash = Opm::PTFlash<Scalar, FluidSystem>;
+
+    const Scalar tolerance = 1e-12;
+    const int verbosity = 0;
+    const int spatialIdx = 0;
+
+    for (const std::string method : { "newton", "ssi", "ssi+newton" }) {
+        suite.run("PTFlash/solve/" + systemName + "/" + method, 1, [&]() {
+            auto fluidState = flashCase.fluidState;
+            Flash::solve(fluidState, flashCase.z, spatialIdx, method, tolerance, verbosity);
+            Opm::Benchmark::doNotOptimize(fluidState.L());
+        });
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    Opm::Benchmark::Suite suite("ptflash", argc, argv);
+
+    using ThreeComponentSystem = Opm::ThreeComponentFluidSystem<Scalar>;
+    const FlashCase<ThreeComponentSystem> threeComponentCase(10e5, {0.5, 0.3}, 300.0);
+    benchFlash(suite, "threecomponents", threeComponentCase);
+
+    using Co2BrineSystem = Opm::Co2BrineFluidSystem<Scalar>;
+    const FlashCase<Co2BrineSystem> co2BrineCase(10e5, {0.5}, 300.0);
+    benchFlash(suite, "co2brine", co2BrineCase);
+
+    return suite.finish();
+}
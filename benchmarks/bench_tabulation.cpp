@@ -0,0 +1,190 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Benchmarks for the evaluation of Tabulated1DFunction and
+ *        UniformXTabulated2DFunction.
+ */
+#include "config.h"
+
+#include "BenchmarkHarness.hpp"
+
+#include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/UniformXTabulated2DFunction.hpp>
+#include <opm/material/densead/Evaluation.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Scalar = double;
+using AdEval = Opm::DenseAd::Evaluation<Scalar, 3>;
+
+constexpr std::size_t numPoints = 4096;
+
+std::vector<Scalar> randomValues(Scalar min, Scalar max, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<Scalar> dist(min, max);
+    std::vector<Scalar> values(numPoints);
+    for (auto& v : values)
+        v = dist(gen);
+    return values;
+}
+
+std::vector<AdEval> toAd(const std::vector<Scalar>& values, unsigned varIdx)
+{
+    std::vector<AdEval> result;
+    for (Scalar v : values)
+        result.push_back(AdEval::createVariable(v, varIdx));
+    return result;
+}
+
+void benchTabulated1D(Opm::Benchmark::Suite& suite)
+{
+    // a smooth function with the typical number of sampling points of a PVT table
+    const unsigned numSamples = 100;
+    std::vector<Scalar> xs(numSamples), ys(numSamples);
+    for (unsigned i = 0; i < numSamples; ++i) {
+        xs[i] = 1e5 + i*5e5;
+        ys[i] = std::sqrt(xs[i]);
+    }
+    const Opm::Tabulated1DFunction<Scalar> fn(numSamples, xs, ys);
+
+    const auto x = randomValues(xs.front(), xs.back(), 42);
+    auto xSorted = x;
+    std::sort(xSorted.begin(), xSorted.end());
+    const auto xAd = toAd(x, 0);
+
+    suite.run("Tabulated1DFunction/eval/random", numPoints, [&]() {
+        Scalar sum = 0.0;
+        for (Scalar v : x)
+            sum += fn.eval(v);
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    suite.run("Tabulated1DFunction/eval/sorted", numPoints, [&]() {
+        Scalar sum = 0.0;
+        for (Scalar v : xSorted)
+            sum += fn.eval(v);
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    suite.run("Tabulated1DFunction/eval/sorted_cursor", numPoints, [&]() {
+        Opm::SegmentCursor cursor;
+        Scalar sum = 0.0;
+        for (Scalar v : xSorted)
+            sum += fn.eval(v, cursor);
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    std::vector<Scalar> result(numPoints);
+    suite.run("Tabulated1DFunction/eval/batch", numPoints, [&]() {
+        fn.eval(x.data(), result.data(), numPoints);
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run("Tabulated1DFunction/eval/ad3", numPoints, [&]() {
+        AdEval sum = 0.0;
+        for (const auto& v : xAd)
+            sum += fn.eval(v);
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    suite.run("Tabulated1DFunction/evalDerivative/random", numPoints, [&]() {
+        Scalar sum = 0.0;
+        for (Scalar v : x)
+            sum += fn.evalDerivative(v);
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+}
+
+void benchUniformXTabulated2D(Opm::Benchmark::Suite& suite)
+{
+    // mimics the layout of a PVTO table: a few dozen dissolution factors with a
+    // pressure range which moves with the dissolution factor. like the PVT classes,
+    // the lookups thus need to extrapolate the neighbouring columns.
+    using Table = Opm::UniformXTabulated2DFunction<Scalar>;
+    Table fn(Table::InterpolationPolicy::LeftExtreme);
+    const unsigned numX = 30;
+    const unsigned numY = 20;
+    for (unsigned i = 0; i < numX; ++i) {
+        const Scalar Rs = 10.0*i;
+        fn.appendXPos(Rs);
+        for (unsigned j = 0; j < numY; ++j) {
+            const Scalar p = 20e5 + 1e5*Rs + j*25e5;
+            fn.appendSamplePoint(i, p, 1.0/(1.0 + 1e-3*Rs - 1e-10*p));
+        }
+    }
+
+    const auto Rs = randomValues(0.0, 10.0*(numX - 1), 1);
+    std::vector<Scalar> p(numPoints);
+    for (std::size_t k = 0; k < numPoints; ++k)
+        p[k] = 20e5 + 1e5*Rs[k] + 0.9*(numY - 1)*25e5*Scalar(k % 97)/97;
+    const auto RsAd = toAd(Rs, 1);
+    const auto pAd = toAd(p, 0);
+
+    suite.run("UniformXTabulated2DFunction/eval/random", numPoints, [&]() {
+        Scalar sum = 0.0;
+        for (std::size_t k = 0; k < numPoints; ++k)
+            sum += fn.eval(Rs[k], p[k], /*extrapolate=*/true);
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    suite.run("UniformXTabulated2DFunction/eval/cursor", numPoints, [&]() {
+        Table::Cursor cursor;
+        Scalar sum = 0.0;
+        for (std::size_t k = 0; k < numPoints; ++k)
+            sum += fn.eval(Rs[k], p[k], cursor, /*extrapolate=*/true);
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+
+    std::vector<Scalar> result(numPoints);
+    suite.run("UniformXTabulated2DFunction/eval/batch", numPoints, [&]() {
+        fn.eval(Rs.data(), p.data(), result.data(), numPoints, /*extrapolate=*/true);
+        Opm::Benchmark::doNotOptimize(result.front());
+    });
+
+    suite.run("UniformXTabulated2DFunction/eval/ad3", numPoints, [&]() {
+        AdEval sum = 0.0;
+        for (std::size_t k = 0; k < numPoints; ++k)
+            sum += fn.eval(RsAd[k], pAd[k], /*extrapolate=*/true);
+        Opm::Benchmark::doNotOptimize(sum);
+    });
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    Opm::Benchmark::Suite suite("tabulation", argc, argv);
+
+    benchTabulated1D(suite);
+    benchUniformXTabulated2D(suite);
+
+    return suite.finish();
+}
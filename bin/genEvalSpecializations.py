@@ -21,7 +21,12 @@ maxDerivs = 12
 if len(sys.argv) == 2:
     maxDerivs = int(sys.argv[1])
 
+# the specializations for at least this many derivatives are replaced by the
+# explicitly vectorized Evaluation class if OPM_DENSEAD_SIMD is enabled
+minSimdDerivs = 4
+
 specializationFileNames = []
+nonSimdSpecializationFileNames = []
 
 specializationTemplate = \
 """// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
@@ -75,9 +80,18 @@ specializationTemplate = \
 
 #include "Evaluation.hpp"
 #include "Math.hpp"
+#include "Expressions.hpp"
+#include "ValueOnlyMode.hpp"
+#include "OperationCounter.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 
+{% if numDerivs == 0 %}\
+#if OPM_DENSEAD_SIMD
+#include "EvaluationSimd.hpp"
+#endif
+
+{% endif %}\
 {% if numDerivs < 0 %}\
 #include <opm/material/common/FastSmallVector.hpp>
 {% else %}\
@@ -89,6 +103,16 @@ specializationTemplate = \
 #include <iostream>
 #include <algorithm>
 
+{% if numDerivs < 0 %}\
+//! The number of entries (i.e., the value plus the derivatives) which dynamically
+//! sized evaluations store without allocating memory if the staticSize template
+//! parameter is zero. Evaluations with more derivatives use the heap buffers of
+//! FastSmallVector, which are recycled by a thread-local pool.
+#ifndef OPM_DENSEAD_DYNAMIC_INLINE_SIZE
+#define OPM_DENSEAD_DYNAMIC_INLINE_SIZE 0
+#endif
+
+{% endif %}\
 namespace Opm {
 namespace DenseAd {
 {% if numDerivs == 0 %}\
@@ -101,10 +125,15 @@ static constexpr int DynamicSize = -1;
 /*!
  * \\brief Represents a function evaluation and its derivatives w.r.t. a
  *        run-time specified set of variables.
+ *
+ * Up to staticSize entries (the value plus staticSize - 1 derivatives) are stored
+ * inside of the object, larger evaluations allocate memory. A staticSize of zero
+ * selects OPM_DENSEAD_DYNAMIC_INLINE_SIZE.
  */
 template <class ValueT, unsigned staticSize>
 class Evaluation<ValueT, DynamicSize, staticSize>
 {% elif numDerivs == 0 %}\
+#if !OPM_DENSEAD_SIMD
 /*!
  * \\brief Represents a function evaluation and its derivatives w.r.t. a fixed set of
  *        variables.
@@ -121,6 +150,10 @@ public:
     //! derivatives (-1 == "DynamicSize" means runtime determined)
 {% if numDerivs < 0 %}\
     static const int numVars = DynamicSize;
+
+    //! the number of entries stored without allocating memory
+    static constexpr unsigned inlineSize =
+        staticSize > 0 ? staticSize : OPM_DENSEAD_DYNAMIC_INLINE_SIZE;
 {% elif numDerivs > 0 %}\
     static const int numVars = {{ numDerivs }};
 {% else %}\
@@ -237,7 +270,7 @@ public:
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
     // derivatives being zero.
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation(const RhsValueType& c)
     {
         setValue(c);
@@ -247,6 +280,19 @@ public:
     }
 {% endif %}\
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation(const Expression<ExprT>& expr)
+{% if numDerivs < 0 %}\
+        : data_(1 + expr.asImp().size())
+{% endif %}\
+    {
+        countOperation(CountedOperation::temporary);
+        assignExpression_(expr.asImp());
+
+        checkDefined_();
+    }
+
     // create an evaluation which represents a constant function
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
@@ -469,6 +515,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] += other.data_[valuepos_()];
+            return *this;
+        }
+
 {% if numDerivs <= 0 %}\
         for (int i = 0; i < length_(); ++i)
             data_[i] += other.data_[i];
@@ -482,7 +533,7 @@ public:
     }
 
     // add value from other to this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator+=(const RhsValueType& other)
     {
         // value is added, derivatives stay the same
@@ -496,6 +547,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] -= other.data_[valuepos_()];
+            return *this;
+        }
+
 {% if numDerivs <= 0 %}\
         for (int i = 0; i < length_(); ++i)
             data_[i] -= other.data_[i];
@@ -509,7 +565,7 @@ public:
     }
 
     // subtract other's value from this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator-=(const RhsValueType& other)
     {
         // for constants, values are subtracted, derivatives stay the same
@@ -522,12 +578,18 @@ public:
     Evaluation& operator*=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::multiplication);
 
         // while the values are multiplied, the derivatives follow the product rule,
         // i.e., (u*v)' = (v'u + u'v).
         const ValueType u = this->value();
         const ValueType v = other.value();
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= v;
+            return *this;
+        }
+
         // value
         data_[valuepos_()] *= v ;
 
@@ -545,9 +607,16 @@ public:
     }
 
     // m(c*u)' = c*u'
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator*=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::multiplication);
+
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= other;
+            return *this;
+        }
+
 {% if numDerivs <= 0 %}\
         for (int i = 0; i < length_(); ++i)
             data_[i] *= other;
@@ -564,11 +633,17 @@ public:
     Evaluation& operator/=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::division);
 
         // values are divided, derivatives follow the rule for division, i.e., (u/v)' = (v'u -
         // u'v)/v^2.
         ValueType& u = data_[valuepos_()];
         const ValueType& v = other.value();
+        if (!derivativesEnabled()) {
+            u /= v;
+            return *this;
+        }
+
 {% if numDerivs <= 0 %}\
         for (int idx = dstart_(); idx < dend_(); ++idx) {
             const ValueType& uPrime = data_[idx];
@@ -587,11 +662,18 @@ public:
     }
 
     // divide value and derivatives by value of other
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator/=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::division);
+
         const ValueType tmp = 1.0/other;
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= tmp;
+            return *this;
+        }
+
 {% if numDerivs <= 0 %}\
         for (int i = 0; i < length_(); ++i)
             data_[i] *= tmp;
@@ -609,6 +691,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -617,9 +700,10 @@ public:
     }
 
     // add constant to this object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator+(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -632,6 +716,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -640,9 +725,10 @@ public:
     }
 
     // subtract constant from evaluation object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator-(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -653,6 +739,7 @@ public:
     // negation (unary minus) operator
     Evaluation operator-() const
     {
+        countOperation(CountedOperation::temporary);
 {% if numDerivs < 0 %}\
         Evaluation result(*this);
 {% else %}\
@@ -676,6 +763,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -683,9 +771,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator*(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -697,6 +786,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -704,9 +794,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator/(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -714,7 +805,7 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator=(const RhsValueType& other)
     {
         setValue( other );
@@ -723,6 +814,20 @@ public:
         return *this;
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation& operator=(const Expression<ExprT>& expr)
+    {
+{% if numDerivs < 0 %}\
+        if (size() != expr.asImp().size())
+            data_ = FastSmallVector<ValueT, inlineSize>(1 + expr.asImp().size());
+
+{% endif %}\
+        assignExpression_(expr.asImp());
+
+        return *this;
+    }
+
     // copy assignment from evaluation
     Evaluation& operator=(const Evaluation& other) = default;
 
@@ -818,16 +923,38 @@ public:
         data_[dstart_() + varIdx] = derVal;
     }
 
+protected:
+    // the values of all nodes of the expression are computed by the time it gets
+    // here, so the expression may reference this object
+    template <class ExprT>
+    void assignExpression_(const ExprT& expr)
+    {
+        assert(size() == expr.size());
+
+        data_[valuepos_()] = expr.value();
+{% if numDerivs <= 0 %}\
+        for (int i = dstart_(); i < dend_(); ++i)
+            data_[i] = expr.derivative(i - dstart_());
+{% else %}\
+{%   for i in range(1, numDerivs+1) %}\
+        data_[{{i}}] = expr.derivative({{i - 1}});
+{%   endfor %}\
+{% endif %}\
+    }
+
 private:
 
 {% if numDerivs < 0 %}\
-    FastSmallVector<ValueT, staticSize> data_;
+    FastSmallVector<ValueT, inlineSize> data_;
 {% elif numDerivs == 0 %}\
     std::array<ValueT, numDerivs + 1> data_;
 {% else %}\
     std::array<ValueT, {{numDerivs + 1}}> data_;
 {% endif %}\
 };
+{% if numDerivs == 0 %}\
+#endif // !OPM_DENSEAD_SIMD
+{% endif %}\
 
 {% if numDerivs == 0 %}\
 // the generic operators are only required for the unspecialized case
@@ -851,31 +978,38 @@ template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
 bool operator!=(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 { return a != b.value(); }
 
-template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
+template <class RhsValueType, class ValueType, int numVars, unsigned staticSize,
+          EnableIfNotExpression<RhsValueType> = 0>
 Evaluation<ValueType, numVars, staticSize> operator+(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 {
+    countOperation(CountedOperation::temporary);
     Evaluation<ValueType, numVars, staticSize> result(b);
     result += a;
     return result;
 }
 
-template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
+template <class RhsValueType, class ValueType, int numVars, unsigned staticSize,
+          EnableIfNotExpression<RhsValueType> = 0>
 Evaluation<ValueType, numVars, staticSize> operator-(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 {
     return -(b - a);
 }
 
-template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
+template <class RhsValueType, class ValueType, int numVars, unsigned staticSize,
+          EnableIfNotExpression<RhsValueType> = 0>
 Evaluation<ValueType, numVars, staticSize> operator/(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 {
+    countOperation(CountedOperation::temporary);
     Evaluation<ValueType, numVars, staticSize> tmp(a);
     tmp /= b;
     return tmp;
 }
 
-template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
+template <class RhsValueType, class ValueType, int numVars, unsigned staticSize,
+          EnableIfNotExpression<RhsValueType> = 0>
 Evaluation<ValueType, numVars, staticSize> operator*(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 {
+    countOperation(CountedOperation::temporary);
     Evaluation<ValueType, numVars, staticSize> result(b);
     result *= a;
     return result;
@@ -973,6 +1107,26 @@ includeSpecializationsTemplate = \
 #include <{{ fileName }}>
 {% endfor %}\
 
+// the explicitly vectorized Evaluation class handles all larger static sizes by
+// itself. below that, the vectors are mostly padding and scalar code is faster.
+#if !OPM_DENSEAD_SIMD
+{% for fileName in nonSimdSpecializationFileNames %}\
+#include <{{ fileName }}>
+{% endfor %}\
+#endif // !OPM_DENSEAD_SIMD
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+namespace Opm {
+namespace DenseAd {
+// libopmmaterial contains the evaluations with double precision for the statically
+// specialized numbers of derivatives (see opm/material/densead/Evaluation.cpp)
+{% for numDerivs in instantiatedSizes %}\
+extern template class Evaluation<double, {{ numDerivs }}>;
+{% endfor %}\
+} // namespace DenseAd
+} // namespace Opm
+#endif // OPM_MATERIAL_EXTERN_TEMPLATES
+
 #endif // OPM_DENSEAD_EVALUATION_SPECIALIZATIONS_HPP
 """
 
@@ -997,7 +1151,10 @@ for numDerivs in range(1, maxDerivs + 1):
     print ("Generating specialization for %d derivatives"%numDerivs)
 
     fileName = "opm/material/densead/Evaluation%d.hpp"%numDerivs
-    specializationFileNames.append(fileName)
+    if numDerivs < minSimdDerivs:
+        specializationFileNames.append(fileName)
+    else:
+        nonSimdSpecializationFileNames.append(fileName)
 
     template = jinja2.Template(specializationTemplate)
     fileContents = template.render(numDerivs=numDerivs, scriptName=os.path.basename(sys.argv[0]))
@@ -1007,7 +1164,10 @@ for numDerivs in range(1, maxDerivs + 1):
     f.close()
 
 template = jinja2.Template(includeSpecializationsTemplate)
-fileContents = template.render(specializationFileNames=specializationFileNames, scriptName=os.path.basename(sys.argv[0]))
+fileContents = template.render(specializationFileNames=specializationFileNames,
+                               nonSimdSpecializationFileNames=nonSimdSpecializationFileNames,
+                               instantiatedSizes=range(1, maxDerivs + 1),
+                               scriptName=os.path.basename(sys.argv[0]))
 
 f = open("opm/material/densead/EvaluationSpecializations.hpp", "w")
 f.write(fileContents)
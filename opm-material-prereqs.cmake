@@ -5,6 +5,12 @@ set (opm-material_CONFIG_VAR
   HAVE_VALGRIND
   HAVE_FINAL
   HAVE_ECL_INPUT
+  OPM_DENSEAD_SIMD
+  OPM_DENSEAD_SIMD_BYTES
+  OPM_DENSEAD_DYNAMIC_INLINE_SIZE
+  OPM_DENSEAD_VALUE_ONLY_MODE
+  OPM_DENSEAD_COUNT_OPERATIONS
+  OPM_MATERIAL_EXTERN_TEMPLATES
   )
 
 # dependencies
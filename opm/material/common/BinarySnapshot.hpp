@@ -0,0 +1,569 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief A versioned binary file format to store fully initialized tables and
+ *        parameter objects.
+ *
+ * Objects take part in a snapshot by providing a method
+ *
+ * \code
+ * template <class Serializer>
+ * void serializeOp(Serializer& serializer)
+ * { serializer(member1_); serializer(member2_); ... }
+ * \endcode
+ *
+ * which is used for both, writing and reading. Arithmetic values are stored in
+ * little-endian byte order, integers always use 64 bits. Thus snapshots can be
+ * exchanged between hosts of different endianess and word size, but they are specific
+ * to the floating point type which was used to write them. Snapshots are read from a
+ * memory mapped file if the platform supports it.
+ */
+#ifndef OPM_BINARY_SNAPSHOT_HPP
+#define OPM_BINARY_SNAPSHOT_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OPM_SNAPSHOT_HAVE_MMAP 1
+#else
+#define OPM_SNAPSHOT_HAVE_MMAP 0
+#endif
+
+namespace Opm {
+namespace SnapshotDetail {
+//! The first bytes of each snapshot file
+inline constexpr char magic[8] = { 'O', 'P', 'M', 'S', 'N', 'A', 'P', '\0' };
+
+//! The version of the file format. Increment this if the layout of any object changes.
+inline constexpr std::uint32_t formatVersion = 1;
+
+inline bool hostIsLittleEndian()
+{
+    const std::uint16_t probe = 1;
+    unsigned char firstByte;
+    std::memcpy(&firstByte, &probe, 1);
+    return firstByte == 1;
+}
+
+inline void reverseBytes(char* bytes, std::size_t size)
+{
+    for (std::size_t i = 0; i < size/2; ++i)
+        std::swap(bytes[i], bytes[size - i - 1]);
+}
+
+// 64 bit FNV-1a hash of the payload
+inline std::uint64_t checksum(const char* data, std::size_t size)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// the type which is used to store a value of an arithmetic type or of an enumeration
+template <class T, class Enable = void>
+struct StorageType
+{ using type = T; };
+
+template <class T>
+struct StorageType<T, std::enable_if_t<std::is_enum<T>::value>>
+{ using type = std::int64_t; };
+
+template <>
+struct StorageType<bool>
+{ using type = std::uint8_t; };
+
+template <class T>
+struct StorageType<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>>
+{ using type = std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>; };
+
+template <class T>
+constexpr bool isStoredDirectly()
+{ return std::is_arithmetic<T>::value || std::is_enum<T>::value; }
+
+// types which have the same size in memory and in the file, and thus can be copied
+// as a block on little-endian hosts
+template <class T>
+constexpr bool isBlockCopyable()
+{ return isStoredDirectly<T>() && std::is_same<typename StorageType<T>::type, T>::value; }
+
+template <class T>
+struct IsStdVector : std::false_type {};
+template <class T, class A>
+struct IsStdVector<std::vector<T, A>> : std::true_type {};
+
+template <class T>
+struct IsStdArray : std::false_type {};
+template <class T, std::size_t n>
+struct IsStdArray<std::array<T, n>> : std::true_type {};
+
+template <class T>
+struct IsStdPair : std::false_type {};
+template <class T1, class T2>
+struct IsStdPair<std::pair<T1, T2>> : std::true_type {};
+
+template <class T>
+struct IsSharedPtr : std::false_type {};
+template <class T>
+struct IsSharedPtr<std::shared_ptr<T>> : std::true_type {};
+} // namespace SnapshotDetail
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Provides read-only access to the contents of a file.
+ *
+ * The file is memory mapped if the platform supports this. Otherwise, it is read
+ * into a buffer.
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& fileName)
+    {
+#if OPM_SNAPSHOT_HAVE_MMAP
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Could not open file '" + fileName + "'");
+
+        struct stat fileStat;
+        if (::fstat(fd, &fileStat) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not determine the size of file '" + fileName + "'");
+        }
+
+        size_ = static_cast<std::size_t>(fileStat.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not memory map file '" + fileName + "'");
+            }
+            mapping_ = addr;
+            data_ = static_cast<const char*>(addr);
+        }
+        ::close(fd);
+#else
+        std::ifstream is(fileName, std::ios::binary | std::ios::ate);
+        if (!is)
+            throw std::runtime_error("Could not open file '" + fileName + "'");
+
+        buffer_.resize(static_cast<std::size_t>(is.tellg()));
+        is.seekg(0);
+        if (!is.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size())))
+            throw std::runtime_error("Could not read file '" + fileName + "'");
+
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+#if OPM_SNAPSHOT_HAVE_MMAP
+        if (mapping_)
+            ::munmap(mapping_, size_);
+#endif
+    }
+
+    /*!
+     * \brief Returns a pointer to the first byte of the file.
+     */
+    const char* data() const
+    { return data_; }
+
+    /*!
+     * \brief Returns the size of the file in bytes.
+     */
+    std::size_t size() const
+    { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+#if OPM_SNAPSHOT_HAVE_MMAP
+    void* mapping_ = nullptr;
+#else
+    std::vector<char> buffer_;
+#endif
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Serializes objects into the payload of a snapshot.
+ */
+class SnapshotWriter
+{
+public:
+    /*!
+     * \brief Returns false, this serializer only writes.
+     */
+    bool isReading() const
+    { return false; }
+
+    /*!
+     * \brief Append an object to the snapshot.
+     */
+    template <class T>
+    void operator()(const T& value)
+    {
+        using namespace SnapshotDetail;
+
+        if constexpr (isStoredDirectly<T>())
+            writeValues_(&value, 1);
+        else if constexpr (std::is_array<T>::value) {
+            for (const auto& v : value)
+                (*this)(v);
+        }
+        else if constexpr (IsStdVector<T>::value) {
+            writeSize_(value.size());
+            writeRange_(value.data(), value.size());
+        }
+        else if constexpr (IsStdArray<T>::value)
+            writeRange_(value.data(), value.size());
+        else if constexpr (IsStdPair<T>::value) {
+            (*this)(value.first);
+            (*this)(value.second);
+        }
+        else if constexpr (std::is_same<T, std::string>::value) {
+            writeSize_(value.size());
+            buffer_.insert(buffer_.end(), value.begin(), value.end());
+        }
+        else if constexpr (IsSharedPtr<T>::value) {
+            (*this)(static_cast<bool>(value));
+            if (value)
+                (*this)(*value);
+        }
+        else
+            // serializeOp() is used for reading and writing, so it cannot be const
+            const_cast<T&>(value).serializeOp(*this);
+    }
+
+    /*!
+     * \brief Returns the serialized data.
+     */
+    const std::vector<char>& payload() const
+    { return buffer_; }
+
+    /*!
+     * \brief Write the serialized data to a file.
+     *
+     * The content tag identifies the kind of the serialized data. It is checked when
+     * the snapshot is read.
+     */
+    void writeFile(const std::string& fileName, const std::string& contentTag) const
+    {
+        SnapshotWriter header;
+        header.buffer_.assign(std::begin(SnapshotDetail::magic), std::end(SnapshotDetail::magic));
+        header(SnapshotDetail::formatVersion);
+        header(contentTag);
+        header(static_cast<std::uint64_t>(buffer_.size()));
+        header(SnapshotDetail::checksum(buffer_.data(), buffer_.size()));
+
+        std::ofstream os(fileName, std::ios::binary | std::ios::trunc);
+        os.write(header.buffer_.data(), static_cast<std::streamsize>(header.buffer_.size()));
+        os.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        if (!os)
+            throw std::runtime_error("Could not write snapshot file '" + fileName + "'");
+    }
+
+private:
+    void writeSize_(std::size_t size)
+    { (*this)(static_cast<std::uint64_t>(size)); }
+
+    template <class T>
+    void writeRange_(const T* values, std::size_t n)
+    {
+        if constexpr (SnapshotDetail::isStoredDirectly<T>())
+            writeValues_(values, n);
+        else {
+            for (std::size_t i = 0; i < n; ++i)
+                (*this)(values[i]);
+        }
+    }
+
+    template <class T>
+    void writeValues_(const T* values, std::size_t n)
+    {
+        using Stored = typename SnapshotDetail::StorageType<T>::type;
+        static_assert(!std::is_floating_point<T>::value || std::numeric_limits<T>::is_iec559,
+                      "Only IEEE 754 floating point values can be stored in snapshots");
+        static_assert(sizeof(Stored) <= 8,
+                      "Extended precision floating point values cannot be stored in snapshots");
+
+        const std::size_t offset = buffer_.size();
+        buffer_.resize(offset + n*sizeof(Stored));
+        char* dest = buffer_.data() + offset;
+
+        if constexpr (SnapshotDetail::isBlockCopyable<T>()) {
+            if (SnapshotDetail::hostIsLittleEndian()) {
+                std::memcpy(dest, values, n*sizeof(T));
+                return;
+            }
+        }
+
+        for (std::size_t i = 0; i < n; ++i, dest += sizeof(Stored)) {
+            const Stored v = static_cast<Stored>(values[i]);
+            std::memcpy(dest, &v, sizeof(Stored));
+            if (!SnapshotDetail::hostIsLittleEndian())
+                SnapshotDetail::reverseBytes(dest, sizeof(Stored));
+        }
+    }
+
+    std::vector<char> buffer_;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Restores objects from a snapshot file.
+ *
+ * The objects must be read in the same order as they were written.
+ */
+class SnapshotReader
+{
+public:
+    /*!
+     * \brief Open a snapshot file and validate its header.
+     *
+     * An exception is thrown if the file is not a snapshot, if it was written using
+     * a different version of the file format or a different content tag, or if it is
+     * corrupted.
+     */
+    SnapshotReader(const std::string& fileName, const std::string& contentTag)
+        : file_(fileName)
+    {
+        const auto& magic = SnapshotDetail::magic;
+        if (file_.size() < sizeof(magic) || std::memcmp(file_.data(), magic, sizeof(magic)) != 0)
+            throw std::runtime_error("File '" + fileName + "' is not a snapshot");
+
+        pos_ = file_.data() + sizeof(magic);
+        end_ = file_.data() + file_.size();
+
+        std::uint32_t version;
+        (*this)(version);
+        if (version != SnapshotDetail::formatVersion)
+            throw std::runtime_error("Snapshot '" + fileName + "' uses version "
+                                     + std::to_string(version) + " of the file format, expected version "
+                                     + std::to_string(SnapshotDetail::formatVersion));
+
+        std::string tag;
+        (*this)(tag);
+        if (tag != contentTag)
+            throw std::runtime_error("Snapshot '" + fileName + "' contains '" + tag
+                                     + "', expected '" + contentTag + "'");
+
+        std::uint64_t payloadSize;
+        std::uint64_t payloadChecksum;
+        (*this)(payloadSize);
+        (*this)(payloadChecksum);
+        if (static_cast<std::uint64_t>(end_ - pos_) != payloadSize
+            || SnapshotDetail::checksum(pos_, payloadSize) != payloadChecksum)
+            throw std::runtime_error("Snapshot '" + fileName + "' is corrupted");
+    }
+
+    /*!
+     * \brief Returns true, this serializer only reads.
+     */
+    bool isReading() const
+    { return true; }
+
+    /*!
+     * \brief Read the next object from the snapshot.
+     */
+    template <class T>
+    void operator()(T& value)
+    {
+        using namespace SnapshotDetail;
+
+        if constexpr (isStoredDirectly<T>())
+            readValues_(&value, 1);
+        else if constexpr (std::is_array<T>::value) {
+            for (auto& v : value)
+                (*this)(v);
+        }
+        else if constexpr (IsStdVector<T>::value) {
+            value.resize(readSize_());
+            readRange_(value.data(), value.size());
+        }
+        else if constexpr (IsStdArray<T>::value)
+            readRange_(value.data(), value.size());
+        else if constexpr (IsStdPair<T>::value) {
+            (*this)(value.first);
+            (*this)(value.second);
+        }
+        else if constexpr (std::is_same<T, std::string>::value) {
+            const std::size_t size = readSize_();
+            const char* src = consume_(size);
+            value.assign(src, src + size);
+        }
+        else if constexpr (IsSharedPtr<T>::value) {
+            bool present;
+            (*this)(present);
+            if (present) {
+                value = std::make_shared<typename T::element_type>();
+                (*this)(*value);
+            }
+            else
+                value.reset();
+        }
+        else
+            value.serializeOp(*this);
+    }
+
+    /*!
+     * \brief Throw an exception unless all data of the snapshot has been read.
+     */
+    void checkEnd() const
+    {
+        if (pos_ != end_)
+            throw std::runtime_error("Snapshot contains more data than was read");
+    }
+
+private:
+    std::size_t readSize_()
+    {
+        std::uint64_t size;
+        (*this)(size);
+        // each element occupies at least one byte
+        if (size > static_cast<std::uint64_t>(end_ - pos_))
+            throw std::runtime_error("Snapshot is truncated");
+        return static_cast<std::size_t>(size);
+    }
+
+    const char* consume_(std::size_t numBytes)
+    {
+        if (numBytes > static_cast<std::size_t>(end_ - pos_))
+            throw std::runtime_error("Snapshot is truncated");
+        const char* src = pos_;
+        pos_ += numBytes;
+        return src;
+    }
+
+    template <class T>
+    void readRange_(T* values, std::size_t n)
+    {
+        if constexpr (SnapshotDetail::isStoredDirectly<T>())
+            readValues_(values, n);
+        else {
+            for (std::size_t i = 0; i < n; ++i)
+                (*this)(values[i]);
+        }
+    }
+
+    template <class T>
+    void readValues_(T* values, std::size_t n)
+    {
+        using Stored = typename SnapshotDetail::StorageType<T>::type;
+        const char* src = consume_(n*sizeof(Stored));
+
+        if constexpr (SnapshotDetail::isBlockCopyable<T>()) {
+            if (SnapshotDetail::hostIsLittleEndian()) {
+                std::memcpy(values, src, n*sizeof(T));
+                return;
+            }
+        }
+
+        for (std::size_t i = 0; i < n; ++i, src += sizeof(Stored)) {
+            char bytes[sizeof(Stored)];
+            std::memcpy(bytes, src, sizeof(Stored));
+            if (!SnapshotDetail::hostIsLittleEndian())
+                SnapshotDetail::reverseBytes(bytes, sizeof(Stored));
+
+            Stored v;
+            std::memcpy(&v, bytes, sizeof(Stored));
+            values[i] = static_cast<T>(v);
+        }
+    }
+
+    MappedFile file_;
+    const char* pos_ = nullptr;
+    const char* end_ = nullptr;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Write an object which provides a serializeOp() method to a snapshot file.
+ */
+template <class T>
+void saveSnapshot(const std::string& fileName, const std::string& contentTag, const T& obj)
+{
+    SnapshotWriter writer;
+    writer(obj);
+    writer.writeFile(fileName, contentTag);
+}
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Restore an object which provides a serializeOp() method from a snapshot file.
+ */
+template <class T>
+void loadSnapshot(const std::string& fileName, const std::string& contentTag, T& obj)
+{
+    SnapshotReader reader(fileName, contentTag);
+    reader(obj);
+    reader.checkEnd();
+}
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Returns a string which identifies a floating point type in content tags.
+ */
+template <class Scalar>
+std::string snapshotScalarName()
+{
+    static_assert(std::is_floating_point<Scalar>::value,
+                  "Snapshots can only be written for floating point scalars");
+    return std::is_same<Scalar, float>::value ? "float" : "double";
+}
+
+} // namespace Opm
+
+#undef OPM_SNAPSHOT_HAVE_MMAP
+
+#endif
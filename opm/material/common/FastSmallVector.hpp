@@ -33,17 +33,171 @@
 
 #include <array>
 #include <algorithm>
-#include <vector>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+//! Set this macro to 0 to make FastSmallVector allocate each heap buffer
+//! individually using operator new instead of recycling them via a
+//! thread-local pool.
+#ifndef OPM_FAST_SMALL_VECTOR_POOL
+#define OPM_FAST_SMALL_VECTOR_POOL 1
+#endif
 
 namespace Opm {
 
+/*!
+ * \brief Allocates the heap buffers of FastSmallVector objects individually using
+ *        the global operator new.
+ */
+template <class ValueType>
+class FastSmallVectorHeapAllocator
+{
+public:
+    //! allocate raw memory for at least the given number of objects. the number of
+    //! objects which fit into the buffer is returned via the argument.
+    static ValueType* allocate(std::size_t& capacity)
+    { return static_cast<ValueType*>(::operator new(capacity*sizeof(ValueType))); }
+
+    //! release a buffer which was obtained from allocate()
+    static void deallocate(ValueType* ptr, std::size_t /* capacity */)
+    { ::operator delete(ptr); }
+};
+
+/*!
+ * \brief Recycles the heap buffers of FastSmallVector objects via a thread-local pool.
+ *
+ * Buffers are handed out in power-of-two sizes. Released buffers are kept in a
+ * per-thread free list for their size and are reused by the next allocation of the
+ * same size, so temporaries which exceed the inline capacity of a FastSmallVector do
+ * not go through malloc and free. Each free list holds at most maxCachedBuffers
+ * buffers; everything else, as well as buffers with more than 2^maxPooledLog2
+ * elements, is returned to operator delete immediately.
+ *
+ * Buffers may be released by a different thread than the one which allocated them.
+ */
+template <class ValueType>
+class FastSmallVectorPoolAllocator
+{
+    static_assert(alignof(ValueType) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "The pooled allocator only supports the default alignment of operator new");
+
+public:
+    //! the largest pooled buffer has 2^maxPooledLog2 elements
+    static constexpr unsigned maxPooledLog2 = 16;
+
+    //! the maximum number of unused buffers kept per size and thread
+    static constexpr unsigned maxCachedBuffers = 64;
+
+    //! allocate raw memory for at least the given number of objects. the number of
+    //! objects which fit into the buffer is returned via the argument.
+    static ValueType* allocate(std::size_t& capacity)
+    {
+        unsigned log2 = minLog2_;
+        while ((std::size_t(1) << log2) < capacity)
+            ++log2;
+        capacity = std::size_t(1) << log2;
+
+        if (log2 <= maxPooledLog2 && !threadExited_) {
+            FreeList_& list = cache_().lists[log2];
+            if (list.head) {
+                Node_* node = list.head;
+                list.head = node->next;
+                --list.count;
+                return reinterpret_cast<ValueType*>(node);
+            }
+        }
+
+        return static_cast<ValueType*>(::operator new(capacity*sizeof(ValueType)));
+    }
+
+    //! release a buffer which was obtained from allocate()
+    static void deallocate(ValueType* ptr, std::size_t capacity)
+    {
+        unsigned log2 = minLog2_;
+        while ((std::size_t(1) << log2) < capacity)
+            ++log2;
+
+        if (log2 <= maxPooledLog2 && !threadExited_) {
+            FreeList_& list = cache_().lists[log2];
+            if (list.count < maxCachedBuffers) {
+                Node_* node = ::new(static_cast<void*>(ptr)) Node_;
+                node->next = list.head;
+                list.head = node;
+                ++list.count;
+                return;
+            }
+        }
+
+        ::operator delete(ptr);
+    }
+
+private:
+    struct Node_
+    { Node_* next; };
+
+    // the smallest buffer must be able to hold the link of the free list
+    static constexpr unsigned computeMinLog2_()
+    {
+        unsigned log2 = 0;
+        while ((std::size_t(1) << log2)*sizeof(ValueType) < sizeof(Node_))
+            ++log2;
+        return log2;
+    }
+    static constexpr unsigned minLog2_ = computeMinLog2_();
+
+    struct FreeList_
+    {
+        Node_* head = nullptr;
+        unsigned count = 0;
+    };
+
+    struct ThreadCache_
+    {
+        ~ThreadCache_()
+        {
+            for (auto& list : lists) {
+                while (list.head) {
+                    Node_* node = list.head;
+                    list.head = node->next;
+                    ::operator delete(static_cast<void*>(node));
+                }
+            }
+            // thread-local objects which are destroyed after the cache must not
+            // use it anymore
+            threadExited_ = true;
+        }
+
+        std::array<FreeList_, maxPooledLog2 + 1> lists;
+    };
+
+    static ThreadCache_& cache_()
+    {
+        static thread_local ThreadCache_ cache;
+        return cache;
+    }
+
+    static thread_local bool threadExited_;
+};
+
+template <class ValueType>
+thread_local bool FastSmallVectorPoolAllocator<ValueType>::threadExited_ = false;
+
 /*!
  * \brief An implementation of vector/array based on small object optimization. It is intended
  *        to be used by the DynamicEvaluation for better efficiency.
  */
 //! ValueType is the type of the data
 //! N is the size of the buffer that willl be allocated during compilation time
-template <typename ValueType, unsigned N>
+//! Allocator provides the memory if more than N elements are required
+#if OPM_FAST_SMALL_VECTOR_POOL
+template <typename ValueType, unsigned N,
+          class Allocator = FastSmallVectorPoolAllocator<ValueType>>
+#else
+template <typename ValueType, unsigned N,
+          class Allocator = FastSmallVectorHeapAllocator<ValueType>>
+#endif
 class FastSmallVector
 {
 public:
@@ -51,6 +205,7 @@ public:
     FastSmallVector()
     {
         size_ = 0;
+        capacity_ = N;
         dataPtr_ = smallBuf_.data();
     }
 
@@ -72,16 +227,27 @@ public:
     //! copy constructor
     FastSmallVector(const FastSmallVector& other)
     {
-        size_ = 0;
-        dataPtr_ = smallBuf_.data();
+        size_ = other.size_;
+        capacity_ = N;
 
-        (*this) = other;
+        if (size_ > N) {
+            capacity_ = size_;
+            dataPtr_ = Allocator::allocate(capacity_);
+            std::uninitialized_copy_n(other.dataPtr_, size_, dataPtr_);
+        }
+        else {
+            // the other vector may keep small contents in a heap buffer
+            dataPtr_ = smallBuf_.data();
+            for (std::size_t i = 0; i < size_; ++i)
+                dataPtr_[i] = other.dataPtr_[i];
+        }
     }
 
     //! move constructor
     FastSmallVector(FastSmallVector&& other)
     {
         size_ = 0;
+        capacity_ = N;
         dataPtr_ = smallBuf_.data();
 
         (*this) = std::move(other);
@@ -90,24 +256,32 @@ public:
     //! destructor
     ~FastSmallVector()
     {
+        release_();
     }
 
 
     //! move assignment
     FastSmallVector& operator=(FastSmallVector&& other)
     {
-        size_ = other.size_;
-        if (size_ <= N) {
-            smallBuf_ = std::move(other.smallBuf_);
-            dataPtr_ = smallBuf_.data();
+        if (this == &other)
+            return (*this);
+
+        if (other.onHeap_()) {
+            // steal the buffer of the other object
+            release_();
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            dataPtr_ = other.dataPtr_;
         }
         else {
-            data_ = std::move(other.data_);
-            dataPtr_ = data_.data();
+            resize_(other.size_);
+            std::move(other.dataPtr_, other.dataPtr_ + size_, dataPtr_);
+            other.release_();
         }
 
-        other.dataPtr_ = nullptr;
         other.size_ = 0;
+        other.capacity_ = N;
+        other.dataPtr_ = other.smallBuf_.data();
 
         return (*this);
     }
@@ -115,16 +289,11 @@ public:
     //! copy assignment
     FastSmallVector& operator=(const FastSmallVector& other)
     {
-        size_ = other.size_;
+        if (this == &other)
+            return (*this);
 
-        if (size_ <= N) {
-            smallBuf_ = other.smallBuf_;
-            dataPtr_ = smallBuf_.data();
-        }
-        else if (dataPtr_ != other.dataPtr_) {
-            data_ = other.data_;
-            dataPtr_ = data_.data();
-        }
+        resize_(other.size_);
+        std::copy(other.dataPtr_, other.dataPtr_ + size_, dataPtr_);
 
         return (*this);
     }
@@ -141,21 +310,60 @@ public:
     size_t size() const
     { return size_; }
 
+    //! the number of elements which fit into the current storage
+    size_t capacity() const
+    { return capacity_; }
+
 private:
+    bool onHeap_() const
+    { return dataPtr_ != smallBuf_.data(); }
+
     void init_(size_t numElem)
     {
         size_ = numElem;
+        capacity_ = N;
 
         if (size_ > N) {
-            data_.resize(size_);
-            dataPtr_ = data_.data();
+            capacity_ = size_;
+            dataPtr_ = Allocator::allocate(capacity_);
+            std::uninitialized_value_construct_n(dataPtr_, size_);
         } else
             dataPtr_ = smallBuf_.data();
     }
 
+    // change the number of elements. the values are unspecified afterwards, but
+    // storage is only reallocated if the current one is too small.
+    void resize_(size_t numElem)
+    {
+        if (numElem <= capacity_) {
+            if (onHeap_()) {
+                if (numElem > size_)
+                    std::uninitialized_value_construct(dataPtr_ + size_, dataPtr_ + numElem);
+                else
+                    std::destroy(dataPtr_ + numElem, dataPtr_ + size_);
+            }
+            size_ = numElem;
+            return;
+        }
+
+        release_();
+        init_(numElem);
+    }
+
+    void release_()
+    {
+        if (onHeap_()) {
+            std::destroy_n(dataPtr_, size_);
+            Allocator::deallocate(dataPtr_, capacity_);
+        }
+        size_ = 0;
+        capacity_ = N;
+        dataPtr_ = smallBuf_.data();
+    }
+
     std::array<ValueType, N> smallBuf_;
-    std::vector<ValueType> data_;
     std::size_t size_;
+    std::size_t capacity_;
     ValueType* dataPtr_;
 };
 
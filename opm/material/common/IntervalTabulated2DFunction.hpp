@@ -31,12 +31,14 @@
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/RangeCheckPolicy.hpp>
 
 #include <vector>
 #include <limits>
 #include <sstream>
 #include <cassert>
 #include <algorithm>
+#include <array>
 
 namespace Opm {
 
@@ -45,8 +47,12 @@ namespace Opm {
  *
  * The function is sampled in regular intervals in both directions, i.e., the
  * interpolation cells are rectangles. The table can be extrapolated in either direction.
+ *
+ * \tparam RangeCheckPolicy Specifies how positions outside of the tabulated range are
+ *                          dealt with in the directions in which extrapolation is not
+ *                          allowed.
  */
-template <class Scalar>
+template <class Scalar, class RangeCheckPolicy = RangeCheck::Checked>
 class IntervalTabulated2DFunction
 {
 public:
@@ -143,7 +149,7 @@ public:
     bool yExtrapolate() const
     { return yExtrapolate_; }
 
-    bool operator==(const IntervalTabulated2DFunction<Scalar>& data) const {
+    bool operator==(const IntervalTabulated2DFunction& data) const {
         return this->xPos() == data.xPos() &&
                this->yPos() == data.yPos() &&
                this->samples() == data.samples() &&
@@ -182,36 +188,61 @@ public:
     /*!
      * \brief Evaluate the function at a given (x,y) position.
      *
-     * If this method is called for a value outside of the tabulated
-     * range, and extrapolation is not allowed in the corresponding direction,
-     * a \c Opm::NumericalIssue exception is thrown.
+     * If this method is called for a value outside of the tabulated range, and
+     * extrapolation is not allowed in the corresponding direction, a \c
+     * Opm::NumericalIssue exception is thrown by the checked range policy, the value
+     * at the closest boundary is used by the clamped policy and the function is
+     * extrapolated by the unchecked policy.
      */
     template <typename Evaluation>
     Evaluation eval(const Evaluation& x, const Evaluation& y) const
     {
-        if ((!xExtrapolate_ && !appliesX(x)) || (!yExtrapolate_ && !appliesY(y))) {
-            std::ostringstream oss;
-            oss << "Attempt to get undefined table value (" << x << ", " << y << ")";
-            throw NumericalIssue(oss.str());
-        };
+        checkRange_(x, y);
 
         // bi-linear interpolation: first, calculate the x and y indices in the lookup
         // table ...
         const unsigned i = xSegmentIndex_(x);
         const unsigned j = ySegmentIndex_(y);
 
-        // bi-linear interpolation / extrapolation
-        const Evaluation alpha = xToAlpha(x, i);
-        const Evaluation beta = yToBeta(y, j);
+        return interpolate_(x, y, i, j);
+    }
 
-        const Evaluation s1 = valueAt(i, j) * (1.0 - beta) + valueAt(i, j + 1) * beta;
-        const Evaluation s2 = valueAt(i + 1, j) * (1.0 - beta) + valueAt(i + 1, j + 1) * beta;
+    /*!
+     * \brief Evaluate the function at a batch of (x,y) positions.
+     *
+     * The interval indices of all points of a chunk are determined first, then the
+     * bi-linear interpolation is done in a separate loop without branches which can
+     * be vectorized by the compiler for plain floating point types. The results are
+     * identical to calling eval() for each point individually.
+     *
+     * \param x Array of size \c n which contains the x positions
+     * \param y Array of size \c n which contains the y positions
+     * \param result Array of size \c n to which the function values are written
+     * \param n The number of points
+     */
+    template <typename Evaluation>
+    void eval(const Evaluation* x, const Evaluation* y, Evaluation* result, size_t n) const
+    {
+        constexpr size_t chunkSize = 64;
+        std::array<unsigned, chunkSize> xSegIdx;
+        std::array<unsigned, chunkSize> ySegIdx;
 
-        Valgrind::CheckDefined(s1);
-        Valgrind::CheckDefined(s2);
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += chunkSize) {
+            const size_t chunkLen = std::min(chunkSize, n - chunkBegin);
+            const Evaluation* xChunk = x + chunkBegin;
+            const Evaluation* yChunk = y + chunkBegin;
+            Evaluation* resultChunk = result + chunkBegin;
 
-        // ... and combine them using the x position
-        return s1*(1.0 - alpha) + s2*alpha;
+            for (size_t k = 0; k < chunkLen; ++k) {
+                checkRange_(xChunk[k], yChunk[k]);
+
+                xSegIdx[k] = xSegmentIndex_(xChunk[k]);
+                ySegIdx[k] = ySegmentIndex_(yChunk[k]);
+            }
+
+            for (size_t k = 0; k < chunkLen; ++k)
+                resultChunk[k] = interpolate_(xChunk[k], yChunk[k], xSegIdx[k], ySegIdx[k]);
+        }
     }
 
 private:
@@ -225,13 +256,61 @@ private:
     bool xExtrapolate_ = false;
     bool yExtrapolate_ = false;
 
+    // throws if a position is outside of the tabulated range in a direction in which
+    // extrapolation is not allowed. this is a no-op for all policies except the
+    // checked one.
+    template <class Evaluation>
+    void checkRange_(const Evaluation& x, const Evaluation& y) const
+    {
+        if constexpr (RangeCheckPolicy::check) {
+            if ((!xExtrapolate_ && !appliesX(x)) || (!yExtrapolate_ && !appliesY(y)))
+                RangeCheck::throwError<NumericalIssue>("Attempt to get undefined table value (",
+                                                       scalarValue(x), ", ", scalarValue(y), ")");
+        }
+    }
+
+    // bi-linear interpolation / extrapolation within the cell (i, j)
+    template <class Evaluation>
+    Evaluation interpolate_(const Evaluation& x, const Evaluation& y, unsigned i, unsigned j) const
+    {
+        Evaluation alpha = xToAlpha(x, i);
+        Evaluation beta = yToBeta(y, j);
+
+        if constexpr (RangeCheckPolicy::clamp) {
+            // the segment searches already return the first or the last segment, so
+            // clamping the relative positions moves the position to the boundary
+            if (!xExtrapolate_)
+                clampWeight_(alpha);
+            if (!yExtrapolate_)
+                clampWeight_(beta);
+        }
+
+        const Evaluation s1 = valueAt(i, j) * (1.0 - beta) + valueAt(i, j + 1) * beta;
+        const Evaluation s2 = valueAt(i + 1, j) * (1.0 - beta) + valueAt(i + 1, j + 1) * beta;
+
+        Valgrind::CheckDefined(s1);
+        Valgrind::CheckDefined(s2);
+
+        // ... and combine them using the x position
+        return s1*(1.0 - alpha) + s2*alpha;
+    }
+
+    template <class Evaluation>
+    static void clampWeight_(Evaluation& w)
+    {
+        if (w < 0.0)
+            w = MathToolbox<Evaluation>::createConstant(w, 0.0);
+        else if (w > 1.0)
+            w = MathToolbox<Evaluation>::createConstant(w, 1.0);
+    }
+
     /*!
      * \brief Return the interval index of a given position on the x-axis.
      */
     template <class Evaluation>
     unsigned xSegmentIndex_(const Evaluation& x) const
     {
-        assert(xExtrapolate_ || appliesX(x) );
+        assert(!RangeCheckPolicy::check || xExtrapolate_ || appliesX(x) );
 
         return segmentIndex_(x, xPos_);
     }
@@ -242,7 +321,7 @@ private:
     template <class Evaluation>
     unsigned ySegmentIndex_(const Evaluation& y) const
     {
-        assert(yExtrapolate_ || appliesY(y) );
+        assert(!RangeCheckPolicy::check || yExtrapolate_ || appliesY(y) );
 
         return segmentIndex_(y, yPos_);
     }
@@ -336,6 +336,20 @@ auto scalarValue(const Evaluation& val)
     -> decltype(MathToolbox<Evaluation>::scalarValue(val))
 { return MathToolbox<Evaluation>::scalarValue(val); }
 
+/*!
+ * \brief Returns true iff the derivatives of an evaluation are plain scalars of a given
+ *        type.
+ *
+ * Functions of such evaluations can be computed by determining their value and slope
+ * using scalars and then applying the chain rule to the derivatives.
+ */
+template <class Evaluation, class Scalar>
+constexpr bool hasScalarDerivatives()
+{
+    return !std::is_floating_point<Evaluation>::value &&
+           std::is_same<typename MathToolbox<Evaluation>::ValueType, Scalar>::value;
+}
+
 template <class Evaluation1, class Evaluation2>
 typename ReturnEval_<Evaluation1, Evaluation2>::type
 max(const Evaluation1& arg1, const Evaluation2& arg2)
@@ -0,0 +1,114 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Policies which specify how tabulated functions deal with arguments outside
+ *        of the tabulated range.
+ */
+#ifndef OPM_RANGE_CHECK_POLICY_HPP
+#define OPM_RANGE_CHECK_POLICY_HPP
+
+#include <sstream>
+
+#if defined(__GNUC__)
+//! Marks functions which are only called on error paths, so that the compiler keeps
+//! them out of line and moves their call sites away from the hot code.
+#define OPM_COLD_FUNCTION __attribute__((cold, noinline))
+#else
+#define OPM_COLD_FUNCTION
+#endif
+
+namespace Opm {
+namespace RangeCheck {
+/*!
+ * \ingroup Common
+ *
+ * \brief Arguments outside of the tabulated range are considered to be an error.
+ *
+ * Such arguments cause an exception unless extrapolation is explicitly requested.
+ */
+struct Checked
+{
+    static constexpr bool check = true;
+    static constexpr bool clamp = false;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Arguments outside of the tabulated range are moved to the closest boundary.
+ *
+ * Unless extrapolation is explicitly requested, the function is thus continued by a
+ * constant outside of its range.
+ */
+struct Clamped
+{
+    static constexpr bool check = false;
+    static constexpr bool clamp = true;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Arguments are not checked at all.
+ *
+ * The caller guarantees that the arguments are finite. Arguments outside of the
+ * tabulated range are extrapolated.
+ */
+struct Unchecked
+{
+    static constexpr bool check = false;
+    static constexpr bool clamp = false;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Check the arguments in debug builds only.
+ */
+#ifdef NDEBUG
+using DebugChecked = Unchecked;
+#else
+using DebugChecked = Checked;
+#endif
+
+/*!
+ * \brief Throw an exception with a message which is composed of all arguments.
+ *
+ * This is kept out of line so that formatting the message does not bloat the
+ * functions which do the range checks.
+ */
+template <class Exception, class... Args>
+[[noreturn]] OPM_COLD_FUNCTION
+void throwError(const Args&... args)
+{
+    std::ostringstream oss;
+    (oss << ... << args);
+    throw Exception(oss.str());
+}
+
+} // namespace RangeCheck
+} // namespace Opm
+
+#endif
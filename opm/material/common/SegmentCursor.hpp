@@ -0,0 +1,95 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::SegmentCursor
+ */
+#ifndef OPM_SEGMENT_CURSOR_HPP
+#define OPM_SEGMENT_CURSOR_HPP
+
+namespace Opm {
+/*!
+ * \ingroup Common
+ *
+ * \brief Remembers the segment of a tabulated function which was found by the last
+ *        lookup.
+ *
+ * The tabulated functions which accept a cursor check the remembered segment and its
+ * two neighbours before they fall back to a full search. Since the cursor is owned by
+ * the caller (e.g., one per cell of the grid), the tables themselves stay immutable and
+ * can be shared between threads. The segment which is returned is always the same as
+ * the one which would have been found without a cursor.
+ */
+class SegmentCursor
+{
+public:
+    SegmentCursor()
+        : segmentIdx_(0)
+    {}
+
+    /*!
+     * \brief Return the index of the segment found by the last lookup.
+     */
+    unsigned segmentIndex() const
+    { return segmentIdx_; }
+
+    /*!
+     * \brief Forget the segment of the last lookup.
+     */
+    void reset()
+    { segmentIdx_ = 0; }
+
+    /*!
+     * \brief Find a segment using the cursor.
+     *
+     * \param numSegments The number of segments of the tabulated function
+     * \param inSegment Predicate which returns true iff the value to be looked up
+     *                  belongs to the segment of a given index
+     * \param fullSearch Callable which returns the index of the segment if it is not
+     *                   in the direct neighbourhood of the remembered one
+     */
+    template <class InSegment, class FullSearch>
+    unsigned find(unsigned numSegments, const InSegment& inSegment, const FullSearch& fullSearch)
+    {
+        unsigned idx = segmentIdx_;
+        if (idx < numSegments) {
+            if (inSegment(idx))
+                return idx;
+            if (idx + 1 < numSegments && inSegment(idx + 1))
+                return segmentIdx_ = idx + 1;
+            if (idx > 0 && inSegment(idx - 1))
+                return segmentIdx_ = idx - 1;
+        }
+
+        segmentIdx_ = static_cast<unsigned>(fullSearch());
+        return segmentIdx_;
+    }
+
+private:
+    unsigned segmentIdx_;
+};
+
+} // namespace Opm
+
+#endif
@@ -30,20 +30,30 @@
 #include <opm/common/OpmLog/OpmLog.hpp>
 #include <opm/material/densead/Math.hpp>
 #include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/RangeCheckPolicy.hpp>
+#include <opm/material/common/SegmentCursor.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <tuple>
 #include <vector>
 #include <sstream>
+#include <stdexcept>
 
 namespace Opm {
 /*!
  * \brief Implements a linearly interpolated scalar function that depends on one
  *        variable.
+ *
+ * \tparam RangeCheckPolicy Specifies how arguments outside of the tabulated range are
+ *                          dealt with if no extrapolation is requested, see
+ *                          RangeCheck::Checked, RangeCheck::Clamped and
+ *                          RangeCheck::Unchecked.
  */
-template <class Scalar>
+template <class Scalar, class RangeCheckPolicy = RangeCheck::Checked>
 class Tabulated1DFunction
 {
 public:
@@ -117,6 +127,8 @@ public:
             sortInput_();
         else if (xValues_[0] > xValues_[numSamples() - 1])
             reverseSamplingPoints_();
+
+        initSegmentLookup_();
     }
 
     /*!
@@ -141,6 +153,8 @@ public:
             else if (xValues_[0] > xValues_[numSamples() - 1])
                 reverseSamplingPoints_();
         }
+
+        initSegmentLookup_();
     }
 
     /*!
@@ -165,6 +179,8 @@ public:
             sortInput_();
         else if (xValues_[0] > xValues_[numSamples() - 1])
             reverseSamplingPoints_();
+
+        initSegmentLookup_();
     }
 
     /*!
@@ -201,6 +217,8 @@ public:
             sortInput_();
         else if (xValues_[0] > xValues_[numSamples() - 1])
             reverseSamplingPoints_();
+
+        initSegmentLookup_();
     }
 
     /*!
@@ -258,15 +276,76 @@ public:
     template <class Evaluation>
     Evaluation eval(const Evaluation& x, bool extrapolate = false) const
     {
+        if constexpr (RangeCheckPolicy::clamp)
+            if (!extrapolate && !applies(x))
+                return clampedValue_(x);
+
         size_t segIdx = findSegmentIndex_(x, extrapolate);
 
-        Scalar x0 = xValues_[segIdx];
-        Scalar x1 = xValues_[segIdx + 1];
+        return interpolate_(x, segIdx);
+    }
 
-        Scalar y0 = yValues_[segIdx];
-        Scalar y1 = yValues_[segIdx + 1];
+    /*!
+     * \brief Evaluate the function at a given position using a lookup cursor.
+     *
+     * The cursor remembers the segment of the previous lookup, so that the search can
+     * be skipped if the function is repeatedly evaluated at nearby positions. The
+     * result is identical to the one of eval() without cursor.
+     *
+     * \param x The value on the abscissa where the function ought to be evaluated
+     * \param cursor The caller-owned cursor which is updated by the lookup
+     * \param extrapolate If this parameter is set to true, the function will be extended
+     *                    beyond its range by straight lines.
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, SegmentCursor& cursor, bool extrapolate = false) const
+    {
+        if constexpr (RangeCheckPolicy::clamp)
+            if (!extrapolate && !applies(x))
+                return clampedValue_(x);
+
+        size_t segIdx = findSegmentIndex_(x, extrapolate, cursor);
 
-        return y0 + (y1 - y0)*(x - x0)/(x1 - x0);
+        return interpolate_(x, segIdx);
+    }
+
+    /*!
+     * \brief Evaluate the function at a batch of positions.
+     *
+     * The segments of all points of a chunk are determined first and the
+     * interpolation is then done by a separate loop without any branches. If
+     * Evaluation is a plain floating point type, this allows the compiler to
+     * vectorize the interpolation. The results are identical to calling eval() for
+     * each point individually.
+     *
+     * \param x Array of size \c n which contains the positions on the abscissa
+     * \param result Array of size \c n to which the function values are written
+     * \param n The number of positions
+     * \param extrapolate If this parameter is set to true, the function will be extended
+     *                    beyond its range by straight lines.
+     */
+    template <class Evaluation>
+    void eval(const Evaluation* x, Evaluation* result, size_t n, bool extrapolate = false) const
+    {
+        constexpr size_t chunkSize = 64;
+        std::array<size_t, chunkSize> segIdx;
+
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += chunkSize) {
+            size_t chunkLen = std::min(chunkSize, n - chunkBegin);
+            const Evaluation* xChunk = x + chunkBegin;
+            Evaluation* resultChunk = result + chunkBegin;
+
+            findSegmentIndices_(xChunk, segIdx.data(), chunkLen, extrapolate);
+
+            for (size_t k = 0; k < chunkLen; ++k)
+                resultChunk[k] = interpolate_(xChunk[k], segIdx[k]);
+
+            if constexpr (RangeCheckPolicy::clamp)
+                if (!extrapolate)
+                    for (size_t k = 0; k < chunkLen; ++k)
+                        if (!applies(xChunk[k]))
+                            resultChunk[k] = clampedValue_(xChunk[k]);
+        }
     }
 
     /*!
@@ -283,10 +362,31 @@ public:
     template <class Evaluation>
     Evaluation evalDerivative(const Evaluation& x, bool extrapolate = false) const
     {
+        if constexpr (RangeCheckPolicy::clamp)
+            if (!extrapolate && !applies(x))
+                return MathToolbox<Evaluation>::createConstant(x, 0.0);
+
         unsigned segIdx = findSegmentIndex_(x, extrapolate);
         return evalDerivative_(x, segIdx);
     }
 
+    /*!
+     * \brief Evaluate the function's derivative at a given position using a lookup
+     *        cursor.
+     *
+     * \copydetails eval(const Evaluation&, SegmentCursor&, bool) const
+     */
+    template <class Evaluation>
+    Evaluation evalDerivative(const Evaluation& x, SegmentCursor& cursor, bool extrapolate = false) const
+    {
+        if constexpr (RangeCheckPolicy::clamp)
+            if (!extrapolate && !applies(x))
+                return MathToolbox<Evaluation>::createConstant(x, 0.0);
+
+        unsigned segIdx = findSegmentIndex_(x, extrapolate, cursor);
+        return evalDerivative_(x, segIdx);
+    }
+
     /*!
      * \brief Evaluate the function's second derivative at a given position.
      *
@@ -399,6 +499,42 @@ public:
     int monotonic() const
     { return monotonic(xMin(), xMax()); }
 
+    /*!
+     * \brief Returns true iff the values of all sampling points are either strictly
+     *        increasing or strictly decreasing.
+     *
+     * Only such functions can be inverted.
+     */
+    bool isStrictlyMonotonic() const
+    {
+        if (numSamples() < 2)
+            return false;
+
+        const bool increasing = yValues_[0] < yValues_[1];
+        for (size_t i = 0; i + 1 < numSamples(); ++i) {
+            if (increasing ? !(yValues_[i] < yValues_[i + 1])
+                           : !(yValues_[i] > yValues_[i + 1]))
+                return false;
+        }
+
+        return true;
+    }
+
+    /*!
+     * \brief Returns the inverse of a strictly monotonic function.
+     *
+     * The inverse of a piecewise linear function is again piecewise linear with the
+     * roles of the sampling points and their values swapped. This also applies to the
+     * straight lines used for extrapolation, so the result is exact everywhere.
+     */
+    Tabulated1DFunction inverse() const
+    {
+        if (!isStrictlyMonotonic())
+            throw std::logic_error("Only strictly monotonic functions can be inverted");
+
+        return Tabulated1DFunction(yValues_, xValues_, /*sortInputs=*/false);
+    }
+
     /*!
      * \brief Prints k tuples of the format (x, y, dx/dy, isMonotonic)
      *        to stdout.
@@ -446,36 +582,69 @@ public:
         }
     }
 
-    bool operator==(const Tabulated1DFunction<Scalar>& data) const {
+    bool operator==(const Tabulated1DFunction& data) const {
         return xValues_ == data.xValues_ &&
                yValues_ == data.yValues_;
     }
 
+    /*!
+     * \brief Write the sampling points to a snapshot or restore them from one.
+     *
+     * The segment lookup accelerator is rebuilt when the object is read.
+     */
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(xValues_);
+        serializer(yValues_);
+        if (serializer.isReading())
+            initSegmentLookup_();
+    }
+
 private:
     template <class Evaluation>
-    size_t findSegmentIndex_(const Evaluation& x, bool extrapolate = false) const
+    void checkLookupArgument_(const Evaluation& x, bool extrapolate) const
     {
-        if (!isfinite(x)) {
-            std::ostringstream sstream;
-            sstream << "We can not search for extrapolation/interpolation segment in an 1D table for non-finite value " << getValue(x) << " .";
-            throw std::runtime_error(sstream.str());
+        if constexpr (RangeCheckPolicy::check) {
+            if (!isfinite(x))
+                RangeCheck::throwError<std::runtime_error>("We can not search for extrapolation/interpolation "
+                                                           "segment in an 1D table for non-finite value ",
+                                                           getValue(x), " .");
+
+            if (!extrapolate && !applies(x))
+                RangeCheck::throwError<std::logic_error>("Trying to evaluate a tabulated function outside of its range");
+
+            // we need at least two sampling points!
+            if (numSamples() < 2)
+                RangeCheck::throwError<std::logic_error>("We need at least two sampling points to do "
+                                                         "interpolation/extrapolation,"
+                                                         "and the table only contains {} sampling points",
+                                                         numSamples());
         }
+    }
 
-        if (!extrapolate && !applies(x))
-            throw std::logic_error("Trying to evaluate a tabulated function outside of its range");
+    // the value of the function for an argument outside of its range if the range
+    // check policy clamps the arguments
+    template <class Evaluation>
+    Evaluation clampedValue_(const Evaluation& x) const
+    {
+        Scalar y = (x > xValues_.back()) ? yValues_.back() : yValues_.front();
+        return MathToolbox<Evaluation>::createConstant(x, y);
+    }
 
-        // we need at least two sampling points!
-        if (numSamples() < 2) {
-            std::ostringstream sstream;
-            sstream << "We need at least two sampling points to do interpolation/extrapolation,"
-                       "and the table only contains {} sampling points" << numSamples();
-            throw std::logic_error(sstream.str());
-        }
+    template <class Evaluation>
+    size_t findSegmentIndex_(const Evaluation& x, bool extrapolate = false) const
+    {
+        checkLookupArgument_(x, extrapolate);
 
-        if (x <= xValues_[1])
+        // written such that non-finite arguments which are not rejected by the range
+        // check policy end up in the first segment instead of the bucket lookup
+        if (!(x > xValues_[1]))
             return 0;
         else if (x >= xValues_[xValues_.size() - 2])
             return xValues_.size() - 2;
+        else if (segmentLookupEnabled_())
+            return lookupSegmentIndex_(scalarValue(x));
         else {
             // bisection
             size_t lowerIdx = 1;
@@ -488,31 +657,203 @@ private:
                     lowerIdx = pivotIdx;
             }
 
-            if (xValues_[lowerIdx] > x || x > xValues_[lowerIdx + 1]) {
-                std::ostringstream sstream;
-                sstream << "Problematic interpolation/extrapolation segment is found for the input value " << Opm::getValue(x)
-                        << "\nthe lower index of the found segment is " << lowerIdx << ", the size of the table is " << numSamples()
-                        << ",\nand the end values of the found segment are " << xValues_[lowerIdx] << " and " << xValues_[lowerIdx + 1]
-                        << ", respectively.";
-                std::ostringstream sstream2;
-                sstream2 << " Outputting the problematic table for more information(with *** marking the found segment):";
-                for (size_t i = 0; i < numSamples(); ++i) {
-                    if (i % 10 == 0)
-                        sstream2 << "\n";
-                    if (i == lowerIdx)
-                        sstream2 << " ***";
-                    sstream2 << " " << xValues_[i];
-                    if (i == lowerIdx + 1)
-                        sstream2 << " ***";
-                }
-                sstream2<< "\n";
-                OpmLog::debug(sstream.str() + "\n" + sstream2.str());
-                throw std::runtime_error(sstream.str());
-            }
+            if constexpr (RangeCheckPolicy::check)
+                if (xValues_[lowerIdx] > x || x > xValues_[lowerIdx + 1])
+                    reportInvalidSegment_(scalarValue(x), lowerIdx);
+
             return lowerIdx;
         }
     }
 
+    template <class Evaluation>
+    size_t findSegmentIndex_(const Evaluation& x, bool extrapolate, SegmentCursor& cursor) const
+    {
+        // for unsorted sampling points the segment found by bisection may differ from
+        // the one which contains x. since the cursor must not change the results, it
+        // is not used for such tables.
+        if (!segmentLookupEnabled_() && numSamples() >= 4)
+            return findSegmentIndex_(x, extrapolate);
+
+        checkLookupArgument_(x, extrapolate);
+
+        Scalar xv = scalarValue(x);
+        return cursor.find(numSamples() - 1,
+                           [this, xv](unsigned segIdx) { return inSegment_(segIdx, xv); },
+                           [this, &x, extrapolate]() { return findSegmentIndex_(x, extrapolate); });
+    }
+
+    [[noreturn]] OPM_COLD_FUNCTION
+    void reportInvalidSegment_(Scalar x, size_t lowerIdx) const
+    {
+        std::ostringstream sstream;
+        sstream << "Problematic interpolation/extrapolation segment is found for the input value " << x
+                << "\nthe lower index of the found segment is " << lowerIdx << ", the size of the table is " << numSamples()
+                << ",\nand the end values of the found segment are " << xValues_[lowerIdx] << " and " << xValues_[lowerIdx + 1]
+                << ", respectively.";
+        std::ostringstream sstream2;
+        sstream2 << " Outputting the problematic table for more information(with *** marking the found segment):";
+        for (size_t i = 0; i < numSamples(); ++i) {
+            if (i % 10 == 0)
+                sstream2 << "\n";
+            if (i == lowerIdx)
+                sstream2 << " ***";
+            sstream2 << " " << xValues_[i];
+            if (i == lowerIdx + 1)
+                sstream2 << " ***";
+        }
+        sstream2<< "\n";
+        OpmLog::debug(sstream.str() + "\n" + sstream2.str());
+        throw std::runtime_error(sstream.str());
+    }
+
+    // returns true iff findSegmentIndex_() yields a given segment for a value
+    bool inSegment_(size_t segIdx, Scalar x) const
+    {
+        size_t n = numSamples();
+        if (x <= xValues_[1])
+            return segIdx == 0;
+        else if (x >= xValues_[n - 2])
+            return segIdx == n - 2;
+
+        return xValues_[segIdx] <= x && x < xValues_[segIdx + 1];
+    }
+
+    // batched version of findSegmentIndex_(). all points are checked first, so that
+    // the search itself does not need to deal with invalid input.
+    template <class Evaluation>
+    void findSegmentIndices_(const Evaluation* x, size_t* segIdx, size_t n, bool extrapolate) const
+    {
+        if (!segmentLookupEnabled_()) {
+            for (size_t k = 0; k < n; ++k)
+                segIdx[k] = findSegmentIndex_(x[k], extrapolate);
+            return;
+        }
+
+        if constexpr (RangeCheckPolicy::check) {
+            bool valid = true;
+            for (size_t k = 0; k < n; ++k)
+                valid = valid && isfinite(x[k]) && (extrapolate || applies(x[k]));
+            if (!valid) {
+                // let the scalar version produce the proper error message
+                for (size_t k = 0; k < n; ++k)
+                    findSegmentIndex_(x[k], extrapolate);
+            }
+        }
+
+        Scalar xFirst = xValues_[1];
+        Scalar xLast = xValues_[numSamples() - 2];
+        for (size_t k = 0; k < n; ++k) {
+            // the comparison is written such that clamped non-finite arguments end up
+            // in the first segment
+            Scalar xk = scalarValue(x[k]);
+            if (!(xk > xFirst))
+                segIdx[k] = 0;
+            else if (xk >= xLast)
+                segIdx[k] = numSamples() - 2;
+            else
+                segIdx[k] = lookupSegmentIndex_(xk);
+        }
+    }
+
+    /*!
+     * \brief Set up the lookup accelerator for findSegmentIndex_().
+     *
+     * If the sampling points are equidistant, the segment index is directly computed
+     * from the x value. Otherwise, the range of the function is divided into a uniform
+     * grid of buckets and the first segment which overlaps with each bucket is
+     * stored. In both cases, the result is corrected by a short linear search, i.e.,
+     * the returned segment is always the same as the one found by bisection.
+     */
+    void initSegmentLookup_()
+    {
+        bucketSegmentIdx_.clear();
+        bucketInvWidth_ = 0.0;
+        uniformX_ = false;
+
+        // the first and the last segment are handled without a search
+        size_t n = numSamples();
+        if (n < 4)
+            return;
+
+        // unsorted sampling points are left to the bisection which complains about
+        // them.
+        if (!std::is_sorted(xValues_.begin(), xValues_.end()))
+            return;
+
+        Scalar range = xMax() - xMin();
+        if (!std::isfinite(range) || range <= 0.0)
+            return;
+
+        Scalar dx = range/(n - 1);
+        uniformX_ = true;
+        for (size_t i = 0; i < n - 1; ++i) {
+            if (std::abs(xValues_[i + 1] - xValues_[i] - dx) > 1e-6*dx) {
+                uniformX_ = false;
+                break;
+            }
+        }
+
+        if (uniformX_) {
+            bucketInvWidth_ = 1.0/dx;
+            return;
+        }
+
+        size_t numBuckets = 2*(n - 1);
+        bucketInvWidth_ = numBuckets/range;
+        bucketSegmentIdx_.resize(numBuckets);
+        size_t segIdx = 1;
+        for (size_t bucketIdx = 0; bucketIdx < numBuckets; ++bucketIdx) {
+            Scalar bucketXMin = xMin() + bucketIdx*range/numBuckets;
+            while (segIdx < n - 3 && xValues_[segIdx + 1] <= bucketXMin)
+                ++segIdx;
+            bucketSegmentIdx_[bucketIdx] = static_cast<unsigned>(segIdx);
+        }
+    }
+
+    bool segmentLookupEnabled_() const
+    { return bucketInvWidth_ > 0.0; }
+
+    // find the segment for x values which satisfy xValues_[1] < x < xValues_[n - 2]
+    size_t lookupSegmentIndex_(Scalar x) const
+    {
+        size_t n = numSamples();
+        size_t idx = static_cast<size_t>((x - xValues_[0])*bucketInvWidth_);
+        if (uniformX_)
+            idx = std::min(std::max(idx, size_t(1)), n - 3);
+        else
+            idx = bucketSegmentIdx_[std::min(idx, bucketSegmentIdx_.size() - 1)];
+
+        while (xValues_[idx + 1] <= x)
+            ++idx;
+        while (xValues_[idx] > x)
+            --idx;
+
+        return idx;
+    }
+
+    template <class Evaluation>
+    Evaluation interpolate_(const Evaluation& x, size_t segIdx) const
+    {
+        Scalar x0 = xValues_[segIdx];
+        Scalar x1 = xValues_[segIdx + 1];
+
+        Scalar y0 = yValues_[segIdx];
+        Scalar y1 = yValues_[segIdx + 1];
+
+        if constexpr (hasScalarDerivatives<Evaluation, Scalar>()) {
+            // compute the value and the slope of the segment using scalars and get
+            // the derivatives via the chain rule, i.e., f'(x) = slope*x'. this avoids
+            // doing the interpolation arithmetic on all derivatives.
+            Scalar slope = (y1 - y0)/(x1 - x0);
+
+            Evaluation result = x*slope;
+            result.setValue(y0 + (y1 - y0)*(x.value() - x0)/(x1 - x0));
+            return result;
+        }
+        else
+            return y0 + (y1 - y0)*(x - x0)/(x1 - x0);
+    }
+
     template <class Evaluation>
     Evaluation evalDerivative_(const Evaluation& x, size_t segIdx) const
     {
@@ -624,6 +965,11 @@ private:
 
     std::vector<Scalar> xValues_;
     std::vector<Scalar> yValues_;
+
+    // accelerator for the segment search. see initSegmentLookup_()
+    std::vector<unsigned> bucketSegmentIdx_;
+    Scalar bucketInvWidth_ = 0.0;
+    bool uniformX_ = false;
 };
 } // namespace Opm
 
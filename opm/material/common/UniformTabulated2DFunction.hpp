@@ -30,6 +30,7 @@
 
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/RangeCheckPolicy.hpp>
 
 #if HAVE_OPM_COMMON
 #include <opm/common/OpmLog/OpmLog.hpp>
@@ -49,8 +50,11 @@ namespace Opm {
  *
  * This class can be used when the sampling points are calculated at
  * run time.
+ *
+ * \tparam RangeCheckPolicy Specifies how positions outside of the tabulated range are
+ *                          dealt with if no extrapolation is requested.
  */
-template <class Scalar>
+template <class Scalar, class RangeCheckPolicy = RangeCheck::Checked>
 class UniformTabulated2DFunction
 {
 public:
@@ -198,32 +202,20 @@ public:
     template <class Evaluation>
     Evaluation eval(const Evaluation& x, const Evaluation& y, bool extrapolate) const
     {
-        if (!applies(x,y))
-        {
-            std::string msg = "Attempt to get tabulated value for ("
-                +std::to_string(double(scalarValue(x)))+", "+std::to_string(double(scalarValue(y)))
-                +") on a table of extent "
-                +std::to_string(xMin())+" to "+std::to_string(xMax())+" times "
-                +std::to_string(yMin())+" to "+std::to_string(yMax());
-
-            if (!extrapolate)
-            {
-                throw NumericalIssue(msg);
-            }
-            else
-            {
-#if HAVE_OPM_COMMON
-                OpmLog::warning("PVT Table evaluation:" + msg + ". Will use extrapolation");
-#else
-                std::cerr << "warning: "<< msg<<std::endl;
-#endif
-            }
-
-        };
+        if constexpr (RangeCheckPolicy::check)
+            if (!applies(x,y))
+                handleOutOfRange_(scalarValue(x), scalarValue(y), extrapolate);
 
         Evaluation alpha = xToI(x);
         Evaluation beta = yToJ(y);
 
+        if constexpr (RangeCheckPolicy::clamp) {
+            if (!extrapolate) {
+                clampIndex_(alpha, numX() - 1);
+                clampIndex_(beta, numY() - 1);
+            }
+        }
+
         unsigned i =
             static_cast<unsigned>(
                 std::max(0, std::min(static_cast<int>(numX()) - 2,
@@ -268,7 +260,7 @@ public:
         samples_[j*m_ + i] = value;
     }
 
-    bool operator==(const UniformTabulated2DFunction<Scalar>& data) const
+    bool operator==(const UniformTabulated2DFunction& data) const
     {
         return samples_ == data.samples_ &&
                m_ == data.m_ &&
@@ -281,6 +273,42 @@ public:
 
 
 private:
+    // throws an exception or prints a warning if the table is evaluated outside of its
+    // range
+    OPM_COLD_FUNCTION
+    void handleOutOfRange_(Scalar x, Scalar y, bool extrapolate) const
+    {
+        std::string msg = "Attempt to get tabulated value for ("
+            +std::to_string(double(x))+", "+std::to_string(double(y))
+            +") on a table of extent "
+            +std::to_string(xMin())+" to "+std::to_string(xMax())+" times "
+            +std::to_string(yMin())+" to "+std::to_string(yMax());
+
+        if (!extrapolate)
+        {
+            throw NumericalIssue(msg);
+        }
+        else
+        {
+#if HAVE_OPM_COMMON
+            OpmLog::warning("PVT Table evaluation:" + msg + ". Will use extrapolation");
+#else
+            std::cerr << "warning: "<< msg<<std::endl;
+#endif
+        }
+    }
+
+    // restrict a position in index space to [0, maxIdx]. clamped positions are
+    // constant.
+    template <class Evaluation>
+    static void clampIndex_(Evaluation& idx, unsigned maxIdx)
+    {
+        if (idx < 0.0)
+            idx = MathToolbox<Evaluation>::createConstant(idx, 0.0);
+        else if (idx > maxIdx)
+            idx = MathToolbox<Evaluation>::createConstant(idx, Scalar(maxIdx));
+    }
+
     // the vector which contains the values of the sample points
     // f(x_i, y_j). don't use this directly, use getSamplePoint(i,j)
     // instead!
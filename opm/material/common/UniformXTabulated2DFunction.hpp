@@ -31,7 +31,11 @@
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/RangeCheckPolicy.hpp>
+#include <opm/material/common/SegmentCursor.hpp>
 
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <vector>
 #include <limits>
@@ -39,6 +43,7 @@
 #include <sstream>
 #include <cassert>
 #include <cmath>
+#include <type_traits>
 
 namespace Opm {
 /*!
@@ -48,8 +53,12 @@ namespace Opm {
  * "Uniform on the X-axis" means that all Y sampling points must be located along a line
  * for this value. This class can be used when the sampling points are calculated at run
  * time.
+ *
+ * \tparam RangeCheckPolicy Specifies how positions outside of the tabulated range are
+ *                          dealt with if no extrapolation is requested. By default,
+ *                          they are only detected in debug builds.
  */
-template <class Scalar>
+template <class Scalar, class RangeCheckPolicy = RangeCheck::DebugChecked>
 class UniformXTabulated2DFunction
 {
 public:
@@ -71,19 +80,73 @@ public:
         Vertical
     };
 
+    /*!
+     * \brief Caller-owned lookup cursor for eval().
+     *
+     * It remembers the segment on the x axis as well as the segments on the y axis of
+     * the two columns which were used for the last lookup.
+     */
+    struct Cursor
+    {
+        SegmentCursor x;
+        SegmentCursor yLower;
+        SegmentCursor yUpper;
+    };
+
+    /*!
+     * \brief The sampling points and weights which are used to interpolate the
+     *        function at a given position.
+     *
+     * The value at the position is given by combining the sampling points (i, j1),
+     * (i, j1 + 1) using beta1 and (i + 1, j2), (i + 1, j2 + 1) using beta2, and then
+     * combining the two results using alpha.
+     */
+    template <class Evaluation>
+    struct InterpolationStencil
+    {
+        unsigned i;
+        unsigned j1;
+        unsigned j2;
+        Evaluation alpha;
+        Evaluation beta1;
+        Evaluation beta2;
+    };
+
+    /*!
+     * \brief The partial derivatives of the weights of an interpolation stencil with
+     *        regard to the x and y coordinates of the position.
+     */
+    struct InterpolationStencilDerivatives
+    {
+        Scalar dAlpha_dx;
+        Scalar dBeta1_dx;
+        Scalar dBeta1_dy;
+        Scalar dBeta2_dx;
+        Scalar dBeta2_dy;
+    };
+
     explicit UniformXTabulated2DFunction(const InterpolationPolicy interpolationGuide = Vertical)
-        : interpolationGuide_(interpolationGuide)
+        : columnOffsets_(1, 0)
+        , interpolationGuide_(interpolationGuide)
     { }
 
     UniformXTabulated2DFunction(const std::vector<Scalar>& xPos,
                                 const std::vector<Scalar>& yPos,
                                 const std::vector<std::vector<SamplePoint>>& samples,
                                 InterpolationPolicy interpolationGuide)
-        : samples_(samples)
+        : columnOffsets_(1, 0)
         , xPos_(xPos)
         , yPos_(yPos)
         , interpolationGuide_(interpolationGuide)
-    { }
+    {
+        for (const auto& colSamplePoints : samples) {
+            for (const auto& samplePoint : colSamplePoints) {
+                yValues_.push_back(std::get<1>(samplePoint));
+                values_.push_back(std::get<2>(samplePoint));
+            }
+            columnOffsets_.push_back(yValues_.size());
+        }
+    }
 
     /*!
      * \brief Returns the minimum of the X coordinate of the sampling points.
@@ -107,13 +170,32 @@ public:
      * \brief Returns the value of the Y coordinate of a sampling point.
      */
     Scalar yAt(size_t i, size_t j) const
-    { return std::get<1>(samples_[i][j]); }
+    { return yValues_[columnOffsets_[i] + j]; }
 
     /*!
      * \brief Returns the value of a sampling point.
      */
     Scalar valueAt(size_t i, size_t j) const
-    { return std::get<2>(samples_[i][j]); }
+    { return values_[columnOffsets_[i] + j]; }
+
+    /*!
+     * \brief Returns the (x, y, value) tuple of a sampling point.
+     */
+    SamplePoint samplePoint(size_t i, size_t j) const
+    { return SamplePoint(xPos_[i], yAt(i, j), valueAt(i, j)); }
+
+    /*!
+     * \brief Returns the index of a sampling point if all points of the table are
+     *        enumerated column by column.
+     */
+    size_t sampleIndex(size_t i, size_t j) const
+    { return columnOffsets_[i] + j; }
+
+    /*!
+     * \brief Returns the total number of sampling points of the table.
+     */
+    size_t numSamples() const
+    { return yValues_.size(); }
 
     /*!
      * \brief Returns the number of sampling points in X direction.
@@ -125,19 +207,28 @@ public:
      * \brief Returns the minimum of the Y coordinate of the sampling points for a given column.
      */
     Scalar yMin(unsigned i) const
-    { return std::get<1>(samples_.at(i).front()); }
+    {
+        assert(i < numX() && numY(i) > 0);
+        return yValues_[columnOffsets_[i]];
+    }
 
     /*!
      * \brief Returns the maximum of the Y coordinate of the sampling points for a given column.
      */
     Scalar yMax(unsigned i) const
-    { return std::get<1>(samples_.at(i).back()); }
+    {
+        assert(i < numX() && numY(i) > 0);
+        return yValues_[columnOffsets_[i + 1] - 1];
+    }
 
     /*!
      * \brief Returns the number of sampling points in Y direction a given column.
      */
     size_t numY(unsigned i) const
-    { return samples_.at(i).size(); }
+    {
+        assert(i < numX());
+        return columnOffsets_[i + 1] - columnOffsets_[i];
+    }
 
     /*!
      * \brief Return the position on the x-axis of the i-th interval.
@@ -149,9 +240,26 @@ public:
         return xPos_.at(i);
     }
 
-    const std::vector<std::vector<SamplePoint>>& samples() const
+    /*!
+     * \brief Returns the sampling points of all columns.
+     *
+     * The sampling points are stored in a flat structure-of-arrays layout
+     * internally, so this method assembles a copy of them on every call instead of
+     * returning a reference. Use numX(), numY(), samplePoint(), xAt(), yAt() and
+     * valueAt() to access the sampling points without allocating memory.
+     */
+    [[deprecated("samples() copies the sampling points, use samplePoint(i, j) or "
+                 "xAt(i), yAt(i, j) and valueAt(i, j) instead")]]
+    std::vector<std::vector<SamplePoint>> samples() const
     {
-        return samples_;
+        std::vector<std::vector<SamplePoint>> result(numX());
+        for (size_t i = 0; i < numX(); ++i) {
+            result[i].reserve(numY(i));
+            for (size_t j = 0; j < numY(i); ++j)
+                result[i].emplace_back(xPos_[i], yAt(i, j), valueAt(i, j));
+        }
+
+        return result;
     }
 
     const std::vector<Scalar>& xPos() const
@@ -175,9 +283,9 @@ public:
     Scalar jToY(unsigned i, unsigned j) const
     {
         assert(i < numX());
-        assert(size_t(j) < samples_[i].size());
+        assert(size_t(j) < numY(i));
 
-        return std::get<1>(samples_.at(i).at(j));
+        return yAt(i, j);
     }
 
     /*!
@@ -236,24 +344,25 @@ public:
                            [[maybe_unused]] bool extrapolate = false) const
     {
         assert(xSampleIdx < numX());
-        const auto& colSamplePoints = samples_.at(xSampleIdx);
+        const Scalar* colYValues = yValues_.data() + columnOffsets_[xSampleIdx];
+        const unsigned colSize = numY(xSampleIdx);
 
-        assert(colSamplePoints.size() >= 2);
+        assert(colSize >= 2);
         assert(extrapolate || (yMin(xSampleIdx) <= y && y <= yMax(xSampleIdx)));
 
-        if (y <= std::get<1>(colSamplePoints[1]))
+        if (y <= colYValues[1])
             return 0;
-        else if (y >= std::get<1>(colSamplePoints[colSamplePoints.size() - 2]))
-            return colSamplePoints.size() - 2;
+        else if (y >= colYValues[colSize - 2])
+            return colSize - 2;
         else {
-            assert(colSamplePoints.size() >= 3);
+            assert(colSize >= 3);
 
             // bisection
             unsigned lowerIdx = 1;
-            unsigned upperIdx = colSamplePoints.size() - 2;
+            unsigned upperIdx = colSize - 2;
             while (lowerIdx + 1 < upperIdx) {
                 unsigned pivotIdx = (lowerIdx + upperIdx) / 2;
-                if (y < std::get<1>(colSamplePoints[pivotIdx]))
+                if (y < colYValues[pivotIdx])
                     upperIdx = pivotIdx;
                 else
                     lowerIdx = pivotIdx;
@@ -275,10 +384,8 @@ public:
         assert(xSampleIdx < numX());
         assert(ySegmentIdx < numY(xSampleIdx) - 1);
 
-        const auto& colSamplePoints = samples_.at(xSampleIdx);
-
-        Scalar y1 = std::get<1>(colSamplePoints[ySegmentIdx]);
-        Scalar y2 = std::get<1>(colSamplePoints[ySegmentIdx + 1]);
+        Scalar y1 = yAt(xSampleIdx, ySegmentIdx);
+        Scalar y2 = yAt(xSampleIdx, ySegmentIdx + 1);
 
         return (y - y1)/(y2 - y1);
     }
@@ -295,16 +402,13 @@ public:
         unsigned i = xSegmentIndex(x, /*extrapolate=*/false);
         Scalar alpha = xToAlpha(decay<Scalar>(x), i);
 
-        const auto& col1SamplePoints = samples_.at(i);
-        const auto& col2SamplePoints = samples_.at(i + 1);
-
         Scalar minY =
-                alpha*std::get<1>(col1SamplePoints.front()) +
-                (1 - alpha)*std::get<1>(col2SamplePoints.front());
+                alpha*yMin(i) +
+                (1 - alpha)*yMin(i + 1);
 
         Scalar maxY =
-                alpha*std::get<1>(col1SamplePoints.back()) +
-                (1 - alpha)*std::get<1>(col2SamplePoints.back());
+                alpha*yMax(i) +
+                (1 - alpha)*yMax(i + 1);
 
         return minY <= y && y <= maxY;
     }
@@ -316,71 +420,170 @@ public:
      */
     template <class Evaluation>
     Evaluation eval(const Evaluation& x, const Evaluation& y, bool extrapolate=false) const
-    {
-#ifndef NDEBUG
-        if (!extrapolate && !applies(x, y)) {
-            std::ostringstream oss;
-            oss << "Attempt to get undefined table value (" << x << ", " << y << ")";
-            throw NumericalIssue(oss.str());
-        };
-#endif
+    { return eval_(x, y, extrapolate, /*cursor=*/nullptr); }
 
-        // bi-linear interpolation: first, calculate the x and y indices in the lookup
-        // table ...
-        unsigned i = xSegmentIndex(x, extrapolate);
-        const Evaluation& alpha = xToAlpha(x, i);
-        // The 'shift' is used to shift the points used to interpolate within
-        // the (i) and (i+1) sets of sample points, so that when approaching
-        // the boundary of the domain given by the samples, one gets the same
-        // value as one would get by interpolating along the boundary curve
-        // itself.
-        Evaluation shift = 0.0;
-        if (interpolationGuide_ == InterpolationPolicy::Vertical) {
-            // Shift is zero, no need to reset it.
-        } else {
-            // find upper and lower y value
-            if (interpolationGuide_ == InterpolationPolicy::LeftExtreme) {
-                // The domain is above the boundary curve, up to y = infinity.
-                // The shift is therefore the same for all values of y.
-                shift = yPos_[i+1] - yPos_[i];
-            } else {
-                assert(interpolationGuide_ == InterpolationPolicy::RightExtreme);
-                // The domain is below the boundary curve, down to y = 0.
-                // The shift is therefore no longer the the same for all
-                // values of y, since at y = 0 the shift must be zero.
-                // The shift is computed by linear interpolation between
-                // the maximal value at the domain boundary curve, and zero.
-                shift = yPos_[i+1] - yPos_[i];
-                auto yEnd = yPos_[i]*(1.0 - alpha) + yPos_[i+1]*alpha;
-                if (yEnd > 0.) {
-                    shift = shift * y / yEnd;
-                } else {
-                    shift = 0.;
-                }
+    /*!
+     * \brief Evaluate the function at a given (x,y) position using a lookup cursor.
+     *
+     * The cursor remembers the segments of the previous lookup, so that the searches
+     * can be skipped if the function is repeatedly evaluated at nearby positions. The
+     * result is identical to the one of eval() without cursor.
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x, const Evaluation& y, Cursor& cursor, bool extrapolate=false) const
+    { return eval_(x, y, extrapolate, &cursor); }
+
+    /*!
+     * \brief Determine the sampling points and weights which eval() uses for a given
+     *        (x,y) position.
+     *
+     * This allows to interpolate several quantities which are tabulated on the same
+     * sampling points with a single lookup.
+     */
+    template <class Evaluation>
+    InterpolationStencil<Evaluation> interpolationStencil(const Evaluation& x, const Evaluation& y,
+                                                          bool extrapolate=false) const
+    { return interpolationStencil_(x, y, extrapolate, /*cursor=*/nullptr); }
+
+    /*!
+     * \brief Determine the sampling points and weights for a given (x,y) position using
+     *        a lookup cursor.
+     */
+    template <class Evaluation>
+    InterpolationStencil<Evaluation> interpolationStencil(const Evaluation& x, const Evaluation& y,
+                                                          Cursor& cursor, bool extrapolate=false) const
+    { return interpolationStencil_(x, y, extrapolate, &cursor); }
+
+    /*!
+     * \brief Determine the partial derivatives of the weights of an interpolation
+     *        stencil.
+     *
+     * Together with the stencil, this allows to compute the value of a quantity and its
+     * slopes in x and y direction using scalars only.
+     */
+    InterpolationStencilDerivatives
+    interpolationStencilDerivatives(const InterpolationStencil<Scalar>& st, Scalar y) const
+    {
+        const unsigned i = st.i;
+        InterpolationStencilDerivatives d;
+        d.dAlpha_dx = 1.0/(xPos_[i + 1] - xPos_[i]);
+
+        // the shift of the y positions and its partial derivatives. see
+        // interpolationStencil_() for the details.
+        Scalar shift = 0.0;
+        Scalar dShift_dx = 0.0;
+        Scalar dShift_dy = 0.0;
+        if (interpolationGuide_ == InterpolationPolicy::LeftExtreme)
+            shift = yPos_[i+1] - yPos_[i];
+        else if (interpolationGuide_ == InterpolationPolicy::RightExtreme) {
+            Scalar guideShift = yPos_[i+1] - yPos_[i];
+            Scalar yEnd = yPos_[i]*(1.0 - st.alpha) + yPos_[i+1]*st.alpha;
+            if (yEnd > 0.) {
+                shift = guideShift*y/yEnd;
+                dShift_dx = -shift/yEnd*guideShift*d.dAlpha_dx;
+                dShift_dy = guideShift/yEnd;
             }
         }
-        auto yLower =  y - alpha*shift;
-        auto yUpper =  y + (1-alpha)*shift;
 
-        unsigned j1 = ySegmentIndex(yLower, i, extrapolate);
-        unsigned j2 = ySegmentIndex(yUpper, i + 1, extrapolate);
-        const Evaluation& beta1 = yToBeta(yLower, i, j1);
-        const Evaluation& beta2 = yToBeta(yUpper, i + 1, j2);
+        // yLower = y - alpha*shift and yUpper = y + (1 - alpha)*shift
+        Scalar dBeta1_dyLower = 1.0/(yAt(i, st.j1 + 1) - yAt(i, st.j1));
+        Scalar dBeta2_dyUpper = 1.0/(yAt(i + 1, st.j2 + 1) - yAt(i + 1, st.j2));
+        d.dBeta1_dx = -(d.dAlpha_dx*shift + st.alpha*dShift_dx)*dBeta1_dyLower;
+        d.dBeta1_dy = (1.0 - st.alpha*dShift_dy)*dBeta1_dyLower;
+        d.dBeta2_dx = (-d.dAlpha_dx*shift + (1.0 - st.alpha)*dShift_dx)*dBeta2_dyUpper;
+        d.dBeta2_dy = (1.0 + (1.0 - st.alpha)*dShift_dy)*dBeta2_dyUpper;
 
+        return d;
+    }
+
+    /*!
+     * \brief Interpolate the values at the sampling points of a stencil.
+     *
+     * v11 and v12 are the values at the sampling points (i, j1) and (i, j1 + 1) of the
+     * stencil, v21 and v22 the ones at (i + 1, j2) and (i + 1, j2 + 1). The weights are
+     * combined without mixing floating point types, so the result only depends on the
+     * arguments and not on how the compiler schedules the operations.
+     */
+    template <class Evaluation>
+    static Evaluation interpolate(const InterpolationStencil<Evaluation>& st,
+                                  Scalar v11, Scalar v12, Scalar v21, Scalar v22)
+    {
         // evaluate the two function values for the same y value ...
-        const Evaluation& s1 = valueAt(i, j1)*(1.0 - beta1) + valueAt(i, j1 + 1)*beta1;
-        const Evaluation& s2 = valueAt(i + 1, j2)*(1.0 - beta2) + valueAt(i + 1, j2 + 1)*beta2;
+        const Evaluation& s1 = v11*(Scalar{1} - st.beta1) + v12*st.beta1;
+        const Evaluation& s2 = v21*(Scalar{1} - st.beta2) + v22*st.beta2;
 
         Valgrind::CheckDefined(s1);
         Valgrind::CheckDefined(s2);
 
         // ... and combine them using the x position
-        const Evaluation& result = s1*(1.0 - alpha) + s2*alpha;
+        return s1*(Scalar{1} - st.alpha) + s2*st.alpha;
+    }
+
+    /*!
+     * \brief Interpolate the values at the sampling points of a stencil and compute the
+     *        derivatives of the result with respect to x and y via the chain rule.
+     *
+     * The value is identical to the one of interpolate(), but the interpolation is only
+     * done for scalars, i.e., f' = df/dx*x' + df/dy*y'.
+     */
+    template <class Evaluation>
+    static Evaluation interpolate(const Evaluation& x,
+                                  const Evaluation& y,
+                                  const InterpolationStencil<Scalar>& st,
+                                  const InterpolationStencilDerivatives& d,
+                                  Scalar v11, Scalar v12, Scalar v21, Scalar v22)
+    {
+        const Scalar s1 = v11*(Scalar{1} - st.beta1) + v12*st.beta1;
+        const Scalar s2 = v21*(Scalar{1} - st.beta2) + v22*st.beta2;
+
+        const Scalar df_dx =
+            (s2 - s1)*d.dAlpha_dx
+            + (Scalar{1} - st.alpha)*(v12 - v11)*d.dBeta1_dx
+            + st.alpha*(v22 - v21)*d.dBeta2_dx;
+        const Scalar df_dy =
+            (Scalar{1} - st.alpha)*(v12 - v11)*d.dBeta1_dy
+            + st.alpha*(v22 - v21)*d.dBeta2_dy;
+
+        Evaluation result = x*df_dx + y*df_dy;
+        result.setValue(s1*(Scalar{1} - st.alpha) + s2*st.alpha);
         Valgrind::CheckDefined(result);
 
         return result;
     }
 
+    /*!
+     * \brief Evaluate the function at a batch of (x,y) positions.
+     *
+     * Since the y sampling points are different for each x column, the segment
+     * searches of a point depend on each other and are done point by point. If
+     * Evaluation is a plain floating point type, the sampling points found by the
+     * searches of a chunk of points are recorded first and the interpolation weights
+     * and values are then computed by a separate loop without any branches, which
+     * the compiler can vectorize. The results are identical to calling eval() for
+     * each point individually.
+     *
+     * \param x Array of size \c n which contains the x positions
+     * \param y Array of size \c n which contains the y positions
+     * \param result Array of size \c n to which the function values are written
+     * \param n The number of points
+     * \param extrapolate Whether to extrapolate for untabulated values.
+     */
+    template <class Evaluation>
+    void eval(const Evaluation* x, const Evaluation* y, Evaluation* result, size_t n,
+              bool extrapolate = false) const
+    {
+        // clamped weights are not handled by the branch-free loop
+        if constexpr (std::is_floating_point_v<Evaluation>) {
+            if (!RangeCheckPolicy::clamp || extrapolate) {
+                evalChunked_(x, y, result, n, extrapolate);
+                return;
+            }
+        }
+
+        for (size_t k = 0; k < n; ++k)
+            result[k] = eval(x[k], y[k], extrapolate);
+    }
+
     /*!
      * \brief Set the x-position of a vertical line.
      *
@@ -390,15 +593,15 @@ public:
     {
         if (xPos_.empty() || xPos_.back() < nextX) {
             xPos_.push_back(nextX);
-            yPos_.push_back(-1e100);
-            samples_.push_back({});
+            yPos_.push_back(std::numeric_limits<Scalar>::lowest());
+            columnOffsets_.push_back(columnOffsets_.back());
             return xPos_.size() - 1;
         }
         else if (xPos_.front() > nextX) {
             // this is slow, but so what?
             xPos_.insert(xPos_.begin(), nextX);
-            yPos_.insert(yPos_.begin(), -1e100);
-            samples_.insert(samples_.begin(), std::vector<SamplePoint>());
+            yPos_.insert(yPos_.begin(), std::numeric_limits<Scalar>::lowest());
+            columnOffsets_.insert(columnOffsets_.begin(), 0);
             return 0;
         }
         throw std::invalid_argument("Sampling points should be specified either monotonically "
@@ -413,17 +616,16 @@ public:
     size_t appendSamplePoint(size_t i, Scalar y, Scalar value)
     {
         assert(i < numX());
-        Scalar x = iToX(i);
-        if (samples_[i].empty() || std::get<1>(samples_[i].back()) < y) {
-            samples_[i].push_back(SamplePoint(x, y, value));
+        if (numY(i) == 0 || yMax(i) < y) {
+            insertSamplePoint_(i, columnOffsets_[i + 1], y, value);
             if (interpolationGuide_ == InterpolationPolicy::RightExtreme) {
                 yPos_[i] = y;
             }
-            return samples_[i].size() - 1;
+            return numY(i) - 1;
         }
-        else if (std::get<1>(samples_[i].front()) > y) {
+        else if (yMin(i) > y) {
             // slow, but we still don't care...
-            samples_[i].insert(samples_[i].begin(), SamplePoint(x, y, value));
+            insertSamplePoint_(i, columnOffsets_[i], y, value);
             if (interpolationGuide_ == InterpolationPolicy::LeftExtreme) {
                 yPos_[i] = y;
             }
@@ -467,18 +669,295 @@ public:
         }
     }
 
-    bool operator==(const UniformXTabulated2DFunction<Scalar>& data) const {
+    /*!
+     * \brief Returns a copy of the table which only contains the sampling points.
+     *
+     * The copy yields the same interpolation stencils as this table, but it does not
+     * store any function values, i.e., it must not be evaluated.
+     */
+    UniformXTabulated2DFunction samplingGrid() const
+    {
+        UniformXTabulated2DFunction grid(interpolationGuide_);
+        grid.columnOffsets_ = columnOffsets_;
+        grid.yValues_ = yValues_;
+        grid.xPos_ = xPos_;
+        grid.yPos_ = yPos_;
+        return grid;
+    }
+
+    /*!
+     * \brief Returns true iff another table uses exactly the same sampling points
+     *        and interpolation guide as this one.
+     *
+     * In this case, both tables yield the same interpolation stencil for any position.
+     */
+    bool hasSameSamplingPoints(const UniformXTabulated2DFunction& other) const
+    {
+        return this->xPos_ == other.xPos_ &&
+               this->yPos_ == other.yPos_ &&
+               this->columnOffsets_ == other.columnOffsets_ &&
+               this->yValues_ == other.yValues_ &&
+               this->interpolationGuide_ == other.interpolationGuide_;
+    }
+
+    bool operator==(const UniformXTabulated2DFunction& data) const {
         return this->xPos() == data.xPos() &&
                this->yPos() == data.yPos() &&
-               this->samples() == data.samples() &&
+               this->columnOffsets_ == data.columnOffsets_ &&
+               this->yValues_ == data.yValues_ &&
+               this->values_ == data.values_ &&
                this->interpolationGuide() == data.interpolationGuide();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(columnOffsets_);
+        serializer(yValues_);
+        serializer(values_);
+        serializer(xPos_);
+        serializer(yPos_);
+        serializer(interpolationGuide_);
+    }
+
 private:
-    // the vector which contains the values of the sample points
-    // f(x_i, y_j). don't use this directly, use getSamplePoint(i,j)
-    // instead!
-    std::vector<std::vector<SamplePoint> > samples_;
+    template <class Evaluation>
+    Evaluation eval_(const Evaluation& x, const Evaluation& y, bool extrapolate, Cursor* cursor) const
+    {
+        // clamped weights must not contribute to the derivatives, which the slope
+        // based evaluation does not account for
+        if constexpr (hasScalarDerivatives<Evaluation, Scalar>() && !RangeCheckPolicy::clamp) {
+            // compute the value and the two partial slopes using scalars and get the
+            // derivatives via the chain rule, i.e., f' = df/dx*x' + df/dy*y'. this
+            // avoids doing the interpolation arithmetic on all derivatives.
+            Scalar xv = x.value();
+            Scalar yv = y.value();
+            const auto& st = interpolationStencil_(xv, yv, extrapolate, cursor);
+            return interpolate(x, y, st, interpolationStencilDerivatives(st, yv),
+                               valueAt(st.i, st.j1), valueAt(st.i, st.j1 + 1),
+                               valueAt(st.i + 1, st.j2), valueAt(st.i + 1, st.j2 + 1));
+        }
+        else {
+            const auto& st = interpolationStencil_(x, y, extrapolate, cursor);
+            return interpolate(st,
+                               valueAt(st.i, st.j1), valueAt(st.i, st.j1 + 1),
+                               valueAt(st.i + 1, st.j2), valueAt(st.i + 1, st.j2 + 1));
+        }
+    }
+
+    // the part of an interpolation stencil which is determined by the segment
+    // searches. the y positions at which the two columns are interpolated are shifted
+    // by the interpolation guide.
+    template <class Evaluation>
+    struct StencilLocation_
+    {
+        unsigned i;
+        unsigned j1;
+        unsigned j2;
+        Evaluation alpha;
+        Evaluation yLower;
+        Evaluation yUpper;
+    };
+
+    template <class Evaluation>
+    InterpolationStencil<Evaluation> interpolationStencil_(const Evaluation& x, const Evaluation& y,
+                                                           bool extrapolate, Cursor* cursor) const
+    {
+        const auto& loc = locateStencil_(x, y, extrapolate, cursor);
+
+        InterpolationStencil<Evaluation> st;
+        st.i = loc.i;
+        st.j1 = loc.j1;
+        st.j2 = loc.j2;
+        st.alpha = loc.alpha;
+        st.beta1 = yToBeta(loc.yLower, loc.i, loc.j1);
+        st.beta2 = yToBeta(loc.yUpper, loc.i + 1, loc.j2);
+        if (RangeCheckPolicy::clamp && !extrapolate) {
+            clampWeight_(st.beta1);
+            clampWeight_(st.beta2);
+        }
+
+        return st;
+    }
+
+    template <class Evaluation>
+    StencilLocation_<Evaluation> locateStencil_(const Evaluation& x, const Evaluation& y,
+                                                bool extrapolate, Cursor* cursor) const
+    {
+        if constexpr (RangeCheckPolicy::check)
+            if (!extrapolate && !applies(x, y))
+                RangeCheck::throwError<NumericalIssue>("Attempt to get undefined table value (",
+                                                       x, ", ", y, ")");
+
+        // positions outside of the tabulated range only reach the segment searches if
+        // they are extrapolated or clamped afterwards
+        const bool clamp = RangeCheckPolicy::clamp && !extrapolate;
+        extrapolate = extrapolate || !RangeCheckPolicy::check;
+
+        // bi-linear interpolation: first, calculate the x and y indices in the lookup
+        // table ...
+        unsigned i = xSegmentIndex_(x, extrapolate, cursor);
+        Evaluation alpha = xToAlpha(x, i);
+        if (clamp)
+            clampWeight_(alpha);
+        // The 'shift' is used to shift the points used to interpolate within
+        // the (i) and (i+1) sets of sample points, so that when approaching
+        // the boundary of the domain given by the samples, one gets the same
+        // value as one would get by interpolating along the boundary curve
+        // itself.
+        Evaluation shift = 0.0;
+        if (interpolationGuide_ == InterpolationPolicy::Vertical) {
+            // Shift is zero, no need to reset it.
+        } else {
+            // find upper and lower y value
+            if (interpolationGuide_ == InterpolationPolicy::LeftExtreme) {
+                // The domain is above the boundary curve, up to y = infinity.
+                // The shift is therefore the same for all values of y.
+                shift = yPos_[i+1] - yPos_[i];
+            } else {
+                assert(interpolationGuide_ == InterpolationPolicy::RightExtreme);
+                // The domain is below the boundary curve, down to y = 0.
+                // The shift is therefore no longer the the same for all
+                // values of y, since at y = 0 the shift must be zero.
+                // The shift is computed by linear interpolation between
+                // the maximal value at the domain boundary curve, and zero.
+                shift = yPos_[i+1] - yPos_[i];
+                auto yEnd = yPos_[i]*(1.0 - alpha) + yPos_[i+1]*alpha;
+                if (yEnd > 0.) {
+                    shift = shift * y / yEnd;
+                } else {
+                    shift = 0.;
+                }
+            }
+        }
+        auto yLower =  y - alpha*shift;
+        auto yUpper =  y + (1-alpha)*shift;
+
+        unsigned j1 = ySegmentIndex_(yLower, i, extrapolate, cursor ? &cursor->yLower : nullptr);
+        unsigned j2 = ySegmentIndex_(yUpper, i + 1, extrapolate, cursor ? &cursor->yUpper : nullptr);
+
+        return {i, j1, j2, alpha, yLower, yUpper};
+    }
+
+    template <class Evaluation>
+    void evalChunked_(const Evaluation* x, const Evaluation* y, Evaluation* result, size_t n,
+                      bool extrapolate) const
+    {
+        constexpr size_t chunkSize = 64;
+        std::array<size_t, chunkSize> idx1;
+        std::array<size_t, chunkSize> idx2;
+        std::array<Evaluation, chunkSize> alpha;
+        std::array<Evaluation, chunkSize> yLower;
+        std::array<Evaluation, chunkSize> yUpper;
+
+        const Scalar* yv = yValues_.data();
+        const Scalar* v = values_.data();
+        for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += chunkSize) {
+            const size_t chunkLen = std::min(chunkSize, n - chunkBegin);
+            const Evaluation* xChunk = x + chunkBegin;
+            const Evaluation* yChunk = y + chunkBegin;
+            Evaluation* resultChunk = result + chunkBegin;
+
+            // the segment searches, which depend on each other ...
+            for (size_t k = 0; k < chunkLen; ++k) {
+                const auto& loc = locateStencil_(xChunk[k], yChunk[k], extrapolate, /*cursor=*/nullptr);
+                idx1[k] = columnOffsets_[loc.i] + loc.j1;
+                idx2[k] = columnOffsets_[loc.i + 1] + loc.j2;
+                alpha[k] = loc.alpha;
+                yLower[k] = loc.yLower;
+                yUpper[k] = loc.yUpper;
+            }
+
+            // ... and the interpolation, which uses the same arithmetic as interpolate()
+            for (size_t k = 0; k < chunkLen; ++k) {
+                const size_t k1 = idx1[k];
+                const size_t k2 = idx2[k];
+                const Evaluation beta1 = (yLower[k] - yv[k1])/(yv[k1 + 1] - yv[k1]);
+                const Evaluation beta2 = (yUpper[k] - yv[k2])/(yv[k2 + 1] - yv[k2]);
+                const Evaluation s1 = v[k1]*(Scalar{1} - beta1) + v[k1 + 1]*beta1;
+                const Evaluation s2 = v[k2]*(Scalar{1} - beta2) + v[k2 + 1]*beta2;
+                resultChunk[k] = s1*(Scalar{1} - alpha[k]) + s2*alpha[k];
+            }
+        }
+    }
+
+    template <class Evaluation>
+    unsigned xSegmentIndex_(const Evaluation& x, bool extrapolate, Cursor* cursor) const
+    {
+        if (!cursor)
+            return xSegmentIndex(x, extrapolate);
+
+        assert(extrapolate || (xMin() <= x && x <= xMax()));
+        assert(xPos_.size() >= 2);
+
+        Scalar xv = scalarValue(x);
+        return cursor->x.find(numX() - 1,
+                              [this, xv](unsigned segIdx)
+                              { return inSegment_(xPos_.data(), numX(), segIdx, xv); },
+                              [this, &x, extrapolate]()
+                              { return xSegmentIndex(x, extrapolate); });
+    }
+
+    template <class Evaluation>
+    unsigned ySegmentIndex_(const Evaluation& y, unsigned xSampleIdx, bool extrapolate,
+                            SegmentCursor* cursor) const
+    {
+        if (!cursor)
+            return ySegmentIndex(y, xSampleIdx, extrapolate);
+
+        assert(xSampleIdx < numX());
+        assert(numY(xSampleIdx) >= 2);
+        assert(extrapolate || (yMin(xSampleIdx) <= y && y <= yMax(xSampleIdx)));
+
+        const Scalar* colYValues = yValues_.data() + columnOffsets_[xSampleIdx];
+        const size_t colSize = numY(xSampleIdx);
+        Scalar yv = scalarValue(y);
+        return cursor->find(colSize - 1,
+                            [colYValues, colSize, yv](unsigned segIdx)
+                            { return inSegment_(colYValues, colSize, segIdx, yv); },
+                            [this, &y, xSampleIdx, extrapolate]()
+                            { return ySegmentIndex(y, xSampleIdx, extrapolate); });
+    }
+
+    // restrict an interpolation weight to [0, 1]. clamped weights are constant.
+    template <class Evaluation>
+    static void clampWeight_(Evaluation& w)
+    {
+        if (w < 0.0)
+            w = MathToolbox<Evaluation>::createConstant(w, 0.0);
+        else if (w > 1.0)
+            w = MathToolbox<Evaluation>::createConstant(w, 1.0);
+    }
+
+    // returns true iff xSegmentIndex() and ySegmentIndex() yield a given segment of
+    // the sampling positions pos for a value
+    static bool inSegment_(const Scalar* pos, size_t n, size_t segIdx, Scalar v)
+    {
+        if (v <= pos[1])
+            return segIdx == 0;
+        else if (v >= pos[n - 2])
+            return segIdx == n - 2;
+
+        return pos[segIdx] <= v && v < pos[segIdx + 1];
+    }
+
+    // insert a sampling point into the flat arrays at a given position and shift
+    // the offsets of all subsequent columns
+    void insertSamplePoint_(size_t i, size_t pos, Scalar y, Scalar value)
+    {
+        yValues_.insert(yValues_.begin() + pos, y);
+        values_.insert(values_.begin() + pos, value);
+        for (size_t k = i + 1; k < columnOffsets_.size(); ++k)
+            ++columnOffsets_[k];
+    }
+
+    // the sample points are stored column by column in two flat arrays: the y
+    // positions and the function values f(x_i, y_j). the sampling points of the
+    // i-th column are located in [columnOffsets_[i], columnOffsets_[i + 1]). don't
+    // use these directly, use yAt(i, j) and valueAt(i, j) instead!
+    std::vector<size_t> columnOffsets_;
+    std::vector<Scalar> yValues_;
+    std::vector<Scalar> values_;
 
     // the position of each vertical line on the x-axis
     std::vector<Scalar> xPos_;
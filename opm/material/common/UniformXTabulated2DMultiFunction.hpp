@@ -0,0 +1,196 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::UniformXTabulated2DMultiFunction
+ */
+#ifndef OPM_UNIFORM_X_TABULATED_2D_MULTI_FUNCTION_HPP
+#define OPM_UNIFORM_X_TABULATED_2D_MULTI_FUNCTION_HPP
+
+#include <opm/material/common/UniformXTabulated2DFunction.hpp>
+#include <opm/material/common/Valgrind.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Implements several scalar functions of two variables which are tabulated on
+ *        the same sampling points as a UniformXTabulated2DFunction.
+ *
+ * All quantities of a sampling point are stored next to each other, so that evaluating
+ * all of them only requires a single lookup of the interpolation stencil and touches
+ * the sampling points only once. The results are identical to evaluating the individual
+ * UniformXTabulated2DFunction objects.
+ */
+template <class Scalar, unsigned numQuantities>
+class UniformXTabulated2DMultiFunction
+{
+public:
+    using TabulatedFunction = UniformXTabulated2DFunction<Scalar>;
+    using Cursor = typename TabulatedFunction::Cursor;
+
+    UniformXTabulated2DMultiFunction() = default;
+
+    /*!
+     * \brief Create the table from the individual tables of each quantity.
+     *
+     * All tables must use the same sampling points and interpolation guide.
+     */
+    explicit UniformXTabulated2DMultiFunction(const std::array<const TabulatedFunction*, numQuantities>& quantities)
+    { setQuantities(quantities); }
+
+    /*!
+     * \brief Set the values of all quantities from the individual tables of each quantity.
+     *
+     * All tables must use the same sampling points and interpolation guide.
+     */
+    void setQuantities(const std::array<const TabulatedFunction*, numQuantities>& quantities)
+    {
+        const TabulatedFunction& grid = *quantities[0];
+        for (unsigned qIdx = 1; qIdx < numQuantities; ++qIdx)
+            if (!grid.hasSameSamplingPoints(*quantities[qIdx]))
+                throw std::invalid_argument("All quantities of a multi-valued table must be "
+                                            "tabulated on the same sampling points.");
+
+        grid_ = grid.samplingGrid();
+        values_.resize(grid.numSamples());
+        for (size_t i = 0; i < grid.numX(); ++i)
+            for (size_t j = 0; j < grid.numY(i); ++j)
+                for (unsigned qIdx = 0; qIdx < numQuantities; ++qIdx)
+                    values_[grid.sampleIndex(i, j)][qIdx] = quantities[qIdx]->valueAt(i, j);
+    }
+
+    /*!
+     * \brief Returns true iff no values have been specified yet.
+     */
+    bool empty() const
+    { return values_.empty(); }
+
+    /*!
+     * \brief Returns the table which defines the sampling points.
+     *
+     * This table does not contain any function values, see
+     * UniformXTabulated2DFunction::samplingGrid().
+     */
+    const TabulatedFunction& samplingPoints() const
+    { return grid_; }
+
+    /*!
+     * \brief Returns a quantity at a sampling point.
+     */
+    Scalar valueAt(size_t i, size_t j, unsigned qIdx) const
+    { return values_[grid_.sampleIndex(i, j)][qIdx]; }
+
+    /*!
+     * \brief Evaluate all quantities at a given (x,y) position.
+     */
+    template <class Evaluation>
+    std::array<Evaluation, numQuantities> eval(const Evaluation& x, const Evaluation& y,
+                                               bool extrapolate=false) const
+    {
+        if constexpr (hasScalarDerivatives<Evaluation, Scalar>())
+            return interpolateWithSlopes_(x, y, grid_.interpolationStencil(x.value(), y.value(), extrapolate));
+        else
+            return interpolate_(grid_.interpolationStencil(x, y, extrapolate));
+    }
+
+    /*!
+     * \brief Evaluate all quantities at a given (x,y) position using a lookup cursor.
+     */
+    template <class Evaluation>
+    std::array<Evaluation, numQuantities> eval(const Evaluation& x, const Evaluation& y,
+                                               Cursor& cursor, bool extrapolate=false) const
+    {
+        if constexpr (hasScalarDerivatives<Evaluation, Scalar>())
+            return interpolateWithSlopes_(x, y, grid_.interpolationStencil(x.value(), y.value(), cursor, extrapolate));
+        else
+            return interpolate_(grid_.interpolationStencil(x, y, cursor, extrapolate));
+    }
+
+    bool operator==(const UniformXTabulated2DMultiFunction<Scalar, numQuantities>& data) const
+    {
+        return this->grid_.hasSameSamplingPoints(data.grid_) &&
+               this->values_ == data.values_;
+    }
+
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(grid_);
+        serializer(values_);
+    }
+
+private:
+    template <class Evaluation>
+    std::array<Evaluation, numQuantities>
+    interpolate_(const typename TabulatedFunction::template InterpolationStencil<Evaluation>& st) const
+    {
+        const auto& v11 = values_[grid_.sampleIndex(st.i, st.j1)];
+        const auto& v12 = values_[grid_.sampleIndex(st.i, st.j1 + 1)];
+        const auto& v21 = values_[grid_.sampleIndex(st.i + 1, st.j2)];
+        const auto& v22 = values_[grid_.sampleIndex(st.i + 1, st.j2 + 1)];
+
+        // this is the same arithmetic as UniformXTabulated2DFunction::eval(), so the
+        // results are bitwise identical
+        std::array<Evaluation, numQuantities> result;
+        for (unsigned qIdx = 0; qIdx < numQuantities; ++qIdx)
+            result[qIdx] = TabulatedFunction::interpolate(st, v11[qIdx], v12[qIdx], v21[qIdx], v22[qIdx]);
+
+        return result;
+    }
+
+    // same as interpolate_(), but the value and the two partial slopes of each quantity
+    // are computed using scalars and the derivatives are obtained via the chain rule
+    template <class Evaluation>
+    std::array<Evaluation, numQuantities>
+    interpolateWithSlopes_(const Evaluation& x,
+                           const Evaluation& y,
+                           const typename TabulatedFunction::template InterpolationStencil<Scalar>& st) const
+    {
+        const auto& d = grid_.interpolationStencilDerivatives(st, y.value());
+
+        const auto& v11 = values_[grid_.sampleIndex(st.i, st.j1)];
+        const auto& v12 = values_[grid_.sampleIndex(st.i, st.j1 + 1)];
+        const auto& v21 = values_[grid_.sampleIndex(st.i + 1, st.j2)];
+        const auto& v22 = values_[grid_.sampleIndex(st.i + 1, st.j2 + 1)];
+
+        std::array<Evaluation, numQuantities> result;
+        for (unsigned qIdx = 0; qIdx < numQuantities; ++qIdx)
+            result[qIdx] = TabulatedFunction::interpolate(x, y, st, d,
+                                                          v11[qIdx], v12[qIdx], v21[qIdx], v22[qIdx]);
+
+        return result;
+    }
+
+    // the sampling points, i.e., a table without function values
+    TabulatedFunction grid_;
+    // the values of all quantities, indexed by TabulatedFunction::sampleIndex()
+    std::vector<std::array<Scalar, numQuantities>> values_;
+};
+
+} // namespace Opm
+
+#endif
@@ -34,6 +34,7 @@
 #include <opm/material/fluidstates/CompositionalFluidState.hpp>
 #include <opm/material/densead/Evaluation.hpp>
 #include <opm/material/densead/Math.hpp>
+#include <opm/material/densead/OperationCounter.hpp>
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/Constants.hpp>
@@ -86,6 +87,7 @@ public:
                       Scalar tolerance = -1.,
                       int verbosity = 0)
     {
+        OPM_DENSEAD_COUNT_SCOPE("PTFlash::solve");
 
         using InputEval = typename FluidState::Scalar;
         using ComponentVector = Dune::FieldVector<typename FluidState::Scalar, numComponents>;
@@ -426,6 +428,7 @@ protected:
     template <class FlashFluidState, class ComponentVector>
     static void phaseStabilityTest_(bool& isStable, ComponentVector& K, FlashFluidState& fluid_state, const ComponentVector& z, int verbosity)
     {
+        OPM_DENSEAD_COUNT_SCOPE("PTFlash::phaseStabilityTest_");
         // Declarations
         bool isTrivialL, isTrivialV;
         ComponentVector x, y;
@@ -633,6 +636,7 @@ protected:
                                    FlashFluidState& fluid_state, const ComponentVector& z,
                                    int verbosity)
     {
+        OPM_DENSEAD_COUNT_SCOPE("PTFlash::newtonComposition_");
         // Note: due to the need for inverse flash update for derivatives, the following two can be different
         // Looking for a good way to organize them
         constexpr size_t num_equations = numMisciblePhases * numMiscibleComponents + 1;
@@ -899,6 +903,7 @@ protected:
                                    FluidState& fluid_state,
                                    bool is_single_phase)
     {
+        OPM_DENSEAD_COUNT_SCOPE("PTFlash::updateDerivatives_");
         if(!is_single_phase)
             updateDerivativesTwoPhase_(fluid_state_scalar, z, fluid_state);
         else
@@ -1131,6 +1136,7 @@ protected:
     static void successiveSubstitutionComposition_(ComponentVector& K, typename ComponentVector::field_type& L, FlashFluidState& fluid_state, const ComponentVector& z,
                                                    const bool newton_afterwards, const int verbosity)
     {
+        OPM_DENSEAD_COUNT_SCOPE("PTFlash::successiveSubstitutionComposition_");
         // Determine max. iterations based on if it will be used as a standalone flash or as a pre-process to Newton (or other) method.
         const int maxIterations = newton_afterwards ? 3 : 10;
 
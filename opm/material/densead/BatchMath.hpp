@@ -0,0 +1,510 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Exponential, logarithm, power and square root functions which process whole
+ *        arrays of scalars or dense-AD evaluations at once.
+ *
+ * The per-call functions of Math.hpp use the scalar functions of the C library,
+ * which cannot be vectorized by the compiler. The functions in this file instead
+ * evaluate polynomial approximations on SIMD vectors using the vector extensions of
+ * GCC-compatible compilers. The width of the vectors is determined by the instruction
+ * set which the compiler targets (e.g. -march=native). This requires at least AVX2:
+ * with narrower vectors or without integer operations on them, the approximations
+ * are not faster than the C library, which is then used instead.
+ *
+ * The accuracy of the approximations is selected by a template argument:
+ *
+ * - BatchAccuracy::full: The relative error is within a few units in the last place
+ *   for exp() and log(). (pow() is computed as exp(exponent*log(base)), so its
+ *   relative error grows with the magnitude of exponent*log(base).)
+ * - BatchAccuracy::reduced: Uses shorter polynomials and is accurate to roughly half
+ *   of the digits of the scalar type, i.e., about 1e-8 for double.
+ *
+ * Overflow, underflow, zeros, infinities and NaNs are handled like the C library
+ * does, except that pow() yields NaN for all negative bases.
+ */
+#ifndef OPM_DENSEAD_BATCH_MATH_HPP
+#define OPM_DENSEAD_BATCH_MATH_HPP
+
+#include "Evaluation.hpp"
+#include "Math.hpp"
+#include "ValueOnlyMode.hpp"
+#include "OperationCounter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace Opm {
+namespace DenseAd {
+
+/*!
+ * \brief Specifies how accurate the functions of BatchMath.hpp are.
+ */
+enum class BatchAccuracy {
+    full,
+    reduced
+};
+
+namespace BatchMathDetail {
+#if defined(__GNUC__) && (defined(__AVX2__) || defined(__AVX512F__))
+#define OPM_DENSEAD_BATCH_MATH_VECTORIZED 1
+
+//! the size of the widest vector registers targeted by the compiler [bytes]
+#if defined(__AVX512F__)
+static constexpr unsigned vectorBytes = 64;
+#else
+static constexpr unsigned vectorBytes = 32;
+#endif
+
+/*!
+ * \brief The vector types and the properties of the floating point format for a
+ *        scalar type.
+ */
+template <class Scalar>
+struct Pack;
+
+template <>
+struct Pack<double>
+{
+    typedef double Scalar;
+    typedef double V __attribute__((vector_size(vectorBytes)));
+    typedef std::int64_t IV __attribute__((vector_size(vectorBytes)));
+    static constexpr int width = vectorBytes/sizeof(double);
+
+    static constexpr int mantissaBits = 52;
+    static constexpr std::int64_t exponentBias = 1023;
+    static constexpr std::int64_t exponentMask = 0x7ff;
+
+    // adding and subtracting this rounds to an integer
+    static constexpr double roundingShifter = 6755399441055744.0; // 1.5*2^52
+    static constexpr std::int64_t roundingShifterBits = 0x4338000000000000;
+
+    // ln(2) split into a part which can be multiplied exactly by small integers
+    // and the rest
+    static constexpr double ln2Hi = 6.93147180369123816490e-01;
+    static constexpr double ln2Lo = 1.90821492927058770002e-10;
+
+    // the range of arguments of exp() for which the result is finite and non-zero
+    static constexpr double maxExpArg = 709.782712893383973096;
+    static constexpr double minExpArg = -745.133219101941108420;
+
+    static constexpr double subnormalScale = 18014398509481984.0; // 2^54
+    static constexpr int subnormalScaleLog2 = 54;
+
+    static constexpr int expDegree(BatchAccuracy accuracy)
+    { return accuracy == BatchAccuracy::full ? 13 : 7; }
+
+    static constexpr int logTerms(BatchAccuracy accuracy)
+    { return accuracy == BatchAccuracy::full ? 11 : 5; }
+};
+
+template <>
+struct Pack<float>
+{
+    typedef float Scalar;
+    typedef float V __attribute__((vector_size(vectorBytes)));
+    typedef std::int32_t IV __attribute__((vector_size(vectorBytes)));
+    static constexpr int width = vectorBytes/sizeof(float);
+
+    static constexpr int mantissaBits = 23;
+    static constexpr std::int32_t exponentBias = 127;
+    static constexpr std::int32_t exponentMask = 0xff;
+
+    static constexpr float roundingShifter = 12582912.0f; // 1.5*2^23
+    static constexpr std::int32_t roundingShifterBits = 0x4b400000;
+
+    static constexpr float ln2Hi = 0.693359375f;
+    static constexpr float ln2Lo = -2.12194440e-4f;
+
+    static constexpr float maxExpArg = 88.7228391116729996f;
+    static constexpr float minExpArg = -103.972077083991796f;
+
+    static constexpr float subnormalScale = 33554432.0f; // 2^25
+    static constexpr int subnormalScaleLog2 = 25;
+
+    static constexpr int expDegree(BatchAccuracy accuracy)
+    { return accuracy == BatchAccuracy::full ? 7 : 4; }
+
+    static constexpr int logTerms(BatchAccuracy accuracy)
+    { return accuracy == BatchAccuracy::full ? 5 : 3; }
+};
+
+template <class V, class Scalar>
+inline V splat_(Scalar value)
+{
+    V result = {};
+    return result + value;
+}
+
+// conversions between floating point vectors with integral values and integer
+// vectors. for small k, the bit pattern of roundingShifter + k is the one of
+// roundingShifter plus k.
+template <class P>
+inline typename P::IV toInt_(const typename P::V& k)
+{
+    typedef typename P::IV IV;
+    return (IV)(k + P::roundingShifter) - P::roundingShifterBits;
+}
+
+template <class P>
+inline typename P::V toFloat_(const typename P::IV& k)
+{
+    typedef typename P::V V;
+    return (V)(k + P::roundingShifterBits) - P::roundingShifter;
+}
+
+// 2^k for vectors of integral values k within the range of normalized numbers
+template <class P>
+inline typename P::V exp2Int_(const typename P::V& k)
+{
+    typedef typename P::V V;
+    return (V)((toInt_<P>(k) + P::exponentBias) << P::mantissaBits);
+}
+
+template <class P, BatchAccuracy accuracy>
+inline typename P::V exp_(typename P::V x)
+{
+    typedef typename P::V V;
+    typedef typename P::Scalar Scalar;
+    const Scalar inf = std::numeric_limits<Scalar>::infinity();
+    const V origX = x;
+
+    // clamp the argument, so that the exponent of the result can be represented. NaNs
+    // are passed through.
+    x = (x > P::maxExpArg) ? splat_<V>(P::maxExpArg) : x;
+    x = (x < P::minExpArg) ? splat_<V>(P::minExpArg) : x;
+
+    // x = k*ln(2) + r with integral k and |r| <= ln(2)/2
+    const V k = (x*Scalar(1.44269504088896340736) + P::roundingShifter) - P::roundingShifter;
+    const V r = (x - k*P::ln2Hi) - k*P::ln2Lo;
+
+    // Taylor polynomial of exp(r)
+    constexpr int degree = P::expDegree(accuracy);
+    Scalar coeff = 1;
+    for (int i = 2; i <= degree; ++i)
+        coeff /= i;
+    V p = splat_<V>(coeff);
+    for (int i = degree - 1; i >= 0; --i) {
+        coeff *= (i + 1);
+        p = p*r + coeff;
+    }
+
+    // multiply by 2^k. the factor is split if k is outside of the range of
+    // normalized numbers.
+    const auto isSmall = k < Scalar(2 - P::exponentBias);
+    const auto isLarge = k > Scalar(P::exponentBias - 1);
+    V kk = isSmall ? k + Scalar(P::mantissaBits + 2) : k;
+    kk = isLarge ? kk - 2 : kk;
+    V result = p*exp2Int_<P>(kk);
+    result = isSmall ? result*(Scalar(1)/exp2Int_<P>(splat_<V>(Scalar(P::mantissaBits + 2)))) : result;
+    result = isLarge ? result*4 : result;
+
+    result = (origX > P::maxExpArg) ? splat_<V>(inf) : result;
+    result = (origX < P::minExpArg) ? splat_<V>(Scalar(0)) : result;
+    return result;
+}
+
+template <class P, BatchAccuracy accuracy>
+inline typename P::V log_(typename P::V x)
+{
+    typedef typename P::V V;
+    typedef typename P::IV IV;
+    typedef typename P::Scalar Scalar;
+    const Scalar inf = std::numeric_limits<Scalar>::infinity();
+    const V origX = x;
+
+    // scale subnormal numbers into the normalized range
+    const auto isSubnormal = x < std::numeric_limits<Scalar>::min();
+    x = isSubnormal ? x*P::subnormalScale : x;
+
+    // x = m*2^e with 1 <= m < 2
+    const IV bits = (IV)x;
+    const IV e = ((bits >> P::mantissaBits) & P::exponentMask) - P::exponentBias;
+    const IV mantissaMask = ((IV{} + 1) << P::mantissaBits) - 1;
+    V m = (V)((bits & mantissaMask) | ((IV{} + P::exponentBias) << P::mantissaBits));
+    V ef = toFloat_<P>(e);
+    ef = isSubnormal ? ef - P::subnormalScaleLog2 : ef;
+
+    // move m to the interval [sqrt(1/2), sqrt(2))
+    const auto isLarge = m > Scalar(1.41421356237309504880);
+    m = isLarge ? m*Scalar(0.5) : m;
+    ef = isLarge ? ef + 1 : ef;
+
+    // log(m) = 2*atanh(s) = 2*(s + s^3/3 + s^5/5 + ...) with s = (m - 1)/(m + 1)
+    const V s = (m - 1)/(m + 1);
+    const V z = s*s;
+    constexpr int numTerms = P::logTerms(accuracy);
+    V p = splat_<V>(Scalar(1)/(2*numTerms - 1));
+    for (int i = numTerms - 2; i >= 0; --i)
+        p = p*z + Scalar(1)/(2*i + 1);
+
+    V result = ef*P::ln2Hi + (2*s*p + ef*P::ln2Lo);
+
+    result = (origX == 0) ? splat_<V>(-inf) : result;
+    result = (origX < 0) ? splat_<V>(std::numeric_limits<Scalar>::quiet_NaN()) : result;
+    result = (origX == inf) ? origX : result;
+    result = (origX != origX) ? origX : result;
+    return result;
+}
+
+// apply a function on vectors to an array of scalars. the last few values which do
+// not fill a complete vector are padded with ones.
+template <class Scalar, class VectorFn>
+void applyPacked_(const Scalar* x, Scalar* result, std::size_t n, VectorFn fn)
+{
+    typedef Pack<Scalar> P;
+    typedef typename P::V V;
+
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width) {
+        V v;
+        std::memcpy(&v, x + i, sizeof(V));
+        v = fn(v);
+        std::memcpy(result + i, &v, sizeof(V));
+    }
+
+    if (i < n) {
+        V v = splat_<V>(Scalar(1));
+        std::memcpy(&v, x + i, (n - i)*sizeof(Scalar));
+        v = fn(v);
+        std::memcpy(result + i, &v, (n - i)*sizeof(Scalar));
+    }
+}
+#else
+#define OPM_DENSEAD_BATCH_MATH_VECTORIZED 0
+#endif // defined(__GNUC__) && (defined(__AVX2__) || defined(__AVX512F__))
+
+// the number of evaluations whose values are processed at once
+static constexpr std::size_t evalChunkSize = 64;
+
+// apply a function to the values of an array of evaluations. the derivatives are
+// then set using the chain rule with the derivative of the function.
+template <class ValueType, int numVars, unsigned staticSize, class BatchFn, class DerivFn>
+void applyToEvaluations_(const Evaluation<ValueType, numVars, staticSize>* x,
+                         Evaluation<ValueType, numVars, staticSize>* result,
+                         std::size_t n,
+                         BatchFn batchFn,
+                         DerivFn df_dx)
+{
+    countOperation(CountedOperation::transcendental, n);
+
+    std::array<ValueType, evalChunkSize> values;
+    std::array<ValueType, evalChunkSize> f;
+    for (std::size_t begin = 0; begin < n; begin += evalChunkSize) {
+        const std::size_t chunkSize = std::min(evalChunkSize, n - begin);
+        for (std::size_t i = 0; i < chunkSize; ++i)
+            values[i] = x[begin + i].value();
+
+        batchFn(values.data(), f.data(), chunkSize);
+
+        for (std::size_t i = 0; i < chunkSize; ++i) {
+            Evaluation<ValueType, numVars, staticSize>& r = result[begin + i];
+            if (!derivativesEnabled()) {
+                r.setValue(f[i]);
+                continue;
+            }
+
+            r = x[begin + i];
+            r.setValue(f[i]);
+            df_dx(r, values[i], f[i]);
+        }
+    }
+}
+} // namespace BatchMathDetail
+
+/*!
+ * \brief Computes the exponential function for an array of scalars.
+ *
+ * The input and the output arrays may be identical.
+ */
+template <BatchAccuracy accuracy = BatchAccuracy::full, class Scalar>
+void batchExp(const Scalar* x, Scalar* result, std::size_t n)
+{
+    static_assert(std::is_floating_point<Scalar>::value,
+                  "batchExp() requires a floating point type or an Evaluation");
+#if OPM_DENSEAD_BATCH_MATH_VECTORIZED
+    typedef BatchMathDetail::Pack<Scalar> P;
+    BatchMathDetail::applyPacked_(x, result, n, [](typename P::V v)
+                                  { return BatchMathDetail::exp_<P, accuracy>(v); });
+#else
+    for (std::size_t i = 0; i < n; ++i)
+        result[i] = std::exp(x[i]);
+#endif
+}
+
+/*!
+ * \brief Computes the natural logarithm for an array of scalars.
+ *
+ * The input and the output arrays may be identical.
+ */
+template <BatchAccuracy accuracy = BatchAccuracy::full, class Scalar>
+void batchLog(const Scalar* x, Scalar* result, std::size_t n)
+{
+    static_assert(std::is_floating_point<Scalar>::value,
+                  "batchLog() requires a floating point type or an Evaluation");
+#if OPM_DENSEAD_BATCH_MATH_VECTORIZED
+    typedef BatchMathDetail::Pack<Scalar> P;
+    BatchMathDetail::applyPacked_(x, result, n, [](typename P::V v)
+                                  { return BatchMathDetail::log_<P, accuracy>(v); });
+#else
+    for (std::size_t i = 0; i < n; ++i)
+        result[i] = std::log(x[i]);
+#endif
+}
+
+/*!
+ * \brief Raises an array of non-negative scalars to a fixed power.
+ *
+ * This is computed as exp(exponent*log(base)) without storing the intermediate
+ * logarithms. The input and the output arrays may be identical.
+ */
+template <BatchAccuracy accuracy = BatchAccuracy::full, class Scalar>
+void batchPow(const Scalar* base, Scalar exponent, Scalar* result, std::size_t n)
+{
+    static_assert(std::is_floating_point<Scalar>::value,
+                  "batchPow() requires a floating point type or an Evaluation");
+    if (exponent == 0) {
+        std::fill(result, result + n, Scalar(1));
+        return;
+    }
+
+#if OPM_DENSEAD_BATCH_MATH_VECTORIZED
+    typedef BatchMathDetail::Pack<Scalar> P;
+    BatchMathDetail::applyPacked_(base, result, n, [exponent](typename P::V v)
+    {
+        const typename P::V y = exponent*BatchMathDetail::log_<P, accuracy>(v);
+        return BatchMathDetail::exp_<P, accuracy>(y);
+    });
+#else
+    for (std::size_t i = 0; i < n; ++i)
+        result[i] = (base[i] < 0) ? std::numeric_limits<Scalar>::quiet_NaN() : std::pow(base[i], exponent);
+#endif
+}
+
+/*!
+ * \brief Computes the square root for an array of scalars.
+ *
+ * The square root is provided by the hardware, so this is exact for all accuracies.
+ * The input and the output arrays may be identical.
+ */
+template <BatchAccuracy accuracy = BatchAccuracy::full, class Scalar>
+void batchSqrt(const Scalar* x, Scalar* result, std::size_t n)
+{
+    static_assert(std::is_floating_point<Scalar>::value,
+                  "batchSqrt() requires a floating point type or an Evaluation");
+    for (std::size_t i = 0; i < n; ++i)
+        result[i] = std::sqrt(x[i]);
+}
+
+/*!
+ * \brief Computes the exponential function for an array of evaluations.
+ *
+ * The input and the output arrays may be identical.
+ */
+template <BatchAccuracy accuracy = BatchAccuracy::full, class ValueType, int numVars, unsigned staticSize>
+void batchExp(const Evaluation<ValueType, numVars, staticSize>* x,
+              Evaluation<ValueType, numVars, staticSize>* result,
+              std::size_t n)
+{
+    BatchMathDetail::applyToEvaluations_(x, result, n,
+                                         [](const ValueType* v, ValueType* f, std::size_t m)
+                                         { batchExp<accuracy>(v, f, m); },
+                                         [](auto& r, ValueType, ValueType f)
+                                         { applyChainRule_(r, f); });
+}
+
+/*!
+ * \brief Computes the natural logarithm for an array of evaluations.
+ *
+ * The input and the output arrays may be identical.
+ */
+template <BatchAccuracy accuracy = BatchAccuracy::full, class ValueType, int numVars, unsigned staticSize>
+void batchLog(const Evaluation<ValueType, numVars, staticSize>* x,
+              Evaluation<ValueType, numVars, staticSize>* result,
+              std::size_t n)
+{
+    BatchMathDetail::applyToEvaluations_(x, result, n,
+                                         [](const ValueType* v, ValueType* f, std::size_t m)
+                                         { batchLog<accuracy>(v, f, m); },
+                                         [](auto& r, ValueType v, ValueType)
+                                         { applyChainRule_(r, ValueType(1)/v); });
+}
+
+/*!
+ * \brief Raises an array of evaluations with non-negative values to a fixed power.
+ *
+ * Like the pow() function of Math.hpp, zero bases yield evaluations which are zero,
+ * including their derivatives. The input and the output arrays may be identical.
+ */
+template <BatchAccuracy accuracy = BatchAccuracy::full, class ValueType, int numVars, unsigned staticSize>
+void batchPow(const Evaluation<ValueType, numVars, staticSize>* base,
+              ValueType exponent,
+              Evaluation<ValueType, numVars, staticSize>* result,
+              std::size_t n)
+{
+    BatchMathDetail::applyToEvaluations_(base, result, n,
+                                         [exponent](const ValueType* v, ValueType* f, std::size_t m)
+    {
+        batchPow<accuracy>(v, exponent, f, m);
+        for (std::size_t i = 0; i < m; ++i)
+            if (v[i] == 0.0)
+                f[i] = 0.0;
+    },
+                                         [exponent](auto& r, ValueType v, ValueType f)
+    {
+        if (v == 0.0)
+            r = 0.0;
+        else
+            applyChainRule_(r, f/v*exponent);
+    });
+}
+
+/*!
+ * \brief Computes the square root for an array of evaluations.
+ *
+ * The input and the output arrays may be identical.
+ */
+template <BatchAccuracy accuracy = BatchAccuracy::full, class ValueType, int numVars, unsigned staticSize>
+void batchSqrt(const Evaluation<ValueType, numVars, staticSize>* x,
+               Evaluation<ValueType, numVars, staticSize>* result,
+               std::size_t n)
+{
+    BatchMathDetail::applyToEvaluations_(x, result, n,
+                                         [](const ValueType* v, ValueType* f, std::size_t m)
+                                         { batchSqrt<accuracy>(v, f, m); },
+                                         [](auto& r, ValueType, ValueType f)
+                                         { applyChainRule_(r, ValueType(0.5)/f); });
+}
+
+} // namespace DenseAd
+} // namespace Opm
+
+#endif // OPM_DENSEAD_BATCH_MATH_HPP
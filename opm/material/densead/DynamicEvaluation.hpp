@@ -34,6 +34,9 @@
 
 #include "Evaluation.hpp"
 #include "Math.hpp"
+#include "Expressions.hpp"
+#include "ValueOnlyMode.hpp"
+#include "OperationCounter.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -44,12 +47,24 @@
 #include <iostream>
 #include <algorithm>
 
+//! The number of entries (i.e., the value plus the derivatives) which dynamically
+//! sized evaluations store without allocating memory if the staticSize template
+//! parameter is zero. Evaluations with more derivatives use the heap buffers of
+//! FastSmallVector, which are recycled by a thread-local pool.
+#ifndef OPM_DENSEAD_DYNAMIC_INLINE_SIZE
+#define OPM_DENSEAD_DYNAMIC_INLINE_SIZE 0
+#endif
+
 namespace Opm {
 namespace DenseAd {
 
 /*!
  * \brief Represents a function evaluation and its derivatives w.r.t. a
  *        run-time specified set of variables.
+ *
+ * Up to staticSize entries (the value plus staticSize - 1 derivatives) are stored
+ * inside of the object, larger evaluations allocate memory. A staticSize of zero
+ * selects OPM_DENSEAD_DYNAMIC_INLINE_SIZE.
  */
 template <class ValueT, unsigned staticSize>
 class Evaluation<ValueT, DynamicSize, staticSize>
@@ -59,6 +74,10 @@ public:
     //! derivatives (-1 == "DynamicSize" means runtime determined)
     static const int numVars = DynamicSize;
 
+    //! the number of entries stored without allocating memory
+    static constexpr unsigned inlineSize =
+        staticSize > 0 ? staticSize : OPM_DENSEAD_DYNAMIC_INLINE_SIZE;
+
     //! field type
     typedef ValueT ValueType;
 
@@ -132,6 +151,17 @@ public:
         checkDefined_();
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation(const Expression<ExprT>& expr)
+        : data_(1 + expr.asImp().size())
+    {
+        countOperation(CountedOperation::temporary);
+        assignExpression_(expr.asImp());
+
+        checkDefined_();
+    }
+
     // create an evaluation which represents a constant function
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
@@ -252,6 +282,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] += other.data_[valuepos_()];
+            return *this;
+        }
+
         for (int i = 0; i < length_(); ++i)
             data_[i] += other.data_[i];
 
@@ -259,7 +294,7 @@ public:
     }
 
     // add value from other to this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator+=(const RhsValueType& other)
     {
         // value is added, derivatives stay the same
@@ -273,6 +308,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] -= other.data_[valuepos_()];
+            return *this;
+        }
+
         for (int i = 0; i < length_(); ++i)
             data_[i] -= other.data_[i];
 
@@ -280,7 +320,7 @@ public:
     }
 
     // subtract other's value from this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator-=(const RhsValueType& other)
     {
         // for constants, values are subtracted, derivatives stay the same
@@ -293,12 +333,18 @@ public:
     Evaluation& operator*=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::multiplication);
 
         // while the values are multiplied, the derivatives follow the product rule,
         // i.e., (u*v)' = (v'u + u'v).
         const ValueType u = this->value();
         const ValueType v = other.value();
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= v;
+            return *this;
+        }
+
         // value
         data_[valuepos_()] *= v ;
 
@@ -310,9 +356,16 @@ public:
     }
 
     // m(c*u)' = c*u'
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator*=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::multiplication);
+
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= other;
+            return *this;
+        }
+
         for (int i = 0; i < length_(); ++i)
             data_[i] *= other;
 
@@ -323,11 +376,17 @@ public:
     Evaluation& operator/=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::division);
 
         // values are divided, derivatives follow the rule for division, i.e., (u/v)' = (v'u -
         // u'v)/v^2.
         ValueType& u = data_[valuepos_()];
         const ValueType& v = other.value();
+        if (!derivativesEnabled()) {
+            u /= v;
+            return *this;
+        }
+
         for (int idx = dstart_(); idx < dend_(); ++idx) {
             const ValueType& uPrime = data_[idx];
             const ValueType& vPrime = other.data_[idx];
@@ -340,11 +399,18 @@ public:
     }
 
     // divide value and derivatives by value of other
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator/=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::division);
+
         const ValueType tmp = 1.0/other;
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= tmp;
+            return *this;
+        }
+
         for (int i = 0; i < length_(); ++i)
             data_[i] *= tmp;
 
@@ -356,6 +422,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -364,9 +431,10 @@ public:
     }
 
     // add constant to this object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator+(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -379,6 +447,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -387,9 +456,10 @@ public:
     }
 
     // subtract constant from evaluation object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator-(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -400,6 +470,7 @@ public:
     // negation (unary minus) operator
     Evaluation operator-() const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         // set value and derivatives to negative
@@ -413,6 +484,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -420,9 +492,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator*(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -434,6 +507,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -441,9 +515,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator/(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -451,7 +526,7 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator=(const RhsValueType& other)
     {
         setValue( other );
@@ -460,6 +535,18 @@ public:
         return *this;
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation& operator=(const Expression<ExprT>& expr)
+    {
+        if (size() != expr.asImp().size())
+            data_ = FastSmallVector<ValueT, inlineSize>(1 + expr.asImp().size());
+
+        assignExpression_(expr.asImp());
+
+        return *this;
+    }
+
     // copy assignment from evaluation
     Evaluation& operator=(const Evaluation& other) = default;
 
@@ -555,9 +642,22 @@ public:
         data_[dstart_() + varIdx] = derVal;
     }
 
+protected:
+    // the values of all nodes of the expression are computed by the time it gets
+    // here, so the expression may reference this object
+    template <class ExprT>
+    void assignExpression_(const ExprT& expr)
+    {
+        assert(size() == expr.size());
+
+        data_[valuepos_()] = expr.value();
+        for (int i = dstart_(); i < dend_(); ++i)
+            data_[i] = expr.derivative(i - dstart_());
+    }
+
 private:
 
-    FastSmallVector<ValueT, staticSize> data_;
+    FastSmallVector<ValueT, inlineSize> data_;
 };
 
 template <class Scalar, unsigned staticSize = 0>
@@ -34,9 +34,16 @@
 
 #include "Evaluation.hpp"
 #include "Math.hpp"
+#include "Expressions.hpp"
+#include "ValueOnlyMode.hpp"
+#include "OperationCounter.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 
+#if OPM_DENSEAD_SIMD
+#include "EvaluationSimd.hpp"
+#endif
+
 #include <array>
 #include <cmath>
 #include <cassert>
@@ -50,6 +57,7 @@ namespace DenseAd {
 //! is run-time determined
 static constexpr int DynamicSize = -1;
 
+#if !OPM_DENSEAD_SIMD
 /*!
  * \brief Represents a function evaluation and its derivatives w.r.t. a fixed set of
  *        variables.
@@ -108,7 +116,7 @@ public:
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
     // derivatives being zero.
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation(const RhsValueType& c)
     {
         setValue(c);
@@ -117,6 +125,16 @@ public:
         checkDefined_();
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation(const Expression<ExprT>& expr)
+    {
+        countOperation(CountedOperation::temporary);
+        assignExpression_(expr.asImp());
+
+        checkDefined_();
+    }
+
     // create an evaluation which represents a constant function
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
@@ -245,6 +263,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] += other.data_[valuepos_()];
+            return *this;
+        }
+
         for (int i = 0; i < length_(); ++i)
             data_[i] += other.data_[i];
 
@@ -252,7 +275,7 @@ public:
     }
 
     // add value from other to this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator+=(const RhsValueType& other)
     {
         // value is added, derivatives stay the same
@@ -266,6 +289,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] -= other.data_[valuepos_()];
+            return *this;
+        }
+
         for (int i = 0; i < length_(); ++i)
             data_[i] -= other.data_[i];
 
@@ -273,7 +301,7 @@ public:
     }
 
     // subtract other's value from this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator-=(const RhsValueType& other)
     {
         // for constants, values are subtracted, derivatives stay the same
@@ -286,12 +314,18 @@ public:
     Evaluation& operator*=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::multiplication);
 
         // while the values are multiplied, the derivatives follow the product rule,
         // i.e., (u*v)' = (v'u + u'v).
         const ValueType u = this->value();
         const ValueType v = other.value();
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= v;
+            return *this;
+        }
+
         // value
         data_[valuepos_()] *= v ;
 
@@ -303,9 +337,16 @@ public:
     }
 
     // m(c*u)' = c*u'
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator*=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::multiplication);
+
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= other;
+            return *this;
+        }
+
         for (int i = 0; i < length_(); ++i)
             data_[i] *= other;
 
@@ -316,11 +357,17 @@ public:
     Evaluation& operator/=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::division);
 
         // values are divided, derivatives follow the rule for division, i.e., (u/v)' = (v'u -
         // u'v)/v^2.
         ValueType& u = data_[valuepos_()];
         const ValueType& v = other.value();
+        if (!derivativesEnabled()) {
+            u /= v;
+            return *this;
+        }
+
         for (int idx = dstart_(); idx < dend_(); ++idx) {
             const ValueType& uPrime = data_[idx];
             const ValueType& vPrime = other.data_[idx];
@@ -333,11 +380,18 @@ public:
     }
 
     // divide value and derivatives by value of other
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator/=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::division);
+
         const ValueType tmp = 1.0/other;
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= tmp;
+            return *this;
+        }
+
         for (int i = 0; i < length_(); ++i)
             data_[i] *= tmp;
 
@@ -349,6 +403,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -357,9 +412,10 @@ public:
     }
 
     // add constant to this object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator+(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -372,6 +428,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -380,9 +437,10 @@ public:
     }
 
     // subtract constant from evaluation object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator-(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -393,6 +451,7 @@ public:
     // negation (unary minus) operator
     Evaluation operator-() const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result;
 
         // set value and derivatives to negative
@@ -406,6 +465,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -413,9 +473,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator*(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -427,6 +488,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -434,9 +496,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator/(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -444,7 +507,7 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator=(const RhsValueType& other)
     {
         setValue( other );
@@ -453,6 +516,15 @@ public:
         return *this;
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation& operator=(const Expression<ExprT>& expr)
+    {
+        assignExpression_(expr.asImp());
+
+        return *this;
+    }
+
     // copy assignment from evaluation
     Evaluation& operator=(const Evaluation& other) = default;
 
@@ -548,10 +620,24 @@ public:
         data_[dstart_() + varIdx] = derVal;
     }
 
+protected:
+    // the values of all nodes of the expression are computed by the time it gets
+    // here, so the expression may reference this object
+    template <class ExprT>
+    void assignExpression_(const ExprT& expr)
+    {
+        assert(size() == expr.size());
+
+        data_[valuepos_()] = expr.value();
+        for (int i = dstart_(); i < dend_(); ++i)
+            data_[i] = expr.derivative(i - dstart_());
+    }
+
 private:
 
     std::array<ValueT, numDerivs + 1> data_;
 };
+#endif // !OPM_DENSEAD_SIMD
 
 // the generic operators are only required for the unspecialized case
 template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
@@ -574,31 +660,38 @@ template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
 bool operator!=(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 { return a != b.value(); }
 
-template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
+template <class RhsValueType, class ValueType, int numVars, unsigned staticSize,
+          EnableIfNotExpression<RhsValueType> = 0>
 Evaluation<ValueType, numVars, staticSize> operator+(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 {
+    countOperation(CountedOperation::temporary);
     Evaluation<ValueType, numVars, staticSize> result(b);
     result += a;
     return result;
 }
 
-template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
+template <class RhsValueType, class ValueType, int numVars, unsigned staticSize,
+          EnableIfNotExpression<RhsValueType> = 0>
 Evaluation<ValueType, numVars, staticSize> operator-(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 {
     return -(b - a);
 }
 
-template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
+template <class RhsValueType, class ValueType, int numVars, unsigned staticSize,
+          EnableIfNotExpression<RhsValueType> = 0>
 Evaluation<ValueType, numVars, staticSize> operator/(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 {
+    countOperation(CountedOperation::temporary);
     Evaluation<ValueType, numVars, staticSize> tmp(a);
     tmp /= b;
     return tmp;
 }
 
-template <class RhsValueType, class ValueType, int numVars, unsigned staticSize>
+template <class RhsValueType, class ValueType, int numVars, unsigned staticSize,
+          EnableIfNotExpression<RhsValueType> = 0>
 Evaluation<ValueType, numVars, staticSize> operator*(const RhsValueType& a, const Evaluation<ValueType, numVars, staticSize>& b)
 {
+    countOperation(CountedOperation::temporary);
     Evaluation<ValueType, numVars, staticSize> result(b);
     result *= a;
     return result;
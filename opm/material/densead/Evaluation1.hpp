@@ -33,6 +33,9 @@
 
 #include "Evaluation.hpp"
 #include "Math.hpp"
+#include "Expressions.hpp"
+#include "ValueOnlyMode.hpp"
+#include "OperationCounter.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -100,7 +103,7 @@ public:
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
     // derivatives being zero.
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation(const RhsValueType& c)
     {
         setValue(c);
@@ -109,6 +112,16 @@ public:
         checkDefined_();
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation(const Expression<ExprT>& expr)
+    {
+        countOperation(CountedOperation::temporary);
+        assignExpression_(expr.asImp());
+
+        checkDefined_();
+    }
+
     // create an evaluation which represents a constant function
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
@@ -235,6 +248,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] += other.data_[valuepos_()];
+            return *this;
+        }
+
         data_[0] += other.data_[0];
         data_[1] += other.data_[1];
 
@@ -242,7 +260,7 @@ public:
     }
 
     // add value from other to this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator+=(const RhsValueType& other)
     {
         // value is added, derivatives stay the same
@@ -256,6 +274,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] -= other.data_[valuepos_()];
+            return *this;
+        }
+
         data_[0] -= other.data_[0];
         data_[1] -= other.data_[1];
 
@@ -263,7 +286,7 @@ public:
     }
 
     // subtract other's value from this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator-=(const RhsValueType& other)
     {
         // for constants, values are subtracted, derivatives stay the same
@@ -276,12 +299,18 @@ public:
     Evaluation& operator*=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::multiplication);
 
         // while the values are multiplied, the derivatives follow the product rule,
         // i.e., (u*v)' = (v'u + u'v).
         const ValueType u = this->value();
         const ValueType v = other.value();
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= v;
+            return *this;
+        }
+
         // value
         data_[valuepos_()] *= v ;
 
@@ -292,9 +321,16 @@ public:
     }
 
     // m(c*u)' = c*u'
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator*=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::multiplication);
+
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= other;
+            return *this;
+        }
+
         data_[0] *= other;
         data_[1] *= other;
 
@@ -305,11 +341,17 @@ public:
     Evaluation& operator/=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::division);
 
         // values are divided, derivatives follow the rule for division, i.e., (u/v)' = (v'u -
         // u'v)/v^2.
         ValueType& u = data_[valuepos_()];
         const ValueType& v = other.value();
+        if (!derivativesEnabled()) {
+            u /= v;
+            return *this;
+        }
+
         data_[1] = (v*data_[1] - u*other.data_[1])/(v*v);
         u /= v;
 
@@ -317,11 +359,18 @@ public:
     }
 
     // divide value and derivatives by value of other
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator/=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::division);
+
         const ValueType tmp = 1.0/other;
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= tmp;
+            return *this;
+        }
+
         data_[0] *= tmp;
         data_[1] *= tmp;
 
@@ -333,6 +382,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -341,9 +391,10 @@ public:
     }
 
     // add constant to this object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator+(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -356,6 +407,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -364,9 +416,10 @@ public:
     }
 
     // subtract constant from evaluation object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator-(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -377,6 +430,7 @@ public:
     // negation (unary minus) operator
     Evaluation operator-() const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result;
 
         // set value and derivatives to negative
@@ -390,6 +444,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -397,9 +452,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator*(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -411,6 +467,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -418,9 +475,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator/(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -428,7 +486,7 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator=(const RhsValueType& other)
     {
         setValue( other );
@@ -437,6 +495,15 @@ public:
         return *this;
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation& operator=(const Expression<ExprT>& expr)
+    {
+        assignExpression_(expr.asImp());
+
+        return *this;
+    }
+
     // copy assignment from evaluation
     Evaluation& operator=(const Evaluation& other) = default;
 
@@ -532,6 +599,18 @@ public:
         data_[dstart_() + varIdx] = derVal;
     }
 
+protected:
+    // the values of all nodes of the expression are computed by the time it gets
+    // here, so the expression may reference this object
+    template <class ExprT>
+    void assignExpression_(const ExprT& expr)
+    {
+        assert(size() == expr.size());
+
+        data_[valuepos_()] = expr.value();
+        data_[1] = expr.derivative(0);
+    }
+
 private:
 
     std::array<ValueT, 2> data_;
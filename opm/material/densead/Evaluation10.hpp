@@ -33,6 +33,9 @@
 
 #include "Evaluation.hpp"
 #include "Math.hpp"
+#include "Expressions.hpp"
+#include "ValueOnlyMode.hpp"
+#include "OperationCounter.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -100,7 +103,7 @@ public:
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
     // derivatives being zero.
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation(const RhsValueType& c)
     {
         setValue(c);
@@ -109,6 +112,16 @@ public:
         checkDefined_();
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation(const Expression<ExprT>& expr)
+    {
+        countOperation(CountedOperation::temporary);
+        assignExpression_(expr.asImp());
+
+        checkDefined_();
+    }
+
     // create an evaluation which represents a constant function
     //
     // i.e., f(x) = c. this implies an evaluation with the given value and all
@@ -253,6 +266,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] += other.data_[valuepos_()];
+            return *this;
+        }
+
         data_[0] += other.data_[0];
         data_[1] += other.data_[1];
         data_[2] += other.data_[2];
@@ -269,7 +287,7 @@ public:
     }
 
     // add value from other to this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator+=(const RhsValueType& other)
     {
         // value is added, derivatives stay the same
@@ -283,6 +301,11 @@ public:
     {
         assert(size() == other.size());
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] -= other.data_[valuepos_()];
+            return *this;
+        }
+
         data_[0] -= other.data_[0];
         data_[1] -= other.data_[1];
         data_[2] -= other.data_[2];
@@ -299,7 +322,7 @@ public:
     }
 
     // subtract other's value from this values
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator-=(const RhsValueType& other)
     {
         // for constants, values are subtracted, derivatives stay the same
@@ -312,12 +335,18 @@ public:
     Evaluation& operator*=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::multiplication);
 
         // while the values are multiplied, the derivatives follow the product rule,
         // i.e., (u*v)' = (v'u + u'v).
         const ValueType u = this->value();
         const ValueType v = other.value();
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= v;
+            return *this;
+        }
+
         // value
         data_[valuepos_()] *= v ;
 
@@ -337,9 +366,16 @@ public:
     }
 
     // m(c*u)' = c*u'
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator*=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::multiplication);
+
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= other;
+            return *this;
+        }
+
         data_[0] *= other;
         data_[1] *= other;
         data_[2] *= other;
@@ -359,11 +395,17 @@ public:
     Evaluation& operator/=(const Evaluation& other)
     {
         assert(size() == other.size());
+        countOperation(CountedOperation::division);
 
         // values are divided, derivatives follow the rule for division, i.e., (u/v)' = (v'u -
         // u'v)/v^2.
         ValueType& u = data_[valuepos_()];
         const ValueType& v = other.value();
+        if (!derivativesEnabled()) {
+            u /= v;
+            return *this;
+        }
+
         data_[1] = (v*data_[1] - u*other.data_[1])/(v*v);
         data_[2] = (v*data_[2] - u*other.data_[2])/(v*v);
         data_[3] = (v*data_[3] - u*other.data_[3])/(v*v);
@@ -380,11 +422,18 @@ public:
     }
 
     // divide value and derivatives by value of other
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator/=(const RhsValueType& other)
     {
+        countOperation(CountedOperation::division);
+
         const ValueType tmp = 1.0/other;
 
+        if (!derivativesEnabled()) {
+            data_[valuepos_()] *= tmp;
+            return *this;
+        }
+
         data_[0] *= tmp;
         data_[1] *= tmp;
         data_[2] *= tmp;
@@ -405,6 +454,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -413,9 +463,10 @@ public:
     }
 
     // add constant to this object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator+(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result += other;
@@ -428,6 +479,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -436,9 +488,10 @@ public:
     }
 
     // subtract constant from evaluation object
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator-(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result -= other;
@@ -449,6 +502,7 @@ public:
     // negation (unary minus) operator
     Evaluation operator-() const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result;
 
         // set value and derivatives to negative
@@ -471,6 +525,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -478,9 +533,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator*(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result *= other;
@@ -492,6 +548,7 @@ public:
     {
         assert(size() == other.size());
 
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -499,9 +556,10 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation operator/(const RhsValueType& other) const
     {
+        countOperation(CountedOperation::temporary);
         Evaluation result(*this);
 
         result /= other;
@@ -509,7 +567,7 @@ public:
         return result;
     }
 
-    template <class RhsValueType>
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
     Evaluation& operator=(const RhsValueType& other)
     {
         setValue( other );
@@ -518,6 +576,15 @@ public:
         return *this;
     }
 
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation& operator=(const Expression<ExprT>& expr)
+    {
+        assignExpression_(expr.asImp());
+
+        return *this;
+    }
+
     // copy assignment from evaluation
     Evaluation& operator=(const Evaluation& other) = default;
 
@@ -613,6 +680,27 @@ public:
         data_[dstart_() + varIdx] = derVal;
     }
 
+protected:
+    // the values of all nodes of the expression are computed by the time it gets
+    // here, so the expression may reference this object
+    template <class ExprT>
+    void assignExpression_(const ExprT& expr)
+    {
+        assert(size() == expr.size());
+
+        data_[valuepos_()] = expr.value();
+        data_[1] = expr.derivative(0);
+        data_[2] = expr.derivative(1);
+        data_[3] = expr.derivative(2);
+        data_[4] = expr.derivative(3);
+        data_[5] = expr.derivative(4);
+        data_[6] = expr.derivative(5);
+        data_[7] = expr.derivative(6);
+        data_[8] = expr.derivative(7);
+        data_[9] = expr.derivative(8);
+        data_[10] = expr.derivative(9);
+    }
+
 private:
 
     std::array<ValueT, 11> data_;
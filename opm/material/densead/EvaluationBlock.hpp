@@ -0,0 +1,757 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief A structure-of-arrays container for the function evaluations of a number of
+ *        cells.
+ *
+ * The Evaluation class stores the value and the derivatives of a single function
+ * evaluation contiguously. This allows to vectorize its operations only across the
+ * derivatives, and for the usual three to six primary variables, this does not fill
+ * a SIMD register. EvaluationBlock instead stores the value and the derivatives for
+ * a fixed number of cells ("lanes") in a structure-of-arrays layout: all values are
+ * contiguous, then the first derivatives of all lanes, and so on. All operations are
+ * loops over the lanes, which compilers vectorize.
+ *
+ * The arithmetic operators and the mathematical functions of Math.hpp behave like
+ * applying the respective operation of Evaluation to each lane. Since different lanes
+ * may take different branches, the comparison operators return a mask with one entry
+ * per lane instead of a bool. Code which needs to branch on values can be instantiated
+ * on EvaluationBlock after replacing these branches by select().
+ */
+#ifndef OPM_DENSEAD_EVALUATION_BLOCK_HPP
+#define OPM_DENSEAD_EVALUATION_BLOCK_HPP
+
+#include "Evaluation.hpp"
+#include "Math.hpp"
+#include "EvaluationToolbox.hpp"
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Valgrind.hpp>
+
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <type_traits>
+
+namespace Opm {
+namespace DenseAd {
+
+/*!
+ * \brief The result of comparing the lanes of EvaluationBlock objects.
+ */
+template <int width>
+class EvaluationBlockMask
+{
+public:
+    EvaluationBlockMask() : lanes_()
+    {}
+
+    bool operator[](int lane) const
+    { return lanes_[lane]; }
+
+    bool& operator[](int lane)
+    { return lanes_[lane]; }
+
+    //! returns true if the comparison is true for all lanes
+    bool all() const
+    {
+        for (int lane = 0; lane < width; ++lane)
+            if (!lanes_[lane])
+                return false;
+        return true;
+    }
+
+    //! returns true if the comparison is true for at least one lane
+    bool any() const
+    {
+        for (int lane = 0; lane < width; ++lane)
+            if (lanes_[lane])
+                return true;
+        return false;
+    }
+
+    EvaluationBlockMask operator!() const
+    {
+        EvaluationBlockMask result;
+        for (int lane = 0; lane < width; ++lane)
+            result.lanes_[lane] = !lanes_[lane];
+        return result;
+    }
+
+    EvaluationBlockMask operator&&(const EvaluationBlockMask& other) const
+    {
+        EvaluationBlockMask result;
+        for (int lane = 0; lane < width; ++lane)
+            result.lanes_[lane] = lanes_[lane] && other.lanes_[lane];
+        return result;
+    }
+
+    EvaluationBlockMask operator||(const EvaluationBlockMask& other) const
+    {
+        EvaluationBlockMask result;
+        for (int lane = 0; lane < width; ++lane)
+            result.lanes_[lane] = lanes_[lane] || other.lanes_[lane];
+        return result;
+    }
+
+private:
+    std::array<bool, width> lanes_;
+};
+
+/*!
+ * \brief Represents the function evaluations and their derivatives w.r.t. a fixed set
+ *        of variables for 'width' cells.
+ *
+ * Scalars which are used as operands are applied to all lanes.
+ */
+template <class ValueT, int numDerivs, int width>
+class EvaluationBlock
+{
+    static_assert(std::is_floating_point<ValueT>::value,
+                  "The lanes of EvaluationBlock objects must be floating point scalars");
+    static_assert(width > 0, "EvaluationBlock objects require at least one lane");
+
+    template <class T>
+    using EnableIfScalar_ =
+        typename std::enable_if<std::is_convertible<T, ValueT>::value, int>::type;
+
+public:
+    //! the number of derivatives
+    static const int numVars = numDerivs;
+
+    //! the number of lanes
+    static const int numLanes = width;
+
+    //! field type of the lanes
+    typedef ValueT ValueType;
+
+    //! the values or a derivative of all lanes
+    typedef std::array<ValueT, width> LaneArray;
+
+    //! the result of the comparison operators
+    typedef EvaluationBlockMask<width> Mask;
+
+    //! the Evaluation type which corresponds to a single lane
+    typedef Evaluation<ValueT, numDerivs> LaneEvaluation;
+
+    //! number of derivatives
+    constexpr int size() const
+    { return numDerivs; }
+
+protected:
+    //! instruct valgrind to check that the values and all derivatives of the
+    //! object are well-defined.
+    void checkDefined_() const
+    {
+#ifndef NDEBUG
+        Valgrind::CheckDefined(value_);
+        Valgrind::CheckDefined(derivatives_);
+#endif
+    }
+
+    // the lanes of an operand: scalars are the same for all lanes
+    static ValueT lane_(const LaneArray& a, int lane)
+    { return a[lane]; }
+
+    static ValueT lane_(ValueT a, int)
+    { return a; }
+
+    // create an object whose values and derivatives are uninitialized
+    struct noInit_ {};
+    explicit EvaluationBlock(noInit_)
+    {}
+
+public:
+    //! default constructor
+    EvaluationBlock() : value_(), derivatives_()
+    {}
+
+    //! copy other function evaluation
+    EvaluationBlock(const EvaluationBlock& other) = default;
+
+    // create an evaluation which represents a constant function for all lanes
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock(const RhsValueType& c)
+        : derivatives_()
+    {
+        value_.fill(c);
+    }
+
+    // create an evaluation with a different constant for each lane
+    EvaluationBlock(const LaneArray& c)
+        : value_(c), derivatives_()
+    {}
+
+    // create an evaluation of a "naked" depending variable (i.e., f(x) = x)
+    template <class RhsValueType>
+    EvaluationBlock(const RhsValueType& c, int varPos)
+        : EvaluationBlock(c)
+    {
+        // The variable position must be in represented by the given variable descriptor
+        assert(0 <= varPos && varPos < size());
+
+        derivatives_[varPos].fill(1.0);
+
+        checkDefined_();
+    }
+
+    // create a function evaluation for a "naked" depending variable (i.e., f(x) = x)
+    template <class RhsValueType>
+    static EvaluationBlock createVariable(const RhsValueType& value, int varPos)
+    { return EvaluationBlock(value, varPos); }
+
+    template <class RhsValueType>
+    static EvaluationBlock createVariable(const EvaluationBlock&, const RhsValueType& value, int varPos)
+    { return EvaluationBlock(value, varPos); }
+
+    // "evaluate" a constant function (i.e. a function that does not depend on the set of
+    // relevant variables, f(x) = c).
+    template <class RhsValueType>
+    static EvaluationBlock createConstant(const RhsValueType& value)
+    { return EvaluationBlock(value); }
+
+    template <class RhsValueType>
+    static EvaluationBlock createConstant(const EvaluationBlock&, const RhsValueType& value)
+    { return EvaluationBlock(value); }
+
+    static EvaluationBlock createBlank(const EvaluationBlock&)
+    { return EvaluationBlock(); }
+
+    static EvaluationBlock createConstantZero(const EvaluationBlock&)
+    { return EvaluationBlock(0.); }
+
+    static EvaluationBlock createConstantOne(const EvaluationBlock&)
+    { return EvaluationBlock(1.); }
+
+    // set all derivatives of all lanes to zero
+    void clearDerivatives()
+    {
+        for (auto& d : derivatives_)
+            d.fill(0.0);
+    }
+
+    // print the values and the derivatives of all lanes
+    void print(std::ostream& os = std::cout) const
+    {
+        for (int lane = 0; lane < width; ++lane) {
+            os << "[" << lane << "] v: " << value_[lane] << " / d:";
+            for (int varIdx = 0; varIdx < size(); ++varIdx)
+                os << " " << derivatives_[varIdx][lane];
+            os << "\n";
+        }
+    }
+
+    // extract the function evaluation of a single lane
+    LaneEvaluation lane(int laneIdx) const
+    {
+        LaneEvaluation result;
+        result.setValue(value_[laneIdx]);
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            result.setDerivative(varIdx, derivatives_[varIdx][laneIdx]);
+        return result;
+    }
+
+    // overwrite the function evaluation of a single lane
+    void setLane(int laneIdx, const LaneEvaluation& eval)
+    {
+        value_[laneIdx] = eval.value();
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            derivatives_[varIdx][laneIdx] = eval.derivative(varIdx);
+    }
+
+    EvaluationBlock& operator+=(const EvaluationBlock& other)
+    {
+        for (int lane = 0; lane < width; ++lane)
+            value_[lane] += other.value_[lane];
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                derivatives_[varIdx][lane] += other.derivatives_[varIdx][lane];
+
+        return *this;
+    }
+
+    // add a constant to all lanes (the derivatives stay the same)
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock& operator+=(const RhsValueType& other)
+    {
+        for (int lane = 0; lane < width; ++lane)
+            value_[lane] += other;
+
+        return *this;
+    }
+
+    EvaluationBlock& operator-=(const EvaluationBlock& other)
+    {
+        for (int lane = 0; lane < width; ++lane)
+            value_[lane] -= other.value_[lane];
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                derivatives_[varIdx][lane] -= other.derivatives_[varIdx][lane];
+
+        return *this;
+    }
+
+    // subtract a constant from all lanes (the derivatives stay the same)
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock& operator-=(const RhsValueType& other)
+    {
+        for (int lane = 0; lane < width; ++lane)
+            value_[lane] -= other;
+
+        return *this;
+    }
+
+    // multiply values and apply chain rule to derivatives: (u*v)' = (v'u + u'v)
+    EvaluationBlock& operator*=(const EvaluationBlock& other)
+    {
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                derivatives_[varIdx][lane] =
+                    derivatives_[varIdx][lane]*other.value_[lane]
+                    + other.derivatives_[varIdx][lane]*value_[lane];
+        for (int lane = 0; lane < width; ++lane)
+            value_[lane] *= other.value_[lane];
+
+        return *this;
+    }
+
+    // m(c*u)' = c*u'
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock& operator*=(const RhsValueType& other)
+    {
+        for (int lane = 0; lane < width; ++lane)
+            value_[lane] *= other;
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                derivatives_[varIdx][lane] *= other;
+
+        return *this;
+    }
+
+    // m(u*v)' = (vu' - uv')/v^2 = (u' - (u/v)*v')/v
+    EvaluationBlock& operator/=(const EvaluationBlock& other)
+    {
+        LaneArray vInv;
+        for (int lane = 0; lane < width; ++lane) {
+            vInv[lane] = 1.0/other.value_[lane];
+            value_[lane] *= vInv[lane];
+        }
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                derivatives_[varIdx][lane] =
+                    (derivatives_[varIdx][lane] - value_[lane]*other.derivatives_[varIdx][lane])
+                    *vInv[lane];
+
+        return *this;
+    }
+
+    // divide values and derivatives of all lanes by a constant
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock& operator/=(const RhsValueType& other)
+    {
+        const ValueType tmp = 1.0/other;
+
+        return (*this) *= tmp;
+    }
+
+    // the binary operators write their results directly instead of modifying a copy
+    // of the left operand. this avoids reading back the stores of the copy.
+    EvaluationBlock operator+(const EvaluationBlock& other) const
+    {
+        EvaluationBlock result(noInit_{});
+        for (int lane = 0; lane < width; ++lane)
+            result.value_[lane] = value_[lane] + other.value_[lane];
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] =
+                    derivatives_[varIdx][lane] + other.derivatives_[varIdx][lane];
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock operator+(const RhsValueType& other) const
+    {
+        EvaluationBlock result(*this);
+        result += other;
+        return result;
+    }
+
+    EvaluationBlock operator-(const EvaluationBlock& other) const
+    {
+        EvaluationBlock result(noInit_{});
+        for (int lane = 0; lane < width; ++lane)
+            result.value_[lane] = value_[lane] - other.value_[lane];
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] =
+                    derivatives_[varIdx][lane] - other.derivatives_[varIdx][lane];
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock operator-(const RhsValueType& other) const
+    {
+        EvaluationBlock result(*this);
+        result -= other;
+        return result;
+    }
+
+    // negation (unary minus) operator
+    EvaluationBlock operator-() const
+    {
+        EvaluationBlock result(noInit_{});
+        for (int lane = 0; lane < width; ++lane)
+            result.value_[lane] = -value_[lane];
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] = -derivatives_[varIdx][lane];
+        return result;
+    }
+
+    EvaluationBlock operator*(const EvaluationBlock& other) const
+    {
+        EvaluationBlock result(noInit_{});
+        for (int lane = 0; lane < width; ++lane)
+            result.value_[lane] = value_[lane]*other.value_[lane];
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] =
+                    derivatives_[varIdx][lane]*other.value_[lane]
+                    + other.derivatives_[varIdx][lane]*value_[lane];
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock operator*(const RhsValueType& other) const
+    {
+        EvaluationBlock result(noInit_{});
+        for (int lane = 0; lane < width; ++lane)
+            result.value_[lane] = value_[lane]*other;
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] = derivatives_[varIdx][lane]*other;
+        return result;
+    }
+
+    EvaluationBlock operator/(const EvaluationBlock& other) const
+    {
+        EvaluationBlock result(noInit_{});
+        LaneArray vInv;
+        for (int lane = 0; lane < width; ++lane) {
+            vInv[lane] = 1.0/other.value_[lane];
+            result.value_[lane] = value_[lane]*vInv[lane];
+        }
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] =
+                    (derivatives_[varIdx][lane] - result.value_[lane]*other.derivatives_[varIdx][lane])
+                    *vInv[lane];
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock operator/(const RhsValueType& other) const
+    {
+        const ValueType tmp = 1.0/other;
+        return (*this)*tmp;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    EvaluationBlock& operator=(const RhsValueType& other)
+    {
+        value_.fill(other);
+        clearDerivatives();
+
+        return *this;
+    }
+
+    // copy assignment from evaluation
+    EvaluationBlock& operator=(const EvaluationBlock& other) = default;
+
+    // operators for constants on the left hand side
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend EvaluationBlock operator+(const LhsValueType& a, const EvaluationBlock& b)
+    { return b + a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend EvaluationBlock operator-(const LhsValueType& a, const EvaluationBlock& b)
+    { return -(b - a); }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend EvaluationBlock operator*(const LhsValueType& a, const EvaluationBlock& b)
+    { return b*a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend EvaluationBlock operator/(const LhsValueType& a, const EvaluationBlock& b)
+    {
+        // (c/v)' = -c*v'/v^2
+        EvaluationBlock result(noInit_{});
+        LaneArray factor;
+        for (int lane = 0; lane < width; ++lane) {
+            const ValueType vInv = 1.0/b.value_[lane];
+            result.value_[lane] = a*vInv;
+            factor[lane] = -result.value_[lane]*vInv;
+        }
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] = b.derivatives_[varIdx][lane]*factor[lane];
+        return result;
+    }
+
+    // two blocks are equal if the values and the derivatives of all lanes are equal
+    bool operator==(const EvaluationBlock& other) const
+    { return value_ == other.value_ && derivatives_ == other.derivatives_; }
+
+    bool operator!=(const EvaluationBlock& other) const
+    { return !operator==(other); }
+
+    // the comparisons of the values are lane-wise
+    template <class RhsType>
+    Mask operator<(const RhsType& other) const
+    { return compare_(other, [](ValueT a, ValueT b) { return a < b; }); }
+
+    template <class RhsType>
+    Mask operator>(const RhsType& other) const
+    { return compare_(other, [](ValueT a, ValueT b) { return a > b; }); }
+
+    template <class RhsType>
+    Mask operator<=(const RhsType& other) const
+    { return compare_(other, [](ValueT a, ValueT b) { return a <= b; }); }
+
+    template <class RhsType>
+    Mask operator>=(const RhsType& other) const
+    { return compare_(other, [](ValueT a, ValueT b) { return a >= b; }); }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend Mask operator<(const LhsValueType& a, const EvaluationBlock& b)
+    { return b > a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend Mask operator>(const LhsValueType& a, const EvaluationBlock& b)
+    { return b < a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend Mask operator<=(const LhsValueType& a, const EvaluationBlock& b)
+    { return b >= a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend Mask operator>=(const LhsValueType& a, const EvaluationBlock& b)
+    { return b <= a; }
+
+    // return the values of all lanes
+    const LaneArray& value() const
+    { return value_; }
+
+    // return the value of a lane
+    const ValueType& value(int laneIdx) const
+    { return value_[laneIdx]; }
+
+    // set the values of all lanes
+    template <class RhsValueType>
+    void setValue(const RhsValueType& val)
+    {
+        for (int lane = 0; lane < width; ++lane)
+            value_[lane] = lane_(val, lane);
+    }
+
+    // return the varIdx'th derivative of all lanes
+    const LaneArray& derivative(int varIdx) const
+    {
+        assert(0 <= varIdx && varIdx < size());
+
+        return derivatives_[varIdx];
+    }
+
+    // set the derivative at position varIdx for all lanes
+    template <class RhsValueType>
+    void setDerivative(int varIdx, const RhsValueType& derVal)
+    {
+        assert(0 <= varIdx && varIdx < size());
+
+        for (int lane = 0; lane < width; ++lane)
+            derivatives_[varIdx][lane] = lane_(derVal, lane);
+    }
+
+    // apply the chain rule for f(x) to all lanes: the values become f(x), the
+    // derivatives are scaled by df/dx(x). f and df_dx are called for each lane.
+    template <class Fn, class DerivFn>
+    EvaluationBlock chainRule(Fn f, DerivFn df_dx) const
+    {
+        EvaluationBlock result(noInit_{});
+        LaneArray factor;
+        for (int lane = 0; lane < width; ++lane) {
+            result.value_[lane] = f(value_[lane]);
+            factor[lane] = df_dx(value_[lane], result.value_[lane]);
+        }
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] = derivatives_[varIdx][lane]*factor[lane];
+        return result;
+    }
+
+    // apply the chain rule for f(x, y) to all lanes, where x is this object: the values
+    // become f(x, y), the derivatives are the ones of x scaled by df/dx(x, y) plus the
+    // ones of y scaled by df/dy(x, y). f, df_dx and df_dy are called for each lane.
+    template <class Fn, class DerivFn1, class DerivFn2>
+    EvaluationBlock chainRule(const EvaluationBlock& y, Fn f, DerivFn1 df_dx, DerivFn2 df_dy) const
+    {
+        EvaluationBlock result(noInit_{});
+        LaneArray xFactor;
+        LaneArray yFactor;
+        for (int lane = 0; lane < width; ++lane) {
+            result.value_[lane] = f(value_[lane], y.value_[lane]);
+            xFactor[lane] = df_dx(value_[lane], y.value_[lane], result.value_[lane]);
+            yFactor[lane] = df_dy(value_[lane], y.value_[lane], result.value_[lane]);
+        }
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] =
+                    derivatives_[varIdx][lane]*xFactor[lane]
+                    + y.derivatives_[varIdx][lane]*yFactor[lane];
+        return result;
+    }
+
+    // pick the lanes of a if the mask is set and the ones of b otherwise
+    friend EvaluationBlock select(const Mask& mask, const EvaluationBlock& a, const EvaluationBlock& b)
+    {
+        EvaluationBlock result(noInit_{});
+        for (int lane = 0; lane < width; ++lane)
+            result.value_[lane] = mask[lane] ? a.value_[lane] : b.value_[lane];
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (int lane = 0; lane < width; ++lane)
+                result.derivatives_[varIdx][lane] =
+                    mask[lane] ? a.derivatives_[varIdx][lane] : b.derivatives_[varIdx][lane];
+        return result;
+    }
+
+private:
+    template <class RhsType, class Comp>
+    Mask compare_(const RhsType& other, Comp comp) const
+    {
+        Mask result;
+        for (int lane = 0; lane < width; ++lane)
+            result[lane] = comp(value_[lane], otherValue_(other, lane));
+        return result;
+    }
+
+    static ValueT otherValue_(const EvaluationBlock& other, int lane)
+    { return other.value_[lane]; }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    static ValueT otherValue_(const RhsValueType& other, int)
+    { return other; }
+
+    LaneArray value_;
+    std::array<LaneArray, numDerivs> derivatives_;
+};
+
+template <class ValueType, int numVars, int width>
+std::ostream& operator<<(std::ostream& os, const EvaluationBlock<ValueType, numVars, width>& eval)
+{
+    eval.print(os);
+    return os;
+}
+
+// the chain rule of the mathematical functions of EvaluationToolbox is applied to
+// each lane
+template <class ValueType, int numVars, int width, class Fn, class DerivFn>
+EvaluationBlock<ValueType, numVars, width>
+chainRule(const EvaluationBlock<ValueType, numVars, width>& x, Fn f, DerivFn df_dx)
+{ return x.chainRule(f, df_dx); }
+
+template <class ValueType, int numVars, int width, class Fn, class DerivFn1, class DerivFn2>
+EvaluationBlock<ValueType, numVars, width>
+chainRule(const EvaluationBlock<ValueType, numVars, width>& x,
+          const EvaluationBlock<ValueType, numVars, width>& y,
+          Fn f,
+          DerivFn1 df_dx,
+          DerivFn2 df_dy)
+{ return x.chainRule(y, f, df_dx, df_dy); }
+
+} // namespace DenseAd
+
+// the mathematical functions are the ones of EvaluationToolbox. since the lanes may
+// take different branches, min(), max() and abs() use select().
+template <class ValueT, int numVars, int width>
+struct MathToolbox<DenseAd::EvaluationBlock<ValueT, numVars, width> >
+    : public DenseAd::EvaluationToolbox<DenseAd::EvaluationBlock<ValueT, numVars, width> >
+{
+    typedef MathToolbox<ValueT> InnerToolbox;
+    typedef typename InnerToolbox::Scalar Scalar;
+    typedef DenseAd::EvaluationBlock<ValueT, numVars, width> Evaluation;
+
+    // the values of all lanes
+    static const typename Evaluation::LaneArray& value(const Evaluation& eval)
+    { return eval.value(); }
+
+    // comparison
+    static bool isSame(const Evaluation& a, const Evaluation& b, Scalar tolerance)
+    {
+        for (int lane = 0; lane < width; ++lane) {
+            if (!InnerToolbox::isSame(a.value(lane), b.value(lane), tolerance))
+                return false;
+
+            for (int curVarIdx = 0; curVarIdx < numVars; ++curVarIdx)
+                if (!InnerToolbox::isSame(a.derivative(curVarIdx)[lane],
+                                          b.derivative(curVarIdx)[lane],
+                                          tolerance))
+                    return false;
+        }
+
+        return true;
+    }
+
+    static bool isfinite(const Evaluation& arg)
+    {
+        for (int lane = 0; lane < width; ++lane) {
+            if (!InnerToolbox::isfinite(arg.value(lane)))
+                return false;
+
+            for (int i = 0; i < numVars; ++i)
+                if (!InnerToolbox::isfinite(arg.derivative(i)[lane]))
+                    return false;
+        }
+
+        return true;
+    }
+
+    static bool isnan(const Evaluation& arg)
+    {
+        for (int lane = 0; lane < width; ++lane) {
+            if (InnerToolbox::isnan(arg.value(lane)))
+                return true;
+
+            for (int i = 0; i < numVars; ++i)
+                if (InnerToolbox::isnan(arg.derivative(i)[lane]))
+                    return true;
+        }
+
+        return false;
+    }
+};
+
+} // namespace Opm
+
+#endif // OPM_DENSEAD_EVALUATION_BLOCK_HPP
@@ -0,0 +1,715 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Explicitly vectorized representation of an evaluation of a function and its
+ *        derivatives w.r.t. a fixed set of variables.
+ *
+ * This file is only used if the build system was configured with OPM_DENSEAD_SIMD
+ * enabled. In this case, the class defined here replaces the generic Evaluation class
+ * template as well as the hand-unrolled specializations for 4 to 12 derivatives. The
+ * derivatives are stored in an array which is padded to a multiple of the SIMD width
+ * and all operations on them are expressed in terms of the vector extensions of
+ * GCC-compatible compilers. The size of the widest vectors is selected by
+ * OPM_DENSEAD_SIMD_BYTES when the build system is configured: Since it determines the
+ * layout of the Evaluation objects, it must be the same for all translation units
+ * instead of following the instruction set which each of them targets. The
+ * compilation fails if the instruction set does not provide vectors of that size,
+ * e.g., if OPM_DENSEAD_SIMD_BYTES is 32 and AVX is not enabled.
+ */
+#ifndef OPM_DENSEAD_EVALUATION_SIMD_HPP
+#define OPM_DENSEAD_EVALUATION_SIMD_HPP
+
+#include "Expressions.hpp"
+#include "ValueOnlyMode.hpp"
+#include "OperationCounter.hpp"
+
+#include <opm/material/common/Valgrind.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#ifndef OPM_DENSEAD_SIMD_BYTES
+#define OPM_DENSEAD_SIMD_BYTES 16
+#endif
+
+#if OPM_DENSEAD_SIMD_BYTES != 16 && OPM_DENSEAD_SIMD_BYTES != 32 && OPM_DENSEAD_SIMD_BYTES != 64
+#error "OPM_DENSEAD_SIMD_BYTES must be 16, 32 or 64"
+#elif OPM_DENSEAD_SIMD_BYTES == 64 && !defined(__AVX512F__)
+#error "OPM_DENSEAD_SIMD_BYTES is 64, but AVX-512 is not enabled for this translation unit"
+#elif OPM_DENSEAD_SIMD_BYTES == 32 && !defined(__AVX__)
+#error "OPM_DENSEAD_SIMD_BYTES is 32, but AVX is not enabled for this translation unit"
+#elif OPM_DENSEAD_SIMD_BYTES == 16 && !defined(__SSE2__) && !defined(__ARM_NEON)
+#error "OPM_DENSEAD_SIMD_BYTES is 16, but neither SSE2 nor NEON is enabled for this translation unit"
+#endif
+
+namespace Opm {
+namespace DenseAd {
+namespace SimdDetail {
+//! the size of the widest vectors used for the derivatives [bytes]
+static constexpr unsigned maxVectorBytes = OPM_DENSEAD_SIMD_BYTES;
+
+/*!
+ * \brief Returns the vector size which is used for storing a given number of
+ *        scalars.
+ *
+ * This is the smallest power of two which can hold all scalars, bounded by the
+ * register width of the target architecture. This avoids processing mostly empty
+ * AVX-512 registers for evaluations with only a few derivatives.
+ */
+template <class ValueT>
+constexpr unsigned vectorBytes(int numScalars)
+{
+    unsigned n = 16;
+    while (n < maxVectorBytes && n < static_cast<unsigned>(numScalars)*sizeof(ValueT))
+        n *= 2;
+    return (maxVectorBytes < n) ? maxVectorBytes : n;
+}
+
+/*!
+ * \brief Maps a scalar type and a vector size to a vector type.
+ *
+ * The default is to not vectorize at all. This is used for all types for which the
+ * compiler does not provide vector types, e.g. for nested Evaluations.
+ */
+template <class ValueT, unsigned numBytes>
+struct Vector
+{
+    typedef ValueT type;
+    static constexpr int width = 1;
+};
+
+#if defined(__GNUC__)
+template <>
+struct Vector<double, 16>
+{
+    typedef double type __attribute__((vector_size(16)));
+    static constexpr int width = 2;
+};
+
+template <>
+struct Vector<double, 32>
+{
+    typedef double type __attribute__((vector_size(32)));
+    static constexpr int width = 4;
+};
+
+template <>
+struct Vector<double, 64>
+{
+    typedef double type __attribute__((vector_size(64)));
+    static constexpr int width = 8;
+};
+
+template <>
+struct Vector<float, 16>
+{
+    typedef float type __attribute__((vector_size(16)));
+    static constexpr int width = 4;
+};
+
+template <>
+struct Vector<float, 32>
+{
+    typedef float type __attribute__((vector_size(32)));
+    static constexpr int width = 8;
+};
+
+template <>
+struct Vector<float, 64>
+{
+    typedef float type __attribute__((vector_size(64)));
+    static constexpr int width = 16;
+};
+#endif // defined(__GNUC__)
+} // namespace SimdDetail
+
+/*!
+ * \brief Represents a function evaluation and its derivatives w.r.t. a fixed set of
+ *        variables.
+ *
+ * This is the explicitly vectorized variant of the class. Its interface is identical
+ * to the one of the generic Evaluation class template.
+ */
+template <class ValueT, int numDerivs, unsigned staticSize = 0>
+class Evaluation
+{
+    typedef SimdDetail::Vector<ValueT, SimdDetail::vectorBytes<ValueT>(numDerivs)> Simd;
+    typedef typename Simd::type VectorType;
+
+    //! number of scalars per vector
+    static constexpr int simdWidth_ = Simd::width;
+
+    //! number of vectors which are required to store the derivatives
+    static constexpr int numPacks_ = (numDerivs > 0) ? (numDerivs + simdWidth_ - 1)/simdWidth_ : 1;
+
+public:
+    //! the template argument which specifies the number of
+    //! derivatives (-1 == "DynamicSize" means runtime determined)
+    static const int numVars = numDerivs;
+
+    //! field type
+    typedef ValueT ValueType;
+
+    //! number of derivatives
+    constexpr int size() const
+    { return numDerivs; }
+
+protected:
+    //! instruct valgrind to check that the value and all derivatives of the
+    //! Evaluation object are well-defined.
+    void checkDefined_() const
+    {
+#ifndef NDEBUG
+        Valgrind::CheckDefined(value_);
+        for (int i = 0; i < size(); ++i)
+            Valgrind::CheckDefined(derivatives_[i]);
+#endif
+    }
+
+    //! load the packIdx-th vector of derivatives
+    VectorType load_(int packIdx) const
+    {
+        if constexpr (simdWidth_ == 1)
+            return derivatives_[packIdx];
+        else {
+            VectorType result;
+            std::memcpy(&result, derivatives_ + packIdx*simdWidth_, sizeof(VectorType));
+            return result;
+        }
+    }
+
+    //! store the packIdx-th vector of derivatives
+    void store_(int packIdx, const VectorType& v)
+    {
+        if constexpr (simdWidth_ == 1)
+            derivatives_[packIdx] = v;
+        else
+            std::memcpy(derivatives_ + packIdx*simdWidth_, &v, sizeof(VectorType));
+    }
+
+public:
+    //! default constructor
+    Evaluation() : derivatives_(), value_()
+    {}
+
+    //! copy other function evaluation
+    Evaluation(const Evaluation& other) = default;
+
+
+    // create an evaluation which represents a constant function
+    //
+    // i.e., f(x) = c. this implies an evaluation with the given value and all
+    // derivatives being zero.
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation(const RhsValueType& c)
+    {
+        setValue(c);
+        clearDerivatives();
+
+        checkDefined_();
+    }
+
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation(const Expression<ExprT>& expr)
+    {
+        countOperation(CountedOperation::temporary);
+        assignExpression_(expr.asImp());
+
+        checkDefined_();
+    }
+
+    // create an evaluation which represents a constant function
+    //
+    // i.e., f(x) = c. this implies an evaluation with the given value and all
+    // derivatives being zero.
+    template <class RhsValueType>
+    Evaluation(const RhsValueType& c, int varPos)
+    {
+        // The variable position must be in represented by the given variable descriptor
+        assert(0 <= varPos && varPos < size());
+
+        setValue( c );
+        clearDerivatives();
+
+        derivatives_[varPos] = 1.0;
+
+        checkDefined_();
+    }
+
+    // set all derivatives to zero. this includes the padding.
+    void clearDerivatives()
+    {
+        for (int k = 0; k < numPacks_; ++k)
+            store_(k, VectorType{});
+    }
+
+    // create an uninitialized Evaluation object that is compatible with the
+    // argument, but not initialized
+    //
+    // This basically boils down to the copy constructor without copying
+    // anything. If the number of derivatives is known at compile time, this
+    // is equivalent to creating an uninitialized object using the default
+    // constructor, while for dynamic evaluations, it creates an Evaluation
+    // object which exhibits the same number of derivatives as the argument.
+    static Evaluation createBlank(const Evaluation&)
+    { return Evaluation(); }
+
+    // create an Evaluation with value and all the derivatives to be zero
+    static Evaluation createConstantZero(const Evaluation&)
+    { return Evaluation(0.); }
+
+    // create an Evaluation with value to be one and all the derivatives to be zero
+    static Evaluation createConstantOne(const Evaluation&)
+    { return Evaluation(1.); }
+
+    // create a function evaluation for a "naked" depending variable (i.e., f(x) = x)
+    template <class RhsValueType>
+    static Evaluation createVariable(const RhsValueType& value, int varPos)
+    {
+        // copy function value and set all derivatives to 0, except for the variable
+        // which is represented by the value (which is set to 1.0)
+        return Evaluation(value, varPos);
+    }
+
+    template <class RhsValueType>
+    static Evaluation createVariable(int nVars, const RhsValueType& value, int varPos)
+    {
+        if (nVars != numDerivs)
+            throw std::logic_error("This statically-sized evaluation can only represent objects"
+                                   " with "+std::to_string(numDerivs)+" derivatives");
+
+        // copy function value and set all derivatives to 0, except for the variable
+        // which is represented by the value (which is set to 1.0)
+        return Evaluation(value, varPos);
+    }
+
+    template <class RhsValueType>
+    static Evaluation createVariable(const Evaluation&, const RhsValueType& value, int varPos)
+    {
+        // copy function value and set all derivatives to 0, except for the variable
+        // which is represented by the value (which is set to 1.0)
+        return Evaluation(value, varPos);
+    }
+
+
+    // "evaluate" a constant function (i.e. a function that does not depend on the set of
+    // relevant variables, f(x) = c).
+    template <class RhsValueType>
+    static Evaluation createConstant(int nVars, const RhsValueType& value)
+    {
+        if (nVars != numDerivs)
+            throw std::logic_error("This statically-sized evaluation can only represent objects"
+                                   " with "+std::to_string(numDerivs)+" derivatives");
+        return Evaluation(value);
+    }
+
+    // "evaluate" a constant function (i.e. a function that does not depend on the set of
+    // relevant variables, f(x) = c).
+    template <class RhsValueType>
+    static Evaluation createConstant(const RhsValueType& value)
+    {
+        return Evaluation(value);
+    }
+
+    // "evaluate" a constant function (i.e. a function that does not depend on the set of
+    // relevant variables, f(x) = c).
+    template <class RhsValueType>
+    static Evaluation createConstant(const Evaluation&, const RhsValueType& value)
+    {
+        return Evaluation(value);
+    }
+
+    // print the value and the derivatives of the function evaluation
+    void print(std::ostream& os = std::cout) const
+    {
+        // print value
+        os << "v: " << value() << " / d:";
+
+        // print derivatives
+        for (int varIdx = 0; varIdx < size(); ++varIdx) {
+            os << " " << derivative(varIdx);
+        }
+    }
+
+    // copy all derivatives from other
+    void copyDerivatives(const Evaluation& other)
+    {
+        for (int k = 0; k < numPacks_; ++k)
+            store_(k, other.load_(k));
+    }
+
+
+    // add value and derivatives from other to this values and derivatives
+    Evaluation& operator+=(const Evaluation& other)
+    {
+        value_ += other.value_;
+        if (derivativesEnabled()) {
+            for (int k = 0; k < numPacks_; ++k)
+                store_(k, load_(k) + other.load_(k));
+        }
+
+        return *this;
+    }
+
+    // add value from other to this values
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation& operator+=(const RhsValueType& other)
+    {
+        // value is added, derivatives stay the same
+        value_ += other;
+
+        return *this;
+    }
+
+    // subtract other's value and derivatives from this values
+    Evaluation& operator-=(const Evaluation& other)
+    {
+        value_ -= other.value_;
+        if (derivativesEnabled()) {
+            for (int k = 0; k < numPacks_; ++k)
+                store_(k, load_(k) - other.load_(k));
+        }
+
+        return *this;
+    }
+
+    // subtract other's value from this values
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation& operator-=(const RhsValueType& other)
+    {
+        // for constants, values are subtracted, derivatives stay the same
+        value_ -= other;
+
+        return *this;
+    }
+
+    // multiply values and apply chain rule to derivatives: (u*v)' = (v'u + u'v)
+    Evaluation& operator*=(const Evaluation& other)
+    {
+        countOperation(CountedOperation::multiplication);
+
+        // while the values are multiplied, the derivatives follow the product rule,
+        // i.e., (u*v)' = (v'u + u'v).
+        const ValueType u = value_;
+        const ValueType v = other.value_;
+
+        // value
+        value_ *= v;
+
+        //  derivatives
+        if (derivativesEnabled()) {
+            for (int k = 0; k < numPacks_; ++k)
+                store_(k, load_(k)*v + other.load_(k)*u);
+        }
+
+        return *this;
+    }
+
+    // m(c*u)' = c*u'
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation& operator*=(const RhsValueType& other)
+    {
+        countOperation(CountedOperation::multiplication);
+
+        // convert the factor first: the vector extensions only broadcast scalars of
+        // the element type
+        const ValueType c = other;
+
+        value_ *= c;
+        if (derivativesEnabled()) {
+            for (int k = 0; k < numPacks_; ++k)
+                store_(k, load_(k)*c);
+        }
+
+        return *this;
+    }
+
+    // m(u*v)' = (vu' - uv')/v^2
+    Evaluation& operator/=(const Evaluation& other)
+    {
+        countOperation(CountedOperation::division);
+
+        // values are divided, derivatives follow the rule for division, i.e., (u/v)' = (v'u -
+        // u'v)/v^2.
+        const ValueType u = value_;
+        const ValueType v = other.value_;
+        if (derivativesEnabled()) {
+            const ValueType vSquared = v*v;
+            for (int k = 0; k < numPacks_; ++k)
+                store_(k, (v*load_(k) - u*other.load_(k))/vSquared);
+        }
+        value_ /= v;
+
+        return *this;
+    }
+
+    // divide value and derivatives by value of other
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation& operator/=(const RhsValueType& other)
+    {
+        countOperation(CountedOperation::division);
+
+        const ValueType tmp = 1.0/other;
+
+        value_ *= tmp;
+        if (derivativesEnabled()) {
+            for (int k = 0; k < numPacks_; ++k)
+                store_(k, load_(k)*tmp);
+        }
+
+        return *this;
+    }
+
+    // add two evaluation objects
+    Evaluation operator+(const Evaluation& other) const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result(*this);
+
+        result += other;
+
+        return result;
+    }
+
+    // add constant to this object
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation operator+(const RhsValueType& other) const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result(*this);
+
+        result += other;
+
+        return result;
+    }
+
+    // subtract two evaluation objects
+    Evaluation operator-(const Evaluation& other) const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result(*this);
+
+        result -= other;
+
+        return result;
+    }
+
+    // subtract constant from evaluation object
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation operator-(const RhsValueType& other) const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result(*this);
+
+        result -= other;
+
+        return result;
+    }
+
+    // negation (unary minus) operator
+    Evaluation operator-() const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result;
+
+        // set value and derivatives to negative
+        result.value_ = - value_;
+        for (int k = 0; k < numPacks_; ++k)
+            result.store_(k, - load_(k));
+
+        return result;
+    }
+
+    Evaluation operator*(const Evaluation& other) const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result(*this);
+
+        result *= other;
+
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation operator*(const RhsValueType& other) const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result(*this);
+
+        result *= other;
+
+        return result;
+    }
+
+    Evaluation operator/(const Evaluation& other) const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result(*this);
+
+        result /= other;
+
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation operator/(const RhsValueType& other) const
+    {
+        countOperation(CountedOperation::temporary);
+        Evaluation result(*this);
+
+        result /= other;
+
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfNotExpression<RhsValueType> = 0>
+    Evaluation& operator=(const RhsValueType& other)
+    {
+        setValue( other );
+        clearDerivatives();
+
+        return *this;
+    }
+
+    // materialize a lazily evaluated expression (cf. Expressions.hpp)
+    template <class ExprT>
+    Evaluation& operator=(const Expression<ExprT>& expr)
+    {
+        assignExpression_(expr.asImp());
+
+        return *this;
+    }
+
+    // copy assignment from evaluation
+    Evaluation& operator=(const Evaluation& other) = default;
+
+    template <class RhsValueType>
+    bool operator==(const RhsValueType& other) const
+    { return value() == other; }
+
+    bool operator==(const Evaluation& other) const
+    {
+        if (value_ != other.value_)
+            return false;
+
+        for (int idx = 0; idx < size(); ++idx) {
+            if (derivatives_[idx] != other.derivatives_[idx]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const Evaluation& other) const
+    { return !operator==(other); }
+
+    template <class RhsValueType>
+    bool operator!=(const RhsValueType& other) const
+    { return !operator==(other); }
+
+    template <class RhsValueType>
+    bool operator>(RhsValueType other) const
+    { return value() > other; }
+
+    bool operator>(const Evaluation& other) const
+    { return value() > other.value(); }
+
+    template <class RhsValueType>
+    bool operator<(RhsValueType other) const
+    { return value() < other; }
+
+    bool operator<(const Evaluation& other) const
+    { return value() < other.value(); }
+
+    template <class RhsValueType>
+    bool operator>=(RhsValueType other) const
+    { return value() >= other; }
+
+    bool operator>=(const Evaluation& other) const
+    { return value() >= other.value(); }
+
+    template <class RhsValueType>
+    bool operator<=(RhsValueType other) const
+    { return value() <= other; }
+
+    bool operator<=(const Evaluation& other) const
+    { return value() <= other.value(); }
+
+    // return value of variable
+    const ValueType& value() const
+    { return value_; }
+
+    // set value of variable
+    template <class RhsValueType>
+    void setValue(const RhsValueType& val)
+    { value_ = val; }
+
+    // return varIdx'th derivative
+    const ValueType& derivative(int varIdx) const
+    {
+        assert(0 <= varIdx && varIdx < size());
+
+        return derivatives_[varIdx];
+    }
+
+    // set derivative at position varIdx
+    void setDerivative(int varIdx, const ValueType& derVal)
+    {
+        assert(0 <= varIdx && varIdx < size());
+
+        derivatives_[varIdx] = derVal;
+    }
+
+protected:
+    // the values of all nodes of the expression are computed by the time it gets
+    // here, so the expression may reference this object. the derivatives are
+    // evaluated by scalar code because the nodes are not vectorized.
+    template <class ExprT>
+    void assignExpression_(const ExprT& expr)
+    {
+        assert(size() == expr.size());
+
+        value_ = expr.value();
+        for (int i = 0; i < size(); ++i)
+            derivatives_[i] = expr.derivative(i);
+        for (int i = size(); i < numPacks_*simdWidth_; ++i)
+            derivatives_[i] = 0.0;
+    }
+
+private:
+    // the padding entries of the derivatives never contribute to the actual
+    // derivatives because all operations are lane-wise.
+    alignas(alignof(VectorType)) ValueT derivatives_[numPacks_*simdWidth_];
+    ValueT value_;
+};
+
+} // namespace DenseAd
+} // namespace Opm
+
+#endif // OPM_DENSEAD_EVALUATION_SIMD_HPP
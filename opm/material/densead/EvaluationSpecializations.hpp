@@ -35,6 +35,10 @@
 #include <opm/material/densead/Evaluation1.hpp>
 #include <opm/material/densead/Evaluation2.hpp>
 #include <opm/material/densead/Evaluation3.hpp>
+
+// the explicitly vectorized Evaluation class handles all larger static sizes by
+// itself. below that, the vectors are mostly padding and scalar code is faster.
+#if !OPM_DENSEAD_SIMD
 #include <opm/material/densead/Evaluation4.hpp>
 #include <opm/material/densead/Evaluation5.hpp>
 #include <opm/material/densead/Evaluation6.hpp>
@@ -44,5 +48,27 @@
 #include <opm/material/densead/Evaluation10.hpp>
 #include <opm/material/densead/Evaluation11.hpp>
 #include <opm/material/densead/Evaluation12.hpp>
+#endif // !OPM_DENSEAD_SIMD
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+namespace Opm {
+namespace DenseAd {
+// libopmmaterial contains the evaluations with double precision for the statically
+// specialized numbers of derivatives (see opm/material/densead/Evaluation.cpp)
+extern template class Evaluation<double, 1>;
+extern template class Evaluation<double, 2>;
+extern template class Evaluation<double, 3>;
+extern template class Evaluation<double, 4>;
+extern template class Evaluation<double, 5>;
+extern template class Evaluation<double, 6>;
+extern template class Evaluation<double, 7>;
+extern template class Evaluation<double, 8>;
+extern template class Evaluation<double, 9>;
+extern template class Evaluation<double, 10>;
+extern template class Evaluation<double, 11>;
+extern template class Evaluation<double, 12>;
+} // namespace DenseAd
+} // namespace Opm
+#endif // OPM_MATERIAL_EXTERN_TEMPLATES
 
 #endif // OPM_DENSEAD_EVALUATION_SPECIALIZATIONS_HPP
\ No newline at end of file
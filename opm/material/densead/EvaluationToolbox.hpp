@@ -0,0 +1,364 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief The mathematical functions of Math.hpp for the evaluation types which are
+ *        alternatives to the Evaluation class.
+ *
+ * All of these functions are computed by evaluating the function and its slope for
+ * the value of the argument and then applying the chain rule to the derivatives. The
+ * evaluation types only need to provide the chain rule, i.e., the way they scale
+ * their derivatives: the chainRule() functions of this file do this using the
+ * arithmetic operators of evaluation types which store a single value, evaluation
+ * types which store several values, like EvaluationBlock, overload them.
+ */
+#ifndef OPM_DENSEAD_EVALUATION_TOOLBOX_HPP
+#define OPM_DENSEAD_EVALUATION_TOOLBOX_HPP
+
+#include "Evaluation.hpp"
+
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <type_traits>
+
+namespace Opm {
+namespace DenseAd {
+
+/*!
+ * \brief Apply the chain rule for f(x).
+ *
+ * The value of the result is f(x), its derivatives are the ones of x scaled by
+ * df_dx(x, f(x)).
+ */
+template <class Eval, class Fn, class DerivFn>
+Eval chainRule(const Eval& x, Fn f, DerivFn df_dx)
+{
+    const auto value = f(x.value());
+
+    Eval result(x);
+    result *= df_dx(x.value(), value);
+    result.setValue(value);
+    return result;
+}
+
+/*!
+ * \brief Apply the chain rule for f(x, y).
+ *
+ * The value of the result is f(x, y), its derivatives are the ones of x scaled by
+ * df_dx(x, y, f(x, y)) plus the ones of y scaled by df_dy(x, y, f(x, y)).
+ */
+template <class Eval, class Fn, class DerivFn1, class DerivFn2>
+Eval chainRule(const Eval& x, const Eval& y, Fn f, DerivFn1 df_dx, DerivFn2 df_dy)
+{
+    const auto value = f(x.value(), y.value());
+
+    Eval result(x);
+    result *= df_dx(x.value(), y.value(), value);
+    Eval tmp(y);
+    tmp *= df_dy(x.value(), y.value(), value);
+    result += tmp;
+    result.setValue(value);
+    return result;
+}
+
+/*!
+ * \brief Returns a if the condition is true and b otherwise.
+ *
+ * This is the counterpart of the select() function of EvaluationBlock, whose
+ * comparison operators yield one result per lane.
+ */
+template <class Eval>
+Eval select(bool cond, const Eval& a, const Eval& b)
+{ return cond ? a : b; }
+
+/*!
+ * \brief The functions of MathToolbox for an evaluation type.
+ *
+ * The MathToolbox specializations of the evaluation types derive from this class and
+ * only add or replace the functions which depend on the way they store their values.
+ */
+template <class EvalT>
+struct EvaluationToolbox
+{
+    typedef typename EvalT::ValueType ValueType;
+    typedef MathToolbox<ValueType> InnerToolbox;
+    typedef typename InnerToolbox::Scalar Scalar;
+    typedef EvalT Evaluation;
+
+    static const int numVars = Evaluation::numVars;
+
+    static ValueType value(const Evaluation& eval)
+    { return eval.value(); }
+
+    static decltype(InnerToolbox::scalarValue(0.0)) scalarValue(const Evaluation& eval)
+    { return InnerToolbox::scalarValue(eval.value()); }
+
+    static Evaluation createBlank(const Evaluation& x)
+    { return Evaluation::createBlank(x); }
+
+    static Evaluation createConstantZero(const Evaluation& x)
+    { return Evaluation::createConstantZero(x); }
+
+    static Evaluation createConstantOne(const Evaluation& x)
+    { return Evaluation::createConstantOne(x); }
+
+    static Evaluation createConstant(ValueType value)
+    { return Evaluation::createConstant(value); }
+
+    static Evaluation createConstant(const Evaluation& x, const ValueType value)
+    { return Evaluation::createConstant(x, value); }
+
+    static Evaluation createVariable(ValueType value, int varIdx)
+    { return Evaluation::createVariable(value, varIdx); }
+
+    template <class LhsEval>
+    static typename std::enable_if<std::is_same<Evaluation, LhsEval>::value,
+                                   LhsEval>::type
+    decay(const Evaluation& eval)
+    { return eval; }
+
+    // evaluation types which are expressions can be decayed to the Evaluation of the
+    // same size
+    template <class LhsEval>
+    static typename std::enable_if<std::is_same<DenseAd::Evaluation<ValueType, numVars>, LhsEval>::value
+                                   && !std::is_same<Evaluation, LhsEval>::value,
+                                   LhsEval>::type
+    decay(const Evaluation& eval)
+    { return LhsEval(eval); }
+
+    template <class LhsEval>
+    static typename std::enable_if<std::is_floating_point<LhsEval>::value,
+                                   LhsEval>::type
+    decay(const Evaluation& eval)
+    { return eval.value(); }
+
+    // comparison
+    static bool isSame(const Evaluation& a, const Evaluation& b, Scalar tolerance)
+    {
+        // make sure that the value of the evaluation is identical
+        if (!InnerToolbox::isSame(a.value(), b.value(), tolerance))
+            return false;
+
+        // make sure that the derivatives are identical
+        for (int curVarIdx = 0; curVarIdx < numVars; ++curVarIdx)
+            if (!InnerToolbox::isSame(a.derivative(curVarIdx), b.derivative(curVarIdx), tolerance))
+                return false;
+
+        return true;
+    }
+
+    // arithmetic functions
+    template <class Arg1Eval, class Arg2Eval>
+    static Evaluation max(const Arg1Eval& arg1, const Arg2Eval& arg2)
+    { return select(arg1 > arg2, Evaluation(arg1), Evaluation(arg2)); }
+
+    template <class Arg1Eval, class Arg2Eval>
+    static Evaluation min(const Arg1Eval& arg1, const Arg2Eval& arg2)
+    { return select(arg1 < arg2, Evaluation(arg1), Evaluation(arg2)); }
+
+    static Evaluation abs(const Evaluation& arg)
+    { return select(arg > 0.0, arg, -arg); }
+
+    static Evaluation tan(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::tan(x)); },
+                         [](const ValueType&, const ValueType& f) { return ValueType(1 + f*f); });
+    }
+
+    static Evaluation atan(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::atan(x)); },
+                         [](const ValueType& x, const ValueType&) { return ValueType(1/(1 + x*x)); });
+    }
+
+    static Evaluation atan2(const Evaluation& arg1, const Evaluation& arg2)
+    {
+        // d/dz atan2(x, y) = (x'*y - x*y')/(x^2 + y^2)
+        return chainRule(arg1, arg2,
+                         [](const ValueType& x, const ValueType& y)
+                         { return ValueType(InnerToolbox::atan2(x, y)); },
+                         [](const ValueType& x, const ValueType& y, const ValueType&)
+                         { return ValueType(y/(x*x + y*y)); },
+                         [](const ValueType& x, const ValueType& y, const ValueType&)
+                         { return ValueType(-x/(x*x + y*y)); });
+    }
+
+    static Evaluation sin(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::sin(x)); },
+                         [](const ValueType& x, const ValueType&) { return ValueType(InnerToolbox::cos(x)); });
+    }
+
+    static Evaluation asin(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::asin(x)); },
+                         [](const ValueType& x, const ValueType&)
+                         { return ValueType(1.0/InnerToolbox::sqrt(1 - x*x)); });
+    }
+
+    static Evaluation sinh(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::sinh(x)); },
+                         [](const ValueType& x, const ValueType&) { return ValueType(InnerToolbox::cosh(x)); });
+    }
+
+    static Evaluation asinh(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::asinh(x)); },
+                         [](const ValueType& x, const ValueType&)
+                         { return ValueType(1.0/InnerToolbox::sqrt(x*x + 1)); });
+    }
+
+    static Evaluation cos(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::cos(x)); },
+                         [](const ValueType& x, const ValueType&) { return ValueType(-InnerToolbox::sin(x)); });
+    }
+
+    static Evaluation acos(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::acos(x)); },
+                         [](const ValueType& x, const ValueType&)
+                         { return ValueType(-1.0/InnerToolbox::sqrt(1 - x*x)); });
+    }
+
+    static Evaluation cosh(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::cosh(x)); },
+                         [](const ValueType& x, const ValueType&) { return ValueType(InnerToolbox::sinh(x)); });
+    }
+
+    static Evaluation acosh(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::acosh(x)); },
+                         [](const ValueType& x, const ValueType&)
+                         { return ValueType(1.0/InnerToolbox::sqrt(x*x - 1)); });
+    }
+
+    static Evaluation sqrt(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::sqrt(x)); },
+                         [](const ValueType&, const ValueType& f) { return ValueType(0.5/f); });
+    }
+
+    static Evaluation exp(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::exp(x)); },
+                         [](const ValueType&, const ValueType& f) { return f; });
+    }
+
+    static Evaluation log(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::log(x)); },
+                         [](const ValueType& x, const ValueType&) { return ValueType(1/x); });
+    }
+
+    static Evaluation log10(const Evaluation& arg)
+    {
+        return chainRule(arg,
+                         [](const ValueType& x) { return ValueType(InnerToolbox::log10(x)); },
+                         [](const ValueType& x, const ValueType&)
+                         { return ValueType(1/x * InnerToolbox::log10(InnerToolbox::exp(1.0))); });
+    }
+
+    // exponentiation of arbitrary base with a fixed constant. like for Evaluation, a
+    // base of zero yields zero because the generic code leads to NaNs.
+    template <class RhsValueType>
+    static Evaluation pow(const Evaluation& arg1, const RhsValueType& arg2)
+    {
+        const ValueType exp = arg2;
+        return chainRule(arg1,
+                         [exp](const ValueType& x)
+                         { return (x == 0.0) ? ValueType(0.0) : ValueType(InnerToolbox::pow(x, exp)); },
+                         [exp](const ValueType& x, const ValueType& f)
+                         { return (x == 0.0) ? ValueType(0.0) : ValueType(f/x*exp); });
+    }
+
+    // exponentiation of constant base with an arbitrary exponent
+    template <class RhsValueType>
+    static Evaluation pow(const RhsValueType& arg1, const Evaluation& arg2)
+    {
+        if (arg1 == 0.0)
+            return Evaluation(0.0);
+
+        const ValueType lnBase = InnerToolbox::log(arg1);
+        return chainRule(arg2,
+                         [lnBase](const ValueType& x) { return ValueType(InnerToolbox::exp(lnBase*x)); },
+                         [lnBase](const ValueType&, const ValueType& f) { return ValueType(lnBase*f); });
+    }
+
+    static Evaluation pow(const Evaluation& arg1, const Evaluation& arg2)
+    {
+        // (f^g)' = (g*f'/f + log(f)*g') * f^g
+        return chainRule(arg1, arg2,
+                         [](const ValueType& f, const ValueType& g)
+                         { return (f == 0.0) ? ValueType(0.0) : ValueType(InnerToolbox::pow(f, g)); },
+                         [](const ValueType& f, const ValueType& g, const ValueType& valuePow)
+                         { return (f == 0.0) ? ValueType(0.0) : ValueType(g/f*valuePow); },
+                         [](const ValueType& f, const ValueType&, const ValueType& valuePow)
+                         { return (f == 0.0) ? ValueType(0.0) : ValueType(InnerToolbox::log(f)*valuePow); });
+    }
+
+    static bool isfinite(const Evaluation& arg)
+    {
+        if (!InnerToolbox::isfinite(arg.value()))
+            return false;
+
+        for (int i = 0; i < numVars; ++i)
+            if (!InnerToolbox::isfinite(arg.derivative(i)))
+                return false;
+
+        return true;
+    }
+
+    static bool isnan(const Evaluation& arg)
+    {
+        if (InnerToolbox::isnan(arg.value()))
+            return true;
+
+        for (int i = 0; i < numVars; ++i)
+            if (InnerToolbox::isnan(arg.derivative(i)))
+                return true;
+
+        return false;
+    }
+};
+
+} // namespace DenseAd
+} // namespace Opm
+
+#endif // OPM_DENSEAD_EVALUATION_TOOLBOX_HPP
@@ -0,0 +1,490 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Expression templates for the dense automatic differentiation framework.
+ *
+ * The arithmetic operators of the Evaluation class create a full temporary object for
+ * each operation, i.e., a formula like `bo*rhoO + Rs*bo*rhoG` loops four times over
+ * the derivatives. Wrapping the Evaluation operands of such a formula with
+ * Opm::lazy() turns it into a tree of expression nodes instead, which is only
+ * evaluated when it gets assigned to an Evaluation object. At this point, all
+ * derivatives are computed in a single pass.
+ *
+ * The values of all nodes are computed when the expression tree is built, while the
+ * derivatives are evaluated on demand. This makes it safe to assign an expression to
+ * one of its operands. Since the leafs of the tree only reference the wrapped
+ * Evaluation objects, an expression must be materialized within the full-expression
+ * which created it, i.e., it must not be stored using `auto`.
+ *
+ * For non-Evaluation arguments, Opm::lazy() is the identity function, so generic code
+ * which uses it also works for plain floating point types.
+ */
+#ifndef OPM_DENSEAD_EXPRESSIONS_HPP
+#define OPM_DENSEAD_EXPRESSIONS_HPP
+
+#include <type_traits>
+
+namespace Opm {
+namespace DenseAd {
+// forward declaration of the Evaluation template class
+template <class ValueT, int numVars, unsigned staticSize>
+class Evaluation;
+
+/*!
+ * \brief Base class of all nodes of an expression tree.
+ */
+template <class Implementation>
+class Expression
+{
+public:
+    const Implementation& asImp() const
+    { return *static_cast<const Implementation*>(this); }
+};
+
+//! Specifies whether a type is a node of an expression tree
+template <class T>
+struct IsExpression : public std::is_base_of<Expression<T>, T>
+{};
+
+//! Specifies whether a type is a dense-AD Evaluation
+template <class T>
+struct IsEvaluation : public std::false_type
+{};
+
+template <class ValueT, int numVars, unsigned staticSize>
+struct IsEvaluation<Evaluation<ValueT, numVars, staticSize> > : public std::true_type
+{};
+
+//! Specifies whether the operators of this file apply to an expression type. This is
+//! not the case for expression types which bring their own arithmetic operators.
+template <class T>
+struct IsLazyExpression : public IsExpression<T>
+{};
+
+//! Excludes expression trees from the overloads of the Evaluation class which accept
+//! arbitrary right hand sides.
+template <class T>
+using EnableIfNotExpression = typename std::enable_if<!IsExpression<T>::value, int>::type;
+
+/*!
+ * \brief Leaf of an expression tree which references an Evaluation object.
+ */
+template <class EvalT>
+class EvaluationLeaf : public Expression<EvaluationLeaf<EvalT> >
+{
+public:
+    typedef typename EvalT::ValueType ValueType;
+
+    explicit EvaluationLeaf(const EvalT& eval)
+        : eval_(eval)
+        , value_(eval.value())
+    {}
+
+    int size() const
+    { return eval_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    ValueType derivative(int varIdx) const
+    { return eval_.derivative(varIdx); }
+
+private:
+    const EvalT& eval_;
+    ValueType value_;
+};
+
+/*!
+ * \brief Node of an expression tree which represents the sum of two expressions.
+ */
+template <class Arg1, class Arg2>
+class SumExpression : public Expression<SumExpression<Arg1, Arg2> >
+{
+public:
+    typedef typename Arg1::ValueType ValueType;
+
+    SumExpression(const Arg1& a, const Arg2& b)
+        : a_(a)
+        , b_(b)
+        , value_(a.value() + b.value())
+    {}
+
+    int size() const
+    { return a_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    ValueType derivative(int varIdx) const
+    { return a_.derivative(varIdx) + b_.derivative(varIdx); }
+
+private:
+    Arg1 a_;
+    Arg2 b_;
+    ValueType value_;
+};
+
+/*!
+ * \brief Node of an expression tree which represents the difference of two
+ *        expressions.
+ */
+template <class Arg1, class Arg2>
+class DifferenceExpression : public Expression<DifferenceExpression<Arg1, Arg2> >
+{
+public:
+    typedef typename Arg1::ValueType ValueType;
+
+    DifferenceExpression(const Arg1& a, const Arg2& b)
+        : a_(a)
+        , b_(b)
+        , value_(a.value() - b.value())
+    {}
+
+    int size() const
+    { return a_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    ValueType derivative(int varIdx) const
+    { return a_.derivative(varIdx) - b_.derivative(varIdx); }
+
+private:
+    Arg1 a_;
+    Arg2 b_;
+    ValueType value_;
+};
+
+/*!
+ * \brief Node of an expression tree which represents the product of two expressions.
+ */
+template <class Arg1, class Arg2>
+class ProductExpression : public Expression<ProductExpression<Arg1, Arg2> >
+{
+public:
+    typedef typename Arg1::ValueType ValueType;
+
+    ProductExpression(const Arg1& a, const Arg2& b)
+        : a_(a)
+        , b_(b)
+        , value_(a.value()*b.value())
+    {}
+
+    int size() const
+    { return a_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    // (u*v)' = u'v + v'u
+    ValueType derivative(int varIdx) const
+    { return a_.derivative(varIdx)*b_.value() + b_.derivative(varIdx)*a_.value(); }
+
+private:
+    Arg1 a_;
+    Arg2 b_;
+    ValueType value_;
+};
+
+/*!
+ * \brief Node of an expression tree which represents the quotient of two
+ *        expressions.
+ */
+template <class Arg1, class Arg2>
+class QuotientExpression : public Expression<QuotientExpression<Arg1, Arg2> >
+{
+public:
+    typedef typename Arg1::ValueType ValueType;
+
+    QuotientExpression(const Arg1& a, const Arg2& b)
+        : a_(a)
+        , b_(b)
+        , value_(a.value()/b.value())
+        , vSquared_(b.value()*b.value())
+    {}
+
+    int size() const
+    { return a_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    // (u/v)' = (vu' - uv')/v^2
+    ValueType derivative(int varIdx) const
+    { return (b_.value()*a_.derivative(varIdx) - a_.value()*b_.derivative(varIdx))/vSquared_; }
+
+private:
+    Arg1 a_;
+    Arg2 b_;
+    ValueType value_;
+    ValueType vSquared_;
+};
+
+/*!
+ * \brief Node of an expression tree which represents the negation of an expression.
+ */
+template <class Arg>
+class NegationExpression : public Expression<NegationExpression<Arg> >
+{
+public:
+    typedef typename Arg::ValueType ValueType;
+
+    explicit NegationExpression(const Arg& a)
+        : a_(a)
+        , value_(-a.value())
+    {}
+
+    int size() const
+    { return a_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    ValueType derivative(int varIdx) const
+    { return -a_.derivative(varIdx); }
+
+private:
+    Arg a_;
+    ValueType value_;
+};
+
+/*!
+ * \brief Node of an expression tree which represents the sum of an expression and a
+ *        constant.
+ */
+template <class Arg>
+class ConstantSumExpression : public Expression<ConstantSumExpression<Arg> >
+{
+public:
+    typedef typename Arg::ValueType ValueType;
+
+    ConstantSumExpression(const Arg& a, const ValueType& c)
+        : a_(a)
+        , value_(a.value() + c)
+    {}
+
+    int size() const
+    { return a_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    ValueType derivative(int varIdx) const
+    { return a_.derivative(varIdx); }
+
+private:
+    Arg a_;
+    ValueType value_;
+};
+
+/*!
+ * \brief Node of an expression tree which represents the product of an expression and
+ *        a constant.
+ */
+template <class Arg>
+class ConstantProductExpression : public Expression<ConstantProductExpression<Arg> >
+{
+public:
+    typedef typename Arg::ValueType ValueType;
+
+    ConstantProductExpression(const Arg& a, const ValueType& c)
+        : a_(a)
+        , c_(c)
+        , value_(a.value()*c)
+    {}
+
+    int size() const
+    { return a_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    ValueType derivative(int varIdx) const
+    { return a_.derivative(varIdx)*c_; }
+
+private:
+    Arg a_;
+    ValueType c_;
+    ValueType value_;
+};
+
+/*!
+ * \brief Node of an expression tree which represents a constant divided by an
+ *        expression.
+ */
+template <class Arg>
+class ConstantQuotientExpression : public Expression<ConstantQuotientExpression<Arg> >
+{
+public:
+    typedef typename Arg::ValueType ValueType;
+
+    ConstantQuotientExpression(const ValueType& c, const Arg& a)
+        : a_(a)
+        , value_(c/a.value())
+        , factor_(-c/(a.value()*a.value()))
+    {}
+
+    int size() const
+    { return a_.size(); }
+
+    const ValueType& value() const
+    { return value_; }
+
+    // (c/v)' = -cv'/v^2
+    ValueType derivative(int varIdx) const
+    { return factor_*a_.derivative(varIdx); }
+
+private:
+    Arg a_;
+    ValueType value_;
+    ValueType factor_;
+};
+
+//! Maps the operands of the expression operators to expression nodes: Evaluation
+//! objects are wrapped by leafs, expressions are used as they are.
+template <class T, bool isEvaluation = IsEvaluation<T>::value>
+struct ExpressionOperand
+{
+    typedef T type;
+
+    static const T& get(const T& arg)
+    { return arg; }
+};
+
+template <class T>
+struct ExpressionOperand<T, /*isEvaluation=*/true>
+{
+    typedef EvaluationLeaf<T> type;
+
+    static type get(const T& arg)
+    { return type(arg); }
+};
+
+template <class T>
+using ExpressionOperandType = typename ExpressionOperand<T>::type;
+
+//! Enables the operators if both operands are either expressions or Evaluations and
+//! at least one of them is a lazy expression.
+template <class Arg1, class Arg2>
+using EnableIfExpressions =
+    typename std::enable_if<(IsLazyExpression<Arg1>::value || IsLazyExpression<Arg2>::value)
+                            && (IsExpression<Arg1>::value || IsEvaluation<Arg1>::value)
+                            && (IsExpression<Arg2>::value || IsEvaluation<Arg2>::value),
+                            int>::type;
+
+//! Enables the operators if the first argument is a lazy expression and the second one
+//! is a constant
+template <class Arg, class ConstantT>
+using EnableIfConstant =
+    typename std::enable_if<IsLazyExpression<Arg>::value
+                            && !IsExpression<ConstantT>::value
+                            && !IsEvaluation<ConstantT>::value,
+                            int>::type;
+
+template <class Arg1, class Arg2, EnableIfExpressions<Arg1, Arg2> = 0>
+SumExpression<ExpressionOperandType<Arg1>, ExpressionOperandType<Arg2> >
+operator+(const Arg1& a, const Arg2& b)
+{
+    return { ExpressionOperand<Arg1>::get(a), ExpressionOperand<Arg2>::get(b) };
+}
+
+template <class Arg1, class Arg2, EnableIfExpressions<Arg1, Arg2> = 0>
+DifferenceExpression<ExpressionOperandType<Arg1>, ExpressionOperandType<Arg2> >
+operator-(const Arg1& a, const Arg2& b)
+{
+    return { ExpressionOperand<Arg1>::get(a), ExpressionOperand<Arg2>::get(b) };
+}
+
+template <class Arg1, class Arg2, EnableIfExpressions<Arg1, Arg2> = 0>
+ProductExpression<ExpressionOperandType<Arg1>, ExpressionOperandType<Arg2> >
+operator*(const Arg1& a, const Arg2& b)
+{
+    return { ExpressionOperand<Arg1>::get(a), ExpressionOperand<Arg2>::get(b) };
+}
+
+template <class Arg1, class Arg2, EnableIfExpressions<Arg1, Arg2> = 0>
+QuotientExpression<ExpressionOperandType<Arg1>, ExpressionOperandType<Arg2> >
+operator/(const Arg1& a, const Arg2& b)
+{
+    return { ExpressionOperand<Arg1>::get(a), ExpressionOperand<Arg2>::get(b) };
+}
+
+template <class Arg, typename std::enable_if<IsLazyExpression<Arg>::value, int>::type = 0>
+NegationExpression<Arg> operator-(const Expression<Arg>& a)
+{ return NegationExpression<Arg>(a.asImp()); }
+
+template <class Arg, class ConstantT, EnableIfConstant<Arg, ConstantT> = 0>
+ConstantSumExpression<Arg> operator+(const Arg& a, const ConstantT& c)
+{ return ConstantSumExpression<Arg>(a, c); }
+
+template <class Arg, class ConstantT, EnableIfConstant<Arg, ConstantT> = 0>
+ConstantSumExpression<Arg> operator+(const ConstantT& c, const Arg& a)
+{ return ConstantSumExpression<Arg>(a, c); }
+
+template <class Arg, class ConstantT, EnableIfConstant<Arg, ConstantT> = 0>
+ConstantSumExpression<Arg> operator-(const Arg& a, const ConstantT& c)
+{ return ConstantSumExpression<Arg>(a, -c); }
+
+template <class Arg, class ConstantT, EnableIfConstant<Arg, ConstantT> = 0>
+ConstantSumExpression<NegationExpression<Arg> > operator-(const ConstantT& c, const Arg& a)
+{ return ConstantSumExpression<NegationExpression<Arg> >(NegationExpression<Arg>(a), c); }
+
+template <class Arg, class ConstantT, EnableIfConstant<Arg, ConstantT> = 0>
+ConstantProductExpression<Arg> operator*(const Arg& a, const ConstantT& c)
+{ return ConstantProductExpression<Arg>(a, c); }
+
+template <class Arg, class ConstantT, EnableIfConstant<Arg, ConstantT> = 0>
+ConstantProductExpression<Arg> operator*(const ConstantT& c, const Arg& a)
+{ return ConstantProductExpression<Arg>(a, c); }
+
+// like for Evaluations, divisions by constants are multiplications by the reciprocal
+template <class Arg, class ConstantT, EnableIfConstant<Arg, ConstantT> = 0>
+ConstantProductExpression<Arg> operator/(const Arg& a, const ConstantT& c)
+{ return ConstantProductExpression<Arg>(a, 1.0/c); }
+
+template <class Arg, class ConstantT, EnableIfConstant<Arg, ConstantT> = 0>
+ConstantQuotientExpression<Arg> operator/(const ConstantT& c, const Arg& a)
+{ return ConstantQuotientExpression<Arg>(c, a); }
+
+} // namespace DenseAd
+
+/*!
+ * \brief Marks an Evaluation as an operand of a lazily evaluated expression.
+ *
+ * See the documentation of the Expressions.hpp file for details.
+ */
+template <class ValueT, int numVars, unsigned staticSize>
+DenseAd::EvaluationLeaf<DenseAd::Evaluation<ValueT, numVars, staticSize> >
+lazy(const DenseAd::Evaluation<ValueT, numVars, staticSize>& eval)
+{ return DenseAd::EvaluationLeaf<DenseAd::Evaluation<ValueT, numVars, staticSize> >(eval); }
+
+//! For all other types, lazy() is the identity function.
+template <class T, typename std::enable_if<!DenseAd::IsEvaluation<T>::value, int>::type = 0>
+const T& lazy(const T& value)
+{ return value; }
+
+} // namespace Opm
+
+#endif // OPM_DENSEAD_EXPRESSIONS_HPP
@@ -33,6 +33,8 @@
 #define OPM_LOCAL_AD_MATH_HPP
 
 #include "Evaluation.hpp"
+#include "ValueOnlyMode.hpp"
+#include "OperationCounter.hpp"
 
 #include <opm/material/common/MathToolbox.hpp>
 
@@ -42,6 +44,26 @@ namespace DenseAd {
 template <class ValueT, int numVars, unsigned staticSize>
 class Evaluation;
 
+// set the derivatives of an evaluation to df_dx times their current values while
+// leaving its value alone. if 'result' is a copy of x, this applies the chain rule for
+// f(x). the scalar multiplication is used because it is the operation which is
+// vectorized by all Evaluation backends.
+template <class ValueType, int numVars, unsigned staticSize>
+void applyChainRule_(Evaluation<ValueType, numVars, staticSize>& result, const ValueType& df_dx)
+{
+    const ValueType value = result.value();
+    result *= df_dx;
+    result.setValue(value);
+}
+
+// record the call of a transcendental function for the operation counts (cf.
+// OperationCounter.hpp). the function's result is a temporary.
+inline void countFunctionCall_()
+{
+    countOperation(CountedOperation::transcendental);
+    countOperation(CountedOperation::temporary);
+}
+
 // provide some algebraic functions
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> abs(const Evaluation<ValueType, numVars, staticSize>& x)
@@ -96,6 +118,7 @@ Evaluation<ValueType, numVars, staticSize> max(const Evaluation<ValueType, numVa
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> tan(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
@@ -103,10 +126,12 @@ Evaluation<ValueType, numVars, staticSize> tan(const Evaluation<ValueType, numVa
     const ValueType& tmp = ValueTypeToolbox::tan(x.value());
     result.setValue(tmp);
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = 1 + tmp*tmp;
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -114,16 +139,19 @@ Evaluation<ValueType, numVars, staticSize> tan(const Evaluation<ValueType, numVa
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> atan(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::atan(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = 1/(1 + x.value()*x.value());
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -132,12 +160,16 @@ template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> atan2(const Evaluation<ValueType, numVars, staticSize>& x,
                                                  const Evaluation<ValueType, numVars, staticSize>& y)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::atan2(x.value(), y.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& alpha = 1/(1 + (x.value()*x.value())/(y.value()*y.value()));
     for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx) {
@@ -153,12 +185,16 @@ template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> atan2(const Evaluation<ValueType, numVars, staticSize>& x,
                                                  const ValueType& y)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::atan2(x.value(), y));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& alpha = 1/(1 + (x.value()*x.value())/(y*y));
     for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx) {
@@ -174,12 +210,16 @@ template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> atan2(const ValueType& x,
                                                  const Evaluation<ValueType, numVars, staticSize>& y)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(y);
 
     result.setValue(ValueTypeToolbox::atan2(x, y.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& alpha = 1/(1 + (x.value()*x.value())/(y.value()*y.value()));
     for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx) {
@@ -194,16 +234,19 @@ Evaluation<ValueType, numVars, staticSize> atan2(const ValueType& x,
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> sin(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::sin(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = ValueTypeToolbox::cos(x.value());
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -211,16 +254,19 @@ Evaluation<ValueType, numVars, staticSize> sin(const Evaluation<ValueType, numVa
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> asin(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::asin(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = 1.0/ValueTypeToolbox::sqrt(1 - x.value()*x.value());
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -228,16 +274,19 @@ Evaluation<ValueType, numVars, staticSize> asin(const Evaluation<ValueType, numV
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> sinh(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::sinh(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = ValueTypeToolbox::cosh(x.value());
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -245,16 +294,19 @@ Evaluation<ValueType, numVars, staticSize> sinh(const Evaluation<ValueType, numV
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> asinh(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::asinh(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = 1.0/ValueTypeToolbox::sqrt(x.value()*x.value() + 1);
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -262,16 +314,19 @@ Evaluation<ValueType, numVars, staticSize> asinh(const Evaluation<ValueType, num
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> cos(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::cos(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = -ValueTypeToolbox::sin(x.value());
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -279,16 +334,19 @@ Evaluation<ValueType, numVars, staticSize> cos(const Evaluation<ValueType, numVa
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> acos(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::acos(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = - 1.0/ValueTypeToolbox::sqrt(1 - x.value()*x.value());
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -296,16 +354,19 @@ Evaluation<ValueType, numVars, staticSize> acos(const Evaluation<ValueType, numV
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> cosh(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::cosh(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = ValueTypeToolbox::sinh(x.value());
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -313,16 +374,19 @@ Evaluation<ValueType, numVars, staticSize> cosh(const Evaluation<ValueType, numV
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> acosh(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::acosh(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = 1.0/ValueTypeToolbox::sqrt(x.value()*x.value() - 1);
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -330,6 +394,7 @@ Evaluation<ValueType, numVars, staticSize> acosh(const Evaluation<ValueType, num
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> sqrt(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
@@ -337,11 +402,12 @@ Evaluation<ValueType, numVars, staticSize> sqrt(const Evaluation<ValueType, numV
     const ValueType& sqrt_x = ValueTypeToolbox::sqrt(x.value());
     result.setValue(sqrt_x);
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     ValueType df_dx = 0.5/sqrt_x;
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx) {
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
-    }
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -349,16 +415,19 @@ Evaluation<ValueType, numVars, staticSize> sqrt(const Evaluation<ValueType, numV
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> exp(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     const ValueType& exp_x = ValueTypeToolbox::exp(x.value());
     result.setValue(exp_x);
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = exp_x;
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -368,6 +437,7 @@ template <class ValueType, int numVars, unsigned staticSize, class ExpType>
 Evaluation<ValueType, numVars, staticSize> pow(const Evaluation<ValueType, numVars, staticSize>& base,
                                                const ExpType& exp)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
     Evaluation<ValueType, numVars, staticSize> result(base);
 
@@ -380,10 +450,12 @@ Evaluation<ValueType, numVars, staticSize> pow(const Evaluation<ValueType, numVa
         result = 0.0;
     }
     else {
+        if (!derivativesEnabled())
+            return result;
+
         // derivatives use the chain rule
         const ValueType& df_dx = pow_x/base.value()*exp;
-        for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-            result.setDerivative(curVarIdx, df_dx*base.derivative(curVarIdx));
+        applyChainRule_(result, df_dx);
     }
 
     return result;
@@ -394,6 +466,7 @@ template <class BaseType, class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> pow(const BaseType& base,
                                                const Evaluation<ValueType, numVars, staticSize>& exp)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(exp);
@@ -407,10 +480,12 @@ Evaluation<ValueType, numVars, staticSize> pow(const BaseType& base,
         const ValueType& lnBase = ValueTypeToolbox::log(base);
         result.setValue(ValueTypeToolbox::exp(lnBase*exp.value()));
 
+        if (!derivativesEnabled())
+            return result;
+
         // derivatives use the chain rule
         const ValueType& df_dx = lnBase*result.value();
-        for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-            result.setDerivative(curVarIdx, df_dx*exp.derivative(curVarIdx));
+        applyChainRule_(result, df_dx);
     }
 
     return result;
@@ -422,6 +497,7 @@ template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> pow(const Evaluation<ValueType, numVars, staticSize>& base,
                                                const Evaluation<ValueType, numVars, staticSize>& exp)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(base);
@@ -433,18 +509,22 @@ Evaluation<ValueType, numVars, staticSize> pow(const Evaluation<ValueType, numVa
     }
     else {
         ValueType valuePow = ValueTypeToolbox::pow(base.value(), exp.value());
-        result.setValue(valuePow);
+        if (!derivativesEnabled()) {
+            result.setValue(valuePow);
+            return result;
+        }
 
         // use the chain rule for the derivatives. since both, the base and the exponent can
-        // potentially depend on the variable set, calculating these is quite elaborate...
+        // potentially depend on the variable set, calculating these is quite elaborate:
+        // (f^g)' = (g*f'/f + log(f)*g') * f^g
         const ValueType& f = base.value();
         const ValueType& g = exp.value();
         const ValueType& logF = ValueTypeToolbox::log(f);
-        for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx) {
-            const ValueType& fPrime = base.derivative(curVarIdx);
-            const ValueType& gPrime = exp.derivative(curVarIdx);
-            result.setDerivative(curVarIdx, (g*fPrime/f + logF*gPrime) * valuePow);
-        }
+        Evaluation<ValueType, numVars, staticSize> expTerm(exp);
+        expTerm *= logF*valuePow;
+        result *= g/f*valuePow;
+        result += expTerm;
+        result.setValue(valuePow);
     }
 
     return result;
@@ -453,16 +533,19 @@ Evaluation<ValueType, numVars, staticSize> pow(const Evaluation<ValueType, numVa
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> log(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::log(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = 1/x.value();
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -471,16 +554,19 @@ Evaluation<ValueType, numVars, staticSize> log(const Evaluation<ValueType, numVa
 template <class ValueType, int numVars, unsigned staticSize>
 Evaluation<ValueType, numVars, staticSize> log10(const Evaluation<ValueType, numVars, staticSize>& x)
 {
+    countFunctionCall_();
     typedef MathToolbox<ValueType> ValueTypeToolbox;
 
     Evaluation<ValueType, numVars, staticSize> result(x);
 
     result.setValue(ValueTypeToolbox::log10(x.value()));
 
+    if (!derivativesEnabled())
+        return result;
+
     // derivatives use the chain rule
     const ValueType& df_dx = 1/x.value() * ValueTypeToolbox::log10(ValueTypeToolbox::exp(1.0));
-    for (int curVarIdx = 0; curVarIdx < result.size(); ++curVarIdx)
-        result.setDerivative(curVarIdx, df_dx*x.derivative(curVarIdx));
+    applyChainRule_(result, df_dx);
 
     return result;
 }
@@ -0,0 +1,557 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief A variant of the dense-AD Evaluation class which stores the derivatives
+ *        with a lower precision than the value.
+ *
+ * If the derivatives are only used to assemble the Jacobian matrix of a Newton
+ * scheme, their precision mostly affects the convergence rate and not the result.
+ * Storing them as float halves the memory footprint of objects which are cached
+ * per degree of freedom, like the fluid states of the intensive quantities.
+ *
+ * The value is always computed using the full precision. The operations on the
+ * derivatives are carried out using the precision of the derivatives, i.e., the
+ * factors of the chain rule are rounded once per operation.
+ *
+ * MixedPrecisionEvaluation objects implicitly convert to the full precision
+ * Evaluation class of the same size, and mixed arithmetic operations yield full
+ * precision results.
+ */
+#ifndef OPM_DENSEAD_MIXED_PRECISION_EVALUATION_HPP
+#define OPM_DENSEAD_MIXED_PRECISION_EVALUATION_HPP
+
+#include "Evaluation.hpp"
+#include "Math.hpp"
+#include "Expressions.hpp"
+#include "EvaluationToolbox.hpp"
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Valgrind.hpp>
+
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <type_traits>
+
+namespace Opm {
+namespace DenseAd {
+
+/*!
+ * \brief Represents a function evaluation and its derivatives w.r.t. a fixed set of
+ *        variables, where the derivatives are stored using a lower precision.
+ *
+ * MixedPrecisionEvaluation is a node of the expression trees of Expressions.hpp. This
+ * is what allows to assign it to and to construct full precision Evaluations from it.
+ */
+template <class ValueT, int numDerivs, class DerivativeT = float>
+class MixedPrecisionEvaluation
+    : public Expression<MixedPrecisionEvaluation<ValueT, numDerivs, DerivativeT> >
+{
+    static_assert(numDerivs > 0,
+                  "MixedPrecisionEvaluation requires a positive, compile-time number of derivatives");
+
+    template <class T>
+    using EnableIfScalar_ =
+        typename std::enable_if<std::is_convertible<T, ValueT>::value, int>::type;
+
+public:
+    //! the number of derivatives
+    static const int numVars = numDerivs;
+
+    //! field type
+    typedef ValueT ValueType;
+
+    //! type of the derivatives
+    typedef DerivativeT DerivativeType;
+
+    //! the full precision Evaluation type of the same size
+    typedef Evaluation<ValueT, numDerivs> FullEvaluation;
+
+    //! number of derivatives
+    constexpr int size() const
+    { return numDerivs; }
+
+protected:
+    //! instruct valgrind to check that the value and all derivatives of the
+    //! Evaluation object are well-defined.
+    void checkDefined_() const
+    {
+#ifndef NDEBUG
+        Valgrind::CheckDefined(value_);
+        for (const auto& v : derivatives_)
+            Valgrind::CheckDefined(v);
+#endif
+    }
+
+public:
+    //! default constructor
+    MixedPrecisionEvaluation() : derivatives_(), value_()
+    {}
+
+    //! copy other function evaluation
+    MixedPrecisionEvaluation(const MixedPrecisionEvaluation& other) = default;
+
+    // create an evaluation which represents a constant function
+    //
+    // i.e., f(x) = c. this implies an evaluation with the given value and all
+    // derivatives being zero.
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation(const RhsValueType& c)
+        : derivatives_(), value_(c)
+    {}
+
+    // create an evaluation of a "naked" depending variable (i.e., f(x) = x)
+    template <class RhsValueType>
+    MixedPrecisionEvaluation(const RhsValueType& c, int varPos)
+        : derivatives_(), value_(c)
+    {
+        // The variable position must be in represented by the given variable descriptor
+        assert(0 <= varPos && varPos < size());
+
+        derivatives_[varPos] = 1.0;
+
+        checkDefined_();
+    }
+
+    // round the derivatives of a full precision evaluation
+    explicit MixedPrecisionEvaluation(const FullEvaluation& full)
+        : value_(full.value())
+    {
+        for (int i = 0; i < numDerivs; ++i)
+            derivatives_[i] = static_cast<DerivativeT>(full.derivative(i));
+
+        checkDefined_();
+    }
+
+    // create a function evaluation for a "naked" depending variable (i.e., f(x) = x)
+    template <class RhsValueType>
+    static MixedPrecisionEvaluation createVariable(const RhsValueType& value, int varPos)
+    { return MixedPrecisionEvaluation(value, varPos); }
+
+    template <class RhsValueType>
+    static MixedPrecisionEvaluation createVariable(const MixedPrecisionEvaluation&,
+                                                   const RhsValueType& value,
+                                                   int varPos)
+    { return MixedPrecisionEvaluation(value, varPos); }
+
+    // "evaluate" a constant function (i.e. a function that does not depend on the set of
+    // relevant variables, f(x) = c).
+    template <class RhsValueType>
+    static MixedPrecisionEvaluation createConstant(const RhsValueType& value)
+    { return MixedPrecisionEvaluation(value); }
+
+    template <class RhsValueType>
+    static MixedPrecisionEvaluation createConstant(const MixedPrecisionEvaluation&,
+                                                   const RhsValueType& value)
+    { return MixedPrecisionEvaluation(value); }
+
+    static MixedPrecisionEvaluation createBlank(const MixedPrecisionEvaluation&)
+    { return MixedPrecisionEvaluation(); }
+
+    static MixedPrecisionEvaluation createConstantZero(const MixedPrecisionEvaluation&)
+    { return MixedPrecisionEvaluation(0.); }
+
+    static MixedPrecisionEvaluation createConstantOne(const MixedPrecisionEvaluation&)
+    { return MixedPrecisionEvaluation(1.); }
+
+    // set all derivatives to zero
+    void clearDerivatives()
+    {
+        for (auto& d : derivatives_)
+            d = 0.0;
+    }
+
+    // print the value and the derivatives of the function evaluation
+    void print(std::ostream& os = std::cout) const
+    {
+        // print value
+        os << "v: " << value() << " / d:";
+
+        // print derivatives
+        for (int varIdx = 0; varIdx < size(); ++varIdx)
+            os << " " << derivative(varIdx);
+    }
+
+    // convert the object to a full precision Evaluation. since
+    // MixedPrecisionEvaluation is an expression, this can also be done implicitly.
+    FullEvaluation toFull() const
+    { return FullEvaluation(*this); }
+
+    MixedPrecisionEvaluation& operator+=(const MixedPrecisionEvaluation& other)
+    {
+        value_ += other.value_;
+        for (int i = 0; i < numDerivs; ++i)
+            derivatives_[i] += other.derivatives_[i];
+
+        return *this;
+    }
+
+    // add value from other to this values
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation& operator+=(const RhsValueType& other)
+    {
+        // value is added, derivatives stay the same
+        value_ += other;
+
+        return *this;
+    }
+
+    MixedPrecisionEvaluation& operator-=(const MixedPrecisionEvaluation& other)
+    {
+        value_ -= other.value_;
+        for (int i = 0; i < numDerivs; ++i)
+            derivatives_[i] -= other.derivatives_[i];
+
+        return *this;
+    }
+
+    // subtract other's value from this values
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation& operator-=(const RhsValueType& other)
+    {
+        // for constants, values are subtracted, derivatives stay the same
+        value_ -= other;
+
+        return *this;
+    }
+
+    // multiply values and apply chain rule to derivatives: (u*v)' = (v'u + u'v)
+    MixedPrecisionEvaluation& operator*=(const MixedPrecisionEvaluation& other)
+    {
+        const DerivativeT u = static_cast<DerivativeT>(value_);
+        const DerivativeT v = static_cast<DerivativeT>(other.value_);
+
+        value_ *= other.value_;
+        for (int i = 0; i < numDerivs; ++i)
+            derivatives_[i] = derivatives_[i]*v + other.derivatives_[i]*u;
+
+        return *this;
+    }
+
+    // m(c*u)' = c*u'
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation& operator*=(const RhsValueType& other)
+    {
+        const DerivativeT c = static_cast<DerivativeT>(other);
+
+        value_ *= other;
+        for (auto& d : derivatives_)
+            d *= c;
+
+        return *this;
+    }
+
+    // m(u*v)' = (vu' - uv')/v^2 = (u' - (u/v)*v')/v
+    MixedPrecisionEvaluation& operator/=(const MixedPrecisionEvaluation& other)
+    {
+        const ValueType vInv = 1.0/other.value_;
+
+        value_ *= vInv;
+        const DerivativeT u_v = static_cast<DerivativeT>(value_);
+        const DerivativeT vInvD = static_cast<DerivativeT>(vInv);
+        for (int i = 0; i < numDerivs; ++i)
+            derivatives_[i] = (derivatives_[i] - u_v*other.derivatives_[i])*vInvD;
+
+        return *this;
+    }
+
+    // divide value and derivatives by value of other
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation& operator/=(const RhsValueType& other)
+    {
+        const ValueType tmp = 1.0/other;
+
+        return (*this) *= tmp;
+    }
+
+    MixedPrecisionEvaluation operator+(const MixedPrecisionEvaluation& other) const
+    {
+        MixedPrecisionEvaluation result(*this);
+        result += other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation operator+(const RhsValueType& other) const
+    {
+        MixedPrecisionEvaluation result(*this);
+        result += other;
+        return result;
+    }
+
+    MixedPrecisionEvaluation operator-(const MixedPrecisionEvaluation& other) const
+    {
+        MixedPrecisionEvaluation result(*this);
+        result -= other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation operator-(const RhsValueType& other) const
+    {
+        MixedPrecisionEvaluation result(*this);
+        result -= other;
+        return result;
+    }
+
+    // negation (unary minus) operator
+    MixedPrecisionEvaluation operator-() const
+    {
+        MixedPrecisionEvaluation result;
+        result.value_ = -value_;
+        for (int i = 0; i < numDerivs; ++i)
+            result.derivatives_[i] = -derivatives_[i];
+        return result;
+    }
+
+    MixedPrecisionEvaluation operator*(const MixedPrecisionEvaluation& other) const
+    {
+        MixedPrecisionEvaluation result(*this);
+        result *= other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation operator*(const RhsValueType& other) const
+    {
+        MixedPrecisionEvaluation result(*this);
+        result *= other;
+        return result;
+    }
+
+    MixedPrecisionEvaluation operator/(const MixedPrecisionEvaluation& other) const
+    {
+        MixedPrecisionEvaluation result(*this);
+        result /= other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation operator/(const RhsValueType& other) const
+    {
+        MixedPrecisionEvaluation result(*this);
+        result /= other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    MixedPrecisionEvaluation& operator=(const RhsValueType& other)
+    {
+        value_ = other;
+        clearDerivatives();
+
+        return *this;
+    }
+
+    // copy assignment from evaluation
+    MixedPrecisionEvaluation& operator=(const MixedPrecisionEvaluation& other) = default;
+
+    // operators for constants on the left hand side
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend MixedPrecisionEvaluation operator+(const LhsValueType& a, const MixedPrecisionEvaluation& b)
+    { return b + a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend MixedPrecisionEvaluation operator-(const LhsValueType& a, const MixedPrecisionEvaluation& b)
+    { return -(b - a); }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend MixedPrecisionEvaluation operator*(const LhsValueType& a, const MixedPrecisionEvaluation& b)
+    { return b*a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend MixedPrecisionEvaluation operator/(const LhsValueType& a, const MixedPrecisionEvaluation& b)
+    {
+        // (c/v)' = -c*v'/v^2
+        MixedPrecisionEvaluation result(b);
+        result *= -a/(b.value_*b.value_);
+        result.value_ = a/b.value_;
+        return result;
+    }
+
+    // operators which involve full precision Evaluations. these are computed using
+    // the full precision and they produce full precision results.
+    friend FullEvaluation& operator+=(FullEvaluation& a, const MixedPrecisionEvaluation& b)
+    { return a += b.toFull(); }
+
+    friend FullEvaluation& operator-=(FullEvaluation& a, const MixedPrecisionEvaluation& b)
+    { return a -= b.toFull(); }
+
+    friend FullEvaluation& operator*=(FullEvaluation& a, const MixedPrecisionEvaluation& b)
+    { return a *= b.toFull(); }
+
+    friend FullEvaluation& operator/=(FullEvaluation& a, const MixedPrecisionEvaluation& b)
+    { return a /= b.toFull(); }
+
+    friend FullEvaluation operator+(const FullEvaluation& a, const MixedPrecisionEvaluation& b)
+    { return a + b.toFull(); }
+
+    friend FullEvaluation operator+(const MixedPrecisionEvaluation& a, const FullEvaluation& b)
+    { return a.toFull() + b; }
+
+    friend FullEvaluation operator-(const FullEvaluation& a, const MixedPrecisionEvaluation& b)
+    { return a - b.toFull(); }
+
+    friend FullEvaluation operator-(const MixedPrecisionEvaluation& a, const FullEvaluation& b)
+    { return a.toFull() - b; }
+
+    friend FullEvaluation operator*(const FullEvaluation& a, const MixedPrecisionEvaluation& b)
+    { return a*b.toFull(); }
+
+    friend FullEvaluation operator*(const MixedPrecisionEvaluation& a, const FullEvaluation& b)
+    { return a.toFull()*b; }
+
+    friend FullEvaluation operator/(const FullEvaluation& a, const MixedPrecisionEvaluation& b)
+    { return a/b.toFull(); }
+
+    friend FullEvaluation operator/(const MixedPrecisionEvaluation& a, const FullEvaluation& b)
+    { return a.toFull()/b; }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator==(const RhsValueType& other) const
+    { return value() == other; }
+
+    bool operator==(const MixedPrecisionEvaluation& other) const
+    {
+        if (value_ != other.value_)
+            return false;
+
+        for (int idx = 0; idx < size(); ++idx) {
+            if (derivatives_[idx] != other.derivatives_[idx])
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const MixedPrecisionEvaluation& other) const
+    { return !operator==(other); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator!=(const RhsValueType& other) const
+    { return !operator==(other); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator>(RhsValueType other) const
+    { return value() > other; }
+
+    bool operator>(const MixedPrecisionEvaluation& other) const
+    { return value() > other.value(); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator<(RhsValueType other) const
+    { return value() < other; }
+
+    bool operator<(const MixedPrecisionEvaluation& other) const
+    { return value() < other.value(); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator>=(RhsValueType other) const
+    { return value() >= other; }
+
+    bool operator>=(const MixedPrecisionEvaluation& other) const
+    { return value() >= other.value(); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator<=(RhsValueType other) const
+    { return value() <= other; }
+
+    bool operator<=(const MixedPrecisionEvaluation& other) const
+    { return value() <= other.value(); }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend bool operator<(const LhsValueType& a, const MixedPrecisionEvaluation& b)
+    { return b > a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend bool operator>(const LhsValueType& a, const MixedPrecisionEvaluation& b)
+    { return b < a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend bool operator<=(const LhsValueType& a, const MixedPrecisionEvaluation& b)
+    { return b >= a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend bool operator>=(const LhsValueType& a, const MixedPrecisionEvaluation& b)
+    { return b <= a; }
+
+    // return value of variable
+    const ValueType& value() const
+    { return value_; }
+
+    // set value of variable
+    template <class RhsValueType>
+    void setValue(const RhsValueType& val)
+    { value_ = val; }
+
+    // return varIdx'th derivative
+    const DerivativeType& derivative(int varIdx) const
+    {
+        assert(0 <= varIdx && varIdx < size());
+
+        return derivatives_[varIdx];
+    }
+
+    // set derivative at position varIdx
+    template <class RhsValueType>
+    void setDerivative(int varIdx, const RhsValueType& derVal)
+    {
+        assert(0 <= varIdx && varIdx < size());
+
+        derivatives_[varIdx] = static_cast<DerivativeT>(derVal);
+    }
+
+private:
+    std::array<DerivativeT, numDerivs> derivatives_;
+    ValueT value_;
+};
+
+// mixed precision evaluations are expressions, but they provide their own
+// arithmetic operators
+template <class ValueT, int numDerivs, class DerivativeT>
+struct IsLazyExpression<MixedPrecisionEvaluation<ValueT, numDerivs, DerivativeT> >
+    : public std::false_type
+{};
+
+template <class ValueType, int numVars, class DerivType>
+std::ostream& operator<<(std::ostream& os,
+                         const MixedPrecisionEvaluation<ValueType, numVars, DerivType>& eval)
+{
+    os << eval.value();
+    return os;
+}
+
+} // namespace DenseAd
+
+// the mathematical functions for mixed precision evaluations. the value is computed
+// using the full precision, the derivatives are scaled by the rounded derivative of
+// the function.
+template <class ValueT, int numVars, class DerivativeT>
+struct MathToolbox<DenseAd::MixedPrecisionEvaluation<ValueT, numVars, DerivativeT> >
+    : public DenseAd::EvaluationToolbox<DenseAd::MixedPrecisionEvaluation<ValueT, numVars, DerivativeT> >
+{};
+
+} // namespace Opm
+
+#endif // OPM_DENSEAD_MIXED_PRECISION_EVALUATION_HPP
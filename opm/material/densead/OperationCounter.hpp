@@ -0,0 +1,244 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Compile-time instrumentation which counts the operations performed by the
+ *        dense-AD Evaluation classes.
+ *
+ * If OPM_DENSEAD_COUNT_OPERATIONS is enabled, the arithmetic operators of
+ * DenseAd::Evaluation and the functions of Math.hpp record the number of
+ * multiplications, divisions, transcendental function calls and temporary
+ * Evaluation objects that they create. The counts are attributed to the innermost
+ * scope tag that is active on the current thread. Tags are set using the
+ * OPM_DENSEAD_COUNT_SCOPE() macro, e.g.
+ *
+ * \code
+ * OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::density");
+ * \endcode
+ *
+ * Operations which happen outside of any tagged scope are attributed to the
+ * "(untagged)" entry. The counts are kept per thread and can be printed using
+ * printOperationCounts().
+ *
+ * If OPM_DENSEAD_COUNT_OPERATIONS is disabled (the default), the counting functions
+ * are empty, OPM_DENSEAD_COUNT_SCOPE() expands to nothing and OperationCountScope
+ * does nothing.
+ */
+#ifndef OPM_DENSEAD_OPERATION_COUNTER_HPP
+#define OPM_DENSEAD_OPERATION_COUNTER_HPP
+
+#ifndef OPM_DENSEAD_COUNT_OPERATIONS
+#define OPM_DENSEAD_COUNT_OPERATIONS 0
+#endif
+
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace Opm {
+namespace DenseAd {
+
+/*!
+ * \brief The kinds of operations which are counted.
+ */
+enum class CountedOperation {
+    multiplication,
+    division,
+    transcendental,
+    temporary
+};
+
+/*!
+ * \brief The operation counts of a tagged scope.
+ */
+struct OperationCounts
+{
+    //! The number of times the scope was entered
+    std::uint64_t calls = 0;
+    std::uint64_t multiplications = 0;
+    std::uint64_t divisions = 0;
+    std::uint64_t transcendentals = 0;
+    std::uint64_t temporaries = 0;
+};
+
+//! The tag of the operations which happen outside of any tagged scope
+inline constexpr const char* untaggedOperationsName = "(untagged)";
+
+#if OPM_DENSEAD_COUNT_OPERATIONS
+namespace OperationCounterDetail {
+struct ThreadData
+{
+    ThreadData()
+        : current(&countsPerTag[untaggedOperationsName])
+    {}
+
+    // std::map does not invalidate references on insertion, so the scopes can keep
+    // pointers to their entries
+    std::map<std::string, OperationCounts> countsPerTag;
+    OperationCounts* current;
+};
+
+inline ThreadData& threadData()
+{
+    static thread_local ThreadData data;
+    return data;
+}
+} // namespace OperationCounterDetail
+
+/*!
+ * \brief Records that an operation has been performed n times.
+ */
+inline void countOperation(CountedOperation op, std::uint64_t n = 1)
+{
+    OperationCounts& counts = *OperationCounterDetail::threadData().current;
+    switch (op) {
+    case CountedOperation::multiplication:
+        counts.multiplications += n;
+        break;
+    case CountedOperation::division:
+        counts.divisions += n;
+        break;
+    case CountedOperation::transcendental:
+        counts.transcendentals += n;
+        break;
+    case CountedOperation::temporary:
+        counts.temporaries += n;
+        break;
+    }
+}
+#else
+/*!
+ * \brief Records that an operation has been performed n times.
+ */
+constexpr void countOperation(CountedOperation, std::uint64_t = 1)
+{ }
+#endif
+
+/*!
+ * \brief Attributes the operations on the current thread to a tag for the lifetime
+ *        of the object.
+ *
+ * Scopes can be nested. The operations are only attributed to the innermost
+ * scope, i.e., the counts of a tag do not include the ones of the tagged scopes
+ * which are entered from within it.
+ */
+class OperationCountScope
+{
+public:
+    explicit OperationCountScope([[maybe_unused]] const char* tag)
+    {
+#if OPM_DENSEAD_COUNT_OPERATIONS
+        auto& data = OperationCounterDetail::threadData();
+        previous_ = data.current;
+        data.current = &data.countsPerTag[tag];
+        ++ data.current->calls;
+#endif
+    }
+
+    ~OperationCountScope()
+    {
+#if OPM_DENSEAD_COUNT_OPERATIONS
+        OperationCounterDetail::threadData().current = previous_;
+#endif
+    }
+
+    OperationCountScope(const OperationCountScope&) = delete;
+    OperationCountScope& operator=(const OperationCountScope&) = delete;
+
+private:
+#if OPM_DENSEAD_COUNT_OPERATIONS
+    OperationCounts* previous_;
+#endif
+};
+
+/*!
+ * \brief Returns the operation counts of the current thread per tag.
+ *
+ * If OPM_DENSEAD_COUNT_OPERATIONS is disabled, the result is empty.
+ */
+inline std::map<std::string, OperationCounts> operationCounts()
+{
+#if OPM_DENSEAD_COUNT_OPERATIONS
+    return OperationCounterDetail::threadData().countsPerTag;
+#else
+    return {};
+#endif
+}
+
+/*!
+ * \brief Sets all operation counts of the current thread to zero.
+ */
+inline void resetOperationCounts()
+{
+#if OPM_DENSEAD_COUNT_OPERATIONS
+    // the entries themselves are kept because active scopes point to them
+    for (auto& tagAndCounts : OperationCounterDetail::threadData().countsPerTag)
+        tagAndCounts.second = OperationCounts{};
+#endif
+}
+
+/*!
+ * \brief Prints a table of the operation counts of the current thread.
+ */
+inline void printOperationCounts(std::ostream& os)
+{
+    os << std::left << std::setw(50) << "tag" << std::right
+       << std::setw(10) << "calls"
+       << std::setw(14) << "mul"
+       << std::setw(14) << "div"
+       << std::setw(14) << "transc"
+       << std::setw(14) << "temporaries" << "\n";
+    for (const auto& [tag, counts] : operationCounts()) {
+        if (counts.calls == 0 && counts.multiplications == 0 && counts.divisions == 0
+            && counts.transcendentals == 0 && counts.temporaries == 0)
+            continue;
+
+        os << std::left << std::setw(50) << tag << std::right
+           << std::setw(10) << counts.calls
+           << std::setw(14) << counts.multiplications
+           << std::setw(14) << counts.divisions
+           << std::setw(14) << counts.transcendentals
+           << std::setw(14) << counts.temporaries << "\n";
+    }
+}
+
+} // namespace DenseAd
+} // namespace Opm
+
+/*!
+ * \brief Attributes the Evaluation operations until the end of the enclosing block
+ *        to a tag.
+ *
+ * This expands to nothing unless OPM_DENSEAD_COUNT_OPERATIONS is enabled.
+ */
+#if OPM_DENSEAD_COUNT_OPERATIONS
+#define OPM_DENSEAD_COUNT_SCOPE(tag)                                      \
+    ::Opm::DenseAd::OperationCountScope opmDenseAdOperationCountScope_(tag)
+#else
+#define OPM_DENSEAD_COUNT_SCOPE(tag)
+#endif
+
+#endif // OPM_DENSEAD_OPERATION_COUNTER_HPP
@@ -0,0 +1,636 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief A variant of the dense-AD Evaluation class which skips derivatives that are
+ *        structurally zero.
+ *
+ * Many quantities only depend on one or two of the primary variables, e.g. the
+ * saturated gas dissolution factor only depends on pressure and the energy storage of
+ * the rock only on temperature. SparseEvaluation splits the derivatives into blocks of
+ * the size of a SIMD register and keeps a bit mask of the blocks which may contain
+ * non-zero entries. All derivatives of the remaining blocks are zero and they are
+ * skipped by the arithmetic operations and the mathematical functions. Since this
+ * makes the cost of these operations proportional to the number of non-zero blocks
+ * instead of the number of derivatives, this pays off for models with many
+ * derivatives.
+ *
+ * SparseEvaluation objects can be mixed with the dense Evaluation class of the same
+ * size: They implicitly convert to dense Evaluations, and mixed arithmetic operations
+ * yield dense results.
+ */
+#ifndef OPM_DENSEAD_SPARSE_EVALUATION_HPP
+#define OPM_DENSEAD_SPARSE_EVALUATION_HPP
+
+#include "Evaluation.hpp"
+#include "Math.hpp"
+#include "Expressions.hpp"
+#include "EvaluationToolbox.hpp"
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Valgrind.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <type_traits>
+
+namespace Opm {
+namespace DenseAd {
+
+/*!
+ * \brief Represents a function evaluation and its derivatives w.r.t. a fixed set of
+ *        variables, where only some blocks of the derivatives can be non-zero.
+ *
+ * SparseEvaluation is a node of the expression trees of Expressions.hpp. This is what
+ * allows to assign it to and to construct dense Evaluations from it.
+ */
+template <class ValueT, int numDerivs>
+class SparseEvaluation : public Expression<SparseEvaluation<ValueT, numDerivs> >
+{
+    static_assert(numDerivs > 0,
+                  "SparseEvaluation requires a positive, compile-time number of derivatives");
+
+    template <class T>
+    using EnableIfScalar_ =
+        typename std::enable_if<std::is_convertible<T, ValueT>::value, int>::type;
+
+    // the blocks are as large as an SSE register. this is the granularity of the
+    // copies of the derivatives by the compiler, so the blocks can be written
+    // individually without causing store forwarding stalls.
+    static constexpr int blockSize_ = (sizeof(ValueT) < 16) ? 16/sizeof(ValueT) : 1;
+    static constexpr int numBlocks_ = (numDerivs + blockSize_ - 1)/blockSize_;
+    static_assert(numBlocks_ <= 32, "Too many derivatives for the mask of non-zero blocks");
+
+public:
+    //! the number of derivatives
+    static const int numVars = numDerivs;
+
+    //! field type
+    typedef ValueT ValueType;
+
+    //! the dense Evaluation type of the same size
+    typedef Evaluation<ValueT, numDerivs> DenseEvaluation;
+
+    //! number of derivatives
+    constexpr int size() const
+    { return numDerivs; }
+
+protected:
+    //! instruct valgrind to check that the value and all derivatives of the
+    //! Evaluation object are well-defined.
+    void checkDefined_() const
+    {
+#ifndef NDEBUG
+        Valgrind::CheckDefined(value_);
+        Valgrind::CheckDefined(mask_);
+        for (const auto& v : derivatives_)
+            Valgrind::CheckDefined(v);
+#endif
+    }
+
+    static constexpr unsigned blockBit_(int blockIdx)
+    { return 1u << blockIdx; }
+
+    //! returns the pointer to the first derivative of a block
+    ValueT* block_(int blockIdx)
+    { return derivatives_.data() + blockIdx*blockSize_; }
+
+    const ValueT* block_(int blockIdx) const
+    { return derivatives_.data() + blockIdx*blockSize_; }
+
+    //! call fn(blockIdx) for all blocks of the given mask
+    template <class Fn>
+    static void forEachBlock_(unsigned mask, Fn fn)
+    {
+        for (int blockIdx = 0; blockIdx < numBlocks_; ++blockIdx)
+            if (mask & blockBit_(blockIdx))
+                fn(blockIdx);
+    }
+
+public:
+    //! default constructor
+    SparseEvaluation() : derivatives_(), value_(), mask_(0)
+    {}
+
+    //! copy other function evaluation
+    SparseEvaluation(const SparseEvaluation& other) = default;
+
+    // create an evaluation which represents a constant function
+    //
+    // i.e., f(x) = c. this implies an evaluation with the given value and all
+    // derivatives being zero.
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation(const RhsValueType& c)
+        : derivatives_(), value_(c), mask_(0)
+    {}
+
+    // create an evaluation of a "naked" depending variable (i.e., f(x) = x)
+    template <class RhsValueType>
+    SparseEvaluation(const RhsValueType& c, int varPos)
+        : derivatives_(), value_(c), mask_(blockBit_(varPos/blockSize_))
+    {
+        // The variable position must be in represented by the given variable descriptor
+        assert(0 <= varPos && varPos < size());
+
+        derivatives_[varPos] = 1.0;
+
+        checkDefined_();
+    }
+
+    // convert a dense evaluation. only the blocks of non-zero derivatives are marked.
+    explicit SparseEvaluation(const DenseEvaluation& dense)
+        : derivatives_(), value_(dense.value()), mask_(0)
+    {
+        for (int i = 0; i < numDerivs; ++i) {
+            derivatives_[i] = dense.derivative(i);
+            if (derivatives_[i] != 0.0)
+                mask_ |= blockBit_(i/blockSize_);
+        }
+
+        checkDefined_();
+    }
+
+    // create a function evaluation for a "naked" depending variable (i.e., f(x) = x)
+    template <class RhsValueType>
+    static SparseEvaluation createVariable(const RhsValueType& value, int varPos)
+    { return SparseEvaluation(value, varPos); }
+
+    template <class RhsValueType>
+    static SparseEvaluation createVariable(const SparseEvaluation&, const RhsValueType& value, int varPos)
+    { return SparseEvaluation(value, varPos); }
+
+    // "evaluate" a constant function (i.e. a function that does not depend on the set of
+    // relevant variables, f(x) = c).
+    template <class RhsValueType>
+    static SparseEvaluation createConstant(const RhsValueType& value)
+    { return SparseEvaluation(value); }
+
+    template <class RhsValueType>
+    static SparseEvaluation createConstant(const SparseEvaluation&, const RhsValueType& value)
+    { return SparseEvaluation(value); }
+
+    static SparseEvaluation createBlank(const SparseEvaluation&)
+    { return SparseEvaluation(); }
+
+    static SparseEvaluation createConstantZero(const SparseEvaluation&)
+    { return SparseEvaluation(0.); }
+
+    static SparseEvaluation createConstantOne(const SparseEvaluation&)
+    { return SparseEvaluation(1.); }
+
+    // set all derivatives to zero
+    void clearDerivatives()
+    {
+        forEachBlock_(mask_, [this](int b) {
+            for (int i = 0; i < blockSize_; ++i)
+                block_(b)[i] = 0.0;
+        });
+        mask_ = 0;
+    }
+
+    // print the value and the derivatives of the function evaluation
+    void print(std::ostream& os = std::cout) const
+    {
+        // print value
+        os << "v: " << value() << " / d:";
+
+        // print derivatives
+        for (int varIdx = 0; varIdx < size(); ++varIdx)
+            os << " " << derivative(varIdx);
+    }
+
+    // returns false if the varIdx'th derivative is structurally zero
+    bool mayBeNonZero(int varIdx) const
+    { return mask_ & blockBit_(varIdx/blockSize_); }
+
+    // convert the object to a dense Evaluation. since SparseEvaluation is an
+    // expression, this can also be done implicitly.
+    DenseEvaluation toDense() const
+    { return DenseEvaluation(*this); }
+
+    SparseEvaluation& operator+=(const SparseEvaluation& other)
+    {
+        value_ += other.value_;
+
+        forEachBlock_(other.mask_, [&](int b) {
+            for (int i = 0; i < blockSize_; ++i)
+                block_(b)[i] += other.block_(b)[i];
+        });
+        mask_ |= other.mask_;
+
+        return *this;
+    }
+
+    // add value from other to this values
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation& operator+=(const RhsValueType& other)
+    {
+        // value is added, derivatives stay the same
+        value_ += other;
+
+        return *this;
+    }
+
+    SparseEvaluation& operator-=(const SparseEvaluation& other)
+    {
+        value_ -= other.value_;
+
+        forEachBlock_(other.mask_, [&](int b) {
+            for (int i = 0; i < blockSize_; ++i)
+                block_(b)[i] -= other.block_(b)[i];
+        });
+        mask_ |= other.mask_;
+
+        return *this;
+    }
+
+    // subtract other's value from this values
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation& operator-=(const RhsValueType& other)
+    {
+        // for constants, values are subtracted, derivatives stay the same
+        value_ -= other;
+
+        return *this;
+    }
+
+    // multiply values and apply chain rule to derivatives: (u*v)' = (v'u + u'v)
+    SparseEvaluation& operator*=(const SparseEvaluation& other)
+    {
+        const ValueType u = value_;
+        const ValueType v = other.value_;
+
+        value_ *= v;
+        forEachBlock_(mask_, [&](int b) {
+            for (int i = 0; i < blockSize_; ++i)
+                block_(b)[i] *= v;
+        });
+        forEachBlock_(other.mask_, [&](int b) {
+            for (int i = 0; i < blockSize_; ++i)
+                block_(b)[i] += other.block_(b)[i]*u;
+        });
+        mask_ |= other.mask_;
+
+        return *this;
+    }
+
+    // m(c*u)' = c*u'
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation& operator*=(const RhsValueType& other)
+    {
+        value_ *= other;
+        forEachBlock_(mask_, [&](int b) {
+            for (int i = 0; i < blockSize_; ++i)
+                block_(b)[i] *= other;
+        });
+
+        return *this;
+    }
+
+    // m(u*v)' = (vu' - uv')/v^2 = (u' - (u/v)*v')/v
+    SparseEvaluation& operator/=(const SparseEvaluation& other)
+    {
+        const ValueType vInv = 1.0/other.value_;
+
+        value_ *= vInv;
+        forEachBlock_(mask_, [&](int b) {
+            for (int i = 0; i < blockSize_; ++i)
+                block_(b)[i] *= vInv;
+        });
+
+        const ValueType tmp = value_*vInv;
+        forEachBlock_(other.mask_, [&](int b) {
+            for (int i = 0; i < blockSize_; ++i)
+                block_(b)[i] -= tmp*other.block_(b)[i];
+        });
+        mask_ |= other.mask_;
+
+        return *this;
+    }
+
+    // divide value and derivatives by value of other
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation& operator/=(const RhsValueType& other)
+    {
+        const ValueType tmp = 1.0/other;
+
+        return (*this) *= tmp;
+    }
+
+    SparseEvaluation operator+(const SparseEvaluation& other) const
+    {
+        SparseEvaluation result(*this);
+        result += other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation operator+(const RhsValueType& other) const
+    {
+        SparseEvaluation result(*this);
+        result += other;
+        return result;
+    }
+
+    SparseEvaluation operator-(const SparseEvaluation& other) const
+    {
+        SparseEvaluation result(*this);
+        result -= other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation operator-(const RhsValueType& other) const
+    {
+        SparseEvaluation result(*this);
+        result -= other;
+        return result;
+    }
+
+    // negation (unary minus) operator
+    SparseEvaluation operator-() const
+    {
+        SparseEvaluation result(*this);
+        result *= -1.0;
+        return result;
+    }
+
+    SparseEvaluation operator*(const SparseEvaluation& other) const
+    {
+        SparseEvaluation result(*this);
+        result *= other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation operator*(const RhsValueType& other) const
+    {
+        SparseEvaluation result(*this);
+        result *= other;
+        return result;
+    }
+
+    SparseEvaluation operator/(const SparseEvaluation& other) const
+    {
+        SparseEvaluation result(*this);
+        result /= other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation operator/(const RhsValueType& other) const
+    {
+        SparseEvaluation result(*this);
+        result /= other;
+        return result;
+    }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    SparseEvaluation& operator=(const RhsValueType& other)
+    {
+        value_ = other;
+        clearDerivatives();
+
+        return *this;
+    }
+
+    // copy assignment from evaluation
+    SparseEvaluation& operator=(const SparseEvaluation& other) = default;
+
+    // operators for constants on the left hand side
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend SparseEvaluation operator+(const LhsValueType& a, const SparseEvaluation& b)
+    { return b + a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend SparseEvaluation operator-(const LhsValueType& a, const SparseEvaluation& b)
+    { return -(b - a); }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend SparseEvaluation operator*(const LhsValueType& a, const SparseEvaluation& b)
+    { return b*a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend SparseEvaluation operator/(const LhsValueType& a, const SparseEvaluation& b)
+    {
+        // (c/v)' = -c*v'/v^2
+        SparseEvaluation result(b);
+        result *= -a/(b.value_*b.value_);
+        result.value_ = a/b.value_;
+        return result;
+    }
+
+    // operators which involve dense Evaluations. the dense objects are not lazily
+    // evaluated, so these produce dense results.
+    friend DenseEvaluation& operator+=(DenseEvaluation& a, const SparseEvaluation& b)
+    {
+        a.setValue(a.value() + b.value_);
+        forEachBlock_(b.mask_, [&](int blockIdx) {
+            for (int i = blockIdx*blockSize_; i < std::min((blockIdx + 1)*blockSize_, numDerivs); ++i)
+                a.setDerivative(i, a.derivative(i) + b.derivatives_[i]);
+        });
+        return a;
+    }
+
+    friend DenseEvaluation& operator-=(DenseEvaluation& a, const SparseEvaluation& b)
+    {
+        a.setValue(a.value() - b.value_);
+        forEachBlock_(b.mask_, [&](int blockIdx) {
+            for (int i = blockIdx*blockSize_; i < std::min((blockIdx + 1)*blockSize_, numDerivs); ++i)
+                a.setDerivative(i, a.derivative(i) - b.derivatives_[i]);
+        });
+        return a;
+    }
+
+    friend DenseEvaluation& operator*=(DenseEvaluation& a, const SparseEvaluation& b)
+    { return a *= b.toDense(); }
+
+    friend DenseEvaluation& operator/=(DenseEvaluation& a, const SparseEvaluation& b)
+    { return a /= b.toDense(); }
+
+    friend DenseEvaluation operator+(const DenseEvaluation& a, const SparseEvaluation& b)
+    {
+        DenseEvaluation result(a);
+        result += b;
+        return result;
+    }
+
+    friend DenseEvaluation operator+(const SparseEvaluation& a, const DenseEvaluation& b)
+    { return b + a; }
+
+    friend DenseEvaluation operator-(const DenseEvaluation& a, const SparseEvaluation& b)
+    {
+        DenseEvaluation result(a);
+        result -= b;
+        return result;
+    }
+
+    friend DenseEvaluation operator-(const SparseEvaluation& a, const DenseEvaluation& b)
+    {
+        DenseEvaluation result(a);
+        result -= b;
+        return result;
+    }
+
+    friend DenseEvaluation operator*(const DenseEvaluation& a, const SparseEvaluation& b)
+    { return a*b.toDense(); }
+
+    friend DenseEvaluation operator*(const SparseEvaluation& a, const DenseEvaluation& b)
+    { return a.toDense()*b; }
+
+    friend DenseEvaluation operator/(const DenseEvaluation& a, const SparseEvaluation& b)
+    { return a/b.toDense(); }
+
+    friend DenseEvaluation operator/(const SparseEvaluation& a, const DenseEvaluation& b)
+    { return a.toDense()/b; }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator==(const RhsValueType& other) const
+    { return value() == other; }
+
+    bool operator==(const SparseEvaluation& other) const
+    {
+        if (value_ != other.value_)
+            return false;
+
+        for (int idx = 0; idx < size(); ++idx) {
+            if (derivatives_[idx] != other.derivatives_[idx])
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const SparseEvaluation& other) const
+    { return !operator==(other); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator!=(const RhsValueType& other) const
+    { return !operator==(other); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator>(RhsValueType other) const
+    { return value() > other; }
+
+    bool operator>(const SparseEvaluation& other) const
+    { return value() > other.value(); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator<(RhsValueType other) const
+    { return value() < other; }
+
+    bool operator<(const SparseEvaluation& other) const
+    { return value() < other.value(); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator>=(RhsValueType other) const
+    { return value() >= other; }
+
+    bool operator>=(const SparseEvaluation& other) const
+    { return value() >= other.value(); }
+
+    template <class RhsValueType, EnableIfScalar_<RhsValueType> = 0>
+    bool operator<=(RhsValueType other) const
+    { return value() <= other; }
+
+    bool operator<=(const SparseEvaluation& other) const
+    { return value() <= other.value(); }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend bool operator<(const LhsValueType& a, const SparseEvaluation& b)
+    { return b > a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend bool operator>(const LhsValueType& a, const SparseEvaluation& b)
+    { return b < a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend bool operator<=(const LhsValueType& a, const SparseEvaluation& b)
+    { return b >= a; }
+
+    template <class LhsValueType, EnableIfScalar_<LhsValueType> = 0>
+    friend bool operator>=(const LhsValueType& a, const SparseEvaluation& b)
+    { return b <= a; }
+
+    // return value of variable
+    const ValueType& value() const
+    { return value_; }
+
+    // set value of variable
+    template <class RhsValueType>
+    void setValue(const RhsValueType& val)
+    { value_ = val; }
+
+    // return varIdx'th derivative
+    const ValueType& derivative(int varIdx) const
+    {
+        assert(0 <= varIdx && varIdx < size());
+
+        return derivatives_[varIdx];
+    }
+
+    // set derivative at position varIdx
+    void setDerivative(int varIdx, const ValueType& derVal)
+    {
+        assert(0 <= varIdx && varIdx < size());
+
+        mask_ |= blockBit_(varIdx/blockSize_);
+        derivatives_[varIdx] = derVal;
+    }
+
+private:
+    // all derivatives outside of the blocks of mask_ are zero. this includes the
+    // padding of the last block.
+    alignas(blockSize_*sizeof(ValueT)) std::array<ValueT, numBlocks_*blockSize_> derivatives_;
+    ValueT value_;
+    unsigned mask_;
+};
+
+// sparse evaluations are expressions, but they provide their own arithmetic operators
+template <class ValueT, int numDerivs>
+struct IsLazyExpression<SparseEvaluation<ValueT, numDerivs> > : public std::false_type
+{};
+
+template <class ValueType, int numVars>
+std::ostream& operator<<(std::ostream& os, const SparseEvaluation<ValueType, numVars>& eval)
+{
+    os << eval.value();
+    return os;
+}
+
+} // namespace DenseAd
+
+// the mathematical functions for sparse evaluations. like for the dense Evaluation
+// class, the derivatives of the single-argument functions are obtained by scaling the
+// ones of the argument, which only touches the blocks of potentially non-zero
+// derivatives.
+template <class ValueT, int numVars>
+struct MathToolbox<DenseAd::SparseEvaluation<ValueT, numVars> >
+    : public DenseAd::EvaluationToolbox<DenseAd::SparseEvaluation<ValueT, numVars> >
+{};
+
+} // namespace Opm
+
+#endif // OPM_DENSEAD_SPARSE_EVALUATION_HPP
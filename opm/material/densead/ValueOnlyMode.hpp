@@ -0,0 +1,110 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief A run-time switch which disables the computation of derivatives by the
+ *        dense-AD Evaluation classes.
+ *
+ * Some computations only need the values of the residual, e.g., line searches and
+ * convergence checks. If OPM_DENSEAD_VALUE_ONLY_MODE is enabled, the arithmetic
+ * operators of DenseAd::Evaluation and the functions of Math.hpp only update the value
+ * while a ValueOnlyScope object exists on the current thread. The code that is
+ * instantiated for Evaluation then costs roughly the same as the one for scalars.
+ * While the mode is active, the derivatives of the results are unspecified. The
+ * values are bitwise identical to the ones computed with derivatives.
+ *
+ * If OPM_DENSEAD_VALUE_ONLY_MODE is disabled (the default), derivativesEnabled() is
+ * a compile time constant and the checks vanish. ValueOnlyScope then does nothing.
+ */
+#ifndef OPM_DENSEAD_VALUE_ONLY_MODE_HPP
+#define OPM_DENSEAD_VALUE_ONLY_MODE_HPP
+
+#ifndef OPM_DENSEAD_VALUE_ONLY_MODE
+#define OPM_DENSEAD_VALUE_ONLY_MODE 0
+#endif
+
+namespace Opm {
+namespace DenseAd {
+
+#if OPM_DENSEAD_VALUE_ONLY_MODE
+namespace ValueOnlyDetail {
+inline bool& derivativesEnabledFlag()
+{
+    static thread_local bool enabled = true;
+    return enabled;
+}
+} // namespace ValueOnlyDetail
+
+/*!
+ * \brief Returns true if the Evaluation operations on the current thread compute
+ *        derivatives.
+ */
+inline bool derivativesEnabled()
+{ return ValueOnlyDetail::derivativesEnabledFlag(); }
+#else
+/*!
+ * \brief Returns true if the Evaluation operations on the current thread compute
+ *        derivatives.
+ */
+constexpr bool derivativesEnabled()
+{ return true; }
+#endif
+
+/*!
+ * \brief Disables the computation of derivatives on the current thread for the
+ *        lifetime of the object.
+ *
+ * Scopes can be nested. The previous mode is restored by the destructor.
+ */
+class ValueOnlyScope
+{
+public:
+    ValueOnlyScope()
+    {
+#if OPM_DENSEAD_VALUE_ONLY_MODE
+        previous_ = ValueOnlyDetail::derivativesEnabledFlag();
+        ValueOnlyDetail::derivativesEnabledFlag() = false;
+#endif
+    }
+
+    ~ValueOnlyScope()
+    {
+#if OPM_DENSEAD_VALUE_ONLY_MODE
+        ValueOnlyDetail::derivativesEnabledFlag() = previous_;
+#endif
+    }
+
+    ValueOnlyScope(const ValueOnlyScope&) = delete;
+    ValueOnlyScope& operator=(const ValueOnlyScope&) = delete;
+
+private:
+#if OPM_DENSEAD_VALUE_ONLY_MODE
+    bool previous_;
+#endif
+};
+
+} // namespace DenseAd
+} // namespace Opm
+
+#endif // OPM_DENSEAD_VALUE_ONLY_MODE_HPP
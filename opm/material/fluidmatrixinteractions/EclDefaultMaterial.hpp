@@ -28,6 +28,7 @@
 #define OPM_ECL_DEFAULT_MATERIAL_HPP
 
 #include "EclDefaultMaterialParams.hpp"
+#include "MaterialLawCursor.hpp"
 
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/Valgrind.hpp>
@@ -89,6 +90,15 @@ public:
     using Params = ParamsT;
     using Scalar = typename Traits::Scalar;
 
+    /*!
+     * \brief Caller-owned lookup cursors of the nested two-phase material laws.
+     */
+    struct Cursor
+    {
+        MaterialLawCursor<GasOilMaterialLaw> gasOil;
+        MaterialLawCursor<OilWaterMaterialLaw> oilWater;
+    };
+
     static constexpr int numPhases = 3;
     static constexpr int waterPhaseIdx = Traits::wettingPhaseIdx;
     static constexpr int oilPhaseIdx = Traits::nonWettingPhaseIdx;
@@ -136,16 +146,21 @@ public:
     static void capillaryPressures(ContainerT& values,
                                    const Params& params,
                                    const FluidState& state)
-    {
-        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
-        values[gasPhaseIdx] = pcgn<FluidState, Evaluation>(params, state);
-        values[oilPhaseIdx] = 0;
-        values[waterPhaseIdx] = - pcnw<FluidState, Evaluation>(params, state);
+    { capillaryPressures_(values, params, state, static_cast<Cursor*>(nullptr)); }
 
-        Valgrind::CheckDefined(values[gasPhaseIdx]);
-        Valgrind::CheckDefined(values[oilPhaseIdx]);
-        Valgrind::CheckDefined(values[waterPhaseIdx]);
-    }
+    /*!
+     * \brief The same as capillaryPressures(values, params, state), but the two-phase
+     *        curves are looked up using caller-owned cursors.
+     *
+     * \param cursor The cursors of the cell, e.g., a Cursor object. It must provide
+     *               the gasOil and oilWater members.
+     */
+    template <class ContainerT, class FluidState, class CursorT>
+    static void capillaryPressures(ContainerT& values,
+                                   const Params& params,
+                                   const FluidState& state,
+                                   CursorT& cursor)
+    { capillaryPressures_(values, params, state, &cursor); }
 
     /*
      * Hysteresis parameters for oil-water
@@ -224,13 +239,15 @@ public:
      * p_{c,gn} = p_g - p_n
      * \f]
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation pcgn(const Params& params,
-                           const FluidState& fs)
+                           const FluidState& fs,
+                           CursorT* cursor = nullptr)
     {
         // Maximum attainable oil saturation is 1-SWL.
         const auto Sw = 1.0 - params.Swl() - decay<Evaluation>(fs.saturation(gasPhaseIdx));
-        return GasOilMaterialLaw::twoPhaseSatPcnw(params.gasOilParams(), Sw);
+        return TwoPhaseSatLookup::pcnw<GasOilMaterialLaw>(params.gasOilParams(), Sw,
+                                                          gasOilCursor_(cursor));
     }
 
     /*!
@@ -242,12 +259,14 @@ public:
      * p_{c,nw} = p_n - p_w
      * \f]
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation pcnw(const Params& params,
-                           const FluidState& fs)
+                           const FluidState& fs,
+                           CursorT* cursor = nullptr)
     {
         const auto Sw = decay<Evaluation>(fs.saturation(waterPhaseIdx));
-        return OilWaterMaterialLaw::twoPhaseSatPcnw(params.oilWaterParams(), Sw);
+        return TwoPhaseSatLookup::pcnw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                            oilWaterCursor_(cursor));
     }
 
     /*!
@@ -310,43 +329,56 @@ public:
     static void relativePermeabilities(ContainerT& values,
                                        const Params& params,
                                        const FluidState& fluidState)
-    {
-        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+    { relativePermeabilities_(values, params, fluidState, static_cast<Cursor*>(nullptr)); }
 
-        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState);
-        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState);
-        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState);
-    }
+    /*!
+     * \brief The same as relativePermeabilities(values, params, fluidState), but the two-phase
+     *        curves are looked up using caller-owned cursors.
+     *
+     * \param cursor The cursors of the cell, e.g., a Cursor object. It must provide
+     *               the gasOil and oilWater members.
+     */
+    template <class ContainerT, class FluidState, class CursorT>
+    static void relativePermeabilities(ContainerT& values,
+                                       const Params& params,
+                                       const FluidState& fluidState,
+                                       CursorT& cursor)
+    { relativePermeabilities_(values, params, fluidState, &cursor); }
 
     /*!
      * \brief The relative permeability of the gas phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krg(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         // Maximum attainable oil saturation is 1-SWL.
         const Evaluation Sw = 1.0 - params.Swl() - decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
-        return GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), Sw);
+        return TwoPhaseSatLookup::krn<GasOilMaterialLaw>(params.gasOilParams(), Sw,
+                                                         gasOilCursor_(cursor));
     }
 
     /*!
      * \brief The relative permeability of the wetting phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krw(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         const Evaluation Sw = decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
-        return OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
+        return TwoPhaseSatLookup::krw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                           oilWaterCursor_(cursor));
     }
 
     /*!
      * \brief The relative permeability of the non-wetting (i.e., oil) phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krn(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         const Scalar Swco = params.Swl();
 
@@ -357,8 +389,8 @@ public:
         const Evaluation Sg = decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
         const Evaluation Sw_ow = Sg + Sw;
-        const Evaluation kro_ow = relpermOilInOilWaterSystem<Evaluation>(params, fluidState);
-        const Evaluation kro_go = relpermOilInOilGasSystem<Evaluation>(params, fluidState);
+        const Evaluation kro_ow = relpermOilInOilWaterSystem<Evaluation>(params, fluidState, cursor);
+        const Evaluation kro_go = relpermOilInOilGasSystem<Evaluation>(params, fluidState, cursor);
 
         // avoid the division by zero: chose a regularized kro which is used if Sw - Swco
         // < epsilon/2 and interpolate between the oridinary and the regularized kro between
@@ -382,9 +414,10 @@ public:
     /*!
      * \brief The relative permeability of oil in oil/gas system.
      */
-    template <class Evaluation, class FluidState>
+    template <class Evaluation, class FluidState, class CursorT = Cursor>
     static Evaluation relpermOilInOilGasSystem(const Params& params,
-                                               const FluidState& fluidState)
+                                               const FluidState& fluidState,
+                                               CursorT* cursor = nullptr)
     {
         const Evaluation Sw =
             max(Evaluation{ params.Swl() },
@@ -393,15 +426,17 @@ public:
         const Evaluation Sg = decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
         const Evaluation So_go = 1.0 - (Sg + Sw);
 
-        return GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), So_go);
+        return TwoPhaseSatLookup::krw<GasOilMaterialLaw>(params.gasOilParams(), So_go,
+                                                         gasOilCursor_(cursor));
     }
 
     /*!
      * \brief The relative permeability of oil in oil/water system.
      */
-    template <class Evaluation, class FluidState>
+    template <class Evaluation, class FluidState, class CursorT = Cursor>
     static Evaluation relpermOilInOilWaterSystem(const Params& params,
-                                                 const FluidState& fluidState)
+                                                 const FluidState& fluidState,
+                                                 CursorT* cursor = nullptr)
     {
         const Evaluation Sw =
             max(Evaluation{ params.Swl() },
@@ -410,7 +445,8 @@ public:
         const Evaluation Sg = decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
         const Evaluation Sw_ow = Sg + Sw;
 
-        return OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw_ow);
+        return TwoPhaseSatLookup::krn<OilWaterMaterialLaw>(params.oilWaterParams(), Sw_ow,
+                                                           oilWaterCursor_(cursor));
     }
 
     /*!
@@ -467,6 +503,44 @@ public:
         const auto sat = scalarValue(fluidState.saturation(phaseIndex));
         return std::clamp(sat, Scalar{0.0}, Scalar{1.0});
     }
+
+private:
+    template <class CursorT>
+    static auto gasOilCursor_(CursorT* cursor) -> decltype(&cursor->gasOil)
+    { return cursor ? &cursor->gasOil : nullptr; }
+
+    template <class CursorT>
+    static auto oilWaterCursor_(CursorT* cursor) -> decltype(&cursor->oilWater)
+    { return cursor ? &cursor->oilWater : nullptr; }
+
+    template <class ContainerT, class FluidState, class CursorT>
+    static void capillaryPressures_(ContainerT& values,
+                                    const Params& params,
+                                    const FluidState& state,
+                                    CursorT* cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+        values[gasPhaseIdx] = pcgn<FluidState, Evaluation>(params, state, cursor);
+        values[oilPhaseIdx] = 0;
+        values[waterPhaseIdx] = - pcnw<FluidState, Evaluation>(params, state, cursor);
+
+        Valgrind::CheckDefined(values[gasPhaseIdx]);
+        Valgrind::CheckDefined(values[oilPhaseIdx]);
+        Valgrind::CheckDefined(values[waterPhaseIdx]);
+    }
+
+    template <class ContainerT, class FluidState, class CursorT>
+    static void relativePermeabilities_(ContainerT& values,
+                                        const Params& params,
+                                        const FluidState& fluidState,
+                                        CursorT* cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+
+        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState, cursor);
+        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState, cursor);
+        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState, cursor);
+    }
 };
 } // namespace Opm
 
@@ -117,6 +117,31 @@ struct EclEpsScalingPointsInfo
                maxKrg == data.maxKrg;
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(Swl);
+        serializer(Sgl);
+        serializer(Swcr);
+        serializer(Sgcr);
+        serializer(Sowcr);
+        serializer(Sogcr);
+        serializer(Swu);
+        serializer(Sgu);
+        serializer(maxPcow);
+        serializer(maxPcgo);
+        serializer(pcowLeverettFactor);
+        serializer(pcgoLeverettFactor);
+        serializer(Krwr);
+        serializer(Krgr);
+        serializer(Krorw);
+        serializer(Krorg);
+        serializer(maxKrw);
+        serializer(maxKrow);
+        serializer(maxKrog);
+        serializer(maxKrg);
+    }
+
     void print() const
     {
         std::cout << "    Swl: " << Swl << '\n'
@@ -488,6 +513,31 @@ public:
     Scalar maxKrn() const
     { return maxKrn_; }
 
+    bool operator==(const EclEpsScalingPoints<Scalar>& data) const
+    {
+        return maxPcnwOrLeverettFactor_ == data.maxPcnwOrLeverettFactor_ &&
+               maxKrw_ == data.maxKrw_ &&
+               Krwr_ == data.Krwr_ &&
+               maxKrn_ == data.maxKrn_ &&
+               Krnr_ == data.Krnr_ &&
+               saturationPcPoints_ == data.saturationPcPoints_ &&
+               saturationKrwPoints_ == data.saturationKrwPoints_ &&
+               saturationKrnPoints_ == data.saturationKrnPoints_;
+    }
+
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(maxPcnwOrLeverettFactor_);
+        serializer(maxKrw_);
+        serializer(Krwr_);
+        serializer(maxKrn_);
+        serializer(Krnr_);
+        serializer(saturationPcPoints_);
+        serializer(saturationKrwPoints_);
+        serializer(saturationKrnPoints_);
+    }
+
     void print() const
     {
         std::cout << "    saturationKrnPoints_[0]: " << saturationKrnPoints_[0] << "\n"
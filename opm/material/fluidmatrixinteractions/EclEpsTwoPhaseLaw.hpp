@@ -28,6 +28,7 @@
 #define OPM_ECL_EPS_TWO_PHASE_LAW_HPP
 
 #include "EclEpsTwoPhaseLawParams.hpp"
+#include "MaterialLawCursor.hpp"
 
 #include <algorithm>
 #include <cstddef>
@@ -56,6 +57,9 @@ public:
     typedef ParamsT Params;
     typedef typename EffLaw::Scalar Scalar;
 
+    //! The caller-owned lookup cursor of the unscaled material law
+    typedef MaterialLawCursor<EffLaw> Cursor;
+
     enum { wettingPhaseIdx = Traits::wettingPhaseIdx };
     enum { nonWettingPhaseIdx = Traits::nonWettingPhaseIdx };
 
@@ -154,6 +158,15 @@ public:
         return unscaledToScaledPcnw_(params, pcUnscaled);
     }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatPcnw(const Params& params, const Evaluation& SwScaled, Cursor& cursor)
+    {
+        const Evaluation SwUnscaled = scaledToUnscaledSatPc(params, SwScaled);
+        const Evaluation pcUnscaled =
+            TwoPhaseSatLookup::pcnw<EffLaw>(params.effectiveLawParams(), SwUnscaled, &cursor);
+        return unscaledToScaledPcnw_(params, pcUnscaled);
+    }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnwInv(const Params& params, const Evaluation& pcnwScaled)
     {
@@ -226,6 +239,15 @@ public:
         return unscaledToScaledKrw_(SwScaled, params, krwUnscaled);
     }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrw(const Params& params, const Evaluation& SwScaled, Cursor& cursor)
+    {
+        const Evaluation SwUnscaled = scaledToUnscaledSatKrw(params, SwScaled);
+        const Evaluation krwUnscaled =
+            TwoPhaseSatLookup::krw<EffLaw>(params.effectiveLawParams(), SwUnscaled, &cursor);
+        return unscaledToScaledKrw_(SwScaled, params, krwUnscaled);
+    }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatKrwInv(const Params& params, const Evaluation& krwScaled)
     {
@@ -251,6 +273,15 @@ public:
         return unscaledToScaledKrn_(SwScaled, params, krnUnscaled);
     }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrn(const Params& params, const Evaluation& SwScaled, Cursor& cursor)
+    {
+        const Evaluation SwUnscaled = scaledToUnscaledSatKrn(params, SwScaled);
+        const Evaluation krnUnscaled =
+            TwoPhaseSatLookup::krn<EffLaw>(params.effectiveLawParams(), SwUnscaled, &cursor);
+        return unscaledToScaledKrn_(SwScaled, params, krnUnscaled);
+    }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatKrnInv(const Params& params, const Evaluation& krnScaled)
     {
@@ -28,6 +28,7 @@
 #define OPM_ECL_HYSTERESIS_TWO_PHASE_LAW_HPP
 
 #include "EclHysteresisTwoPhaseLawParams.hpp"
+#include "MaterialLawCursor.hpp"
 
 #include <stdexcept>
 
@@ -50,6 +51,15 @@ public:
     using Params = ParamsT;
     using Scalar = typename EffectiveLaw::Scalar;
 
+    /*!
+     * \brief Caller-owned lookup cursors for the drainage and the imbibition curves.
+     */
+    struct Cursor
+    {
+        MaterialLawCursor<EffectiveLaw> drainage;
+        MaterialLawCursor<EffectiveLaw> imbibition;
+    };
+
     enum { wettingPhaseIdx = Traits::wettingPhaseIdx };
     enum { nonWettingPhaseIdx = Traits::nonWettingPhaseIdx };
 
@@ -148,57 +158,13 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params& params, const Evaluation& Sw)
     {
-        // if no pc hysteresis is enabled, use the drainage curve
-        if (!params.config().enableHysteresis() || params.config().pcHysteresisModel() < 0)
-            return EffectiveLaw::twoPhaseSatPcnw(params.drainageParams(), Sw);
-
-        // Initial imbibition process
-        if (params.initialImb()) {
-            if (Sw >= params.pcSwMic()) {
-                return EffectiveLaw::twoPhaseSatPcnw(params.imbibitionParams(), Sw);
-            }
-            else { // Reversal
-                const Evaluation& F = (1.0/(params.pcSwMic()-Sw+params.curvatureCapPrs())-1.0/params.curvatureCapPrs())
-                     / (1.0/(params.pcSwMic()-params.Swcrd()+params.curvatureCapPrs())-1.0/params.curvatureCapPrs());
-
-                const Evaluation& Pcd = EffectiveLaw::twoPhaseSatPcnw(params.drainageParams(), Sw);
-                const Evaluation& Pci = EffectiveLaw::twoPhaseSatPcnw(params.imbibitionParams(), Sw);
-                const Evaluation& pc_Killough = Pci+F*(Pcd-Pci);
-
-                return pc_Killough;
-            }
-        }
-
-        // Initial drainage process
-        if (Sw <= params.pcSwMdc())
-            return EffectiveLaw::twoPhaseSatPcnw(params.drainageParams(), Sw);
-
-        // Reversal
-        Scalar Swma = 1.0-params.Sncrt();
-        if (Sw >= Swma) {
-            const Evaluation& Pci = EffectiveLaw::twoPhaseSatPcnw(params.imbibitionParams(), Sw);
-            return Pci;
-        }
-        else {
-            Scalar pciwght = params.pcWght(); // Align pci and pcd at Swir
-            //const Evaluation& SwEff = params.Swcri()+(Sw-params.pcSwMdc())/(Swma-params.pcSwMdc())*(Swma-params.Swcri());
-            const Evaluation& SwEff = Sw; // This is Killough 1976, Gives significantly better fit compared to benchmark then the above "scaling"
-            const Evaluation& Pci = pciwght*EffectiveLaw::twoPhaseSatPcnw(params.imbibitionParams(), SwEff);
-
-            const Evaluation& Pcd = EffectiveLaw::twoPhaseSatPcnw(params.drainageParams(), Sw);
-
-            if (Pci == Pcd)
-                return Pcd;
-
-            const Evaluation& F = (1.0/(Sw-params.pcSwMdc()+params.curvatureCapPrs())-1.0/params.curvatureCapPrs())
-                                / (1.0/(Swma-params.pcSwMdc()+params.curvatureCapPrs())-1.0/params.curvatureCapPrs());
-
-            const Evaluation& pc_Killough = Pcd+F*(Pci-Pcd);
-
-            return pc_Killough;
-        }
+        return twoPhaseSatPcnw_(params, Sw, /*cursor=*/nullptr);
+    }
 
-        return 0.0;
+    template <class Evaluation>
+    static Evaluation twoPhaseSatPcnw(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    {
+        return twoPhaseSatPcnw_(params, Sw, &cursor);
     }
 
     /*!
@@ -267,17 +233,13 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params& params, const Evaluation& Sw)
     {
-        // if no relperm hysteresis is enabled, use the drainage curve
-        if (!params.config().enableHysteresis() || params.config().krHysteresisModel() < 0)
-            return EffectiveLaw::twoPhaseSatKrw(params.drainageParams(), Sw);
-
-        if (params.config().krHysteresisModel() == 0 || params.config().krHysteresisModel() == 2)
-            // use drainage curve for wetting phase
-            return EffectiveLaw::twoPhaseSatKrw(params.drainageParams(), Sw);
+        return twoPhaseSatKrw_(params, Sw, /*cursor=*/nullptr);
+    }
 
-        // use imbibition curve for wetting phase
-        assert(params.config().krHysteresisModel() == 1 || params.config().krHysteresisModel() == 3);
-        return EffectiveLaw::twoPhaseSatKrw(params.imbibitionParams(), Sw);
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrw(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    {
+        return twoPhaseSatKrw_(params, Sw, &cursor);
     }
 
     /*!
@@ -293,24 +255,129 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params& params, const Evaluation& Sw)
     {
+        return twoPhaseSatKrn_(params, Sw, /*cursor=*/nullptr);
+    }
+
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrn(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    {
+        return twoPhaseSatKrn_(params, Sw, &cursor);
+    }
+
+private:
+    static MaterialLawCursor<EffectiveLaw>* drainageCursor_(Cursor* cursor)
+    { return cursor ? &cursor->drainage : nullptr; }
+
+    static MaterialLawCursor<EffectiveLaw>* imbibitionCursor_(Cursor* cursor)
+    { return cursor ? &cursor->imbibition : nullptr; }
+
+    template <class Evaluation>
+    static Evaluation twoPhaseSatPcnw_(const Params& params, const Evaluation& Sw, Cursor* cursor)
+    {
+        const auto drainagePcnw = [&](const Evaluation& S)
+        { return TwoPhaseSatLookup::pcnw<EffectiveLaw>(params.drainageParams(), S, drainageCursor_(cursor)); };
+        const auto imbibitionPcnw = [&](const Evaluation& S)
+        { return TwoPhaseSatLookup::pcnw<EffectiveLaw>(params.imbibitionParams(), S, imbibitionCursor_(cursor)); };
+
+        // if no pc hysteresis is enabled, use the drainage curve
+        if (!params.config().enableHysteresis() || params.config().pcHysteresisModel() < 0)
+            return drainagePcnw(Sw);
+
+        // Initial imbibition process
+        if (params.initialImb()) {
+            if (Sw >= params.pcSwMic()) {
+                return imbibitionPcnw(Sw);
+            }
+            else { // Reversal
+                const Evaluation& F = (1.0/(params.pcSwMic()-Sw+params.curvatureCapPrs())-1.0/params.curvatureCapPrs())
+                     / (1.0/(params.pcSwMic()-params.Swcrd()+params.curvatureCapPrs())-1.0/params.curvatureCapPrs());
+
+                const Evaluation& Pcd = drainagePcnw(Sw);
+                const Evaluation& Pci = imbibitionPcnw(Sw);
+                const Evaluation& pc_Killough = Pci+F*(Pcd-Pci);
+
+                return pc_Killough;
+            }
+        }
+
+        // Initial drainage process
+        if (Sw <= params.pcSwMdc())
+            return drainagePcnw(Sw);
+
+        // Reversal
+        Scalar Swma = 1.0-params.Sncrt();
+        if (Sw >= Swma) {
+            const Evaluation& Pci = imbibitionPcnw(Sw);
+            return Pci;
+        }
+        else {
+            Scalar pciwght = params.pcWght(); // Align pci and pcd at Swir
+            //const Evaluation& SwEff = params.Swcri()+(Sw-params.pcSwMdc())/(Swma-params.pcSwMdc())*(Swma-params.Swcri());
+            const Evaluation& SwEff = Sw; // This is Killough 1976, Gives significantly better fit compared to benchmark then the above "scaling"
+            const Evaluation& Pci = pciwght*imbibitionPcnw(SwEff);
+
+            const Evaluation& Pcd = drainagePcnw(Sw);
+
+            if (Pci == Pcd)
+                return Pcd;
+
+            const Evaluation& F = (1.0/(Sw-params.pcSwMdc()+params.curvatureCapPrs())-1.0/params.curvatureCapPrs())
+                                / (1.0/(Swma-params.pcSwMdc()+params.curvatureCapPrs())-1.0/params.curvatureCapPrs());
+
+            const Evaluation& pc_Killough = Pcd+F*(Pci-Pcd);
+
+            return pc_Killough;
+        }
+
+        return 0.0;
+    }
+
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrw_(const Params& params, const Evaluation& Sw, Cursor* cursor)
+    {
+        const auto drainageKrw = [&](const Evaluation& S)
+        { return TwoPhaseSatLookup::krw<EffectiveLaw>(params.drainageParams(), S, drainageCursor_(cursor)); };
+        const auto imbibitionKrw = [&](const Evaluation& S)
+        { return TwoPhaseSatLookup::krw<EffectiveLaw>(params.imbibitionParams(), S, imbibitionCursor_(cursor)); };
+
+        // if no relperm hysteresis is enabled, use the drainage curve
+        if (!params.config().enableHysteresis() || params.config().krHysteresisModel() < 0)
+            return drainageKrw(Sw);
+
+        if (params.config().krHysteresisModel() == 0 || params.config().krHysteresisModel() == 2)
+            // use drainage curve for wetting phase
+            return drainageKrw(Sw);
+
+        // use imbibition curve for wetting phase
+        assert(params.config().krHysteresisModel() == 1 || params.config().krHysteresisModel() == 3);
+        return imbibitionKrw(Sw);
+    }
+
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrn_(const Params& params, const Evaluation& Sw, Cursor* cursor)
+    {
+        const auto drainageKrn = [&](const Evaluation& S)
+        { return TwoPhaseSatLookup::krn<EffectiveLaw>(params.drainageParams(), S, drainageCursor_(cursor)); };
+        const auto imbibitionKrn = [&](const Evaluation& S)
+        { return TwoPhaseSatLookup::krn<EffectiveLaw>(params.imbibitionParams(), S, imbibitionCursor_(cursor)); };
+
         // if no relperm hysteresis is enabled, use the drainage curve
         if (!params.config().enableHysteresis() || params.config().krHysteresisModel() < 0)
-            return EffectiveLaw::twoPhaseSatKrn(params.drainageParams(), Sw);
+            return drainageKrn(Sw);
 
         // if it is enabled, use either the drainage or the imbibition curve. if the
         // imbibition curve is used, the saturation must be shifted.
         if (Sw <= params.krnSwMdc())
-            return EffectiveLaw::twoPhaseSatKrn(params.drainageParams(), Sw);
+            return drainageKrn(Sw);
 
         if (params.config().krHysteresisModel() <= 1) { //Carlson
-            return EffectiveLaw::twoPhaseSatKrn(params.imbibitionParams(),
-                                                Sw + params.deltaSwImbKrn());
+            return imbibitionKrn(Sw + params.deltaSwImbKrn());
         }
 
         // Killough
         assert(params.config().krHysteresisModel() == 2 || params.config().krHysteresisModel() == 3);
         Evaluation Snorm = params.Sncri()+(1.0-Sw-params.Sncrt())*(params.Snmaxd()-params.Sncri())/(params.Snhy()-params.Sncrt());
-        return params.krnWght()*EffectiveLaw::twoPhaseSatKrn(params.imbibitionParams(),1.0-Snorm);
+        return params.krnWght()*imbibitionKrn(1.0-Snorm);
     }
 };
 
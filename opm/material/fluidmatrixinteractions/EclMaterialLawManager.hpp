@@ -41,6 +41,7 @@
 #include <opm/material/fluidmatrixinteractions/EclMultiplexerMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 #include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+#include <opm/material/common/BinarySnapshot.hpp>
 
 #if HAVE_OPM_COMMON
 #include <opm/common/OpmLog/OpmLog.hpp>
@@ -55,6 +56,7 @@
 #include <cassert>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace Opm {
@@ -109,6 +111,8 @@ public:
     // the three-phase material law used by the simulation
     using MaterialLaw = EclMultiplexerMaterial<Traits, GasOilTwoPhaseLaw, OilWaterTwoPhaseLaw, GasWaterTwoPhaseLaw>;
     using MaterialLawParams = typename MaterialLaw::Params;
+    // the lookup cursors of the saturation functions of an element
+    using Cursor = typename MaterialLaw::Cursor;
 
 private:
     // internal typedefs
@@ -136,6 +140,13 @@ public:
         const size_t numSatRegions = runspec.tabdims().getNumSatTables();
 
         const auto& ph = runspec.phases();
+        if (satRegionParamsFromSnapshot_
+            && (this->hasGas != ph.active(Phase::GAS)
+                || this->hasOil != ph.active(Phase::OIL)
+                || this->hasWater != ph.active(Phase::WATER)))
+            throw std::runtime_error("The active phases of the saturation function snapshot "
+                                     "do not match the ones of the deck");
+
         this->hasGas = ph.active(Phase::GAS);
         this->hasOil = ph.active(Phase::OIL);
         this->hasWater = ph.active(Phase::WATER);
@@ -168,6 +179,14 @@ public:
             }
         }
 
+        if (satRegionParamsFromSnapshot_) {
+            // the unscaled end points were restored by loadSatRegionSnapshot()
+            if (this->unscaledEpsInfo_.size() != numSatRegions)
+                throw std::runtime_error("The number of saturation regions of the saturation "
+                                         "function snapshot does not match the one of the deck");
+            return;
+        }
+
         this->unscaledEpsInfo_.resize(numSatRegions);
 
         if (this->hasGas + this->hasOil + this->hasWater == 1) {
@@ -193,24 +212,27 @@ public:
         // get the number of saturation regions
         const size_t numSatRegions = eclState.runspec().tabdims().getNumSatTables();
 
-        // setup the saturation region specific parameters
-        gasOilUnscaledPointsVector_.resize(numSatRegions);
-        oilWaterUnscaledPointsVector_.resize(numSatRegions);
-        gasWaterUnscaledPointsVector_.resize(numSatRegions);
-
-        gasOilEffectiveParamVector_.resize(numSatRegions);
-        oilWaterEffectiveParamVector_.resize(numSatRegions);
-        gasWaterEffectiveParamVector_.resize(numSatRegions);
-        for (unsigned satRegionIdx = 0; satRegionIdx < numSatRegions; ++satRegionIdx) {
-            // unscaled points for end-point scaling
-            readGasOilUnscaledPoints_(gasOilUnscaledPointsVector_, gasOilConfig, eclState, satRegionIdx);
-            readOilWaterUnscaledPoints_(oilWaterUnscaledPointsVector_, oilWaterConfig, eclState, satRegionIdx);
-            readGasWaterUnscaledPoints_(gasWaterUnscaledPointsVector_, gasWaterConfig, eclState, satRegionIdx);
-
-            // the parameters for the effective two-phase matererial laws
-            readGasOilEffectiveParameters_(gasOilEffectiveParamVector_, eclState, satRegionIdx);
-            readOilWaterEffectiveParameters_(oilWaterEffectiveParamVector_, eclState, satRegionIdx);
-            readGasWaterEffectiveParameters_(gasWaterEffectiveParamVector_, eclState, satRegionIdx);
+        // setup the saturation region specific parameters unless they were restored by
+        // loadSatRegionSnapshot()
+        if (!satRegionParamsFromSnapshot_) {
+            gasOilUnscaledPointsVector_.resize(numSatRegions);
+            oilWaterUnscaledPointsVector_.resize(numSatRegions);
+            gasWaterUnscaledPointsVector_.resize(numSatRegions);
+
+            gasOilEffectiveParamVector_.resize(numSatRegions);
+            oilWaterEffectiveParamVector_.resize(numSatRegions);
+            gasWaterEffectiveParamVector_.resize(numSatRegions);
+            for (unsigned satRegionIdx = 0; satRegionIdx < numSatRegions; ++satRegionIdx) {
+                // unscaled points for end-point scaling
+                readGasOilUnscaledPoints_(gasOilUnscaledPointsVector_, gasOilConfig, eclState, satRegionIdx);
+                readOilWaterUnscaledPoints_(oilWaterUnscaledPointsVector_, oilWaterConfig, eclState, satRegionIdx);
+                readGasWaterUnscaledPoints_(gasWaterUnscaledPointsVector_, gasWaterConfig, eclState, satRegionIdx);
+
+                // the parameters for the effective two-phase matererial laws
+                readGasOilEffectiveParameters_(gasOilEffectiveParamVector_, eclState, satRegionIdx);
+                readOilWaterEffectiveParameters_(oilWaterEffectiveParamVector_, eclState, satRegionIdx);
+                readGasWaterEffectiveParameters_(gasWaterEffectiveParamVector_, eclState, satRegionIdx);
+            }
         }
 
         // copy the SATNUM grid property. in some cases this is not necessary, but it
@@ -475,6 +497,55 @@ public:
         return Sw;
     }
 
+    /*!
+     * \brief Write the unscaled end points and the effective saturation functions of
+     *        all saturation regions to a binary snapshot file.
+     *
+     * initParamsForElements() must have been called before.
+     */
+    void writeSatRegionSnapshot(const std::string& fileName) const
+    {
+        SnapshotWriter writer;
+        serializeSatRegions_(*this, writer);
+        writer.writeFile(fileName, snapshotTag_());
+    }
+
+    /*!
+     * \brief Restore the unscaled end points and the effective saturation functions of
+     *        all saturation regions from a binary snapshot file.
+     *
+     * This must be called before initFromState(). initFromState() and
+     * initParamsForElements() then skip processing the saturation function tables of
+     * the deck and only set up the parameters which are specific to each element.
+     */
+    void loadSatRegionSnapshot(const std::string& fileName)
+    {
+        SnapshotReader reader(fileName, snapshotTag_());
+        serializeSatRegions_(*this, reader);
+        reader.checkEnd();
+        satRegionParamsFromSnapshot_ = true;
+    }
+
+    /*!
+     * \brief Returns true iff both objects use the same unscaled end points and
+     *        effective saturation functions for all saturation regions.
+     *
+     * These are the quantities which are stored by writeSatRegionSnapshot().
+     */
+    bool hasSameSatRegions(const EclMaterialLawManager& other) const
+    {
+        return this->hasGas == other.hasGas &&
+               this->hasOil == other.hasOil &&
+               this->hasWater == other.hasWater &&
+               this->unscaledEpsInfo_ == other.unscaledEpsInfo_ &&
+               sameObjects_(this->gasOilUnscaledPointsVector_, other.gasOilUnscaledPointsVector_) &&
+               sameObjects_(this->oilWaterUnscaledPointsVector_, other.oilWaterUnscaledPointsVector_) &&
+               sameObjects_(this->gasWaterUnscaledPointsVector_, other.gasWaterUnscaledPointsVector_) &&
+               sameObjects_(this->gasOilEffectiveParamVector_, other.gasOilEffectiveParamVector_) &&
+               sameObjects_(this->oilWaterEffectiveParamVector_, other.oilWaterEffectiveParamVector_) &&
+               sameObjects_(this->gasWaterEffectiveParamVector_, other.gasWaterEffectiveParamVector_);
+    }
+
     bool enableEndPointScaling() const
     { return enableEndPointScaling_; }
 
@@ -493,6 +564,32 @@ public:
         return materialLawParams_[elemIdx];
     }
 
+    /*!
+     * \brief Compute the capillary pressures of an element.
+     *
+     * The cursor is owned by the caller, which typically keeps one of them per element
+     * across Newton iterations, so that the segments of the saturation functions are
+     * usually found without a search.
+     */
+    template <class Container, class FluidState>
+    void capillaryPressures(Container& values,
+                            unsigned elemIdx,
+                            const FluidState& fluidState,
+                            Cursor& cursor) const
+    { MaterialLaw::capillaryPressures(values, materialLawParams(elemIdx), fluidState, cursor); }
+
+    /*!
+     * \brief Compute the relative permeabilities of an element.
+     *
+     * \copydetails capillaryPressures()
+     */
+    template <class Container, class FluidState>
+    void relativePermeabilities(Container& values,
+                                unsigned elemIdx,
+                                const FluidState& fluidState,
+                                Cursor& cursor) const
+    { MaterialLaw::relativePermeabilities(values, materialLawParams(elemIdx), fluidState, cursor); }
+
     /*!
      * \brief Returns a material parameter object for a given element and saturation region.
      *
@@ -708,6 +805,37 @@ public:
     { return oilWaterScaledEpsInfoDrainage_[elemIdx]; }
 
 private:
+    // self is const when writing the snapshot
+    template <class Self, class Serializer>
+    static void serializeSatRegions_(Self& self, Serializer& serializer)
+    {
+        serializer(self.hasGas);
+        serializer(self.hasOil);
+        serializer(self.hasWater);
+        serializer(self.unscaledEpsInfo_);
+
+        serializer(self.gasOilUnscaledPointsVector_);
+        serializer(self.oilWaterUnscaledPointsVector_);
+        serializer(self.gasWaterUnscaledPointsVector_);
+
+        serializer(self.gasOilEffectiveParamVector_);
+        serializer(self.oilWaterEffectiveParamVector_);
+        serializer(self.gasWaterEffectiveParamVector_);
+    }
+
+    static std::string snapshotTag_()
+    { return "EclMaterialLawManager<" + snapshotScalarName<Scalar>() + ">"; }
+
+    // compare two vectors of shared objects by value
+    template <class T>
+    static bool sameObjects_(const std::vector<std::shared_ptr<T>>& v1,
+                             const std::vector<std::shared_ptr<T>>& v2)
+    {
+        return std::equal(v1.begin(), v1.end(), v2.begin(), v2.end(),
+                          [](const std::shared_ptr<T>& p1, const std::shared_ptr<T>& p2)
+                          { return (!p1 || !p2) ? p1 == p2 : *p1 == *p2; });
+    }
+
     void readGlobalEpsOptions_(const EclipseState& eclState)
     {
         oilWaterEclEpsConfig_ = std::make_shared<EclEpsConfig>();
@@ -1270,10 +1398,21 @@ private:
     bool hasOil;
     bool hasWater;
 
+    // true if the saturation region specific parameters were loaded from a snapshot
+    bool satRegionParamsFromSnapshot_ = false;
+
     std::shared_ptr<EclEpsConfig> gasOilConfig;
     std::shared_ptr<EclEpsConfig> oilWaterConfig;
     std::shared_ptr<EclEpsConfig> gasWaterConfig;
 };
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+// instantiated by libopmmaterial for the phase indices of the black-oil fluid system
+extern template class EclMaterialLawManager<ThreePhaseMaterialTraits<double,
+                                                                     /*waterPhaseIdx=*/0,
+                                                                     /*oilPhaseIdx=*/1,
+                                                                     /*gasPhaseIdx=*/2>>;
+#endif
+
 } // namespace Opm
 
 #endif
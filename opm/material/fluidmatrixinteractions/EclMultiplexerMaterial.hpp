@@ -33,6 +33,8 @@
 #include "EclStone2Material.hpp"
 #include "EclTwoPhaseMaterial.hpp"
 
+#include <opm/material/densead/OperationCounter.hpp>
+
 #include <algorithm>
 #include <stdexcept>
 
@@ -86,6 +88,10 @@ public:
     using Params = ParamsT;
     using Scalar = typename Traits::Scalar;
 
+    //! Caller-owned lookup cursors of the nested two-phase material laws. They can be
+    //! used with all approaches.
+    using Cursor = typename TwoPhaseMaterial::Cursor;
+
     static constexpr int numPhases = 3;
     static constexpr int waterPhaseIdx = Traits::wettingPhaseIdx;
     static constexpr int oilPhaseIdx = Traits::nonWettingPhaseIdx;
@@ -133,37 +139,18 @@ public:
     static void capillaryPressures(ContainerT& values,
                                    const Params& params,
                                    const FluidState& fluidState)
-    {
-        switch (params.approach()) {
-        case EclMultiplexerApproach::EclStone1Approach:
-            Stone1Material::capillaryPressures(values,
-                                               params.template getRealParams<EclMultiplexerApproach::EclStone1Approach>(),
-                                               fluidState);
-            break;
+    { capillaryPressures_(values, params, fluidState); }
 
-        case EclMultiplexerApproach::EclStone2Approach:
-            Stone2Material::capillaryPressures(values,
-                                               params.template getRealParams<EclMultiplexerApproach::EclStone2Approach>(),
-                                               fluidState);
-            break;
-
-        case EclMultiplexerApproach::EclDefaultApproach:
-            DefaultMaterial::capillaryPressures(values,
-                                                params.template getRealParams<EclMultiplexerApproach::EclDefaultApproach>(),
-                                                fluidState);
-            break;
-
-        case EclMultiplexerApproach::EclTwoPhaseApproach:
-            TwoPhaseMaterial::capillaryPressures(values,
-                                                 params.template getRealParams<EclMultiplexerApproach::EclTwoPhaseApproach>(),
-                                                 fluidState);
-            break;
-
-        case EclMultiplexerApproach::EclOnePhaseApproach:
-            values[0] = 0.0;
-            break;
-        }
-    }
+    /*!
+     * \brief The same as capillaryPressures(values, params, fluidState), but the two-phase
+     *        curves are looked up using the caller-owned cursors of a cell.
+     */
+    template <class ContainerT, class FluidState>
+    static void capillaryPressures(ContainerT& values,
+                                   const Params& params,
+                                   const FluidState& fluidState,
+                                   Cursor& cursor)
+    { capillaryPressures_(values, params, fluidState, cursor); }
 
     /*
      * Hysteresis parameters for oil-water
@@ -405,41 +392,18 @@ public:
     static void relativePermeabilities(ContainerT& values,
                                        const Params& params,
                                        const FluidState& fluidState)
-    {
-        switch (params.approach()) {
-        case EclMultiplexerApproach::EclStone1Approach:
-            Stone1Material::relativePermeabilities(values,
-                                                   params.template getRealParams<EclMultiplexerApproach::EclStone1Approach>(),
-                                                   fluidState);
-            break;
-
-        case EclMultiplexerApproach::EclStone2Approach:
-            Stone2Material::relativePermeabilities(values,
-                                                   params.template getRealParams<EclMultiplexerApproach::EclStone2Approach>(),
-                                                   fluidState);
-            break;
-
-        case EclMultiplexerApproach::EclDefaultApproach:
-            DefaultMaterial::relativePermeabilities(values,
-                                                    params.template getRealParams<EclMultiplexerApproach::EclDefaultApproach>(),
-                                                    fluidState);
-            break;
-
-        case EclMultiplexerApproach::EclTwoPhaseApproach:
-            TwoPhaseMaterial::relativePermeabilities(values,
-                                                     params.template getRealParams<EclMultiplexerApproach::EclTwoPhaseApproach>(),
-                                                     fluidState);
-            break;
-
-        case EclMultiplexerApproach::EclOnePhaseApproach:
-            values[0] = 1.0;
-            break;
+    { relativePermeabilities_(values, params, fluidState); }
 
-        default:
-            throw std::logic_error("Not implemented: relativePermeabilities() option for unknown EclMultiplexerApproach (="
-                                   + std::to_string(static_cast<int>(params.approach())) + ")");
-        }
-    }
+    /*!
+     * \brief The same as relativePermeabilities(values, params, fluidState), but the two-phase
+     *        curves are looked up using the caller-owned cursors of a cell.
+     */
+    template <class ContainerT, class FluidState>
+    static void relativePermeabilities(ContainerT& values,
+                                       const Params& params,
+                                       const FluidState& fluidState,
+                                       Cursor& cursor)
+    { relativePermeabilities_(values, params, fluidState, cursor); }
 
     /*!
      * \brief The relative permeability of oil in oil/gas system.
@@ -566,6 +530,95 @@ public:
             break;
         }
     }
+
+private:
+    template <class ContainerT, class FluidState, class... CursorT>
+    static void capillaryPressures_(ContainerT& values,
+                                    const Params& params,
+                                    const FluidState& fluidState,
+                                    CursorT&... cursor)
+    {
+        OPM_DENSEAD_COUNT_SCOPE("EclMultiplexerMaterial::capillaryPressures");
+        switch (params.approach()) {
+        case EclMultiplexerApproach::EclStone1Approach:
+            Stone1Material::capillaryPressures(values,
+                                               params.template getRealParams<EclMultiplexerApproach::EclStone1Approach>(),
+                                               fluidState,
+                                               cursor...);
+            break;
+
+        case EclMultiplexerApproach::EclStone2Approach:
+            Stone2Material::capillaryPressures(values,
+                                               params.template getRealParams<EclMultiplexerApproach::EclStone2Approach>(),
+                                               fluidState,
+                                               cursor...);
+            break;
+
+        case EclMultiplexerApproach::EclDefaultApproach:
+            DefaultMaterial::capillaryPressures(values,
+                                                params.template getRealParams<EclMultiplexerApproach::EclDefaultApproach>(),
+                                                fluidState,
+                                                cursor...);
+            break;
+
+        case EclMultiplexerApproach::EclTwoPhaseApproach:
+            TwoPhaseMaterial::capillaryPressures(values,
+                                                 params.template getRealParams<EclMultiplexerApproach::EclTwoPhaseApproach>(),
+                                                 fluidState,
+                                                 cursor...);
+            break;
+
+        case EclMultiplexerApproach::EclOnePhaseApproach:
+            values[0] = 0.0;
+            break;
+        }
+    }
+
+    template <class ContainerT, class FluidState, class... CursorT>
+    static void relativePermeabilities_(ContainerT& values,
+                                        const Params& params,
+                                        const FluidState& fluidState,
+                                        CursorT&... cursor)
+    {
+        OPM_DENSEAD_COUNT_SCOPE("EclMultiplexerMaterial::relativePermeabilities");
+        switch (params.approach()) {
+        case EclMultiplexerApproach::EclStone1Approach:
+            Stone1Material::relativePermeabilities(values,
+                                                   params.template getRealParams<EclMultiplexerApproach::EclStone1Approach>(),
+                                                   fluidState,
+                                                   cursor...);
+            break;
+
+        case EclMultiplexerApproach::EclStone2Approach:
+            Stone2Material::relativePermeabilities(values,
+                                                   params.template getRealParams<EclMultiplexerApproach::EclStone2Approach>(),
+                                                   fluidState,
+                                                   cursor...);
+            break;
+
+        case EclMultiplexerApproach::EclDefaultApproach:
+            DefaultMaterial::relativePermeabilities(values,
+                                                    params.template getRealParams<EclMultiplexerApproach::EclDefaultApproach>(),
+                                                    fluidState,
+                                                    cursor...);
+            break;
+
+        case EclMultiplexerApproach::EclTwoPhaseApproach:
+            TwoPhaseMaterial::relativePermeabilities(values,
+                                                     params.template getRealParams<EclMultiplexerApproach::EclTwoPhaseApproach>(),
+                                                     fluidState,
+                                                     cursor...);
+            break;
+
+        case EclMultiplexerApproach::EclOnePhaseApproach:
+            values[0] = 1.0;
+            break;
+
+        default:
+            throw std::logic_error("Not implemented: relativePermeabilities() option for unknown EclMultiplexerApproach (="
+                                   + std::to_string(static_cast<int>(params.approach())) + ")");
+        }
+    }
 };
 
 } // namespace Opm
@@ -28,6 +28,7 @@
 #define OPM_ECL_STONE1_MATERIAL_HPP
 
 #include "EclStone1MaterialParams.hpp"
+#include "MaterialLawCursor.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/MathToolbox.hpp>
@@ -88,6 +89,15 @@ public:
     using Params = ParamsT;
     using Scalar = typename Traits::Scalar;
 
+    /*!
+     * \brief Caller-owned lookup cursors of the nested two-phase material laws.
+     */
+    struct Cursor
+    {
+        MaterialLawCursor<GasOilMaterialLaw> gasOil;
+        MaterialLawCursor<OilWaterMaterialLaw> oilWater;
+    };
+
     static constexpr int numPhases = 3;
     static constexpr int waterPhaseIdx = Traits::wettingPhaseIdx;
     static constexpr int oilPhaseIdx = Traits::nonWettingPhaseIdx;
@@ -135,15 +145,21 @@ public:
     static void capillaryPressures(ContainerT& values,
                                    const Params& params,
                                    const FluidState& state)
-    {
-        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
-        values[gasPhaseIdx] = pcgn<FluidState, Evaluation>(params, state);
-        values[oilPhaseIdx] = 0;
-        values[waterPhaseIdx] = - pcnw<FluidState, Evaluation>(params, state);
-        Valgrind::CheckDefined(values[gasPhaseIdx]);
-        Valgrind::CheckDefined(values[oilPhaseIdx]);
-        Valgrind::CheckDefined(values[waterPhaseIdx]);
-    }
+    { capillaryPressures_(values, params, state, static_cast<Cursor*>(nullptr)); }
+
+    /*!
+     * \brief The same as capillaryPressures(values, params, state), but the two-phase
+     *        curves are looked up using caller-owned cursors.
+     *
+     * \param cursor The cursors of the cell, e.g., a Cursor object. It must provide
+     *               the gasOil and oilWater members.
+     */
+    template <class ContainerT, class FluidState, class CursorT>
+    static void capillaryPressures(ContainerT& values,
+                                   const Params& params,
+                                   const FluidState& state,
+                                   CursorT& cursor)
+    { capillaryPressures_(values, params, state, &cursor); }
 
     /*
      * Hysteresis parameters for oil-water
@@ -222,13 +238,15 @@ public:
      * p_{c,gn} = p_g - p_n
      * \f]
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation pcgn(const Params& params,
-                           const FluidState& fs)
+                           const FluidState& fs,
+                           CursorT* cursor = nullptr)
     {
         // Maximum attainable oil saturation is 1-SWL
         const auto Sw = 1.0 - params.Swl() - decay<Evaluation>(fs.saturation(gasPhaseIdx));
-        return GasOilMaterialLaw::twoPhaseSatPcnw(params.gasOilParams(), Sw);
+        return TwoPhaseSatLookup::pcnw<GasOilMaterialLaw>(params.gasOilParams(), Sw,
+                                                          gasOilCursor_(cursor));
     }
 
     /*!
@@ -240,14 +258,16 @@ public:
      * p_{c,nw} = p_n - p_w
      * \f]
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation pcnw(const Params& params,
-                           const FluidState& fs)
+                           const FluidState& fs,
+                           CursorT* cursor = nullptr)
     {
         const auto Sw = decay<Evaluation>(fs.saturation(waterPhaseIdx));
         Valgrind::CheckDefined(Sw);
 
-        const auto result = OilWaterMaterialLaw::twoPhaseSatPcnw(params.oilWaterParams(), Sw);
+        const auto result = TwoPhaseSatLookup::pcnw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                                         oilWaterCursor_(cursor));
         Valgrind::CheckDefined(result);
 
         return result;
@@ -313,43 +333,56 @@ public:
     static void relativePermeabilities(ContainerT& values,
                                        const Params& params,
                                        const FluidState& fluidState)
-    {
-        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+    { relativePermeabilities_(values, params, fluidState, static_cast<Cursor*>(nullptr)); }
 
-        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState);
-        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState);
-        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState);
-    }
+    /*!
+     * \brief The same as relativePermeabilities(values, params, fluidState), but the two-phase
+     *        curves are looked up using caller-owned cursors.
+     *
+     * \param cursor The cursors of the cell, e.g., a Cursor object. It must provide
+     *               the gasOil and oilWater members.
+     */
+    template <class ContainerT, class FluidState, class CursorT>
+    static void relativePermeabilities(ContainerT& values,
+                                       const Params& params,
+                                       const FluidState& fluidState,
+                                       CursorT& cursor)
+    { relativePermeabilities_(values, params, fluidState, &cursor); }
 
     /*!
      * \brief The relative permeability of the gas phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krg(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         // Maximum attainable oil saturation is 1-SWL,
         const Evaluation Sw = 1 - params.Swl() - decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
-        return GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), Sw);
+        return TwoPhaseSatLookup::krn<GasOilMaterialLaw>(params.gasOilParams(), Sw,
+                                                         gasOilCursor_(cursor));
     }
 
     /*!
      * \brief The relative permeability of the wetting phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krw(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         const Evaluation Sw = decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
-        return OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
+        return TwoPhaseSatLookup::krw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                           oilWaterCursor_(cursor));
     }
 
     /*!
      * \brief The relative permeability of the non-wetting (i.e., oil) phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krn(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         // the Eclipse docu is inconsistent with naming the variable of connate water: In
         // some places the connate water saturation is represented by "Swl", in others
@@ -362,8 +395,8 @@ public:
         const Evaluation Sw = decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
         const Evaluation Sg = decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
-        const Evaluation kro_ow = relpermOilInOilWaterSystem<Evaluation>(params, fluidState);
-        const Evaluation kro_go = relpermOilInOilGasSystem<Evaluation>(params, fluidState);
+        const Evaluation kro_ow = relpermOilInOilWaterSystem<Evaluation>(params, fluidState, cursor);
+        const Evaluation kro_go = relpermOilInOilGasSystem<Evaluation>(params, fluidState, cursor);
 
         Evaluation beta;
         if (Sw <= Swco)
@@ -388,25 +421,29 @@ public:
     /*!
      * \brief The relative permeability of oil in oil/gas system.
      */
-    template <class Evaluation, class FluidState>
+    template <class Evaluation, class FluidState, class CursorT = Cursor>
     static Evaluation relpermOilInOilGasSystem(const Params& params,
-                                               const FluidState& fluidState)
+                                               const FluidState& fluidState,
+                                               CursorT* cursor = nullptr)
     {
         const Evaluation Sg = decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
-        return GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), 1 - Sg - params.Swl());
+        return TwoPhaseSatLookup::krw<GasOilMaterialLaw>(params.gasOilParams(), 1 - Sg - params.Swl(),
+                                                         gasOilCursor_(cursor));
     }
 
     /*!
      * \brief The relative permeability of oil in oil/water system.
      */
-    template <class Evaluation, class FluidState>
+    template <class Evaluation, class FluidState, class CursorT = Cursor>
     static Evaluation relpermOilInOilWaterSystem(const Params& params,
-                                                 const FluidState& fluidState)
+                                                 const FluidState& fluidState,
+                                                 CursorT* cursor = nullptr)
     {
         const Evaluation Sw = decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
 
-        return OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
+        return TwoPhaseSatLookup::krn<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                           oilWaterCursor_(cursor));
     }
 
     /*!
@@ -428,6 +465,43 @@ public:
                                      /*krwSw=*/ 1.0 - Swco - Sg,
                                      /*krnSw=*/ 1.0 - Swco - Sg);
     }
+
+private:
+    template <class CursorT>
+    static auto gasOilCursor_(CursorT* cursor) -> decltype(&cursor->gasOil)
+    { return cursor ? &cursor->gasOil : nullptr; }
+
+    template <class CursorT>
+    static auto oilWaterCursor_(CursorT* cursor) -> decltype(&cursor->oilWater)
+    { return cursor ? &cursor->oilWater : nullptr; }
+
+    template <class ContainerT, class FluidState, class CursorT>
+    static void capillaryPressures_(ContainerT& values,
+                                    const Params& params,
+                                    const FluidState& state,
+                                    CursorT* cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+        values[gasPhaseIdx] = pcgn<FluidState, Evaluation>(params, state, cursor);
+        values[oilPhaseIdx] = 0;
+        values[waterPhaseIdx] = - pcnw<FluidState, Evaluation>(params, state, cursor);
+        Valgrind::CheckDefined(values[gasPhaseIdx]);
+        Valgrind::CheckDefined(values[oilPhaseIdx]);
+        Valgrind::CheckDefined(values[waterPhaseIdx]);
+    }
+
+    template <class ContainerT, class FluidState, class CursorT>
+    static void relativePermeabilities_(ContainerT& values,
+                                        const Params& params,
+                                        const FluidState& fluidState,
+                                        CursorT* cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+
+        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState, cursor);
+        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState, cursor);
+        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState, cursor);
+    }
 };
 
 } // namespace Opm
@@ -28,6 +28,7 @@
 #define OPM_ECL_STONE2_MATERIAL_HPP
 
 #include "EclStone2MaterialParams.hpp"
+#include "MaterialLawCursor.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/MathToolbox.hpp>
@@ -89,6 +90,15 @@ public:
     using Params = ParamsT;
     using Scalar = typename Traits::Scalar;
 
+    /*!
+     * \brief Caller-owned lookup cursors of the nested two-phase material laws.
+     */
+    struct Cursor
+    {
+        MaterialLawCursor<GasOilMaterialLaw> gasOil;
+        MaterialLawCursor<OilWaterMaterialLaw> oilWater;
+    };
+
     static constexpr int numPhases = 3;
     static constexpr int waterPhaseIdx = Traits::wettingPhaseIdx;
     static constexpr int oilPhaseIdx = Traits::nonWettingPhaseIdx;
@@ -136,15 +146,21 @@ public:
     static void capillaryPressures(ContainerT& values,
                                    const Params& params,
                                    const FluidState& state)
-    {
-        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
-        values[gasPhaseIdx] = pcgn<FluidState, Evaluation>(params, state);
-        values[oilPhaseIdx] = 0;
-        values[waterPhaseIdx] = - pcnw<FluidState, Evaluation>(params, state);
-        Valgrind::CheckDefined(values[gasPhaseIdx]);
-        Valgrind::CheckDefined(values[oilPhaseIdx]);
-        Valgrind::CheckDefined(values[waterPhaseIdx]);
-    }
+    { capillaryPressures_(values, params, state, static_cast<Cursor*>(nullptr)); }
+
+    /*!
+     * \brief The same as capillaryPressures(values, params, state), but the two-phase
+     *        curves are looked up using caller-owned cursors.
+     *
+     * \param cursor The cursors of the cell, e.g., a Cursor object. It must provide
+     *               the gasOil and oilWater members.
+     */
+    template <class ContainerT, class FluidState, class CursorT>
+    static void capillaryPressures(ContainerT& values,
+                                   const Params& params,
+                                   const FluidState& state,
+                                   CursorT& cursor)
+    { capillaryPressures_(values, params, state, &cursor); }
 
     /*
      * Hysteresis parameters for oil-water
@@ -223,13 +239,15 @@ public:
      * p_{c,gn} = p_g - p_n
      * \f]
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation pcgn(const Params& params,
-                           const FluidState& fs)
+                           const FluidState& fs,
+                           CursorT* cursor = nullptr)
     {
         // Maximum attainable oil saturation is 1-SWL.
         const auto Sw = 1.0 - params.Swl() - decay<Evaluation>(fs.saturation(gasPhaseIdx));
-        return GasOilMaterialLaw::twoPhaseSatPcnw(params.gasOilParams(), Sw);
+        return TwoPhaseSatLookup::pcnw<GasOilMaterialLaw>(params.gasOilParams(), Sw,
+                                                          gasOilCursor_(cursor));
     }
 
     /*!
@@ -241,14 +259,16 @@ public:
      * p_{c,nw} = p_n - p_w
      * \f]
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation pcnw(const Params& params,
-                           const FluidState& fs)
+                           const FluidState& fs,
+                           CursorT* cursor = nullptr)
     {
         const auto Sw = decay<Evaluation>(fs.saturation(waterPhaseIdx));
         Valgrind::CheckDefined(Sw);
 
-        const auto result = OilWaterMaterialLaw::twoPhaseSatPcnw(params.oilWaterParams(), Sw);
+        const auto result = TwoPhaseSatLookup::pcnw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                                         oilWaterCursor_(cursor));
         Valgrind::CheckDefined(result);
 
         return result;
@@ -314,54 +334,70 @@ public:
     static void relativePermeabilities(ContainerT& values,
                                        const Params& params,
                                        const FluidState& fluidState)
-    {
-        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+    { relativePermeabilities_(values, params, fluidState, static_cast<Cursor*>(nullptr)); }
 
-        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState);
-        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState);
-        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState);
-    }
+    /*!
+     * \brief The same as relativePermeabilities(values, params, fluidState), but the two-phase
+     *        curves are looked up using caller-owned cursors.
+     *
+     * \param cursor The cursors of the cell, e.g., a Cursor object. It must provide
+     *               the gasOil and oilWater members.
+     */
+    template <class ContainerT, class FluidState, class CursorT>
+    static void relativePermeabilities(ContainerT& values,
+                                       const Params& params,
+                                       const FluidState& fluidState,
+                                       CursorT& cursor)
+    { relativePermeabilities_(values, params, fluidState, &cursor); }
 
     /*!
      * \brief The relative permeability of the gas phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krg(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         // Maximum attainable oil saturation is 1-SWL.
         const Evaluation Sw = 1 - params.Swl() - decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
-        return GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), Sw);
+        return TwoPhaseSatLookup::krn<GasOilMaterialLaw>(params.gasOilParams(), Sw,
+                                                         gasOilCursor_(cursor));
     }
 
     /*!
      * \brief The relative permeability of the wetting phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krw(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         const Evaluation Sw = decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
-        return OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
+        return TwoPhaseSatLookup::krw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                           oilWaterCursor_(cursor));
     }
 
     /*!
      * \brief The relative permeability of the non-wetting (i.e., oil) phase.
      */
-    template <class FluidState, class Evaluation = typename FluidState::Scalar>
+    template <class FluidState, class Evaluation = typename FluidState::Scalar, class CursorT = Cursor>
     static Evaluation krn(const Params& params,
-                          const FluidState& fluidState)
+                          const FluidState& fluidState,
+                          CursorT* cursor = nullptr)
     {
         const Scalar Swco = params.Swl();
 
         const Evaluation Sw = decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
         const Evaluation Sg = decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
+        // the cursor is not used for this lookup because it is made at a fixed saturation
         const Scalar krocw = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Swco);
-        const Evaluation krow = relpermOilInOilWaterSystem<Evaluation>(params, fluidState);
-        const Evaluation krw = OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
-        const Evaluation krg = GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), 1 - Swco - Sg);
-        const Evaluation krog = relpermOilInOilGasSystem<Evaluation>(params, fluidState);
+        const Evaluation krow = relpermOilInOilWaterSystem<Evaluation>(params, fluidState, cursor);
+        const Evaluation krw = TwoPhaseSatLookup::krw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                                           oilWaterCursor_(cursor));
+        const Evaluation krg = TwoPhaseSatLookup::krn<GasOilMaterialLaw>(params.gasOilParams(), 1 - Swco - Sg,
+                                                                         gasOilCursor_(cursor));
+        const Evaluation krog = relpermOilInOilGasSystem<Evaluation>(params, fluidState, cursor);
 
         return max(krocw * ((krow/krocw + krw) * (krog/krocw + krg) - krw - krg), Evaluation{0});
     }
@@ -370,27 +406,31 @@ public:
     /*!
      * \brief The relative permeability of oil in oil/gas system.
      */
-    template <class Evaluation, class FluidState>
+    template <class Evaluation, class FluidState, class CursorT = Cursor>
     static Evaluation relpermOilInOilGasSystem(const Params& params,
-                                               const FluidState& fluidState)
+                                               const FluidState& fluidState,
+                                               CursorT* cursor = nullptr)
     {
         const Scalar Swco = params.Swl();
         const Evaluation Sg = decay<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
-        return GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), 1 - Swco - Sg);
+        return TwoPhaseSatLookup::krw<GasOilMaterialLaw>(params.gasOilParams(), 1 - Swco - Sg,
+                                                         gasOilCursor_(cursor));
     }
 
 
     /*!
      * \brief The relative permeability of oil in oil/water system.
      */
-    template <class Evaluation, class FluidState>
+    template <class Evaluation, class FluidState, class CursorT = Cursor>
     static Evaluation relpermOilInOilWaterSystem(const Params& params,
-                                                 const FluidState& fluidState)
+                                                 const FluidState& fluidState,
+                                                 CursorT* cursor = nullptr)
     {
         const Evaluation Sw = decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
 
-        return OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
+        return TwoPhaseSatLookup::krn<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                           oilWaterCursor_(cursor));
     }
 
     /*!
@@ -412,6 +452,43 @@ public:
                                      /*krwSw=*/ 1.0 - Swco - Sg,
                                      /*krnSw=*/ 1.0 - Swco - Sg);
     }
+
+private:
+    template <class CursorT>
+    static auto gasOilCursor_(CursorT* cursor) -> decltype(&cursor->gasOil)
+    { return cursor ? &cursor->gasOil : nullptr; }
+
+    template <class CursorT>
+    static auto oilWaterCursor_(CursorT* cursor) -> decltype(&cursor->oilWater)
+    { return cursor ? &cursor->oilWater : nullptr; }
+
+    template <class ContainerT, class FluidState, class CursorT>
+    static void capillaryPressures_(ContainerT& values,
+                                    const Params& params,
+                                    const FluidState& state,
+                                    CursorT* cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+        values[gasPhaseIdx] = pcgn<FluidState, Evaluation>(params, state, cursor);
+        values[oilPhaseIdx] = 0;
+        values[waterPhaseIdx] = - pcnw<FluidState, Evaluation>(params, state, cursor);
+        Valgrind::CheckDefined(values[gasPhaseIdx]);
+        Valgrind::CheckDefined(values[oilPhaseIdx]);
+        Valgrind::CheckDefined(values[waterPhaseIdx]);
+    }
+
+    template <class ContainerT, class FluidState, class CursorT>
+    static void relativePermeabilities_(ContainerT& values,
+                                        const Params& params,
+                                        const FluidState& fluidState,
+                                        CursorT* cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+
+        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState, cursor);
+        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState, cursor);
+        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState, cursor);
+    }
 };
 
 } // namespace Opm
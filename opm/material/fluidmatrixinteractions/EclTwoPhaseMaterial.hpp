@@ -28,6 +28,7 @@
 #define OPM_ECL_TWO_PHASE_MATERIAL_HPP
 
 #include "EclTwoPhaseMaterialParams.hpp"
+#include "MaterialLawCursor.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/MathToolbox.hpp>
@@ -82,6 +83,16 @@ public:
     using Params = ParamsT;
     using Scalar = typename Traits::Scalar;
 
+    /*!
+     * \brief Caller-owned lookup cursors of the nested two-phase material laws.
+     */
+    struct Cursor
+    {
+        MaterialLawCursor<GasOilMaterialLaw> gasOil;
+        MaterialLawCursor<OilWaterMaterialLaw> oilWater;
+        MaterialLawCursor<GasWaterMaterialLaw> gasWater;
+    };
+
     static constexpr int numPhases = 3;
     static constexpr int waterPhaseIdx = Traits::wettingPhaseIdx;
     static constexpr int oilPhaseIdx = Traits::nonWettingPhaseIdx;
@@ -129,39 +140,21 @@ public:
     static void capillaryPressures(ContainerT& values,
                                    const Params& params,
                                    const FluidState& fluidState)
-    {
-        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+    { capillaryPressures_(values, params, fluidState, static_cast<Cursor*>(nullptr)); }
 
-        switch (params.approach()) {
-        case EclTwoPhaseApproach::EclTwoPhaseGasOil: {
-            const Evaluation& So =
-                decay<Evaluation>(fluidState.saturation(oilPhaseIdx));
-
-            values[oilPhaseIdx] = 0.0;
-            values[gasPhaseIdx] = GasOilMaterialLaw::twoPhaseSatPcnw(params.gasOilParams(), So);
-            break;
-        }
-
-        case EclTwoPhaseApproach::EclTwoPhaseOilWater: {
-            const Evaluation& Sw =
-                decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
-
-            values[waterPhaseIdx] = 0.0;
-            values[oilPhaseIdx] = OilWaterMaterialLaw::twoPhaseSatPcnw(params.oilWaterParams(), Sw);
-            break;
-        }
-
-        case EclTwoPhaseApproach::EclTwoPhaseGasWater: {
-            const Evaluation& Sw =
-                decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
-
-            values[waterPhaseIdx] = 0.0;           
-            values[gasPhaseIdx] = GasWaterMaterialLaw::twoPhaseSatPcnw(params.gasWaterParams(), Sw);
-            break;
-        }
-
-        }
-    }
+    /*!
+     * \brief The same as capillaryPressures(values, params, fluidState), but the two-phase
+     *        curves are looked up using caller-owned cursors.
+     *
+     * \param cursor The cursors of the cell, e.g., a Cursor object. It must provide
+     *               the gasOil, oilWater and gasWater members.
+     */
+    template <class ContainerT, class FluidState, class CursorT>
+    static void capillaryPressures(ContainerT& values,
+                                   const Params& params,
+                                   const FluidState& fluidState,
+                                   CursorT& cursor)
+    { capillaryPressures_(values, params, fluidState, &cursor); }
 
     /*
      * Hysteresis parameters for oil-water
@@ -317,39 +310,21 @@ public:
     static void relativePermeabilities(ContainerT& values,
                                        const Params& params,
                                        const FluidState& fluidState)
-    {
-        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+    { relativePermeabilities_(values, params, fluidState, static_cast<Cursor*>(nullptr)); }
 
-        switch (params.approach()) {
-        case EclTwoPhaseApproach::EclTwoPhaseGasOil: {
-            const Evaluation& So =
-                decay<Evaluation>(fluidState.saturation(oilPhaseIdx));
-
-            values[oilPhaseIdx] = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), So);
-            values[gasPhaseIdx] = GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), So);
-            break;
-        }
-
-        case EclTwoPhaseApproach::EclTwoPhaseOilWater: {
-            const Evaluation& Sw =
-                decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
-
-            values[waterPhaseIdx] = OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
-            values[oilPhaseIdx] = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
-            break;
-        }
-
-        case EclTwoPhaseApproach::EclTwoPhaseGasWater: {
-            const Evaluation& Sw =
-                decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
-            
-            values[waterPhaseIdx] = GasWaterMaterialLaw::twoPhaseSatKrw(params.gasWaterParams(), Sw);
-            values[gasPhaseIdx] = GasWaterMaterialLaw::twoPhaseSatKrn(params.gasWaterParams(), Sw);
-
-            break;
-        }
-        }
-    }
+    /*!
+     * \brief The same as relativePermeabilities(values, params, fluidState), but the two-phase
+     *        curves are looked up using caller-owned cursors.
+     *
+     * \param cursor The cursors of the cell, e.g., a Cursor object. It must provide
+     *               the gasOil, oilWater and gasWater members.
+     */
+    template <class ContainerT, class FluidState, class CursorT>
+    static void relativePermeabilities(ContainerT& values,
+                                       const Params& params,
+                                       const FluidState& fluidState,
+                                       CursorT& cursor)
+    { relativePermeabilities_(values, params, fluidState, &cursor); }
 
     /*!
      * \brief The relative permeability of the gas phase.
@@ -415,6 +390,106 @@ public:
         }
         }
     }
+
+private:
+    template <class CursorT>
+    static auto gasOilCursor_(CursorT* cursor) -> decltype(&cursor->gasOil)
+    { return cursor ? &cursor->gasOil : nullptr; }
+
+    template <class CursorT>
+    static auto oilWaterCursor_(CursorT* cursor) -> decltype(&cursor->oilWater)
+    { return cursor ? &cursor->oilWater : nullptr; }
+
+    template <class CursorT>
+    static auto gasWaterCursor_(CursorT* cursor) -> decltype(&cursor->gasWater)
+    { return cursor ? &cursor->gasWater : nullptr; }
+
+    template <class ContainerT, class FluidState, class CursorT>
+    static void capillaryPressures_(ContainerT& values,
+                                    const Params& params,
+                                    const FluidState& fluidState,
+                                    CursorT* cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+
+        switch (params.approach()) {
+        case EclTwoPhaseApproach::EclTwoPhaseGasOil: {
+            const Evaluation& So =
+                decay<Evaluation>(fluidState.saturation(oilPhaseIdx));
+
+            values[oilPhaseIdx] = 0.0;
+            values[gasPhaseIdx] = TwoPhaseSatLookup::pcnw<GasOilMaterialLaw>(params.gasOilParams(), So,
+                                                                             gasOilCursor_(cursor));
+            break;
+        }
+
+        case EclTwoPhaseApproach::EclTwoPhaseOilWater: {
+            const Evaluation& Sw =
+                decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
+
+            values[waterPhaseIdx] = 0.0;
+            values[oilPhaseIdx] = TwoPhaseSatLookup::pcnw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                                               oilWaterCursor_(cursor));
+            break;
+        }
+
+        case EclTwoPhaseApproach::EclTwoPhaseGasWater: {
+            const Evaluation& Sw =
+                decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
+
+            values[waterPhaseIdx] = 0.0;           
+            values[gasPhaseIdx] = TwoPhaseSatLookup::pcnw<GasWaterMaterialLaw>(params.gasWaterParams(), Sw,
+                                                                               gasWaterCursor_(cursor));
+            break;
+        }
+
+        }
+    }
+
+    template <class ContainerT, class FluidState, class CursorT>
+    static void relativePermeabilities_(ContainerT& values,
+                                        const Params& params,
+                                        const FluidState& fluidState,
+                                        CursorT* cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+
+        switch (params.approach()) {
+        case EclTwoPhaseApproach::EclTwoPhaseGasOil: {
+            const Evaluation& So =
+                decay<Evaluation>(fluidState.saturation(oilPhaseIdx));
+
+            values[oilPhaseIdx] = TwoPhaseSatLookup::krw<GasOilMaterialLaw>(params.gasOilParams(), So,
+                                                                            gasOilCursor_(cursor));
+            values[gasPhaseIdx] = TwoPhaseSatLookup::krn<GasOilMaterialLaw>(params.gasOilParams(), So,
+                                                                            gasOilCursor_(cursor));
+            break;
+        }
+
+        case EclTwoPhaseApproach::EclTwoPhaseOilWater: {
+            const Evaluation& Sw =
+                decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
+
+            values[waterPhaseIdx] = TwoPhaseSatLookup::krw<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                                                oilWaterCursor_(cursor));
+            values[oilPhaseIdx] = TwoPhaseSatLookup::krn<OilWaterMaterialLaw>(params.oilWaterParams(), Sw,
+                                                                              oilWaterCursor_(cursor));
+            break;
+        }
+
+        case EclTwoPhaseApproach::EclTwoPhaseGasWater: {
+            const Evaluation& Sw =
+                decay<Evaluation>(fluidState.saturation(waterPhaseIdx));
+            
+            values[waterPhaseIdx] = TwoPhaseSatLookup::krw<GasWaterMaterialLaw>(params.gasWaterParams(), Sw,
+                                                                                gasWaterCursor_(cursor));
+            values[gasPhaseIdx] = TwoPhaseSatLookup::krn<GasWaterMaterialLaw>(params.gasWaterParams(), Sw,
+                                                                              gasWaterCursor_(cursor));
+
+            break;
+        }
+        }
+    }
 };
 
 } // namespace Opm
@@ -0,0 +1,144 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Lookup cursors of nested two-phase material laws.
+ */
+#ifndef OPM_MATERIAL_LAW_CURSOR_HPP
+#define OPM_MATERIAL_LAW_CURSOR_HPP
+
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief The cursor of the material laws which do not use one.
+ */
+struct NullMaterialLawCursor
+{};
+
+template <class MaterialLaw, class = void>
+struct MaterialLawCursorType
+{ using type = NullMaterialLawCursor; };
+
+template <class MaterialLaw>
+struct MaterialLawCursorType<MaterialLaw, std::void_t<typename MaterialLaw::Cursor>>
+{ using type = typename MaterialLaw::Cursor; };
+
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief The caller-owned lookup cursor of a material law.
+ *
+ * This is MaterialLaw::Cursor if the material law provides it and
+ * NullMaterialLawCursor otherwise.
+ */
+template <class MaterialLaw>
+using MaterialLawCursor = typename MaterialLawCursorType<MaterialLaw>::type;
+
+/*!
+ * \brief Functions which evaluate the two-phase saturation API of a material law with
+ *        an optional lookup cursor.
+ *
+ * If the cursor is a null pointer or the material law does not accept a cursor, the
+ * plain methods are called.
+ */
+namespace TwoPhaseSatLookup {
+
+// the overloads taking an int are selected if the material law accepts the cursor, the
+// ones taking a long are the fallbacks
+template <class MaterialLaw, class Evaluation, class Cursor>
+auto pcnw_(int, const typename MaterialLaw::Params& params, const Evaluation& Sw, Cursor& cursor)
+    -> decltype(MaterialLaw::twoPhaseSatPcnw(params, Sw, cursor))
+{ return MaterialLaw::twoPhaseSatPcnw(params, Sw, cursor); }
+
+template <class MaterialLaw, class Evaluation, class Cursor>
+Evaluation pcnw_(long, const typename MaterialLaw::Params& params, const Evaluation& Sw, Cursor&)
+{ return MaterialLaw::twoPhaseSatPcnw(params, Sw); }
+
+template <class MaterialLaw, class Evaluation, class Cursor>
+auto krw_(int, const typename MaterialLaw::Params& params, const Evaluation& Sw, Cursor& cursor)
+    -> decltype(MaterialLaw::twoPhaseSatKrw(params, Sw, cursor))
+{ return MaterialLaw::twoPhaseSatKrw(params, Sw, cursor); }
+
+template <class MaterialLaw, class Evaluation, class Cursor>
+Evaluation krw_(long, const typename MaterialLaw::Params& params, const Evaluation& Sw, Cursor&)
+{ return MaterialLaw::twoPhaseSatKrw(params, Sw); }
+
+template <class MaterialLaw, class Evaluation, class Cursor>
+auto krn_(int, const typename MaterialLaw::Params& params, const Evaluation& Sw, Cursor& cursor)
+    -> decltype(MaterialLaw::twoPhaseSatKrn(params, Sw, cursor))
+{ return MaterialLaw::twoPhaseSatKrn(params, Sw, cursor); }
+
+template <class MaterialLaw, class Evaluation, class Cursor>
+Evaluation krn_(long, const typename MaterialLaw::Params& params, const Evaluation& Sw, Cursor&)
+{ return MaterialLaw::twoPhaseSatKrn(params, Sw); }
+
+/*!
+ * \brief The capillary pressure of a two-phase material law.
+ */
+template <class MaterialLaw, class Evaluation>
+Evaluation pcnw(const typename MaterialLaw::Params& params,
+                const Evaluation& Sw,
+                MaterialLawCursor<MaterialLaw>* cursor)
+{
+    if (!cursor)
+        return MaterialLaw::twoPhaseSatPcnw(params, Sw);
+    return pcnw_<MaterialLaw>(/*preferCursor=*/0, params, Sw, *cursor);
+}
+
+/*!
+ * \brief The relative permeability of the wetting phase of a two-phase material law.
+ */
+template <class MaterialLaw, class Evaluation>
+Evaluation krw(const typename MaterialLaw::Params& params,
+               const Evaluation& Sw,
+               MaterialLawCursor<MaterialLaw>* cursor)
+{
+    if (!cursor)
+        return MaterialLaw::twoPhaseSatKrw(params, Sw);
+    return krw_<MaterialLaw>(/*preferCursor=*/0, params, Sw, *cursor);
+}
+
+/*!
+ * \brief The relative permeability of the non-wetting phase of a two-phase material
+ *        law.
+ */
+template <class MaterialLaw, class Evaluation>
+Evaluation krn(const typename MaterialLaw::Params& params,
+               const Evaluation& Sw,
+               MaterialLawCursor<MaterialLaw>* cursor)
+{
+    if (!cursor)
+        return MaterialLaw::twoPhaseSatKrn(params, Sw);
+    return krn_<MaterialLaw>(/*preferCursor=*/0, params, Sw, *cursor);
+}
+
+} // namespace TwoPhaseSatLookup
+
+} // namespace Opm
+
+#endif
@@ -29,8 +29,12 @@
 
 #include "PiecewiseLinearTwoPhaseMaterialParams.hpp"
 
+#include <opm/material/common/Exceptions.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/RangeCheckPolicy.hpp>
+#include <opm/material/common/SegmentCursor.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 #include <type_traits>
 
@@ -44,8 +48,14 @@ namespace Opm {
  * It would be equally possible to use cubic splines, but since the
  * ECLIPSE reservoir simulator uses linear interpolation for capillary
  * pressure and relperm curves, we do the same.
+ *
+ * \tparam RangeCheckPolicy Specifies how saturations outside of the range of the
+ *                          sampling points are dealt with. By default, the curves are
+ *                          continued by the value at the closest sampling point.
  */
-template <class TraitsT, class ParamsT = PiecewiseLinearTwoPhaseMaterialParams<TraitsT> >
+template <class TraitsT,
+          class ParamsT = PiecewiseLinearTwoPhaseMaterialParams<TraitsT>,
+          class RangeCheckPolicy = RangeCheck::Clamped>
 class PiecewiseLinearTwoPhaseMaterial : public TraitsT
 {
     using ValueVector = typename ParamsT::ValueVector;
@@ -90,6 +100,21 @@ public:
     //! are dependent on the phase composition
     static constexpr bool isCompositionDependent = false;
 
+    /*!
+     * \brief Caller-owned lookup cursors for the capillary pressure and the relative
+     *        permeability curves.
+     *
+     * A cursor remembers the segment of the last lookup on a curve, so that the
+     * search can be skipped if the saturation of a cell does not change much between
+     * two evaluations.
+     */
+    struct Cursor
+    {
+        SegmentCursor pcnw;
+        SegmentCursor krw;
+        SegmentCursor krn;
+    };
+
     /*!
      * \brief The capillary pressure-saturation curve.
      */
@@ -102,6 +127,22 @@ public:
         values[Traits::nonWettingPhaseIdx] = pcnw<FluidState, Evaluation>(params, fs);
     }
 
+    /*!
+     * \brief The capillary pressure-saturation curve using a lookup cursor.
+     */
+    template <class Container, class FluidState>
+    static void capillaryPressures(Container& values, const Params& params, const FluidState& fs,
+                                   Cursor& cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+
+        const auto& Sw =
+            decay<Evaluation>(fs.saturation(Traits::wettingPhaseIdx));
+
+        values[Traits::wettingPhaseIdx] = 0.0; // reference phase
+        values[Traits::nonWettingPhaseIdx] = twoPhaseSatPcnw(params, Sw, cursor.pcnw);
+    }
+
     /*!
      * \brief The saturations of the fluid phases starting from their
      *        pressure differences.
@@ -122,6 +163,22 @@ public:
         values[Traits::nonWettingPhaseIdx] = krn<FluidState, Evaluation>(params, fs);
     }
 
+    /*!
+     * \brief The relative permeabilities using a lookup cursor
+     */
+    template <class Container, class FluidState>
+    static void relativePermeabilities(Container& values, const Params& params, const FluidState& fs,
+                                       Cursor& cursor)
+    {
+        using Evaluation = typename std::remove_reference<decltype(values[0])>::type;
+
+        const auto& Sw =
+            decay<Evaluation>(fs.saturation(Traits::wettingPhaseIdx));
+
+        values[Traits::wettingPhaseIdx] = twoPhaseSatKrw(params, Sw, cursor.krw);
+        values[Traits::nonWettingPhaseIdx] = twoPhaseSatKrn(params, Sw, cursor.krn);
+    }
+
     /*!
      * \brief The capillary pressure-saturation curve
      */
@@ -141,6 +198,14 @@ public:
     static Evaluation twoPhaseSatPcnw(const Params& params, const Evaluation& Sw)
     { return eval_(params.SwPcwnSamples(), params.pcnwSamples(), Sw); }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatPcnw(const Params& params, const Evaluation& Sw, SegmentCursor& cursor)
+    { return eval_(params.SwPcwnSamples(), params.pcnwSamples(), Sw, &cursor); }
+
+    template <class Evaluation>
+    static Evaluation twoPhaseSatPcnw(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    { return twoPhaseSatPcnw(params, Sw, cursor.pcnw); }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnwInv(const Params& params, const Evaluation& pcnw)
     { return eval_(params.pcnwSamples(), params.SwPcwnSamples(), pcnw); }
@@ -185,6 +250,14 @@ public:
     static Evaluation twoPhaseSatKrw(const Params& params, const Evaluation& Sw)
     { return eval_(params.SwKrwSamples(), params.krwSamples(), Sw); }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrw(const Params& params, const Evaluation& Sw, SegmentCursor& cursor)
+    { return eval_(params.SwKrwSamples(), params.krwSamples(), Sw, &cursor); }
+
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrw(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    { return twoPhaseSatKrw(params, Sw, cursor.krw); }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatKrwInv(const Params& params, const Evaluation& krw)
     { return eval_(params.krwSamples(), params.SwKrwSamples(), krw); }
@@ -206,6 +279,14 @@ public:
     static Evaluation twoPhaseSatKrn(const Params& params, const Evaluation& Sw)
     { return eval_(params.SwKrnSamples(), params.krnSamples(), Sw); }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrn(const Params& params, const Evaluation& Sw, SegmentCursor& cursor)
+    { return eval_(params.SwKrnSamples(), params.krnSamples(), Sw, &cursor); }
+
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrn(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    { return twoPhaseSatKrn(params, Sw, cursor.krn); }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatKrnInv(const Params& params, const Evaluation& krn)
     { return eval_(params.krnSamples(), params.SwKrnSamples(), krn); }
@@ -214,24 +295,41 @@ private:
     template <class Evaluation>
     static Evaluation eval_(const ValueVector& xValues,
                             const ValueVector& yValues,
-                            const Evaluation& x)
+                            const Evaluation& x,
+                            SegmentCursor* cursor = nullptr)
     {
         if (xValues.front() < xValues.back())
-            return evalAscending_(xValues, yValues, x);
-        return evalDescending_(xValues, yValues, x);
+            return evalAscending_(xValues, yValues, x, cursor);
+        return evalDescending_(xValues, yValues, x, cursor);
     }
 
     template <class Evaluation>
     static Evaluation evalAscending_(const ValueVector& xValues,
                                      const ValueVector& yValues,
-                                     const Evaluation& x)
+                                     const Evaluation& x,
+                                     SegmentCursor* cursor)
     {
-        if (x <= xValues.front())
-            return yValues.front();
-        if (x >= xValues.back())
-            return yValues.back();
+        if constexpr (RangeCheckPolicy::clamp) {
+            if (x <= xValues.front())
+                return yValues.front();
+            if (x >= xValues.back())
+                return yValues.back();
+        }
+        else if constexpr (RangeCheckPolicy::check) {
+            if (!(xValues.front() <= x && x <= xValues.back()))
+                reportOutOfRange_(scalarValue(x), xValues);
+        }
 
-        size_t segIdx = findSegmentIndex_(xValues, scalarValue(x));
+        Scalar xv = scalarValue(x);
+        size_t segIdx;
+        if (cursor)
+            segIdx = cursor->find(xValues.size() - 1,
+                                  [&xValues, xv](unsigned i)
+                                  { return xValues[i] < xv && xv <= xValues[i + 1]; },
+                                  [&xValues, xv]()
+                                  { return findSegmentIndex_(xValues, xv); });
+        else
+            segIdx = findSegmentIndex_(xValues, xv);
 
         Scalar x0 = xValues[segIdx];
         Scalar x1 = xValues[segIdx + 1];
@@ -247,14 +345,30 @@ private:
     template <class Evaluation>
     static Evaluation evalDescending_(const ValueVector& xValues,
                                       const ValueVector& yValues,
-                                      const Evaluation& x)
+                                      const Evaluation& x,
+                                      SegmentCursor* cursor)
     {
-        if (x >= xValues.front())
-            return yValues.front();
-        if (x <= xValues.back())
-            return yValues.back();
+        if constexpr (RangeCheckPolicy::clamp) {
+            if (x >= xValues.front())
+                return yValues.front();
+            if (x <= xValues.back())
+                return yValues.back();
+        }
+        else if constexpr (RangeCheckPolicy::check) {
+            if (!(xValues.back() <= x && x <= xValues.front()))
+                reportOutOfRange_(scalarValue(x), xValues);
+        }
 
-        size_t segIdx = findSegmentIndexDescending_(xValues, scalarValue(x));
+        Scalar xv = scalarValue(x);
+        size_t segIdx;
+        if (cursor)
+            segIdx = cursor->find(xValues.size() - 1,
+                                  [&xValues, xv](unsigned i)
+                                  { return xValues[i] >= xv && xv > xValues[i + 1]; },
+                                  [&xValues, xv]()
+                                  { return findSegmentIndexDescending_(xValues, xv); });
+        else
+            segIdx = findSegmentIndexDescending_(xValues, xv);
 
         Scalar x0 = xValues[segIdx];
         Scalar x1 = xValues[segIdx + 1];
@@ -272,10 +386,16 @@ private:
                                  const ValueVector& yValues,
                                  const Evaluation& x)
     {
-        if (x <= xValues.front())
-            return 0.0;
-        if (x >= xValues.back())
-            return 0.0;
+        if constexpr (RangeCheckPolicy::clamp) {
+            if (x <= xValues.front())
+                return 0.0;
+            if (x >= xValues.back())
+                return 0.0;
+        }
+        else if constexpr (RangeCheckPolicy::check) {
+            if (!(xValues.front() <= x && x <= xValues.back()))
+                reportOutOfRange_(scalarValue(x), xValues);
+        }
 
         size_t segIdx = findSegmentIndex_(xValues, scalarValue(x));
 
@@ -288,6 +408,15 @@ private:
         return (y1 - y0)/(x1 - x0);
     }
 
+    [[noreturn]] OPM_COLD_FUNCTION
+    static void reportOutOfRange_(Scalar x, const ValueVector& xValues)
+    {
+        RangeCheck::throwError<NumericalIssue>("Attempt to evaluate a piecewise linear saturation "
+                                               "function at ", x, ", outside of its range [",
+                                               std::min(xValues.front(), xValues.back()), ", ",
+                                               std::max(xValues.front(), xValues.back()), "]");
+    }
+
     static size_t findSegmentIndex_(const ValueVector& xValues, Scalar x)
     {
         assert(xValues.size() > 1); // we need at least two sampling points!
@@ -315,7 +444,7 @@ private:
         assert(xValues.size() > 1); // we need at least two sampling points!
         size_t n = xValues.size() - 1;
         if (x <= xValues.back())
-            return n;
+            return n - 1;
         else if (xValues.front() <= x)
             return 0;
 
@@ -176,6 +176,32 @@ public:
         std::copy(values.begin(), values.end(), krnSamples_.begin());
     }
 
+    bool operator==(const PiecewiseLinearTwoPhaseMaterialParams<TraitsT>& data) const
+    {
+        return SwPcwnSamples_ == data.SwPcwnSamples_ &&
+               SwKrwSamples_ == data.SwKrwSamples_ &&
+               SwKrnSamples_ == data.SwKrnSamples_ &&
+               pcwnSamples_ == data.pcwnSamples_ &&
+               krwSamples_ == data.krwSamples_ &&
+               krnSamples_ == data.krnSamples_;
+    }
+
+    /*!
+     * \brief Write the sampling points to a snapshot or restore them from one.
+     */
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(SwPcwnSamples_);
+        serializer(SwKrwSamples_);
+        serializer(SwKrnSamples_);
+        serializer(pcwnSamples_);
+        serializer(krwSamples_);
+        serializer(krnSamples_);
+        if (serializer.isReading())
+            finalize();
+    }
+
 private:
     void swapOrder_(ValueVector& swValues, ValueVector& values) const
     {
@@ -50,6 +50,10 @@ public:
     using LETTwoPhaseLaw = TwoPhaseLETCurves<Traits>;
     using PLTwoPhaseLaw = PiecewiseLinearTwoPhaseMaterial<Traits>;
 
+    //! Caller-owned lookup cursors of the piecewise linear curves. They are not used
+    //! by the LET curves.
+    using Cursor = typename PLTwoPhaseLaw::Cursor;
+
     //! The number of fluid phases to which this material law applies.
     static constexpr int numPhases = Traits::numPhases;
     static_assert(numPhases == 2,
@@ -194,6 +198,24 @@ public:
         return 0.0;
     }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatPcnw(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    {
+        switch (params.approach()) {
+        case SatCurveMultiplexerApproach::LETApproach:
+            return LETTwoPhaseLaw::twoPhaseSatPcnw(params.template getRealParams<SatCurveMultiplexerApproach::LETApproach>(),
+                                                   Sw);
+            break;
+
+        case SatCurveMultiplexerApproach::PiecewiseLinearApproach:
+            return PLTwoPhaseLaw::twoPhaseSatPcnw(params.template getRealParams<SatCurveMultiplexerApproach::PiecewiseLinearApproach>(),
+                                                  Sw, cursor);
+            break;
+        }
+
+        return 0.0;
+    }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnwInv(const Params&, const Evaluation&)
     {
@@ -309,6 +331,24 @@ public:
         return 0.0;
     }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrw(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    {
+        switch (params.approach()) {
+        case SatCurveMultiplexerApproach::LETApproach:
+            return LETTwoPhaseLaw::twoPhaseSatKrw(params.template getRealParams<SatCurveMultiplexerApproach::LETApproach>(),
+                                                  Sw);
+            break;
+
+        case SatCurveMultiplexerApproach::PiecewiseLinearApproach:
+            return PLTwoPhaseLaw::twoPhaseSatKrw(params.template getRealParams<SatCurveMultiplexerApproach::PiecewiseLinearApproach>(),
+                                                 Sw, cursor);
+            break;
+        }
+
+        return 0.0;
+    }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatKrwInv(const Params&, const Evaluation&)
     {
@@ -355,6 +395,24 @@ public:
         return 0.0;
     }
 
+    template <class Evaluation>
+    static Evaluation twoPhaseSatKrn(const Params& params, const Evaluation& Sw, Cursor& cursor)
+    {
+        switch (params.approach()) {
+        case SatCurveMultiplexerApproach::LETApproach:
+            return LETTwoPhaseLaw::twoPhaseSatKrn(params.template getRealParams<SatCurveMultiplexerApproach::LETApproach>(),
+                                                  Sw);
+            break;
+
+        case SatCurveMultiplexerApproach::PiecewiseLinearApproach:
+            return PLTwoPhaseLaw::twoPhaseSatKrn(params.template getRealParams<SatCurveMultiplexerApproach::PiecewiseLinearApproach>(),
+                                                 Sw, cursor);
+            break;
+        }
+
+        return 0.0;
+    }
+
     template <class Evaluation>
     static Evaluation twoPhaseSatKrnInv(const Params& params, const Evaluation& krn)
     {
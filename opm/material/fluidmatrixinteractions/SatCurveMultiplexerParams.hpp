@@ -155,6 +155,49 @@ public:
         return this->template castTo<PLParams>();
     }
 
+    bool operator==(const SatCurveMultiplexerParams<TraitsT>& data) const
+    {
+        if (approach() != data.approach())
+            return false;
+
+        switch (approach()) {
+        case SatCurveMultiplexerApproach::LETApproach:
+            return castTo<LETParams>() == data.template castTo<LETParams>();
+
+        case SatCurveMultiplexerApproach::PiecewiseLinearApproach:
+            return castTo<PLParams>() == data.template castTo<PLParams>();
+        }
+
+        return true;
+    }
+
+    /*!
+     * \brief Write the parameters to a snapshot or restore them from one.
+     *
+     * Contrary to the copy constructor, this includes the parameters of the
+     * underlying saturation functions.
+     */
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        SatCurveMultiplexerApproach appr = approach_;
+        serializer(appr);
+        if (serializer.isReading()) {
+            realParams_.reset();
+            setApproach(appr);
+        }
+
+        switch (approach()) {
+        case SatCurveMultiplexerApproach::LETApproach:
+            serializer(castTo<LETParams>());
+            break;
+
+        case SatCurveMultiplexerApproach::PiecewiseLinearApproach:
+            serializer(castTo<PLParams>());
+            break;
+        }
+    }
+
 private:
     template <class ParamT>
     ParamT& castTo()
@@ -30,6 +30,8 @@
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/EnsureFinalized.hpp>
 
+#include <algorithm>
+
 namespace Opm {
 
 /*!
@@ -194,6 +196,49 @@ public:
         dSpc_ = 1.0 - letProp[0] - letProp[1];
     }
 
+    bool operator==(const TwoPhaseLETCurvesParams<TraitsT>& data) const
+    {
+        const auto sameCoeffs = [](const Scalar* a, const Scalar* b)
+        { return std::equal(a, a + Traits::numPhases, b); };
+
+        return sameCoeffs(Smin_, data.Smin_) &&
+               sameCoeffs(dS_, data.dS_) &&
+               sameCoeffs(L_, data.L_) &&
+               sameCoeffs(E_, data.E_) &&
+               sameCoeffs(T_, data.T_) &&
+               sameCoeffs(Krt_, data.Krt_) &&
+               Sminpc_ == data.Sminpc_ &&
+               dSpc_ == data.dSpc_ &&
+               Lpc_ == data.Lpc_ &&
+               Epc_ == data.Epc_ &&
+               Tpc_ == data.Tpc_ &&
+               Pcir_ == data.Pcir_ &&
+               Pct_ == data.Pct_;
+    }
+
+    /*!
+     * \brief Write the LET coefficients to a snapshot or restore them from one.
+     */
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(Smin_);
+        serializer(dS_);
+        serializer(L_);
+        serializer(E_);
+        serializer(T_);
+        serializer(Krt_);
+        serializer(Sminpc_);
+        serializer(dSpc_);
+        serializer(Lpc_);
+        serializer(Epc_);
+        serializer(Tpc_);
+        serializer(Pcir_);
+        serializer(Pct_);
+        if (serializer.isReading())
+            finalize();
+    }
+
 private:
     /*!
      * \brief Set the LET coefficients for phase relperm
@@ -0,0 +1,2284 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BlackOilFluidSystemNonStatic
+ */
+#ifndef OPM_BLACK_OIL_FLUID_SYSTEM_NON_STATIC_HPP
+#define OPM_BLACK_OIL_FLUID_SYSTEM_NON_STATIC_HPP
+
+#include "BlackOilDefaultIndexTraits.hpp"
+#include "NullParameterCache.hpp"
+#include "PvtRegionSchedule.hpp"
+#include "blackoilpvt/OilPvtMultiplexer.hpp"
+#include "blackoilpvt/GasPvtMultiplexer.hpp"
+#include "blackoilpvt/WaterPvtMultiplexer.hpp"
+#include "blackoilpvt/PvtCursor.hpp"
+#include "blackoilpvt/PvtLookup.hpp"
+#include "blackoilpvt/BrineCo2Pvt.hpp"
+
+#include <opm/material/Constants.hpp>
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/densead/Expressions.hpp>
+#include <opm/material/densead/OperationCounter.hpp>
+#include <opm/material/common/Valgrind.hpp>
+#include <opm/material/common/HasMemberGeneratorMacros.hpp>
+#include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/BinarySnapshot.hpp>
+
+#if HAVE_ECL_INPUT
+#include <opm/input/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/input/eclipse/EclipseState/Tables/FlatTable.hpp>
+#include <opm/input/eclipse/EclipseState/Tables/TableManager.hpp>
+#endif
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <array>
+
+namespace Opm {
+namespace BlackOil {
+OPM_GENERATE_HAS_MEMBER(Rs, ) // Creates 'HasMember_Rs<T>'.
+OPM_GENERATE_HAS_MEMBER(Rv, ) // Creates 'HasMember_Rv<T>'.
+OPM_GENERATE_HAS_MEMBER(Rvw, ) // Creates 'HasMember_Rvw<T>'.
+OPM_GENERATE_HAS_MEMBER(saltConcentration, )
+OPM_GENERATE_HAS_MEMBER(saltSaturation, )
+
+template <class FluidSystem, class FluidState, class LhsEval>
+LhsEval getRs_(typename std::enable_if<!HasMember_Rs<FluidState>::value, const FluidState&>::type fluidState,
+               unsigned regionIdx)
+{
+    const auto& XoG =
+        decay<LhsEval>(fluidState.massFraction(FluidSystem::oilPhaseIdx, FluidSystem::gasCompIdx));
+    return FluidSystem::convertXoGToRs(XoG, regionIdx);
+}
+
+template <class FluidSystem, class FluidState, class LhsEval>
+auto getRs_(typename std::enable_if<HasMember_Rs<FluidState>::value, const FluidState&>::type fluidState,
+            unsigned)
+    -> decltype(decay<LhsEval>(fluidState.Rs()))
+{ return decay<LhsEval>(fluidState.Rs()); }
+
+template <class FluidSystem, class FluidState, class LhsEval>
+LhsEval getRv_(typename std::enable_if<!HasMember_Rv<FluidState>::value, const FluidState&>::type fluidState,
+               unsigned regionIdx)
+{
+    const auto& XgO =
+        decay<LhsEval>(fluidState.massFraction(FluidSystem::gasPhaseIdx, FluidSystem::oilCompIdx));
+    return FluidSystem::convertXgOToRv(XgO, regionIdx);
+}
+
+template <class FluidSystem, class FluidState, class LhsEval>
+auto getRv_(typename std::enable_if<HasMember_Rv<FluidState>::value, const FluidState&>::type fluidState,
+            unsigned)
+    -> decltype(decay<LhsEval>(fluidState.Rv()))
+{ return decay<LhsEval>(fluidState.Rv()); }
+
+template <class FluidSystem, class FluidState, class LhsEval>
+LhsEval getRvw_(typename std::enable_if<!HasMember_Rvw<FluidState>::value, const FluidState&>::type fluidState,
+               unsigned regionIdx)
+{
+    const auto& XgW =
+        decay<LhsEval>(fluidState.massFraction(FluidSystem::gasPhaseIdx, FluidSystem::waterCompIdx));
+    return FluidSystem::convertXgWToRvw(XgW, regionIdx);
+}
+
+template <class FluidSystem, class FluidState, class LhsEval>
+auto getRvw_(typename std::enable_if<HasMember_Rvw<FluidState>::value, const FluidState&>::type fluidState,
+            unsigned)
+    -> decltype(decay<LhsEval>(fluidState.Rvw()))
+{ return decay<LhsEval>(fluidState.Rvw()); }
+
+template <class FluidSystem, class FluidState, class LhsEval>
+LhsEval getSaltConcentration_(typename std::enable_if<!HasMember_saltConcentration<FluidState>::value,
+                              const FluidState&>::type,
+                              unsigned)
+{return 0.0;}
+
+template <class FluidSystem, class FluidState, class LhsEval>
+auto getSaltConcentration_(typename std::enable_if<HasMember_saltConcentration<FluidState>::value, const FluidState&>::type fluidState,
+            unsigned)
+    -> decltype(decay<LhsEval>(fluidState.saltConcentration()))
+{ return decay<LhsEval>(fluidState.saltConcentration()); }
+
+template <class FluidSystem, class FluidState, class LhsEval>
+LhsEval getSaltSaturation_(typename std::enable_if<!HasMember_saltSaturation<FluidState>::value,
+                              const FluidState&>::type,
+                              unsigned)
+{return 0.0;}
+
+template <class FluidSystem, class FluidState, class LhsEval>
+auto getSaltSaturation_(typename std::enable_if<HasMember_saltSaturation<FluidState>::value, const FluidState&>::type fluidState,
+            unsigned)
+    -> decltype(decay<LhsEval>(fluidState.saltSaturation()))
+{ return decay<LhsEval>(fluidState.saltSaturation()); }
+
+// variants of the helpers above for fluid system objects
+template <class FluidSystem, class FluidState, class LhsEval>
+LhsEval getRs_(const FluidSystem& fluidSystem,
+               typename std::enable_if<!HasMember_Rs<FluidState>::value, const FluidState&>::type fluidState,
+               unsigned regionIdx)
+{
+    const auto& XoG =
+        decay<LhsEval>(fluidState.massFraction(FluidSystem::oilPhaseIdx, FluidSystem::gasCompIdx));
+    return fluidSystem.convertXoGToRs(XoG, regionIdx);
+}
+
+template <class FluidSystem, class FluidState, class LhsEval>
+auto getRs_(const FluidSystem&,
+            typename std::enable_if<HasMember_Rs<FluidState>::value, const FluidState&>::type fluidState,
+            unsigned)
+    -> decltype(decay<LhsEval>(fluidState.Rs()))
+{ return decay<LhsEval>(fluidState.Rs()); }
+
+template <class FluidSystem, class FluidState, class LhsEval>
+LhsEval getRv_(const FluidSystem& fluidSystem,
+               typename std::enable_if<!HasMember_Rv<FluidState>::value, const FluidState&>::type fluidState,
+               unsigned regionIdx)
+{
+    const auto& XgO =
+        decay<LhsEval>(fluidState.massFraction(FluidSystem::gasPhaseIdx, FluidSystem::oilCompIdx));
+    return fluidSystem.convertXgOToRv(XgO, regionIdx);
+}
+
+template <class FluidSystem, class FluidState, class LhsEval>
+auto getRv_(const FluidSystem&,
+            typename std::enable_if<HasMember_Rv<FluidState>::value, const FluidState&>::type fluidState,
+            unsigned)
+    -> decltype(decay<LhsEval>(fluidState.Rv()))
+{ return decay<LhsEval>(fluidState.Rv()); }
+
+template <class FluidSystem, class FluidState, class LhsEval>
+LhsEval getRvw_(const FluidSystem& fluidSystem,
+                typename std::enable_if<!HasMember_Rvw<FluidState>::value, const FluidState&>::type fluidState,
+                unsigned regionIdx)
+{
+    const auto& XgW =
+        decay<LhsEval>(fluidState.massFraction(FluidSystem::gasPhaseIdx, FluidSystem::waterCompIdx));
+    return fluidSystem.convertXgWToRvw(XgW, regionIdx);
+}
+
+template <class FluidSystem, class FluidState, class LhsEval>
+auto getRvw_(const FluidSystem&,
+             typename std::enable_if<HasMember_Rvw<FluidState>::value, const FluidState&>::type fluidState,
+             unsigned)
+    -> decltype(decay<LhsEval>(fluidState.Rvw()))
+{ return decay<LhsEval>(fluidState.Rvw()); }
+
+} // namespace BlackOil
+
+/*!
+ * \brief A black-oil fluid system which keeps its parameters and PVT relations in an
+ *        object instead of in static members.
+ *
+ * This provides the same API as BlackOilFluidSystem, but the methods which depend on
+ * the parameters of the fluid system are non-static. It can thus be used to evaluate
+ * several independently configured models in the same process, e.g., the members of
+ * an ensemble. The reference densities, molar masses and diffusion coefficients are
+ * stored by value. The PVT objects are kept by shared pointers, so copies of a fluid
+ * system share their tables, which are only read after initialization. Once
+ * initialized, the const methods of an object may be called concurrently.
+ *
+ * Note that the methods of BlackOilFluidState which require a fluid system, e.g.,
+ * the conversion of the dissolution factors to mass fractions, use the static
+ * BlackOilFluidSystem.
+ *
+ * By default, the PVT relations are represented by the multiplexer classes which
+ * select the concrete PVT implementation at runtime. If the PVT implementations are
+ * known, they can be specified directly (e.g., LiveOilPvt, WetGasPvt and
+ * ConstantCompressibilityWaterPvt) so that the compiler can inline the table
+ * lookups. Such a specialized fluid system is usually created from a generic one
+ * using the converting constructor or dispatchBlackOilFluidSystem().
+ *
+ * \tparam ScalarT The type used for scalar floating point values
+ * \tparam OilPvtT The class which represents the PVT relations of the oil phase
+ * \tparam GasPvtT The class which represents the PVT relations of the gas phase
+ * \tparam WaterPvtT The class which represents the PVT relations of the water phase
+ */
+template <class ScalarT,
+          class IndexTraits = BlackOilDefaultIndexTraits,
+          class OilPvtT = OilPvtMultiplexer<ScalarT>,
+          class GasPvtT = GasPvtMultiplexer<ScalarT>,
+          class WaterPvtT = WaterPvtMultiplexer<ScalarT> >
+class BlackOilFluidSystemNonStatic
+{
+    using ThisType = BlackOilFluidSystemNonStatic;
+
+    template <class, class, class, class, class>
+    friend class BlackOilFluidSystemNonStatic;
+
+public:
+    using Scalar = ScalarT;
+    using GasPvt = GasPvtT;
+    using OilPvt = OilPvtT;
+    using WaterPvt = WaterPvtT;
+
+    //! The fluid system which uses other classes for the PVT relations
+    template <class OtherOilPvt, class OtherGasPvt, class OtherWaterPvt>
+    using WithPvt = BlackOilFluidSystemNonStatic<Scalar, IndexTraits, OtherOilPvt, OtherGasPvt, OtherWaterPvt>;
+
+    BlackOilFluidSystemNonStatic() = default;
+
+    /*!
+     * \brief Create a fluid system from one which uses other classes for the PVT
+     *        relations.
+     *
+     * All parameters are copied. The PVT objects of the other fluid system must either
+     * be of the same type or be multiplexers which currently use the PVT classes of
+     * this fluid system. In the latter case, the PVT objects are shared with the
+     * multiplexers of the other fluid system, i.e., no tables are copied.
+     *
+     * \throws std::invalid_argument if a PVT multiplexer uses another approach
+     */
+    template <class OtherOilPvt, class OtherGasPvt, class OtherWaterPvt>
+    explicit BlackOilFluidSystemNonStatic(const WithPvt<OtherOilPvt, OtherGasPvt, OtherWaterPvt>& other)
+        : surfacePressure(other.surfacePressure)
+        , surfaceTemperature(other.surfaceTemperature)
+        , numActivePhases_(other.numActivePhases_)
+        , phaseIsActive_(other.phaseIsActive_)
+        , reservoirTemperature_(other.reservoirTemperature_)
+        , gasPvt_(convertPvt_<GasPvt>(other.gasPvt_, "gas"))
+        , oilPvt_(convertPvt_<OilPvt>(other.oilPvt_, "oil"))
+        , waterPvt_(convertPvt_<WaterPvt>(other.waterPvt_, "water"))
+        , enableDissolvedGas_(other.enableDissolvedGas_)
+        , enableVaporizedOil_(other.enableVaporizedOil_)
+        , enableVaporizedWater_(other.enableVaporizedWater_)
+        , enableDiffusion_(other.enableDiffusion_)
+        , referenceDensity_(other.referenceDensity_)
+        , molarMass_(other.molarMass_)
+        , diffusionCoefficients_(other.diffusionCoefficients_)
+        , activeToCanonicalPhaseIdx_(other.activeToCanonicalPhaseIdx_)
+        , canonicalToActivePhaseIdx_(other.canonicalToActivePhaseIdx_)
+        , isInitialized_(other.isInitialized_)
+    { }
+
+    /*!
+     * \brief Returns true if the PVT objects of this fluid system can be used by a
+     *        fluid system with the given PVT classes.
+     *
+     * This is the case if the PVT objects are of the same type or if they are
+     * multiplexers which currently use the given PVT classes.
+     */
+    template <class OtherOilPvt, class OtherGasPvt, class OtherWaterPvt>
+    bool hasPvtTypes() const
+    {
+        return hasPvtType_<OtherOilPvt>(oilPvt_)
+            && hasPvtType_<OtherGasPvt>(gasPvt_)
+            && hasPvtType_<OtherWaterPvt>(waterPvt_);
+    }
+
+    //! \copydoc BaseFluidSystem::ParameterCache
+    template <class EvaluationT>
+    struct ParameterCache : public NullParameterCache<EvaluationT>
+    {
+        using Evaluation = EvaluationT;
+
+    public:
+        ParameterCache(Scalar maxOilSat = 1.0, unsigned regionIdx=0)
+        {
+            maxOilSat_ = maxOilSat;
+            regionIdx_ = regionIdx;
+        }
+
+        /*!
+         * \brief Copy the data which is not dependent on the type of the Scalars from
+         *        another parameter cache.
+         *
+         * For the black-oil parameter cache this means that the region index must be
+         * copied.
+         */
+        template <class OtherCache>
+        void assignPersistentData(const OtherCache& other)
+        {
+            regionIdx_ = other.regionIndex();
+            maxOilSat_ = other.maxOilSat();
+        }
+
+        /*!
+         * \brief Return the index of the region which should be used to determine the
+         *        thermodynamic properties
+         *
+         * This is only required because "oil" and "gas" are pseudo-components, i.e. for
+         * more comprehensive equations of state there would only be one "region".
+         */
+        unsigned regionIndex() const
+        { return regionIdx_; }
+
+        /*!
+         * \brief Set the index of the region which should be used to determine the
+         *        thermodynamic properties
+         *
+         * This is only required because "oil" and "gas" are pseudo-components, i.e. for
+         * more comprehensive equations of state there would only be one "region".
+         */
+        void setRegionIndex(unsigned val)
+        { regionIdx_ = val; }
+
+        const Evaluation& maxOilSat() const
+        { return maxOilSat_; }
+
+        void setMaxOilSat(const Evaluation& val)
+        { maxOilSat_ = val; }
+
+    private:
+        Evaluation maxOilSat_;
+        unsigned regionIdx_;
+    };
+
+    /****************************************
+     * Initialization
+     ****************************************/
+#if HAVE_ECL_INPUT
+    /*!
+     * \brief Initialize the fluid system using an ECL deck object
+     */
+    void initFromState(const EclipseState& eclState, const Schedule& schedule)
+    {
+        size_t numRegions = eclState.runspec().tabdims().getNumPVTTables();
+        initBegin(numRegions);
+
+        numActivePhases_ = 0;
+        std::fill_n(&phaseIsActive_[0], numPhases, false);
+
+
+        if (eclState.runspec().phases().active(Phase::OIL)) {
+            phaseIsActive_[oilPhaseIdx] = true;
+            ++ numActivePhases_;
+        }
+
+        if (eclState.runspec().phases().active(Phase::GAS)) {
+            phaseIsActive_[gasPhaseIdx] = true;
+            ++ numActivePhases_;
+        }
+
+        if (eclState.runspec().phases().active(Phase::WATER)) {
+            phaseIsActive_[waterPhaseIdx] = true;
+            ++ numActivePhases_;
+        }
+
+        // set the surface conditions using the STCOND keyword
+        surfaceTemperature = eclState.getTableManager().stCond().temperature;
+        surfacePressure = eclState.getTableManager().stCond().pressure;
+
+        // The reservoir temperature does not really belong into the table manager. TODO:
+        // change this in opm-parser
+        setReservoirTemperature(eclState.getTableManager().rtemp());
+
+        // this fluidsystem only supports two or three phases
+        assert(numActivePhases_ >= 1 && numActivePhases_ <= 3);
+
+        setEnableDissolvedGas(eclState.getSimulationConfig().hasDISGAS());
+        setEnableVaporizedOil(eclState.getSimulationConfig().hasVAPOIL());
+        setEnableVaporizedWater(eclState.getSimulationConfig().hasVAPWAT());
+
+        if (phaseIsActive(gasPhaseIdx)) {
+            gasPvt_ = std::make_shared<GasPvt>();
+            gasPvt_->initFromState(eclState, schedule);
+        }
+
+        if (phaseIsActive(oilPhaseIdx)) {
+            oilPvt_ = std::make_shared<OilPvt>();
+            oilPvt_->initFromState(eclState, schedule);
+        }
+
+        if (phaseIsActive(waterPhaseIdx)) {
+            waterPvt_ = std::make_shared<WaterPvt>();
+            waterPvt_->initFromState(eclState, schedule);
+        }
+
+        // set the reference densities of all PVT regions
+        for (unsigned regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+            setReferenceDensities(phaseIsActive(oilPhaseIdx)? oilPvt_->oilReferenceDensity(regionIdx):700.,
+                                  phaseIsActive(waterPhaseIdx)? waterPvt_->waterReferenceDensity(regionIdx):1000.,
+                                  phaseIsActive(gasPhaseIdx)? gasPvt_->gasReferenceDensity(regionIdx):2.,
+                                  regionIdx);
+        }
+
+        // set default molarMass and mappings
+        initEnd();
+
+        // use molarMass of CO2 and Brine as default
+        // when we are using the the CO2STORE option
+        // NB the oil component is used internally for
+        // brine
+        if (eclState.runspec().co2Storage()) {
+            for (unsigned regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+                molarMass_[regionIdx][oilCompIdx] = BrineCo2Pvt<Scalar>::Brine::molarMass();
+                molarMass_[regionIdx][gasCompIdx] = BrineCo2Pvt<Scalar>::CO2::molarMass();
+            }
+        }
+
+        setEnableDiffusion(eclState.getSimulationConfig().isDiffusive());
+        if(enableDiffusion()) {
+            const auto& diffCoeffTables = eclState.getTableManager().getDiffusionCoefficientTable();
+            if(!diffCoeffTables.empty()) {
+                // if diffusion coefficient table is empty we relay on the PVT model to
+                // to give us the coefficients.
+                diffusionCoefficients_.resize(numRegions,{0,0,0,0,0,0,0,0,0});
+                assert(diffCoeffTables.size() == numRegions);
+                for (unsigned regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+                    const auto& diffCoeffTable = diffCoeffTables[regionIdx];
+                    molarMass_[regionIdx][oilCompIdx] = diffCoeffTable.oil_mw;
+                    molarMass_[regionIdx][gasCompIdx] = diffCoeffTable.gas_mw;
+                    setDiffusionCoefficient(diffCoeffTable.gas_in_gas, gasCompIdx, gasPhaseIdx, regionIdx);
+                    setDiffusionCoefficient(diffCoeffTable.oil_in_gas, oilCompIdx, gasPhaseIdx, regionIdx);
+                    setDiffusionCoefficient(diffCoeffTable.gas_in_oil, gasCompIdx, oilPhaseIdx, regionIdx);
+                    setDiffusionCoefficient(diffCoeffTable.oil_in_oil, oilCompIdx, oilPhaseIdx, regionIdx);
+                    if(diffCoeffTable.gas_in_oil_cross_phase > 0 || diffCoeffTable.oil_in_oil_cross_phase > 0) {
+                        throw std::runtime_error("Cross phase diffusion is set in the deck, but not implemented in Flow. "
+                                                 "Please default DIFFC item 7 and item 8 or set it to zero.");
+                    }
+                }
+            }
+        }
+    }
+#endif // HAVE_ECL_INPUT
+
+    /*!
+     * \brief Begin the initialization of the black oil fluid system.
+     *
+     * After calling this method the reference densities, all dissolution and formation
+     * volume factors, the oil bubble pressure, all viscosities and the water
+     * compressibility must be set. Before the fluid system can be used, initEnd() must
+     * be called to finalize the initialization.
+     */
+    void initBegin(size_t numPvtRegions)
+    {
+        isInitialized_ = false;
+
+        enableDissolvedGas_ = true;
+        enableVaporizedOil_ = false;
+        enableVaporizedWater_ = false;
+        enableDiffusion_ = false;
+
+        oilPvt_ = nullptr;
+        gasPvt_ = nullptr;
+        waterPvt_ = nullptr;
+
+        surfaceTemperature = 273.15 + 15.56; // [K]
+        surfacePressure = 1.01325e5; // [Pa]
+        setReservoirTemperature(surfaceTemperature);
+
+        numActivePhases_ = numPhases;
+        std::fill_n(&phaseIsActive_[0], numPhases, true);
+
+        resizeArrays_(numPvtRegions);
+    }
+
+    /*!
+     * \brief Specify whether the fluid system should consider that the gas component can
+     *        dissolve in the oil phase
+     *
+     * By default, dissolved gas is considered.
+     */
+    void setEnableDissolvedGas(bool yesno)
+    { enableDissolvedGas_ = yesno; }
+
+    /*!
+     * \brief Specify whether the fluid system should consider that the oil component can
+     *        dissolve in the gas phase
+     *
+     * By default, vaporized oil is not considered.
+     */
+    void setEnableVaporizedOil(bool yesno)
+    { enableVaporizedOil_ = yesno; }
+
+     /*!
+     * \brief Specify whether the fluid system should consider that the water component can
+     *        dissolve in the gas phase
+     *
+     * By default, vaporized water is not considered.
+     */
+    void setEnableVaporizedWater(bool yesno)
+    { enableVaporizedWater_ = yesno; }
+
+    /*!
+     * \brief Specify whether the fluid system should consider diffusion
+     *
+     * By default, diffusion is not considered.
+     */
+    void setEnableDiffusion(bool yesno)
+    { enableDiffusion_ = yesno; }
+
+
+    /*!
+     * \brief Set the pressure-volume-saturation (PVT) relations for the gas phase.
+     */
+    void setGasPvt(std::shared_ptr<GasPvt> pvtObj)
+    { gasPvt_ = pvtObj; }
+
+    /*!
+     * \brief Set the pressure-volume-saturation (PVT) relations for the oil phase.
+     */
+    void setOilPvt(std::shared_ptr<OilPvt> pvtObj)
+    { oilPvt_ = pvtObj; }
+
+    /*!
+     * \brief Set the pressure-volume-saturation (PVT) relations for the water phase.
+     */
+    void setWaterPvt(std::shared_ptr<WaterPvt> pvtObj)
+    { waterPvt_ = pvtObj; }
+
+    /*!
+     * \brief Initialize the values of the reference densities
+     *
+     * \param rhoOil The reference density of (gas saturated) oil phase.
+     * \param rhoWater The reference density of the water phase.
+     * \param rhoGas The reference density of the gas phase.
+     */
+    void setReferenceDensities(Scalar rhoOil,
+                               Scalar rhoWater,
+                               Scalar rhoGas,
+                               unsigned regionIdx)
+    {
+        referenceDensity_[regionIdx][oilPhaseIdx] = rhoOil;
+        referenceDensity_[regionIdx][waterPhaseIdx] = rhoWater;
+        referenceDensity_[regionIdx][gasPhaseIdx] = rhoGas;
+    }
+
+
+    /*!
+     * \brief Finish initializing the black oil fluid system.
+     */
+    void initEnd()
+    {
+        // calculate the final 2D functions which are used for interpolation.
+        size_t numRegions = molarMass_.size();
+        for (unsigned regionIdx = 0; regionIdx < numRegions; ++ regionIdx) {
+            // calculate molar masses
+
+            // water is simple: 18 g/mol
+            molarMass_[regionIdx][waterCompIdx] = 18e-3;
+
+            if (phaseIsActive(gasPhaseIdx)) {
+                // for gas, we take the density at standard conditions and assume it to be ideal
+                Scalar p = surfacePressure;
+                Scalar T = surfaceTemperature;
+                Scalar rho_g = referenceDensity_[/*regionIdx=*/0][gasPhaseIdx];
+                molarMass_[regionIdx][gasCompIdx] = Constants<Scalar>::R*T*rho_g / p;
+            }
+            else
+                // hydrogen gas. we just set this do avoid NaNs later
+                molarMass_[regionIdx][gasCompIdx] = 2e-3;
+
+            // finally, for oil phase, we take the molar mass from the spe9 paper
+            molarMass_[regionIdx][oilCompIdx] = 175e-3; // kg/mol
+        }
+
+
+        int activePhaseIdx = 0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if(phaseIsActive(phaseIdx)){
+                canonicalToActivePhaseIdx_[phaseIdx] = activePhaseIdx;
+                activeToCanonicalPhaseIdx_[activePhaseIdx] = phaseIdx;
+                activePhaseIdx++;
+            }
+        }
+        isInitialized_ = true;
+    }
+
+    bool isInitialized() const
+    { return isInitialized_; }
+
+    /*!
+     * \brief Returns true iff both fluid systems use the same parameters and PVT
+     *        relations.
+     *
+     * The PVT objects are compared by value, i.e., they do not need to be shared.
+     */
+    bool operator==(const BlackOilFluidSystemNonStatic& data) const
+    {
+        return this->numActivePhases_ == data.numActivePhases_ &&
+               this->phaseIsActive_ == data.phaseIsActive_ &&
+               this->surfacePressure == data.surfacePressure &&
+               this->surfaceTemperature == data.surfaceTemperature &&
+               this->reservoirTemperature_ == data.reservoirTemperature_ &&
+               samePvt_(this->gasPvt_, data.gasPvt_) &&
+               samePvt_(this->oilPvt_, data.oilPvt_) &&
+               samePvt_(this->waterPvt_, data.waterPvt_) &&
+               this->enableDissolvedGas_ == data.enableDissolvedGas_ &&
+               this->enableVaporizedOil_ == data.enableVaporizedOil_ &&
+               this->enableVaporizedWater_ == data.enableVaporizedWater_ &&
+               this->enableDiffusion_ == data.enableDiffusion_ &&
+               this->referenceDensity_ == data.referenceDensity_ &&
+               this->molarMass_ == data.molarMass_ &&
+               this->diffusionCoefficients_ == data.diffusionCoefficients_ &&
+               this->activeToCanonicalPhaseIdx_ == data.activeToCanonicalPhaseIdx_ &&
+               this->canonicalToActivePhaseIdx_ == data.canonicalToActivePhaseIdx_ &&
+               this->isInitialized_ == data.isInitialized_;
+    }
+
+    /*!
+     * \brief Write the fully initialized fluid system to a snapshot or restore it
+     *        from one.
+     */
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(numActivePhases_);
+        serializer(phaseIsActive_);
+        serializer(surfacePressure);
+        serializer(surfaceTemperature);
+        serializer(reservoirTemperature_);
+
+        serializer(gasPvt_);
+        serializer(oilPvt_);
+        serializer(waterPvt_);
+
+        serializer(enableDissolvedGas_);
+        serializer(enableVaporizedOil_);
+        serializer(enableVaporizedWater_);
+        serializer(enableDiffusion_);
+
+        serializer(referenceDensity_);
+        serializer(molarMass_);
+        serializer(diffusionCoefficients_);
+
+        serializer(activeToCanonicalPhaseIdx_);
+        serializer(canonicalToActivePhaseIdx_);
+
+        serializer(isInitialized_);
+    }
+
+    /*!
+     * \brief Write the fluid system including all PVT tables to a binary snapshot file.
+     *
+     * The fluid system must be fully initialized.
+     */
+    void writeSnapshot(const std::string& fileName) const
+    {
+        if (!isInitialized_)
+            throw std::logic_error("Only initialized fluid systems can be written to a snapshot");
+
+        saveSnapshot(fileName, snapshotTag_(), *this);
+    }
+
+    /*!
+     * \brief Initialize the fluid system from a binary snapshot file.
+     *
+     * This replaces initFromState() and does not require to construct any tables.
+     */
+    void initFromSnapshot(const std::string& fileName)
+    {
+        isInitialized_ = false;
+        oilPvt_ = nullptr;
+        gasPvt_ = nullptr;
+        waterPvt_ = nullptr;
+
+        loadSnapshot(fileName, snapshotTag_(), *this);
+    }
+
+    /****************************************
+     * Generic phase properties
+     ****************************************/
+
+    //! \copydoc BaseFluidSystem::numPhases
+    static constexpr unsigned numPhases = 3;
+
+    //! Index of the water phase
+    static constexpr unsigned waterPhaseIdx = IndexTraits::waterPhaseIdx;
+    //! Index of the oil phase
+    static constexpr unsigned oilPhaseIdx = IndexTraits::oilPhaseIdx;
+    //! Index of the gas phase
+    static constexpr unsigned gasPhaseIdx = IndexTraits::gasPhaseIdx;
+
+    //! The pressure at the surface
+    Scalar surfacePressure{};
+
+    //! The temperature at the surface
+    Scalar surfaceTemperature{};
+
+    //! \copydoc BaseFluidSystem::phaseName
+    static const char* phaseName(unsigned phaseIdx)
+    {
+        switch (phaseIdx) {
+        case waterPhaseIdx:
+            return "water";
+        case oilPhaseIdx:
+            return "oil";
+        case gasPhaseIdx:
+            return "gas";
+
+        default:
+            throw std::logic_error("Phase index " + std::to_string(phaseIdx) + " is unknown");
+        }
+    }
+
+    //! \copydoc BaseFluidSystem::isLiquid
+    static bool isLiquid(unsigned phaseIdx)
+    {
+        assert(phaseIdx < numPhases);
+        return phaseIdx != gasPhaseIdx;
+    }
+
+    /****************************************
+     * Generic component related properties
+     ****************************************/
+
+    //! \copydoc BaseFluidSystem::numComponents
+    static constexpr unsigned numComponents = 3;
+
+    //! Index of the oil component
+    static constexpr unsigned oilCompIdx = IndexTraits::oilCompIdx;
+    //! Index of the water component
+    static constexpr unsigned waterCompIdx = IndexTraits::waterCompIdx;
+    //! Index of the gas component
+    static constexpr unsigned gasCompIdx = IndexTraits::gasCompIdx;
+
+protected:
+    unsigned char numActivePhases_{};
+    std::array<bool,numPhases> phaseIsActive_{};
+
+public:
+    //! \brief Returns the number of active fluid phases (i.e., usually three)
+    unsigned numActivePhases() const
+    { return numActivePhases_; }
+
+    //! \brief Returns whether a fluid phase is active
+    unsigned phaseIsActive(unsigned phaseIdx) const
+    {
+        assert(phaseIdx < numPhases);
+        return phaseIsActive_[phaseIdx];
+    }
+
+    //! \brief returns the index of "primary" component of a phase (solvent)
+    static constexpr unsigned solventComponentIndex(unsigned phaseIdx)
+    {
+        switch (phaseIdx) {
+        case waterPhaseIdx:
+            return waterCompIdx;
+        case oilPhaseIdx:
+            return oilCompIdx;
+        case gasPhaseIdx:
+            return gasCompIdx;
+
+        default:
+            throw std::logic_error("Phase index " + std::to_string(phaseIdx) + " is unknown");
+        }
+    }
+
+    //! \brief returns the index of "secondary" component of a phase (solute)
+    static constexpr unsigned soluteComponentIndex(unsigned phaseIdx)
+    {
+        switch (phaseIdx) {
+        case waterPhaseIdx:
+            throw std::logic_error("The water phase does not have any solutes in the black oil model!");
+        case oilPhaseIdx:
+            return gasCompIdx;
+        case gasPhaseIdx:
+            return oilCompIdx;
+
+        default:
+            throw std::logic_error("Phase index " + std::to_string(phaseIdx) + " is unknown");
+        }
+    }
+
+    //! \copydoc BaseFluidSystem::componentName
+    static const char* componentName(unsigned compIdx)
+    {
+        switch (compIdx) {
+        case waterCompIdx:
+            return "Water";
+        case oilCompIdx:
+            return "Oil";
+        case gasCompIdx:
+            return "Gas";
+
+        default:
+            throw std::logic_error("Component index " + std::to_string(compIdx) + " is unknown");
+        }
+    }
+
+    //! \copydoc BaseFluidSystem::molarMass
+    Scalar molarMass(unsigned compIdx, unsigned regionIdx = 0) const
+    { return molarMass_[regionIdx][compIdx]; }
+
+    //! \copydoc BaseFluidSystem::isIdealMixture
+    static bool isIdealMixture(unsigned /*phaseIdx*/)
+    {
+        // fugacity coefficients are only pressure dependent -> we
+        // have an ideal mixture
+        return true;
+    }
+
+    //! \copydoc BaseFluidSystem::isCompressible
+    static bool isCompressible(unsigned /*phaseIdx*/)
+    { return true; /* all phases are compressible */ }
+
+    //! \copydoc BaseFluidSystem::isIdealGas
+    static bool isIdealGas(unsigned /*phaseIdx*/)
+    { return false; }
+
+
+    /****************************************
+     * Black-oil specific properties
+     ****************************************/
+    /*!
+     * \brief Returns the number of PVT regions which are considered.
+     *
+     * By default, this is 1.
+     */
+    size_t numRegions() const
+    { return molarMass_.size(); }
+
+    /*!
+     * \brief Returns whether the fluid system should consider that the gas component can
+     *        dissolve in the oil phase
+     *
+     * By default, dissolved gas is considered.
+     */
+    bool enableDissolvedGas() const
+    { return enableDissolvedGas_; }
+
+    /*!
+     * \brief Returns whether the fluid system should consider that the oil component can
+     *        dissolve in the gas phase
+     *
+     * By default, vaporized oil is not considered.
+     */
+    bool enableVaporizedOil() const
+    { return enableVaporizedOil_; }
+
+    /*!
+     * \brief Returns whether the fluid system should consider that the water component can
+     *        dissolve in the gas phase
+     *
+     * By default, vaporized water is not considered.
+     */
+    bool enableVaporizedWater() const
+    { return enableVaporizedWater_; }
+
+    /*!
+     * \brief Returns whether the fluid system should consider diffusion
+     *
+     * By default, diffusion is not considered.
+     */
+    bool enableDiffusion() const
+    { return enableDiffusion_; }
+
+    /*!
+     * \brief Returns the density of a fluid phase at surface pressure [kg/m^3]
+     *
+     * \copydoc Doxygen::phaseIdxParam
+     */
+    Scalar referenceDensity(unsigned phaseIdx, unsigned regionIdx) const
+    { return referenceDensity_[regionIdx][phaseIdx]; }
+
+    /****************************************
+     * thermodynamic quantities (generic version)
+     ****************************************/
+    //! \copydoc BaseFluidSystem::density
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParamCacheEval = LhsEval>
+    LhsEval density(const FluidState& fluidState,
+                    const ParameterCache<ParamCacheEval>& paramCache,
+                    unsigned phaseIdx) const
+    { return density<FluidState, LhsEval>(fluidState, phaseIdx, paramCache.regionIndex()); }
+
+    //! \copydoc BaseFluidSystem::fugacityCoefficient
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParamCacheEval = LhsEval>
+    LhsEval fugacityCoefficient(const FluidState& fluidState,
+                                const ParameterCache<ParamCacheEval>& paramCache,
+                                unsigned phaseIdx,
+                                unsigned compIdx) const
+    {
+        return fugacityCoefficient<FluidState, LhsEval>(fluidState,
+                                                        phaseIdx,
+                                                        compIdx,
+                                                        paramCache.regionIndex());
+    }
+
+    //! \copydoc BaseFluidSystem::viscosity
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParamCacheEval = LhsEval>
+    LhsEval viscosity(const FluidState& fluidState,
+                      const ParameterCache<ParamCacheEval>& paramCache,
+                      unsigned phaseIdx) const
+    { return viscosity<FluidState, LhsEval>(fluidState, phaseIdx, paramCache.regionIndex()); }
+
+    //! \copydoc BaseFluidSystem::enthalpy
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParamCacheEval = LhsEval>
+    LhsEval enthalpy(const FluidState& fluidState,
+                     const ParameterCache<ParamCacheEval>& paramCache,
+                     unsigned phaseIdx) const
+    { return enthalpy<FluidState, LhsEval>(fluidState, phaseIdx, paramCache.regionIndex()); }
+
+    /****************************************
+     * thermodynamic quantities (black-oil specific version: Note that the PVT region
+     * index is explicitly passed instead of a parameter cache object)
+     ****************************************/
+    //! \copydoc BaseFluidSystem::density
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval density(const FluidState& fluidState,
+                    unsigned phaseIdx,
+                    unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::density");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const LhsEval& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const LhsEval& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+        const LhsEval& saltConcentration = BlackOil::template getSaltConcentration_<ThisType, FluidState, LhsEval>(fluidState, regionIdx);
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: {
+            if (enableDissolvedGas()) {
+                // miscible oil
+                const LhsEval& Rs = BlackOil::template getRs_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                const LhsEval& bo = oilPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rs);
+
+                return
+                    lazy(bo)*referenceDensity(oilPhaseIdx, regionIdx)
+                    + lazy(Rs)*lazy(bo)*referenceDensity(gasPhaseIdx, regionIdx);
+            }
+
+            // immiscible oil
+            const LhsEval Rs(0.0);
+            const auto& bo = oilPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rs);
+
+            return referenceDensity(phaseIdx, regionIdx)*bo;
+        }
+
+        case gasPhaseIdx: {
+             if (enableVaporizedOil() && enableVaporizedWater()) {
+                // gas containing vaporized oil and vaporized water
+                const LhsEval& Rv = BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                const LhsEval& Rvw = BlackOil::template getRvw_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                const LhsEval& bg = gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+
+                return
+                    lazy(bg)*referenceDensity(gasPhaseIdx, regionIdx)
+                    + lazy(Rv)*lazy(bg)*referenceDensity(oilPhaseIdx, regionIdx)
+                    + lazy(Rvw)*lazy(bg)*referenceDensity(waterPhaseIdx, regionIdx);
+            }
+            if (enableVaporizedOil()) {
+                // miscible gas
+                const LhsEval Rvw(0.0);
+                const LhsEval& Rv = BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                const LhsEval& bg = gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+
+                return
+                    lazy(bg)*referenceDensity(gasPhaseIdx, regionIdx)
+                    + lazy(Rv)*lazy(bg)*referenceDensity(oilPhaseIdx, regionIdx);
+            }
+            if (enableVaporizedWater()) {
+                // gas containing vaporized water
+                const LhsEval Rv(0.0);
+                const LhsEval& Rvw = BlackOil::template getRvw_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                const LhsEval& bg = gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+
+                return
+                    lazy(bg)*referenceDensity(gasPhaseIdx, regionIdx)
+                    + lazy(Rvw)*lazy(bg)*referenceDensity(waterPhaseIdx, regionIdx);
+            }
+
+            // immiscible gas
+            const LhsEval Rv(0.0);
+            const LhsEval Rvw(0.0);
+            const auto& bg = gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+            return bg*referenceDensity(phaseIdx, regionIdx);
+        }
+
+        case waterPhaseIdx:
+            return
+                referenceDensity(waterPhaseIdx, regionIdx)
+                * waterPvt_->inverseFormationVolumeFactor(regionIdx, T, p, saltConcentration);
+        }
+
+        throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+    }
+
+    /*!
+     * \brief Compute the density of a saturated fluid phase.
+     *
+     * This means the density of the given fluid phase if the dissolved component (gas
+     * for the oil phase and oil for the gas phase) is at the thermodynamically possible
+     * maximum. For the water phase, there's no difference to the density() method.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval saturatedDensity(const FluidState& fluidState,
+                             unsigned phaseIdx,
+                             unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::saturatedDensity");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const auto& p = fluidState.pressure(phaseIdx);
+        const auto& T = fluidState.temperature(phaseIdx);
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: {
+            if (enableDissolvedGas()) {
+                // miscible oil
+                const LhsEval& Rs = saturatedDissolutionFactor<FluidState, LhsEval>(fluidState, oilPhaseIdx, regionIdx);
+                const LhsEval& bo = oilPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rs);
+
+                return
+                    lazy(bo)*referenceDensity(oilPhaseIdx, regionIdx)
+                    + lazy(Rs)*lazy(bo)*referenceDensity(gasPhaseIdx, regionIdx);
+            }
+
+            // immiscible oil
+            const LhsEval Rs(0.0);
+            const LhsEval& bo = oilPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rs);
+            return referenceDensity(phaseIdx, regionIdx)*bo;
+        }
+
+        case gasPhaseIdx: {
+            if (enableVaporizedOil() && enableVaporizedWater()) {
+                // gas containing vaporized oil and vaporized water
+                const LhsEval& Rv = saturatedDissolutionFactor<FluidState, LhsEval>(fluidState, gasPhaseIdx, regionIdx);
+                const LhsEval& Rvw = saturatedVaporizationFactor<FluidState, LhsEval>(fluidState, gasPhaseIdx, regionIdx);
+                const LhsEval& bg = gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+
+                return
+                    lazy(bg)*referenceDensity(gasPhaseIdx, regionIdx)
+                    + lazy(Rv)*lazy(bg)*referenceDensity(oilPhaseIdx, regionIdx)
+                    + lazy(Rvw)*lazy(bg)*referenceDensity(waterPhaseIdx, regionIdx) ;
+            }
+
+            if (enableVaporizedOil()) {
+                // miscible gas
+                const LhsEval Rvw(0.0);
+                const LhsEval& Rv = saturatedDissolutionFactor<FluidState, LhsEval>(fluidState, gasPhaseIdx, regionIdx);
+                const LhsEval& bg = gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+
+                return
+                    lazy(bg)*referenceDensity(gasPhaseIdx, regionIdx)
+                    + lazy(Rv)*lazy(bg)*referenceDensity(oilPhaseIdx, regionIdx);
+            }
+
+            if (enableVaporizedWater()) {
+                // gas containing vaporized water
+                const LhsEval Rv(0.0);
+                const LhsEval& Rvw = saturatedVaporizationFactor<FluidState, LhsEval>(fluidState, gasPhaseIdx, regionIdx);
+                const LhsEval& bg = gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+
+                return
+                    lazy(bg)*referenceDensity(gasPhaseIdx, regionIdx)
+                    + lazy(Rvw)*lazy(bg)*referenceDensity(waterPhaseIdx, regionIdx);
+            }
+
+            // immiscible gas
+            const LhsEval Rv(0.0);
+            const LhsEval Rvw(0.0);
+            const LhsEval& bg = gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+
+            return referenceDensity(phaseIdx, regionIdx)*bg;
+
+        }
+
+        case waterPhaseIdx:
+            return
+                referenceDensity(waterPhaseIdx, regionIdx)
+                *inverseFormationVolumeFactor<FluidState, LhsEval>(fluidState, waterPhaseIdx, regionIdx);
+        }
+
+        throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+    }
+
+    /*!
+     * \brief Returns the formation volume factor \f$B_\alpha\f$ of an "undersaturated"
+     *        fluid phase
+     *
+     * For the oil (gas) phase, "undersaturated" means that the concentration of the gas
+     * (oil) component is not assumed to be at the thermodynamically possible maximum at
+     * the given temperature and pressure.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval inverseFormationVolumeFactor(const FluidState& fluidState,
+                                         unsigned phaseIdx,
+                                         unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::inverseFormationVolumeFactor");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+        const auto& saltConcentration = decay<LhsEval>(fluidState.saltConcentration());
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: {
+            if (enableDissolvedGas()) {
+                const auto& Rs = BlackOil::template getRs_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                if (fluidState.saturation(gasPhaseIdx) > 0.0
+                    && Rs >= (1.0 - 1e-10)*oilPvt_->saturatedGasDissolutionFactor(regionIdx, scalarValue(T), scalarValue(p)))
+                {
+                    return oilPvt_->saturatedInverseFormationVolumeFactor(regionIdx, T, p);
+                } else {
+                    return oilPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rs);
+                }
+            }
+
+            const LhsEval Rs(0.0);
+            return oilPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rs);
+        }
+        case gasPhaseIdx: {
+            if (enableVaporizedOil() && enableVaporizedWater()) {
+                 const auto& Rvw = BlackOil::template getRvw_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                 const auto& Rv = BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                 if (fluidState.saturation(waterPhaseIdx) > 0.0
+                    && Rvw >= (1.0 - 1e-10)*gasPvt_->saturatedWaterVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p))
+                    && fluidState.saturation(oilPhaseIdx) > 0.0
+                    && Rv >= (1.0 - 1e-10)*gasPvt_->saturatedOilVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p)))
+                 { 
+                    return gasPvt_->saturatedInverseFormationVolumeFactor(regionIdx, T, p);
+                 } else {
+                     return gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+                 }
+            }
+
+            if (enableVaporizedOil()) {
+                const auto& Rv = BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                if (fluidState.saturation(oilPhaseIdx) > 0.0
+                    && Rv >= (1.0 - 1e-10)*gasPvt_->saturatedOilVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p)))
+                {
+                    return gasPvt_->saturatedInverseFormationVolumeFactor(regionIdx, T, p);
+                } else {
+                    const LhsEval Rvw(0.0);
+                    return gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+                }
+            }
+
+            if (enableVaporizedWater()) { 
+                const auto& Rvw = BlackOil::template getRvw_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                if (fluidState.saturation(waterPhaseIdx) > 0.0
+                    && Rvw >= (1.0 - 1e-10)*gasPvt_->saturatedWaterVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p)))
+                {
+                    return gasPvt_->saturatedInverseFormationVolumeFactor(regionIdx, T, p);
+                } else {
+                    const LhsEval Rv(0.0);
+                    return gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+                }
+            }
+            
+            const LhsEval Rv(0.0);
+            const LhsEval Rvw(0.0);
+            return gasPvt_->inverseFormationVolumeFactor(regionIdx, T, p, Rv, Rvw);
+        }
+        case waterPhaseIdx:
+            return waterPvt_->inverseFormationVolumeFactor(regionIdx, T, p, saltConcentration);
+        default: throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+        }
+    }
+
+    /*!
+     * \brief Returns the formation volume factor \f$B_\alpha\f$ of a "saturated" fluid
+     *        phase
+     *
+     * For the oil phase, this means that it is gas saturated, the gas phase is oil
+     * saturated and for the water phase, there is no difference to formationVolumeFactor()
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval saturatedInverseFormationVolumeFactor(const FluidState& fluidState,
+                                                  unsigned phaseIdx,
+                                                  unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::saturatedInverseFormationVolumeFactor");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+        const auto& saltConcentration = decay<LhsEval>(fluidState.saltConcentration());
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: return oilPvt_->saturatedInverseFormationVolumeFactor(regionIdx, T, p);
+        case gasPhaseIdx: return gasPvt_->saturatedInverseFormationVolumeFactor(regionIdx, T, p);
+        case waterPhaseIdx: return waterPvt_->inverseFormationVolumeFactor(regionIdx, T, p, saltConcentration);
+        default: throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+        }
+    }
+
+    /*!
+     * \brief The quantities of all fluid phases which are computed by
+     *        computePhaseProperties()
+     *
+     * The entries of inactive phases are not touched. The saturated dissolution factors
+     * are zero if dissolved gas respectively vaporized oil are disabled.
+     */
+    template <class LhsEval>
+    struct PhaseProperties
+    {
+        std::array<LhsEval, numPhases> invB;
+        std::array<LhsEval, numPhases> density;
+        std::array<LhsEval, numPhases> viscosity;
+        LhsEval saturatedRs;
+        LhsEval saturatedRv;
+    };
+
+    /*!
+     * \brief Caller-owned lookup cursors of the PVT tables of a cell.
+     *
+     * The cursors can be passed to computePhaseProperties(), e.g., one per cell, so that
+     * the table segments of the previous call are checked first. The water PVT
+     * relations are not tabulated over pressure, so only the oil and gas phases have a
+     * cursor.
+     */
+    struct Cursor
+    {
+        PvtCursor<Scalar> oil;
+        PvtCursor<Scalar> gas;
+    };
+
+    /*!
+     * \brief Compute the inverse formation volume factors, densities and viscosities of
+     *        all active phases as well as the saturated R_s and R_v factors of a cell.
+     *
+     * The results are identical to the ones of inverseFormationVolumeFactor(),
+     * viscosity() and saturatedDissolutionFactor(), but the composition of the fluid
+     * state is only read once and the saturated dissolution factors are reused to
+     * determine whether the oil and gas phases are saturated. The densities are
+     * computed from the inverse formation volume factors and the dissolution factors
+     * of the fluid state, i.e., for saturated phases they may slightly differ from the
+     * ones returned by density() which always uses the undersaturated tables.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    void computePhaseProperties(PhaseProperties<LhsEval>& result,
+                                const FluidState& fluidState,
+                                unsigned regionIdx) const
+    {
+        computeRegionPhaseProperties_<FluidState, LhsEval>(&result,
+                                                           &fluidState,
+                                                           /*cursors=*/nullptr,
+                                                           regionIdx,
+                                                           /*numCells=*/1,
+                                                           [](size_t i) { return i; });
+    }
+
+    /*!
+     * \brief Compute the properties of all active phases of a cell using its lookup
+     *        cursors.
+     *
+     * The results are identical to the ones of computePhaseProperties() without cursors.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    void computePhaseProperties(PhaseProperties<LhsEval>& result,
+                                const FluidState& fluidState,
+                                unsigned regionIdx,
+                                Cursor& cursor) const
+    {
+        computeRegionPhaseProperties_<FluidState, LhsEval>(&result,
+                                                           &fluidState,
+                                                           &cursor,
+                                                           regionIdx,
+                                                           /*numCells=*/1,
+                                                           [](size_t i) { return i; });
+    }
+
+    /*!
+     * \brief Compute the properties of all active phases for a range of cells.
+     *
+     * The PVT region of each cell is given by the pvtRegionIndex() method of its fluid
+     * state. Each run of consecutive cells which are part of the same PVT region is
+     * processed as a batch, see computeRegionPhaseProperties_().
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    void computePhaseProperties(PhaseProperties<LhsEval>* results,
+                                const FluidState* fluidStates,
+                                size_t numCells) const
+    {
+        computePhaseProperties<FluidState, LhsEval>(results, fluidStates, /*cursors=*/nullptr, numCells);
+    }
+
+    /*!
+     * \brief Compute the properties of all active phases for a range of cells using
+     *        their lookup cursors.
+     *
+     * The cursors are indexed in the same way as the fluid states. If cursors is a null
+     * pointer, no cursors are used.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    void computePhaseProperties(PhaseProperties<LhsEval>* results,
+                                const FluidState* fluidStates,
+                                Cursor* cursors,
+                                size_t numCells) const
+    {
+        size_t runBegin = 0;
+        while (runBegin < numCells) {
+            const unsigned regionIdx = fluidStates[runBegin].pvtRegionIndex();
+            size_t runEnd = runBegin + 1;
+            while (runEnd < numCells && fluidStates[runEnd].pvtRegionIndex() == regionIdx)
+                ++runEnd;
+
+            computeRegionPhaseProperties_<FluidState, LhsEval>(results + runBegin,
+                                                               fluidStates + runBegin,
+                                                               cursors ? cursors + runBegin : nullptr,
+                                                               regionIdx,
+                                                               runEnd - runBegin,
+                                                               [](size_t i) { return i; });
+            runBegin = runEnd;
+        }
+    }
+
+    /*!
+     * \brief Compute the properties of all active phases for the cells of a schedule.
+     *
+     * The cells of each PVT region of the schedule are processed as one batch, see
+     * computeRegionPhaseProperties_(). The fluid states and the results are indexed by
+     * the cell indices of the schedule, i.e., the results are stored in the original
+     * cell order.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    void computePhaseProperties(PhaseProperties<LhsEval>* results,
+                                const FluidState* fluidStates,
+                                const PvtRegionSchedule& schedule) const
+    {
+        computePhaseProperties<FluidState, LhsEval>(results, fluidStates, /*cursors=*/nullptr, schedule);
+    }
+
+    /*!
+     * \brief Compute the properties of all active phases for the cells of a schedule
+     *        using their lookup cursors.
+     *
+     * The cursors are indexed by the cell indices of the schedule. If cursors is a null
+     * pointer, no cursors are used.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    void computePhaseProperties(PhaseProperties<LhsEval>* results,
+                                const FluidState* fluidStates,
+                                Cursor* cursors,
+                                const PvtRegionSchedule& schedule) const
+    {
+        schedule.forEachRegion([&](unsigned regionIdx, const unsigned* cellBegin, const unsigned* cellEnd) {
+            computeRegionPhaseProperties_<FluidState, LhsEval>(results,
+                                                               fluidStates,
+                                                               cursors,
+                                                               regionIdx,
+                                                               static_cast<size_t>(cellEnd - cellBegin),
+                                                               [cellBegin](size_t i) { return cellBegin[i]; });
+        });
+    }
+
+    //! \copydoc BaseFluidSystem::fugacityCoefficient
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval fugacityCoefficient(const FluidState& fluidState,
+                                unsigned phaseIdx,
+                                unsigned compIdx,
+                                unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::fugacityCoefficient");
+        assert(phaseIdx <= numPhases);
+        assert(compIdx <= numComponents);
+        assert(regionIdx <= numRegions());
+
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+
+        // for the fugacity coefficient of the oil component in the oil phase, we use
+        // some pseudo-realistic value for the vapor pressure to ease physical
+        // interpretation of the results
+        const LhsEval phi_oO = 20e3/p;
+
+        // for the gas component in the gas phase, assume it to be an ideal gas
+        constexpr const Scalar phi_gG = 1.0;
+
+        // for the fugacity coefficient of the water component in the water phase, we use
+        // the same approach as for the oil component in the oil phase
+        const LhsEval phi_wW = 30e3/p;
+
+        switch (phaseIdx) {
+        case gasPhaseIdx: // fugacity coefficients for all components in the gas phase
+            switch (compIdx) {
+            case gasCompIdx:
+                return phi_gG;
+
+            // for the oil component, we calculate the Rv value for saturated gas and Rs
+            // for saturated oil, and compute the fugacity coefficients at the
+            // equilibrium. for this, we assume that in equilibrium the fugacities of the
+            // oil component is the same in both phases.
+            case oilCompIdx: {
+                if (!enableVaporizedOil())
+                    // if there's no vaporized oil, the gas phase is assumed to be
+                    // immiscible with the oil component
+                    return phi_gG*1e6;
+
+                const auto& R_vSat = gasPvt_->saturatedOilVaporizationFactor(regionIdx, T, p);
+                const auto& X_gOSat = convertRvToXgO(R_vSat, regionIdx);
+                const auto& x_gOSat = convertXgOToxgO(X_gOSat, regionIdx);
+
+                const auto& R_sSat = oilPvt_->saturatedGasDissolutionFactor(regionIdx, T, p);
+                const auto& X_oGSat = convertRsToXoG(R_sSat, regionIdx);
+                const auto& x_oGSat = convertXoGToxoG(X_oGSat, regionIdx);
+                const auto& x_oOSat = 1.0 - x_oGSat;
+
+                const auto& p_o = decay<LhsEval>(fluidState.pressure(oilPhaseIdx));
+                const auto& p_g = decay<LhsEval>(fluidState.pressure(gasPhaseIdx));
+
+                return phi_oO*p_o*x_oOSat / (p_g*x_gOSat);
+            }
+
+            case waterCompIdx:
+                // the water component is assumed to be never miscible with the gas phase
+                return phi_gG*1e6;
+
+            default:
+                throw std::logic_error("Invalid component index "+std::to_string(compIdx));
+            }
+
+        case oilPhaseIdx: // fugacity coefficients for all components in the oil phase
+            switch (compIdx) {
+            case oilCompIdx:
+                return phi_oO;
+
+            // for the oil and water components, we proceed analogous to the gas and
+            // water components in the gas phase
+            case gasCompIdx: {
+                if (!enableDissolvedGas())
+                    // if there's no dissolved gas, the oil phase is assumed to be
+                    // immiscible with the gas component
+                    return phi_oO*1e6;
+
+                const auto& R_vSat = gasPvt_->saturatedOilVaporizationFactor(regionIdx, T, p);
+                const auto& X_gOSat = convertRvToXgO(R_vSat, regionIdx);
+                const auto& x_gOSat = convertXgOToxgO(X_gOSat, regionIdx);
+                const auto& x_gGSat = 1.0 - x_gOSat;
+
+                const auto& R_sSat = oilPvt_->saturatedGasDissolutionFactor(regionIdx, T, p);
+                const auto& X_oGSat = convertRsToXoG(R_sSat, regionIdx);
+                const auto& x_oGSat = convertXoGToxoG(X_oGSat, regionIdx);
+
+                const auto& p_o = decay<LhsEval>(fluidState.pressure(oilPhaseIdx));
+                const auto& p_g = decay<LhsEval>(fluidState.pressure(gasPhaseIdx));
+
+                return phi_gG*p_g*x_gGSat / (p_o*x_oGSat);
+            }
+
+            case waterCompIdx:
+                return phi_oO*1e6;
+
+            default:
+                throw std::logic_error("Invalid component index "+std::to_string(compIdx));
+            }
+
+        case waterPhaseIdx: // fugacity coefficients for all components in the water phase
+            // the water phase fugacity coefficients are pretty simple: because the water
+            // phase is assumed to consist entirely from the water component, we just
+            // need to make sure that the fugacity coefficients for the other components
+            // are a few orders of magnitude larger than the one of the water
+            // component. (i.e., the affinity of the gas and oil components to the water
+            // phase is lower by a few orders of magnitude)
+            switch (compIdx) {
+            case waterCompIdx: return phi_wW;
+            case oilCompIdx: return 1.1e6*phi_wW;
+            case gasCompIdx: return 1e6*phi_wW;
+            default:
+                throw std::logic_error("Invalid component index "+std::to_string(compIdx));
+            }
+
+        default:
+            throw std::logic_error("Invalid phase index "+std::to_string(phaseIdx));
+        }
+
+        throw std::logic_error("Unhandled phase or component index");
+    }
+
+    //! \copydoc BaseFluidSystem::viscosity
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval viscosity(const FluidState& fluidState,
+                      unsigned phaseIdx,
+                      unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::viscosity");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const LhsEval& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const LhsEval& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+        const LhsEval& saltConcentration = BlackOil::template getSaltConcentration_<ThisType, FluidState, LhsEval>(fluidState, regionIdx);
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: {
+            if (enableDissolvedGas()) {
+                const auto& Rs = BlackOil::template getRs_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                if (fluidState.saturation(gasPhaseIdx) > 0.0
+                    && Rs >= (1.0 - 1e-10)*oilPvt_->saturatedGasDissolutionFactor(regionIdx, scalarValue(T), scalarValue(p)))
+                {
+                    return oilPvt_->saturatedViscosity(regionIdx, T, p);
+                } else {
+                    return oilPvt_->viscosity(regionIdx, T, p, Rs);
+                }
+            }
+
+            const LhsEval Rs(0.0);
+            return oilPvt_->viscosity(regionIdx, T, p, Rs);
+        }
+
+        case gasPhaseIdx: {
+             if (enableVaporizedOil() && enableVaporizedWater()) {
+                 const auto& Rvw = BlackOil::template getRvw_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                 const auto& Rv = BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                 if (fluidState.saturation(waterPhaseIdx) > 0.0
+                    && Rvw >= (1.0 - 1e-10)*gasPvt_->saturatedWaterVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p))
+                    && fluidState.saturation(oilPhaseIdx) > 0.0
+                    && Rv >= (1.0 - 1e-10)*gasPvt_->saturatedOilVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p)))
+                 { 
+                     return gasPvt_->saturatedViscosity(regionIdx, T, p);
+                 } else {
+                     return gasPvt_->viscosity(regionIdx, T, p, Rv, Rvw);
+                 }
+            }
+            if (enableVaporizedOil()) {
+                const auto& Rv = BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                if (fluidState.saturation(oilPhaseIdx) > 0.0
+                    && Rv >= (1.0 - 1e-10)*gasPvt_->saturatedOilVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p)))
+                {
+                    return gasPvt_->saturatedViscosity(regionIdx, T, p);
+                } else {
+                    const LhsEval Rvw(0.0);
+                    return gasPvt_->viscosity(regionIdx, T, p, Rv, Rvw);
+                }
+            }
+            if (enableVaporizedWater()) {
+                const auto& Rvw = BlackOil::template getRvw_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+                if (fluidState.saturation(waterPhaseIdx) > 0.0
+                    && Rvw >= (1.0 - 1e-10)*gasPvt_->saturatedWaterVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p)))
+                {
+                    return gasPvt_->saturatedViscosity(regionIdx, T, p); 
+                } else {
+                    const LhsEval Rv(0.0);
+                    return gasPvt_->viscosity(regionIdx, T, p, Rv, Rvw);
+                }
+            }
+
+            const LhsEval Rv(0.0);
+            const LhsEval Rvw(0.0);
+            return gasPvt_->viscosity(regionIdx, T, p, Rv, Rvw);
+        }
+
+        case waterPhaseIdx:
+            // since water is always assumed to be immiscible in the black-oil model,
+            // there is no "saturated water"
+            return waterPvt_->viscosity(regionIdx, T, p, saltConcentration);
+        }
+
+        throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+    }
+
+    //! \copydoc BaseFluidSystem::enthalpy
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval enthalpy(const FluidState& fluidState,
+                     unsigned phaseIdx,
+                     unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::enthalpy");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+
+        switch (phaseIdx) {
+        case oilPhaseIdx:
+            return
+                oilPvt_->internalEnergy(regionIdx, T, p, BlackOil::template getRs_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx))
+                + p/density<FluidState, LhsEval>(fluidState, phaseIdx, regionIdx);
+
+        case gasPhaseIdx:
+            return
+                 gasPvt_->internalEnergy(regionIdx, T, p, BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx))
+                  + p/density<FluidState, LhsEval>(fluidState, phaseIdx, regionIdx);
+
+        case waterPhaseIdx:
+            return
+                waterPvt_->internalEnergy(regionIdx, T, p, BlackOil::template getSaltConcentration_<ThisType, FluidState, LhsEval>(fluidState, regionIdx))
+                + p/density<FluidState, LhsEval>(fluidState, phaseIdx, regionIdx);
+
+        default: throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+        }
+
+        throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+    }
+
+    /*!
+     * \brief Returns the water vaporization factor \f$R_\alpha\f$ of saturated phase
+     *
+     * For the gas phase, this means the R_vw factor, for the water and oil phase,
+     * it is always 0.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval saturatedVaporizationFactor(const FluidState& fluidState,
+                                       unsigned phaseIdx,
+                                       unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::saturatedVaporizationFactor");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+        const auto& saltConcentration = decay<LhsEval>(fluidState.saltConcentration());
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: return 0.0;
+        case gasPhaseIdx: return gasPvt_->saturatedWaterVaporizationFactor(regionIdx, T, p, saltConcentration);
+        case waterPhaseIdx: return 0.0;
+        default: throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+        }
+    }
+
+    /*!
+     * \brief Returns the dissolution factor \f$R_\alpha\f$ of a saturated fluid phase
+     *
+     * For the oil (gas) phase, this means the R_s and R_v factors, for the water phase,
+     * it is always 0.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval saturatedDissolutionFactor(const FluidState& fluidState,
+                                       unsigned phaseIdx,
+                                       unsigned regionIdx,
+                                       const LhsEval& maxOilSaturation) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::saturatedDissolutionFactor");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+        const auto& So = decay<LhsEval>(fluidState.saturation(oilPhaseIdx));
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: return oilPvt_->saturatedGasDissolutionFactor(regionIdx, T, p, So, maxOilSaturation);
+        case gasPhaseIdx: return gasPvt_->saturatedOilVaporizationFactor(regionIdx, T, p, So, maxOilSaturation);
+        case waterPhaseIdx: return 0.0;
+        default: throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+        }
+    }
+
+    /*!
+     * \brief Returns the dissolution factor \f$R_\alpha\f$ of a saturated fluid phase
+     *
+     * For the oil (gas) phase, this means the R_s and R_v factors, for the water phase,
+     * it is always 0. The difference of this method compared to the previous one is that
+     * this method does not prevent dissolving a given component if the corresponding
+     * phase's saturation is small-
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval saturatedDissolutionFactor(const FluidState& fluidState,
+                                       unsigned phaseIdx,
+                                       unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::saturatedDissolutionFactor");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: return oilPvt_->saturatedGasDissolutionFactor(regionIdx, T, p);
+        case gasPhaseIdx: return gasPvt_->saturatedOilVaporizationFactor(regionIdx, T, p);
+        case waterPhaseIdx: return 0.0;
+        default: throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+        }
+    }
+
+    /*!
+     * \brief Returns the bubble point pressure $P_b$ using the current Rs
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval bubblePointPressure(const FluidState& fluidState,
+                                unsigned regionIdx) const
+    {
+        return saturationPressure(fluidState, oilPhaseIdx, regionIdx);
+    }
+
+
+    /*!
+     * \brief Returns the dew point pressure $P_d$ using the current Rv
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval dewPointPressure(const FluidState& fluidState,
+                                unsigned regionIdx) const
+    {
+        return saturationPressure(fluidState, gasPhaseIdx, regionIdx);
+    }
+
+    /*!
+     * \brief Returns the saturation pressure of a given phase [Pa] depending on its
+     *        composition.
+     *
+     * In the black-oil model, the saturation pressure it the pressure at which the fluid
+     * phase is in equilibrium with the gas phase, i.e., it is the inverse of the
+     * "dissolution factor". Note that a-priori this quantity is undefined for the water
+     * phase (because water is assumed to be immiscible with everything else). This method
+     * here just returns 0, though.
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    LhsEval saturationPressure(const FluidState& fluidState,
+                               unsigned phaseIdx,
+                               unsigned regionIdx) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::saturationPressure");
+        assert(phaseIdx <= numPhases);
+        assert(regionIdx <= numRegions());
+
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: return oilPvt_->saturationPressure(regionIdx, T, BlackOil::template getRs_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx));
+        case gasPhaseIdx: return gasPvt_->saturationPressure(regionIdx, T, BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx));
+        case waterPhaseIdx: return 0.0;
+        default: throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+        }
+    }
+
+    /****************************************
+     * Auxiliary and convenience methods for the black-oil model
+     ****************************************/
+    /*!
+     * \brief Convert the mass fraction of the gas component in the oil phase to the
+     *        corresponding gas dissolution factor.
+     */
+    template <class LhsEval>
+    LhsEval convertXoGToRs(const LhsEval& XoG, unsigned regionIdx) const
+    {
+        Scalar rho_oRef = referenceDensity_[regionIdx][oilPhaseIdx];
+        Scalar rho_gRef = referenceDensity_[regionIdx][gasPhaseIdx];
+
+        return XoG/(1.0 - XoG)*(rho_oRef/rho_gRef);
+    }
+
+    /*!
+     * \brief Convert the mass fraction of the oil component in the gas phase to the
+     *        corresponding oil vaporization factor.
+     */
+    template <class LhsEval>
+    LhsEval convertXgOToRv(const LhsEval& XgO, unsigned regionIdx) const
+    {
+        Scalar rho_oRef = referenceDensity_[regionIdx][oilPhaseIdx];
+        Scalar rho_gRef = referenceDensity_[regionIdx][gasPhaseIdx];
+
+        return XgO/(1.0 - XgO)*(rho_gRef/rho_oRef);
+    }
+
+    /*!
+     * \brief Convert the mass fraction of the water component in the gas phase to the
+     *        corresponding water vaporization factor.
+     */
+    template <class LhsEval>
+    LhsEval convertXgWToRvw(const LhsEval& XgW, unsigned regionIdx) const
+    {
+        Scalar rho_wRef = referenceDensity_[regionIdx][waterPhaseIdx];
+        Scalar rho_gRef = referenceDensity_[regionIdx][gasPhaseIdx];
+
+        return XgW/(1.0 - XgW)*(rho_gRef/rho_wRef);
+    }
+
+
+    /*!
+     * \brief Convert a gas dissolution factor to the the corresponding mass fraction
+     *        of the gas component in the oil phase.
+     */
+    template <class LhsEval>
+    LhsEval convertRsToXoG(const LhsEval& Rs, unsigned regionIdx) const
+    {
+        Scalar rho_oRef = referenceDensity_[regionIdx][oilPhaseIdx];
+        Scalar rho_gRef = referenceDensity_[regionIdx][gasPhaseIdx];
+
+        const LhsEval& rho_oG = Rs*rho_gRef;
+        return rho_oG/(rho_oRef + rho_oG);
+    }
+
+    /*!
+     * \brief Convert an oil vaporization factor to the corresponding mass fraction
+     *        of the oil component in the gas phase.
+     */
+    template <class LhsEval>
+    LhsEval convertRvToXgO(const LhsEval& Rv, unsigned regionIdx) const
+    {
+        Scalar rho_oRef = referenceDensity_[regionIdx][oilPhaseIdx];
+        Scalar rho_gRef = referenceDensity_[regionIdx][gasPhaseIdx];
+
+        const LhsEval& rho_gO = Rv*rho_oRef;
+        return rho_gO/(rho_gRef + rho_gO);
+    }
+
+    /*!
+     * \brief Convert an water vaporization factor to the corresponding mass fraction
+     *        of the water component in the gas phase.
+     */
+    template <class LhsEval>
+    LhsEval convertRvwToXgW(const LhsEval& Rvw, unsigned regionIdx) const
+    {
+        Scalar rho_wRef = referenceDensity_[regionIdx][waterPhaseIdx];
+        Scalar rho_gRef = referenceDensity_[regionIdx][gasPhaseIdx];
+
+        const LhsEval& rho_gW = Rvw*rho_wRef;
+        return rho_gW/(rho_gRef + rho_gW);
+    }
+
+    /*!
+     * \brief Convert a gas mass fraction in the oil phase the corresponding mole fraction.
+     */
+    template <class LhsEval>
+    LhsEval convertXoGToxoG(const LhsEval& XoG, unsigned regionIdx) const
+    {
+        Scalar MO = molarMass_[regionIdx][oilCompIdx];
+        Scalar MG = molarMass_[regionIdx][gasCompIdx];
+
+        return XoG*MO / (MG*(1 - XoG) + XoG*MO);
+    }
+
+    /*!
+     * \brief Convert a gas mole fraction in the oil phase the corresponding mass fraction.
+     */
+    template <class LhsEval>
+    LhsEval convertxoGToXoG(const LhsEval& xoG, unsigned regionIdx) const
+    {
+        Scalar MO = molarMass_[regionIdx][oilCompIdx];
+        Scalar MG = molarMass_[regionIdx][gasCompIdx];
+
+        return xoG*MG / (xoG*(MG - MO) + MO);
+    }
+
+    /*!
+     * \brief Convert a oil mass fraction in the gas phase the corresponding mole fraction.
+     */
+    template <class LhsEval>
+    LhsEval convertXgOToxgO(const LhsEval& XgO, unsigned regionIdx) const
+    {
+        Scalar MO = molarMass_[regionIdx][oilCompIdx];
+        Scalar MG = molarMass_[regionIdx][gasCompIdx];
+
+        return XgO*MG / (MO*(1 - XgO) + XgO*MG);
+    }
+
+    /*!
+     * \brief Convert a oil mole fraction in the gas phase the corresponding mass fraction.
+     */
+    template <class LhsEval>
+    LhsEval convertxgOToXgO(const LhsEval& xgO, unsigned regionIdx) const
+    {
+        Scalar MO = molarMass_[regionIdx][oilCompIdx];
+        Scalar MG = molarMass_[regionIdx][gasCompIdx];
+
+        return xgO*MO / (xgO*(MO - MG) + MG);
+    }
+
+    /*!
+     * \brief Return a reference to the low-level object which calculates the gas phase
+     *        quantities.
+     *
+     * \note It is not recommended to use this method directly, but the black-oil
+     *       specific methods of the fluid systems from above should be used instead.
+     */
+    const GasPvt& gasPvt() const
+    { return *gasPvt_; }
+
+    /*!
+     * \brief Return a reference to the low-level object which calculates the oil phase
+     *        quantities.
+     *
+     * \note It is not recommended to use this method directly, but the black-oil
+     *       specific methods of the fluid systems from above should be used instead.
+     */
+    const OilPvt& oilPvt() const
+    { return *oilPvt_; }
+
+    /*!
+     * \brief Return a reference to the low-level object which calculates the water phase
+     *        quantities.
+     *
+     * \note It is not recommended to use this method directly, but the black-oil
+     *       specific methods of the fluid systems from above should be used instead.
+     */
+    const WaterPvt& waterPvt() const
+    { return *waterPvt_; }
+
+    /*!
+     * \brief Set the temperature of the reservoir.
+     *
+     * This method is black-oil specific and only makes sense for isothermal simulations.
+     */
+    Scalar reservoirTemperature(unsigned = 0) const
+    { return reservoirTemperature_; }
+
+    /*!
+     * \brief Return the temperature of the reservoir.
+     *
+     * This method is black-oil specific and only makes sense for isothermal simulations.
+     */
+    void setReservoirTemperature(Scalar value)
+    { reservoirTemperature_ = value; }
+
+    short activeToCanonicalPhaseIdx(unsigned activePhaseIdx) const {
+        assert(activePhaseIdx<numActivePhases());
+        return activeToCanonicalPhaseIdx_[activePhaseIdx];
+    }
+
+    short canonicalToActivePhaseIdx(unsigned phaseIdx) const {
+        assert(phaseIdx<numPhases);
+        assert(phaseIsActive(phaseIdx));
+        return canonicalToActivePhaseIdx_[phaseIdx];
+    }
+
+    //! \copydoc BaseFluidSystem::diffusionCoefficient
+    Scalar diffusionCoefficient(unsigned compIdx, unsigned phaseIdx, unsigned regionIdx = 0) const
+    { return diffusionCoefficients_[regionIdx][numPhases*compIdx + phaseIdx]; }
+
+    //! \copydoc BaseFluidSystem::setDiffusionCoefficient
+    void setDiffusionCoefficient(Scalar coefficient, unsigned compIdx, unsigned phaseIdx, unsigned regionIdx = 0)
+    { diffusionCoefficients_[regionIdx][numPhases*compIdx + phaseIdx] = coefficient ; }
+
+    /*!
+     * \copydoc BaseFluidSystem::diffusionCoefficient
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParamCacheEval = LhsEval>
+    LhsEval diffusionCoefficient(const FluidState& fluidState,
+                                 const ParameterCache<ParamCacheEval>& paramCache,
+                                 unsigned phaseIdx,
+                                 unsigned compIdx) const
+    {
+        // diffusion is disabled by the user
+        if(!enableDiffusion())
+            return 0.0;
+
+        // diffusion coefficients are set, and we use them
+        if(!diffusionCoefficients_.empty()) {
+            return diffusionCoefficient(compIdx, phaseIdx, paramCache.regionIndex());
+        }
+
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& T = decay<LhsEval>(fluidState.temperature(phaseIdx));
+
+        switch (phaseIdx) {
+        case oilPhaseIdx: return oilPvt().diffusionCoefficient(T, p, compIdx);
+        case gasPhaseIdx: return gasPvt().diffusionCoefficient(T, p, compIdx);
+        case waterPhaseIdx: return 0.0;
+        default: throw std::logic_error("Unhandled phase index "+std::to_string(phaseIdx));
+        }
+    }
+
+private:
+    void resizeArrays_(size_t numRegions)
+    {
+        molarMass_.resize(numRegions);
+        referenceDensity_.resize(numRegions);
+    }
+
+    template <class Pvt, class OtherPvt>
+    static bool hasPvtType_(const std::shared_ptr<OtherPvt>& pvt)
+    {
+        if constexpr (std::is_same<Pvt, OtherPvt>::value)
+            return true;
+        else
+            // the PVT objects of inactive phases are not used
+            return !pvt || pvt->template realPvtIf<Pvt>() != nullptr;
+    }
+
+    // compute the properties of the cells of a single PVT region. the reference
+    // densities of the region are looked up once and the cells are processed phase by
+    // phase. the PVT implementation of each phase is only selected once per region and
+    // the inverse formation volume factor and the viscosity of a phase are determined
+    // by a single lookup. cellIndex(i) yields the position of the i-th cell in the
+    // arrays. the cursors are optional, i.e., cursors may be a null pointer.
+    template <class FluidState, class LhsEval, class CellIndexFn>
+    void computeRegionPhaseProperties_(PhaseProperties<LhsEval>* results,
+                                       const FluidState* fluidStates,
+                                       Cursor* cursors,
+                                       unsigned regionIdx,
+                                       size_t numCells,
+                                       CellIndexFn cellIndex) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("BlackOilFluidSystem::computePhaseProperties");
+        assert(regionIdx <= numRegions());
+
+        const auto& rhoRef = referenceDensity_[regionIdx];
+        const auto forEachCell = [&](const auto& fn) {
+            for (size_t i = 0; i < numCells; ++i) {
+                const auto cellIdx = cellIndex(i);
+                fn(results[cellIdx], fluidStates[cellIdx], cursors ? cursors + cellIdx : nullptr);
+            }
+        };
+
+        if (phaseIsActive(waterPhaseIdx)) {
+            PvtLookup::visitRealPvt(*waterPvt_, [&](const auto& waterPvt) {
+                forEachCell([&](PhaseProperties<LhsEval>& result, const FluidState& fluidState, Cursor*) {
+                    computeWaterPhaseProperties_(waterPvt, result, fluidState, regionIdx, rhoRef);
+                });
+            });
+        }
+
+        if (phaseIsActive(oilPhaseIdx)) {
+            PvtLookup::visitRealPvt(*oilPvt_, [&](const auto& oilPvt) {
+                forEachCell([&](PhaseProperties<LhsEval>& result, const FluidState& fluidState, Cursor* cursor) {
+                    computeOilPhaseProperties_(oilPvt, result, fluidState, cursor ? &cursor->oil : nullptr,
+                                               regionIdx, rhoRef);
+                });
+            });
+        }
+        else
+            forEachCell([](PhaseProperties<LhsEval>& result, const FluidState&, Cursor*) { result.saturatedRs = 0.0; });
+
+        if (phaseIsActive(gasPhaseIdx)) {
+            PvtLookup::visitRealPvt(*gasPvt_, [&](const auto& gasPvt) {
+                forEachCell([&](PhaseProperties<LhsEval>& result, const FluidState& fluidState, Cursor* cursor) {
+                    computeGasPhaseProperties_(gasPvt, result, fluidState, cursor ? &cursor->gas : nullptr,
+                                               regionIdx, rhoRef);
+                });
+            });
+        }
+        else
+            forEachCell([](PhaseProperties<LhsEval>& result, const FluidState&, Cursor*) { result.saturatedRv = 0.0; });
+    }
+
+    template <class WaterPvtImpl, class FluidState, class LhsEval>
+    void computeWaterPhaseProperties_(const WaterPvtImpl& waterPvt,
+                                      PhaseProperties<LhsEval>& result,
+                                      const FluidState& fluidState,
+                                      unsigned regionIdx,
+                                      const std::array<Scalar, numPhases>& rhoRef) const
+    {
+        const LhsEval& p = decay<LhsEval>(fluidState.pressure(waterPhaseIdx));
+        const LhsEval& T = decay<LhsEval>(fluidState.temperature(waterPhaseIdx));
+        const LhsEval& saltConcentration = BlackOil::template getSaltConcentration_<ThisType, FluidState, LhsEval>(fluidState, regionIdx);
+
+        LhsEval& bw = result.invB[waterPhaseIdx];
+        PvtLookup::inverseFormationVolumeFactorAndViscosity(waterPvt, bw, result.viscosity[waterPhaseIdx],
+                                                            regionIdx, T, p, saltConcentration);
+        result.density[waterPhaseIdx] = rhoRef[waterPhaseIdx]*bw;
+    }
+
+    template <class OilPvtImpl, class FluidState, class LhsEval>
+    void computeOilPhaseProperties_(const OilPvtImpl& oilPvt,
+                                    PhaseProperties<LhsEval>& result,
+                                    const FluidState& fluidState,
+                                    PvtCursor<Scalar>* cursor,
+                                    unsigned regionIdx,
+                                    const std::array<Scalar, numPhases>& rhoRef) const
+    {
+        const LhsEval& p = decay<LhsEval>(fluidState.pressure(oilPhaseIdx));
+        const LhsEval& T = decay<LhsEval>(fluidState.temperature(oilPhaseIdx));
+        LhsEval& bo = result.invB[oilPhaseIdx];
+        LhsEval& muo = result.viscosity[oilPhaseIdx];
+
+        if (enableDissolvedGas()) {
+            const LhsEval& Rs = BlackOil::template getRs_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+            result.saturatedRs = PvtLookup::saturatedGasDissolutionFactor(oilPvt, cursor, regionIdx, T, p);
+            if (fluidState.saturation(gasPhaseIdx) > 0.0
+                && Rs >= (1.0 - 1e-10)*scalarValue(result.saturatedRs))
+            {
+                PvtLookup::saturatedInverseFormationVolumeFactorAndViscosity(oilPvt, cursor, bo, muo, regionIdx, T, p);
+            } else {
+                PvtLookup::inverseFormationVolumeFactorAndViscosity(oilPvt, cursor, bo, muo, regionIdx, T, p, Rs);
+            }
+
+            result.density[oilPhaseIdx] =
+                lazy(bo)*rhoRef[oilPhaseIdx]
+                + lazy(Rs)*lazy(bo)*rhoRef[gasPhaseIdx];
+        }
+        else {
+            result.saturatedRs = 0.0;
+            const LhsEval Rs(0.0);
+            PvtLookup::inverseFormationVolumeFactorAndViscosity(oilPvt, cursor, bo, muo, regionIdx, T, p, Rs);
+            result.density[oilPhaseIdx] = rhoRef[oilPhaseIdx]*bo;
+        }
+    }
+
+    template <class GasPvtImpl, class FluidState, class LhsEval>
+    void computeGasPhaseProperties_(const GasPvtImpl& gasPvt,
+                                    PhaseProperties<LhsEval>& result,
+                                    const FluidState& fluidState,
+                                    PvtCursor<Scalar>* cursor,
+                                    unsigned regionIdx,
+                                    const std::array<Scalar, numPhases>& rhoRef) const
+    {
+        const LhsEval& p = decay<LhsEval>(fluidState.pressure(gasPhaseIdx));
+        const LhsEval& T = decay<LhsEval>(fluidState.temperature(gasPhaseIdx));
+        LhsEval& bg = result.invB[gasPhaseIdx];
+        LhsEval& mug = result.viscosity[gasPhaseIdx];
+
+        result.saturatedRv = 0.0;
+        LhsEval Rv(0.0);
+        LhsEval Rvw(0.0);
+        bool saturated = enableVaporizedOil() || enableVaporizedWater();
+        if (enableVaporizedWater()) {
+            Rvw = BlackOil::template getRvw_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+            saturated = fluidState.saturation(waterPhaseIdx) > 0.0
+                && Rvw >= (1.0 - 1e-10)*gasPvt.saturatedWaterVaporizationFactor(regionIdx, scalarValue(T), scalarValue(p));
+        }
+        if (enableVaporizedOil()) {
+            Rv = BlackOil::template getRv_<ThisType, FluidState, LhsEval>(*this, fluidState, regionIdx);
+            result.saturatedRv = PvtLookup::saturatedOilVaporizationFactor(gasPvt, cursor, regionIdx, T, p);
+            saturated = saturated
+                && fluidState.saturation(oilPhaseIdx) > 0.0
+                && Rv >= (1.0 - 1e-10)*scalarValue(result.saturatedRv);
+        }
+
+        if (saturated)
+            PvtLookup::saturatedInverseFormationVolumeFactorAndViscosity(gasPvt, cursor, bg, mug, regionIdx, T, p);
+        else
+            PvtLookup::inverseFormationVolumeFactorAndViscosity(gasPvt, cursor, bg, mug, regionIdx, T, p, Rv, Rvw);
+
+        LhsEval& rhoGas = result.density[gasPhaseIdx];
+        rhoGas = rhoRef[gasPhaseIdx]*bg;
+        if (enableVaporizedOil())
+            rhoGas += lazy(Rv)*lazy(bg)*rhoRef[oilPhaseIdx];
+        if (enableVaporizedWater())
+            rhoGas += lazy(Rvw)*lazy(bg)*rhoRef[waterPhaseIdx];
+    }
+
+    template <class Pvt, class OtherPvt>
+    static std::shared_ptr<Pvt> convertPvt_(const std::shared_ptr<OtherPvt>& pvt, const std::string& phaseName)
+    {
+        if constexpr (std::is_same<Pvt, OtherPvt>::value)
+            return pvt;
+        else {
+            if (!pvt)
+                return nullptr;
+
+            Pvt* realPvt = pvt->template realPvtIf<Pvt>();
+            if (!realPvt)
+                throw std::invalid_argument("The "+phaseName+" PVT relations of the fluid system "
+                                            "are not represented by the requested class");
+
+            // share the ownership with the multiplexer
+            return std::shared_ptr<Pvt>(pvt, realPvt);
+        }
+    }
+
+    template <class Pvt>
+    static bool samePvt_(const std::shared_ptr<Pvt>& pvt1, const std::shared_ptr<Pvt>& pvt2)
+    {
+        if (!pvt1 || !pvt2)
+            return pvt1 == pvt2;
+        return *pvt1 == *pvt2;
+    }
+
+    static std::string snapshotTag_()
+    {
+        std::string tag = "BlackOilFluidSystem<" + snapshotScalarName<Scalar>() + ">";
+        // the PVT objects of specialized fluid systems are serialized without the
+        // multiplexer, so their snapshots are not interchangeable
+        if (!std::is_same<OilPvt, OilPvtMultiplexer<Scalar>>::value
+            || !std::is_same<GasPvt, GasPvtMultiplexer<Scalar>>::value
+            || !std::is_same<WaterPvt, WaterPvtMultiplexer<Scalar>>::value)
+        {
+            tag += std::string("[") + typeid(OilPvt).name() + ","
+                + typeid(GasPvt).name() + "," + typeid(WaterPvt).name() + "]";
+        }
+        return tag;
+    }
+
+    Scalar reservoirTemperature_{};
+
+    std::shared_ptr<GasPvt> gasPvt_;
+    std::shared_ptr<OilPvt> oilPvt_;
+    std::shared_ptr<WaterPvt> waterPvt_;
+
+    bool enableDissolvedGas_{};
+    bool enableVaporizedOil_{};
+    bool enableVaporizedWater_{};
+    bool enableDiffusion_{};
+
+    // HACK for GCC 4.4: the array size has to be specified using the literal value '3'
+    // here, because GCC 4.4 seems to be unable to determine the number of phases from
+    // the BlackOil fluid system in the attribute declaration below...
+    std::vector<std::array<Scalar, /*numPhases=*/3> > referenceDensity_;
+    std::vector<std::array<Scalar, /*numComponents=*/3> > molarMass_;
+    std::vector<std::array<Scalar, /*numComponents=*/3 * /*numPhases=*/3> > diffusionCoefficients_;
+
+    std::array<short, numPhases> activeToCanonicalPhaseIdx_{};
+    std::array<short, numPhases> canonicalToActivePhaseIdx_{};
+
+    bool isInitialized_ = false;
+};
+
+/*!
+ * \brief Specifies the classes for the PVT relations of the oil, gas and water phases
+ *        for dispatchBlackOilFluidSystem().
+ */
+template <class OilPvtT, class GasPvtT, class WaterPvtT>
+struct BlackOilPvtTypes
+{};
+
+namespace BlackOil {
+template <class FluidSystem, class Visitor>
+decltype(auto) dispatchFluidSystem_(const FluidSystem& fluidSystem, Visitor&& visitor)
+{ return visitor(fluidSystem); }
+
+template <class FluidSystem, class Visitor,
+          class OilPvt, class GasPvt, class WaterPvt, class ...OtherPvtTypes>
+decltype(auto) dispatchFluidSystem_(const FluidSystem& fluidSystem,
+                                    Visitor&& visitor,
+                                    BlackOilPvtTypes<OilPvt, GasPvt, WaterPvt>,
+                                    OtherPvtTypes... otherPvtTypes)
+{
+    if (fluidSystem.template hasPvtTypes<OilPvt, GasPvt, WaterPvt>()) {
+        using SpecializedFluidSystem = typename FluidSystem::template WithPvt<OilPvt, GasPvt, WaterPvt>;
+        const SpecializedFluidSystem specializedFluidSystem(fluidSystem);
+        return visitor(specializedFluidSystem);
+    }
+
+    return dispatchFluidSystem_(fluidSystem, std::forward<Visitor>(visitor), otherPvtTypes...);
+}
+} // namespace BlackOil
+
+/*!
+ * \brief Call a visitor with the fluid system which is specialized for the PVT
+ *        classes which are actually used.
+ *
+ * The candidate PVT classes are specified as BlackOilPvtTypes template arguments and
+ * are tried in order. For the first one which matches the PVT approaches of the
+ * fluid system, the visitor is called with a fluid system of type
+ * FluidSystem::WithPvt<...>, which shares the PVT objects of the given one. If none
+ * matches, the visitor is called with the given fluid system. The visitor thus
+ * needs to be a generic callable which returns the same type for all candidates.
+ * Since the specialized fluid system only lives during the call, the visitor should
+ * run the complete computation, e.g., a loop over all cells:
+ *
+ * \code
+ * dispatchBlackOilFluidSystem<BlackOilPvtTypes<LiveOilPvt<double>,
+ *                                              WetGasPvt<double>,
+ *                                              ConstantCompressibilityWaterPvt<double>>>(
+ *     fluidSystem,
+ *     [&](const auto& fs) {
+ *         for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx)
+ *             fs.computePhaseProperties(props[cellIdx], fluidStates[cellIdx], regionIdx[cellIdx]);
+ *     });
+ * \endcode
+ */
+template <class ...PvtTypes, class FluidSystem, class Visitor>
+decltype(auto) dispatchBlackOilFluidSystem(const FluidSystem& fluidSystem, Visitor&& visitor)
+{
+    return BlackOil::dispatchFluidSystem_(fluidSystem,
+                                          std::forward<Visitor>(visitor),
+                                          PvtTypes{}...);
+}
+
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+// instantiated by libopmmaterial
+extern template class BlackOilFluidSystemNonStatic<double, BlackOilDefaultIndexTraits>;
+#endif
+
+} // namespace Opm
+
+#endif
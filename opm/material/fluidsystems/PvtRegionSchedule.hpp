@@ -0,0 +1,164 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PvtRegionSchedule
+ */
+#ifndef OPM_PVT_REGION_SCHEDULE_HPP
+#define OPM_PVT_REGION_SCHEDULE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Groups a set of cells by their PVT region.
+ *
+ * In a reservoir model, cells of different PVT regions are usually interleaved in
+ * memory, so evaluating the fluid properties in cell order jumps between the tables of
+ * unrelated regions. This class computes a permutation of the cells in which the cells
+ * of each region are contiguous, so that the tables of one region stay in the cache
+ * while its cells are processed. Within a region, the cells keep their original
+ * relative order.
+ *
+ * The schedule only depends on the region indices of the cells, i.e., it can be
+ * computed once and then be reused for all evaluations of fluid properties.
+ */
+class PvtRegionSchedule
+{
+public:
+    PvtRegionSchedule() = default;
+
+    /*!
+     * \brief Create a schedule for the cells [0, regionIndices.size()), cell i being
+     *        part of the PVT region regionIndices[i].
+     */
+    explicit PvtRegionSchedule(const std::vector<unsigned>& regionIndices)
+    { update(regionIndices.data(), regionIndices.size()); }
+
+    /*!
+     * \brief Recompute the schedule for the cells [0, numCells), cell i being part of
+     *        the PVT region regionIndices[i].
+     */
+    void update(const unsigned* regionIndices, size_t numCells)
+    {
+        std::vector<unsigned> cellIndices(numCells);
+        std::iota(cellIndices.begin(), cellIndices.end(), 0u);
+        update(cellIndices.data(), regionIndices, numCells);
+    }
+
+    /*!
+     * \brief Recompute the schedule for an arbitrary set of cells.
+     *
+     * The cell cellIndices[i] is part of the PVT region regionIndices[i].
+     */
+    void update(const unsigned* cellIndices, const unsigned* regionIndices, size_t numCells)
+    {
+        size_t numRegions = 0;
+        for (size_t i = 0; i < numCells; ++i)
+            numRegions = std::max<size_t>(numRegions, regionIndices[i] + 1);
+
+        // counting sort by region index
+        regionOffsets_.assign(numRegions + 1, 0);
+        for (size_t i = 0; i < numCells; ++i)
+            ++regionOffsets_[regionIndices[i] + 1];
+        std::partial_sum(regionOffsets_.begin(), regionOffsets_.end(), regionOffsets_.begin());
+
+        // the input may alias cellOrder_, so the new order is assembled separately
+        std::vector<unsigned> cellOrder(numCells);
+        std::vector<size_t> pos(regionOffsets_.begin(), regionOffsets_.end() - 1);
+        for (size_t i = 0; i < numCells; ++i)
+            cellOrder[pos[regionIndices[i]]++] = cellIndices[i];
+        cellOrder_.swap(cellOrder);
+    }
+
+    /*!
+     * \brief Returns the number of scheduled cells.
+     */
+    size_t numCells() const
+    { return cellOrder_.size(); }
+
+    /*!
+     * \brief Returns the number of PVT regions, i.e., the largest region index plus one.
+     */
+    size_t numRegions() const
+    { return regionOffsets_.empty() ? 0 : regionOffsets_.size() - 1; }
+
+    /*!
+     * \brief Returns the indices of all scheduled cells grouped by PVT region.
+     */
+    const std::vector<unsigned>& cellOrder() const
+    { return cellOrder_; }
+
+    /*!
+     * \brief Returns a pointer to the first cell index of a PVT region in cellOrder().
+     */
+    const unsigned* regionBegin(unsigned regionIdx) const
+    {
+        assert(regionIdx < numRegions());
+        return cellOrder_.data() + regionOffsets_[regionIdx];
+    }
+
+    /*!
+     * \brief Returns a pointer behind the last cell index of a PVT region in
+     *        cellOrder().
+     */
+    const unsigned* regionEnd(unsigned regionIdx) const
+    {
+        assert(regionIdx < numRegions());
+        return cellOrder_.data() + regionOffsets_[regionIdx + 1];
+    }
+
+    /*!
+     * \brief Returns the number of cells which are part of a PVT region.
+     */
+    size_t regionSize(unsigned regionIdx) const
+    { return static_cast<size_t>(regionEnd(regionIdx) - regionBegin(regionIdx)); }
+
+    /*!
+     * \brief Call a functor for each non-empty PVT region.
+     *
+     * The functor is called as fn(regionIdx, cellBegin, cellEnd) where [cellBegin,
+     * cellEnd) are the indices of the region's cells.
+     */
+    template <class Functor>
+    void forEachRegion(Functor&& fn) const
+    {
+        for (unsigned regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+            if (regionSize(regionIdx) > 0)
+                fn(regionIdx, regionBegin(regionIdx), regionEnd(regionIdx));
+        }
+    }
+
+private:
+    std::vector<unsigned> cellOrder_;
+    std::vector<size_t> regionOffsets_;
+};
+
+} // namespace Opm
+
+#endif
@@ -300,6 +300,15 @@ public:
                 brineReferenceDensity_ == data.brineReferenceDensity_;
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(brineReferenceDensity_);
+        serializer(co2ReferenceDensity_);
+        serializer(salinity_);
+        serializer(enableDissolution_);
+    }
+
     template <class Evaluation>
     Evaluation diffusionCoefficient(const Evaluation& temperature,
                                     const Evaluation& pressure,
@@ -32,6 +32,10 @@
 #include <opm/input/eclipse/Schedule/Schedule.hpp>
 #endif
 
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
 namespace Opm {
 /*!
  * \brief This class represents the Pressure-Volume-Temperature relations of the oil phase
@@ -297,6 +301,17 @@ public:
                this->oilViscosibility() == data.oilViscosibility();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(oilReferenceDensity_);
+        serializer(oilReferencePressure_);
+        serializer(oilReferenceFormationVolumeFactor_);
+        serializer(oilCompressibility_);
+        serializer(oilViscosity_);
+        serializer(oilViscosibility_);
+    }
+
 private:
     std::vector<Scalar> oilReferenceDensity_;
     std::vector<Scalar> oilReferencePressure_;
@@ -31,6 +31,8 @@
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
 #endif
 
+#include <cstddef>
+#include <stdexcept>
 #include <vector>
 
 namespace Opm {
@@ -234,6 +236,17 @@ public:
                this->waterViscosibility() == data.waterViscosibility();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(waterReferenceDensity_);
+        serializer(waterReferencePressure_);
+        serializer(waterReferenceFormationVolumeFactor_);
+        serializer(waterCompressibility_);
+        serializer(waterViscosity_);
+        serializer(waterViscosibility_);
+    }
+
 private:
     std::vector<Scalar> waterReferenceDensity_;
     std::vector<Scalar> waterReferencePressure_;
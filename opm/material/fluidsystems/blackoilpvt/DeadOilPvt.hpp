@@ -302,6 +302,15 @@ public:
                this->inverseOilBMu() == data.inverseOilBMu();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(oilReferenceDensity_);
+        serializer(inverseOilB_);
+        serializer(oilMu_);
+        serializer(inverseOilBMu_);
+    }
+
 private:
     std::vector<Scalar> oilReferenceDensity_;
     std::vector<TabulatedOneDFunction> inverseOilB_;
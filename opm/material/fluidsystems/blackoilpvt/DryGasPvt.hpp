@@ -338,6 +338,15 @@ public:
                inverseGasBMu_ == data.inverseGasBMu_;
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(gasReferenceDensity_);
+        serializer(inverseGasB_);
+        serializer(gasMu_);
+        serializer(inverseGasBMu_);
+    }
+
 private:
     std::vector<Scalar> gasReferenceDensity_;
     std::vector<TabulatedOneDFunction> inverseGasB_;
@@ -667,6 +667,23 @@ public:
                this->vapPar1() == data.vapPar1();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(gasReferenceDensity_);
+        serializer(waterReferenceDensity_);
+        serializer(inverseGasB_);
+        serializer(inverseSaturatedGasB_);
+        serializer(gasMu_);
+        serializer(inverseGasBMu_);
+        serializer(inverseSaturatedGasBMu_);
+        serializer(saturatedWaterVaporizationFactorTable_);
+        serializer(saturatedWaterVaporizationSaltFactorTable_);
+        serializer(saturationPressure_);
+        serializer(enableRwgSalt_);
+        serializer(vapPar1_);
+    }
+
 private:
     void updateSaturationPressure_(unsigned regionIdx)
     {
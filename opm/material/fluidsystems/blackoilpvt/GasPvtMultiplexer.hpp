@@ -33,6 +33,12 @@
 #include "WetGasPvt.hpp"
 #include "GasPvtThermal.hpp"
 #include "Co2GasPvt.hpp"
+#include "PvtCursor.hpp"
+#include "PvtLookup.hpp"
+
+#include <opm/material/densead/OperationCounter.hpp>
+
+#include <type_traits>
 
 #if HAVE_ECL_INPUT
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
@@ -99,6 +105,8 @@ template <class Scalar, bool enableThermal = true>
 class GasPvtMultiplexer
 {
 public:
+    using Cursor = PvtCursor<Scalar>;
+
     GasPvtMultiplexer()
     {
         gasPvtApproach_ = GasPvtApproach::NoGasPvt;
@@ -232,7 +240,10 @@ public:
                         const Evaluation& temperature,
                         const Evaluation& pressure,
                         const Evaluation& Rv) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.internalEnergy(regionIdx, temperature, pressure, Rv)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::internalEnergy");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.internalEnergy(regionIdx, temperature, pressure, Rv)); return 0;
+    }
 
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
@@ -243,7 +254,10 @@ public:
                          const Evaluation& pressure,
                          const Evaluation& Rv,
                          const Evaluation& Rvw ) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.viscosity(regionIdx, temperature, pressure, Rv, Rvw)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::viscosity");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.viscosity(regionIdx, temperature, pressure, Rv, Rvw)); return 0;
+    }
 
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of oil saturated gas given a set of parameters.
@@ -252,7 +266,10 @@ public:
     Evaluation saturatedViscosity(unsigned regionIdx,
                                   const Evaluation& temperature,
                                   const Evaluation& pressure) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedViscosity(regionIdx, temperature, pressure)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedViscosity");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedViscosity(regionIdx, temperature, pressure)); return 0;
+    }
 
     /*!
      * \brief Returns the formation volume factor [-] of the fluid phase.
@@ -263,7 +280,10 @@ public:
                                             const Evaluation& pressure,
                                             const Evaluation& Rv,
                                             const Evaluation& Rvw) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.inverseFormationVolumeFactor(regionIdx, temperature, pressure, Rv, Rvw)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::inverseFormationVolumeFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.inverseFormationVolumeFactor(regionIdx, temperature, pressure, Rv, Rvw)); return 0;
+    }
 
     /*!
      * \brief Returns the formation volume factor [-] of oil saturated gas given a set of parameters.
@@ -272,7 +292,84 @@ public:
     Evaluation saturatedInverseFormationVolumeFactor(unsigned regionIdx,
                                                      const Evaluation& temperature,
                                                      const Evaluation& pressure) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedInverseFormationVolumeFactor(regionIdx, temperature, pressure)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedInverseFormationVolumeFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedInverseFormationVolumeFactor(regionIdx, temperature, pressure)); return 0;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase.
+     *
+     * The PVT implementation is only selected once and determines both quantities
+     * using a single table lookup if it supports this.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& temperature,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rv,
+                                                  const Evaluation& Rvw,
+                                                  Evaluation& invBg,
+                                                  Evaluation& mug) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::inverseFormationVolumeFactorAndViscosity");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(PvtLookup::inverseFormationVolumeFactorAndViscosity(pvtImpl, invBg, mug, regionIdx, temperature, pressure, Rv, Rvw));
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase using a caller-owned lookup cursor.
+     *
+     * The cursor is ignored if the selected PVT implementation is not tabulated.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& temperature,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rv,
+                                                  const Evaluation& Rvw,
+                                                  Evaluation& invBg,
+                                                  Evaluation& mug,
+                                                  Cursor& cursor) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::inverseFormationVolumeFactorAndViscosity");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(PvtLookup::inverseFormationVolumeFactorAndViscosity(pvtImpl, &cursor, invBg, mug, regionIdx, temperature, pressure, Rv, Rvw));
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of oil saturated gas.
+     *
+     * The PVT implementation is only selected once and determines both quantities
+     * using a single table lookup if it supports this.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& temperature,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBg,
+                                                           Evaluation& mug) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedInverseFormationVolumeFactorAndViscosity");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(PvtLookup::saturatedInverseFormationVolumeFactorAndViscosity(pvtImpl, invBg, mug, regionIdx, temperature, pressure));
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of oil saturated gas using a caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& temperature,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBg,
+                                                           Evaluation& mug,
+                                                           Cursor& cursor) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedInverseFormationVolumeFactorAndViscosity");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(PvtLookup::saturatedInverseFormationVolumeFactorAndViscosity(pvtImpl, &cursor, invBg, mug, regionIdx, temperature, pressure));
+    }
 
     /*!
      * \brief Returns the oil vaporization factor \f$R_v\f$ [m^3/m^3] of oil saturated gas.
@@ -281,7 +378,24 @@ public:
     Evaluation saturatedOilVaporizationFactor(unsigned regionIdx,
                                               const Evaluation& temperature,
                                               const Evaluation& pressure) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedOilVaporizationFactor(regionIdx, temperature, pressure)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedOilVaporizationFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedOilVaporizationFactor(regionIdx, temperature, pressure)); return 0;
+    }
+
+    /*!
+     * \brief Returns the oil vaporization factor \f$R_v\f$ [m^3/m^3] of oil saturated gas using a
+     *        caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    Evaluation saturatedOilVaporizationFactor(unsigned regionIdx,
+                                              const Evaluation& temperature,
+                                              const Evaluation& pressure,
+                                              Cursor& cursor) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedOilVaporizationFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return PvtLookup::saturatedOilVaporizationFactor(pvtImpl, &cursor, regionIdx, temperature, pressure)); return 0;
+    }
 
     /*!
      * \brief Returns the oil vaporization factor \f$R_v\f$ [m^3/m^3] of oil saturated gas.
@@ -292,7 +406,10 @@ public:
                                               const Evaluation& pressure,
                                               const Evaluation& oilSaturation,
                                               const Evaluation& maxOilSaturation) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedOilVaporizationFactor(regionIdx, temperature, pressure, oilSaturation, maxOilSaturation)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedOilVaporizationFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedOilVaporizationFactor(regionIdx, temperature, pressure, oilSaturation, maxOilSaturation)); return 0;
+    }
 
     /*!
      * \brief Returns the water vaporization factor \f$R_vw\f$ [m^3/m^3] of water saturated gas.
@@ -301,7 +418,10 @@ public:
     Evaluation saturatedWaterVaporizationFactor(unsigned regionIdx,
                                               const Evaluation& temperature,
                                               const Evaluation& pressure) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedWaterVaporizationFactor(regionIdx, temperature, pressure)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedWaterVaporizationFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedWaterVaporizationFactor(regionIdx, temperature, pressure)); return 0;
+    }
     
     /*!
      * \brief Returns the water vaporization factor \f$R_vw\f$ [m^3/m^3] of water saturated gas.
@@ -311,7 +431,10 @@ public:
                                               const Evaluation& temperature,
                                               const Evaluation& pressure, 
                                               const Evaluation& saltConcentration) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedWaterVaporizationFactor(regionIdx, temperature, pressure, saltConcentration)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturatedWaterVaporizationFactor");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedWaterVaporizationFactor(regionIdx, temperature, pressure, saltConcentration)); return 0;
+    }
 
     /*!
      * \brief Returns the saturation pressure of the gas phase [Pa]
@@ -323,7 +446,10 @@ public:
     Evaluation saturationPressure(unsigned regionIdx,
                                   const Evaluation& temperature,
                                   const Evaluation& Rv) const
-    { OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturationPressure(regionIdx, temperature, Rv)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::saturationPressure");
+        OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.saturationPressure(regionIdx, temperature, Rv)); return 0;
+    }
 
     /*!
      * \copydoc BaseFluidSystem::diffusionCoefficient
@@ -333,6 +459,7 @@ public:
                                     const Evaluation& pressure,
                                     unsigned compIdx) const
     {
+        OPM_DENSEAD_COUNT_SCOPE("GasPvtMultiplexer::diffusionCoefficient");
       OPM_GAS_PVT_MULTIPLEXER_CALL(return pvtImpl.diffusionCoefficient(temperature, pressure, compIdx)); return 0;
     }
 
@@ -344,6 +471,34 @@ public:
     GasPvtApproach gasPvtApproach() const
     { return gasPvtApproach_; }
 
+    /*!
+     * \brief Call a functor with the PVT implementation which is used.
+     *
+     * The functor is called as visitor(pvtImpl), i.e., it must accept all PVT
+     * implementations of the gas phase.
+     */
+    template <class Visitor>
+    void visitRealPvt(Visitor&& visitor) const
+    { OPM_GAS_PVT_MULTIPLEXER_CALL(visitor(pvtImpl)); }
+
+    /*!
+     * \brief Returns the PVT implementation if it is of type RealPvt, or nullptr if
+     *        another approach is used.
+     */
+    template <class RealPvt>
+    RealPvt* realPvtIf()
+    {
+        if (gasPvtApproach_ == GasPvtApproach::NoGasPvt)
+            return nullptr;
+
+        OPM_GAS_PVT_MULTIPLEXER_CALL(if constexpr (std::is_same<std::decay_t<decltype(pvtImpl)>, RealPvt>::value) return &pvtImpl);
+        return nullptr;
+    }
+
+    template <class RealPvt>
+    const RealPvt* realPvtIf() const
+    { return const_cast<GasPvtMultiplexer*>(this)->template realPvtIf<RealPvt>(); }
+
     // get the parameter object for the dry gas case
     template <GasPvtApproach approachV>
     typename std::enable_if<approachV == GasPvtApproach::DryGasPvt, DryGasPvt<Scalar> >::type& getRealPvt()
@@ -463,6 +618,28 @@ public:
         }
     }
 
+    /*!
+     * \brief Write the PVT object to a snapshot or restore it from one.
+     *
+     * When reading, the multiplexer must not have been assigned a different approach
+     * before.
+     */
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        GasPvtApproach appr = gasPvtApproach_;
+        serializer(appr);
+        if (serializer.isReading() && appr != gasPvtApproach_) {
+            if (gasPvtApproach_ != GasPvtApproach::NoGasPvt)
+                throw std::logic_error("The approach of an initialized gas PVT object cannot be changed");
+            if (appr != GasPvtApproach::NoGasPvt)
+                setApproach(appr);
+        }
+
+        if (gasPvtApproach_ != GasPvtApproach::NoGasPvt)
+            OPM_GAS_PVT_MULTIPLEXER_CALL(serializer(pvtImpl));
+    }
+
     GasPvtMultiplexer<Scalar,enableThermal>& operator=(const GasPvtMultiplexer<Scalar,enableThermal>& data)
     {
         gasPvtApproach_ = data.gasPvtApproach_;
@@ -499,6 +676,12 @@ private:
 
 #undef OPM_GAS_PVT_MULTIPLEXER_CALL
 
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+// instantiated by libopmmaterial
+extern template class GasPvtMultiplexer<double, /*enableThermal=*/false>;
+extern template class GasPvtMultiplexer<double, /*enableThermal=*/true>;
+#endif
+
 } // namespace Opm
 
 #endif
@@ -286,19 +286,26 @@ public:
                 Evaluation alpha = (c1T + 2 * c2T * (temperature - Tref)) /
                     (1 + c1T  *(temperature - Tref) + c2T * (temperature - Tref) * (temperature - Tref));
 
-                constexpr const int N = 100; // value is experimental
-                Evaluation deltaP = (pressure - Pref)/N;
-                Evaluation enthalpyPresPrev = 0;
-                for (size_t i = 0; i < N; ++i) {
-                    Evaluation Pnew = Pref + i * deltaP;
-                    Evaluation rho = inverseFormationVolumeFactor(regionIdx, temperature, Pnew, Rv, Rvw) *
-                                     (gasReferenceDensity(regionIdx) + Rv * rhoRefO_[regionIdx]);
-                    // see e.g.https://en.wikipedia.org/wiki/Joule-Thomson_effect for a derivation of the Joule-Thomson coeff.
-                    Evaluation jouleThomsonCoefficient = -(1.0/Cp) * (1.0 - alpha * temperature)/rho;
-                    Evaluation deltaEnthalpyPres = -Cp * jouleThomsonCoefficient * deltaP;
-                    enthalpyPres = enthalpyPresPrev + deltaEnthalpyPres; 
-                    enthalpyPresPrev = enthalpyPres;
+                // integrate 1/rho over [Pref, p] by composite three-point Gauss-Legendre
+                // quadrature. unlike the left Riemann sum it does not evaluate the
+                // integrand at the lower bound, where the formation volume factor of gas
+                // is largest if Pref is close to atmospheric pressure.
+                constexpr int numIntervals = 8;
+                constexpr Scalar gaussPos[3] = { -0.774596669241483377, 0.0, 0.774596669241483377 };
+                constexpr Scalar gaussWeight[3] = { 5.0/9.0, 8.0/9.0, 5.0/9.0 };
+                Evaluation deltaP = (pressure - Pref)/numIntervals;
+                Evaluation invRhoIntegral = 0.0;
+                for (int i = 0; i < numIntervals; ++i) {
+                    for (int j = 0; j < 3; ++j) {
+                        const Scalar xi = i + (1 + gaussPos[j])/2;
+                        Evaluation Pnew = Pref + xi * deltaP;
+                        invRhoIntegral += gaussWeight[j]/inverseFormationVolumeFactor(regionIdx, temperature, Pnew, Rv, Rvw);
+                    }
                 }
+                invRhoIntegral *= 0.5*deltaP/(gasReferenceDensity(regionIdx) + Rv * rhoRefO_[regionIdx]);
+
+                // see e.g.https://en.wikipedia.org/wiki/Joule-Thomson_effect for a derivation of the Joule-Thomson coeff.
+                enthalpyPres = (1.0 - alpha * temperature) * invRhoIntegral;
             }
             else {
                   throw std::runtime_error("Requested Joule-thomson calculation but thermal gas density (GASDENT) is not provided");
@@ -522,11 +529,36 @@ public:
                 this->gasJTC() == data.gasJTC() &&
                 this->internalEnergyCurves() == data.internalEnergyCurves() &&
                 this->enableThermalDensity() == data.enableThermalDensity() &&
-                this->enableJouleThomson() == data.enableJouleThomson() &&
+                this->enableJouleThomsony() == data.enableJouleThomsony() &&
                 this->enableThermalViscosity() == data.enableThermalViscosity() &&
                 this->enableInternalEnergy() == data.enableInternalEnergy();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        bool hasIsothermalPvt = isothermalPvt_ != nullptr;
+        serializer(hasIsothermalPvt);
+        if (serializer.isReading()) {
+            delete isothermalPvt_;
+            isothermalPvt_ = hasIsothermalPvt ? new IsothermalPvt : nullptr;
+        }
+        if (isothermalPvt_)
+            serializer(*isothermalPvt_);
+        serializer(gasvisctCurves_);
+        serializer(gasdentRefTemp_);
+        serializer(gasdentCT1_);
+        serializer(gasdentCT2_);
+        serializer(gasJTRefPres_);
+        serializer(gasJTC_);
+        serializer(rhoRefO_);
+        serializer(internalEnergyCurves_);
+        serializer(enableThermalDensity_);
+        serializer(enableJouleThomson_);
+        serializer(enableThermalViscosity_);
+        serializer(enableInternalEnergy_);
+    }
+
     GasPvtThermal<Scalar>& operator=(const GasPvtThermal<Scalar>& data)
     {
         if (data.isothermalPvt_)
@@ -29,7 +29,9 @@
 
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/UniformXTabulated2DFunction.hpp>
+#include <opm/material/common/UniformXTabulated2DMultiFunction.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/PvtCursor.hpp>
 
 #if HAVE_ECL_INPUT
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
@@ -55,6 +57,8 @@ class LiveOilPvt
 public:
     using TabulatedTwoDFunction = UniformXTabulated2DFunction<Scalar>;
     using TabulatedOneDFunction = Tabulated1DFunction<Scalar>;
+    using FusedTwoDFunction = UniformXTabulated2DMultiFunction<Scalar, 2>;
+    using Cursor = PvtCursor<Scalar>;
 
     LiveOilPvt()
     {
@@ -83,7 +87,12 @@ public:
         , saturatedGasDissolutionFactorTable_(saturatedGasDissolutionFactorTable)
         , saturationPressure_(saturationPressure)
         , vapPar2_(vapPar2)
-    { }
+    {
+        inverseOilBAndBMuTable_.resize(inverseOilBTable_.size());
+        for (unsigned regionIdx = 0; regionIdx < inverseOilBTable_.size(); ++regionIdx)
+            updateInverseOilBAndBMuTable_(regionIdx);
+        updateExactSaturationPressures_();
+    }
 
 #if HAVE_ECL_INPUT
     /*!
@@ -263,12 +272,14 @@ public:
         gasReferenceDensity_.resize(numRegions);
         inverseOilBTable_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::LeftExtreme});
         inverseOilBMuTable_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::LeftExtreme});
+        inverseOilBAndBMuTable_.resize(numRegions);
         inverseSaturatedOilBTable_.resize(numRegions);
         inverseSaturatedOilBMuTable_.resize(numRegions);
         oilMuTable_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::LeftExtreme});
         saturatedOilMuTable_.resize(numRegions);
         saturatedGasDissolutionFactorTable_.resize(numRegions);
         saturationPressure_.resize(numRegions);
+        exactSaturationPressure_.resize(numRegions);
     }
 
     /*!
@@ -425,6 +436,7 @@ public:
             invSatOilBMu.setXYContainers(satPressuresArray, invSatOilBMuArray);
 
             updateSaturationPressure_(regionIdx);
+            updateInverseOilBAndBMuTable_(regionIdx);
         }
     }
 
@@ -451,17 +463,102 @@ public:
      */
     template <class Evaluation>
     Evaluation viscosity(unsigned regionIdx,
-                         const Evaluation& /*temperature*/,
+                         const Evaluation& temperature,
                          const Evaluation& pressure,
                          const Evaluation& Rs) const
     {
-        // ATTENTION: Rs is the first axis!
-        const Evaluation& invBo = inverseOilBTable_[regionIdx].eval(Rs, pressure, /*extrapolate=*/true);
-        const Evaluation& invMuoBo = inverseOilBMuTable_[regionIdx].eval(Rs, pressure, /*extrapolate=*/true);
+        Evaluation invBo, muo, invMuoBo;
+        inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure, Rs,
+                                                 invBo, muo, invMuoBo);
+        return muo;
+    }
 
-        return invBo/invMuoBo;
+    /*!
+     * \brief Returns the inverse formation volume factor [-], the dynamic viscosity [Pa s]
+     *        and the inverse of their product [1/(Pa s)] of the fluid phase.
+     *
+     * All three quantities are determined using a single lookup in the PVT table.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& /*temperature*/,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rs,
+                                                  Evaluation& invBo,
+                                                  Evaluation& muo,
+                                                  Evaluation& invMuoBo) const
+    {
+        undersaturatedLookup_(regionIdx, pressure, Rs, invBo, muo, invMuoBo,
+                              static_cast<typename TabulatedTwoDFunction::Cursor*>(nullptr));
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase.
+     *
+     * Both quantities are determined using a single lookup in the PVT table.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& temperature,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rs,
+                                                  Evaluation& invBo,
+                                                  Evaluation& muo) const
+    {
+        Evaluation invMuoBo;
+        inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure, Rs,
+                                                 invBo, muo, invMuoBo);
     }
 
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase using a caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& /*temperature*/,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rs,
+                                                  Evaluation& invBo,
+                                                  Evaluation& muo,
+                                                  Cursor& cursor) const
+    {
+        Evaluation invMuoBo;
+        undersaturatedLookup_(regionIdx, pressure, Rs, invBo, muo, invMuoBo, &cursor.undersaturated);
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the saturated fluid phase.
+     *
+     * The tables of both quantities are looked up using the same segment cursor, so
+     * the pressure segment only needs to be searched once.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& /*temperature*/,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBo,
+                                                           Evaluation& muo) const
+    {
+        SegmentCursor cursor;
+        saturatedLookup_(regionIdx, pressure, invBo, muo, cursor);
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the saturated fluid phase using a caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& /*temperature*/,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBo,
+                                                           Evaluation& muo,
+                                                           Cursor& cursor) const
+    { saturatedLookup_(regionIdx, pressure, invBo, muo, cursor.saturated); }
+
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
      */
@@ -511,6 +608,17 @@ public:
                                              const Evaluation& pressure) const
     { return saturatedGasDissolutionFactorTable_[regionIdx].eval(pressure, /*extrapolate=*/true); }
 
+    /*!
+     * \brief Returns the gas dissolution factor \f$R_s\f$ [m^3/m^3] of the oil phase using a
+     *        caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    Evaluation saturatedGasDissolutionFactor(unsigned regionIdx,
+                                             const Evaluation& /*temperature*/,
+                                             const Evaluation& pressure,
+                                             Cursor& cursor) const
+    { return saturatedGasDissolutionFactorTable_[regionIdx].eval(pressure, cursor.saturated, /*extrapolate=*/true); }
+
     /*!
      * \brief Returns the gas dissolution factor \f$R_s\f$ [m^3/m^3] of the oil phase.
      *
@@ -553,6 +661,17 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        // if the gas dissolution factor is strictly monotonic, its inverse is
+        // tabulated exactly and the saturation pressure is a single lookup
+        const auto& exactPSat = exactSaturationPressure_[regionIdx];
+        if (exactPSat.numSamples() > 0) {
+            const Evaluation& pSat = exactPSat.eval(Rs, /*extrapolate=*/true);
+            if (pSat < 0.0)
+                return 0.0;
+
+            return pSat;
+        }
+
         const auto& RsTable = saturatedGasDissolutionFactorTable_[regionIdx];
         constexpr const Scalar eps = std::numeric_limits<typename Toolbox::Scalar>::epsilon()*1e6;
 
@@ -655,7 +774,64 @@ public:
                this->vapPar2() == data.vapPar2();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(gasReferenceDensity_);
+        serializer(oilReferenceDensity_);
+        serializer(inverseOilBTable_);
+        serializer(oilMuTable_);
+        serializer(inverseOilBMuTable_);
+        serializer(inverseOilBAndBMuTable_);
+        serializer(saturatedOilMuTable_);
+        serializer(inverseSaturatedOilBTable_);
+        serializer(inverseSaturatedOilBMuTable_);
+        serializer(saturatedGasDissolutionFactorTable_);
+        serializer(saturationPressure_);
+        serializer(vapPar2_);
+        if (serializer.isReading())
+            updateExactSaturationPressures_();
+    }
+
 private:
+    template <class Evaluation, class TableCursor>
+    void undersaturatedLookup_(unsigned regionIdx,
+                               const Evaluation& pressure,
+                               const Evaluation& Rs,
+                               Evaluation& invBo,
+                               Evaluation& muo,
+                               Evaluation& invMuoBo,
+                               TableCursor* cursor) const
+    {
+        // ATTENTION: Rs is the first axis!
+        const auto& fusedTable = inverseOilBAndBMuTable_[regionIdx];
+        if (fusedTable.empty()) {
+            invBo = evalPvtTable(inverseOilBTable_[regionIdx], cursor, Rs, pressure);
+            invMuoBo = evalPvtTable(inverseOilBMuTable_[regionIdx], cursor, Rs, pressure);
+        }
+        else {
+            const auto& values = evalPvtTable(fusedTable, cursor, Rs, pressure);
+            invBo = values[0];
+            invMuoBo = values[1];
+        }
+
+        muo = invBo/invMuoBo;
+    }
+
+    // the tables of both quantities are looked up using the same segment cursor, so the
+    // pressure segment only needs to be searched once
+    template <class Evaluation>
+    void saturatedLookup_(unsigned regionIdx,
+                          const Evaluation& pressure,
+                          Evaluation& invBo,
+                          Evaluation& muo,
+                          SegmentCursor& cursor) const
+    {
+        invBo = inverseSaturatedOilBTable_[regionIdx].eval(pressure, cursor, /*extrapolate=*/true);
+        const Evaluation& invMuoBo = inverseSaturatedOilBMuTable_[regionIdx].eval(pressure, cursor, /*extrapolate=*/true);
+        muo = invBo/invMuoBo;
+    }
+
     void updateSaturationPressure_(unsigned regionIdx)
     {
         typedef std::pair<Scalar, Scalar> Pair;
@@ -685,6 +861,39 @@ private:
             pSatSamplePoints.erase(last, pSatSamplePoints.end());
 
         saturationPressure_[regionIdx].setContainerOfTuples(pSatSamplePoints);
+        updateExactSaturationPressure_(regionIdx);
+    }
+
+    // the inverse of a strictly monotonic Rs(p) table is again piecewise linear. if the
+    // table is not monotonic, the tabulated saturation pressure is only used as the
+    // initial guess of the Newton method.
+    void updateExactSaturationPressure_(unsigned regionIdx)
+    {
+        const auto& gasDissolutionFac = saturatedGasDissolutionFactorTable_[regionIdx];
+        if (gasDissolutionFac.isStrictlyMonotonic())
+            exactSaturationPressure_[regionIdx] = gasDissolutionFac.inverse();
+        else
+            exactSaturationPressure_[regionIdx] = TabulatedOneDFunction();
+    }
+
+    void updateExactSaturationPressures_()
+    {
+        exactSaturationPressure_.resize(saturatedGasDissolutionFactorTable_.size());
+        for (unsigned regionIdx = 0; regionIdx < exactSaturationPressure_.size(); ++regionIdx)
+            updateExactSaturationPressure_(regionIdx);
+    }
+
+    // store the inverse formation volume factor and the inverse of its product with the
+    // viscosity in a single table. this is only possible if both tables use the same
+    // sampling points, otherwise the individual tables are evaluated.
+    void updateInverseOilBAndBMuTable_(unsigned regionIdx)
+    {
+        const auto& invOilB = inverseOilBTable_[regionIdx];
+        const auto& invOilBMu = inverseOilBMuTable_[regionIdx];
+        if (invOilB.numX() > 1 && invOilB.hasSameSamplingPoints(invOilBMu))
+            inverseOilBAndBMuTable_[regionIdx].setQuantities({&invOilB, &invOilBMu});
+        else
+            inverseOilBAndBMuTable_[regionIdx] = FusedTwoDFunction();
     }
 
     std::vector<Scalar> gasReferenceDensity_;
@@ -692,11 +901,13 @@ private:
     std::vector<TabulatedTwoDFunction> inverseOilBTable_;
     std::vector<TabulatedTwoDFunction> oilMuTable_;
     std::vector<TabulatedTwoDFunction> inverseOilBMuTable_;
+    std::vector<FusedTwoDFunction> inverseOilBAndBMuTable_;
     std::vector<TabulatedOneDFunction> saturatedOilMuTable_;
     std::vector<TabulatedOneDFunction> inverseSaturatedOilBTable_;
     std::vector<TabulatedOneDFunction> inverseSaturatedOilBMuTable_;
     std::vector<TabulatedOneDFunction> saturatedGasDissolutionFactorTable_;
     std::vector<TabulatedOneDFunction> saturationPressure_;
+    std::vector<TabulatedOneDFunction> exactSaturationPressure_;
 
     Scalar vapPar2_;
 };
@@ -32,6 +32,12 @@
 #include "LiveOilPvt.hpp"
 #include "OilPvtThermal.hpp"
 #include "BrineCo2Pvt.hpp"
+#include "PvtCursor.hpp"
+#include "PvtLookup.hpp"
+
+#include <opm/material/densead/OperationCounter.hpp>
+
+#include <type_traits>
 
 #if HAVE_ECL_INPUT
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
@@ -95,6 +101,8 @@ template <class Scalar, bool enableThermal = true>
 class OilPvtMultiplexer
 {
 public:
+    using Cursor = PvtCursor<Scalar>;
+
     OilPvtMultiplexer()
     {
         approach_ = OilPvtApproach::NoOilPvt;
@@ -191,7 +199,10 @@ public:
                         const Evaluation& temperature,
                         const Evaluation& pressure,
                         const Evaluation& Rs) const
-    { OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.internalEnergy(regionIdx, temperature, pressure, Rs)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::internalEnergy");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.internalEnergy(regionIdx, temperature, pressure, Rs)); return 0;
+    }
 
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
@@ -201,7 +212,10 @@ public:
                          const Evaluation& temperature,
                          const Evaluation& pressure,
                          const Evaluation& Rs) const
-    { OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.viscosity(regionIdx, temperature, pressure, Rs)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::viscosity");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.viscosity(regionIdx, temperature, pressure, Rs)); return 0;
+    }
 
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
@@ -210,7 +224,10 @@ public:
     Evaluation saturatedViscosity(unsigned regionIdx,
                                   const Evaluation& temperature,
                                   const Evaluation& pressure) const
-    { OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedViscosity(regionIdx, temperature, pressure)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::saturatedViscosity");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedViscosity(regionIdx, temperature, pressure)); return 0;
+    }
 
     /*!
      * \brief Returns the formation volume factor [-] of the fluid phase.
@@ -220,7 +237,10 @@ public:
                                             const Evaluation& temperature,
                                             const Evaluation& pressure,
                                             const Evaluation& Rs) const
-    { OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.inverseFormationVolumeFactor(regionIdx, temperature, pressure, Rs)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::inverseFormationVolumeFactor");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.inverseFormationVolumeFactor(regionIdx, temperature, pressure, Rs)); return 0;
+    }
 
     /*!
      * \brief Returns the formation volume factor [-] of the fluid phase.
@@ -229,7 +249,82 @@ public:
     Evaluation saturatedInverseFormationVolumeFactor(unsigned regionIdx,
                                                      const Evaluation& temperature,
                                                      const Evaluation& pressure) const
-    { OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedInverseFormationVolumeFactor(regionIdx, temperature, pressure)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::saturatedInverseFormationVolumeFactor");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedInverseFormationVolumeFactor(regionIdx, temperature, pressure)); return 0;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase.
+     *
+     * The PVT implementation is only selected once and determines both quantities
+     * using a single table lookup if it supports this.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& temperature,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rs,
+                                                  Evaluation& invBo,
+                                                  Evaluation& muo) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::inverseFormationVolumeFactorAndViscosity");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(PvtLookup::inverseFormationVolumeFactorAndViscosity(pvtImpl, invBo, muo, regionIdx, temperature, pressure, Rs));
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase using a caller-owned lookup cursor.
+     *
+     * The cursor is ignored if the selected PVT implementation is not tabulated.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& temperature,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rs,
+                                                  Evaluation& invBo,
+                                                  Evaluation& muo,
+                                                  Cursor& cursor) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::inverseFormationVolumeFactorAndViscosity");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(PvtLookup::inverseFormationVolumeFactorAndViscosity(pvtImpl, &cursor, invBo, muo, regionIdx, temperature, pressure, Rs));
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of gas saturated oil.
+     *
+     * The PVT implementation is only selected once and determines both quantities
+     * using a single table lookup if it supports this.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& temperature,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBo,
+                                                           Evaluation& muo) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::saturatedInverseFormationVolumeFactorAndViscosity");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(PvtLookup::saturatedInverseFormationVolumeFactorAndViscosity(pvtImpl, invBo, muo, regionIdx, temperature, pressure));
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of gas saturated oil using a caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& temperature,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBo,
+                                                           Evaluation& muo,
+                                                           Cursor& cursor) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::saturatedInverseFormationVolumeFactorAndViscosity");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(PvtLookup::saturatedInverseFormationVolumeFactorAndViscosity(pvtImpl, &cursor, invBo, muo, regionIdx, temperature, pressure));
+    }
 
     /*!
      * \brief Returns the gas dissolution factor \f$R_s\f$ [m^3/m^3] of saturated oil.
@@ -238,7 +333,24 @@ public:
     Evaluation saturatedGasDissolutionFactor(unsigned regionIdx,
                                              const Evaluation& temperature,
                                              const Evaluation& pressure) const
-    { OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedGasDissolutionFactor(regionIdx, temperature, pressure)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::saturatedGasDissolutionFactor");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedGasDissolutionFactor(regionIdx, temperature, pressure)); return 0;
+    }
+
+    /*!
+     * \brief Returns the gas dissolution factor \f$R_s\f$ [m^3/m^3] of saturated oil using a
+     *        caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    Evaluation saturatedGasDissolutionFactor(unsigned regionIdx,
+                                             const Evaluation& temperature,
+                                             const Evaluation& pressure,
+                                             Cursor& cursor) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::saturatedGasDissolutionFactor");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return PvtLookup::saturatedGasDissolutionFactor(pvtImpl, &cursor, regionIdx, temperature, pressure)); return 0;
+    }
 
     /*!
      * \brief Returns the gas dissolution factor \f$R_s\f$ [m^3/m^3] of saturated oil.
@@ -249,7 +361,10 @@ public:
                                              const Evaluation& pressure,
                                              const Evaluation& oilSaturation,
                                              const Evaluation& maxOilSaturation) const
-    { OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedGasDissolutionFactor(regionIdx, temperature, pressure, oilSaturation, maxOilSaturation)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::saturatedGasDissolutionFactor");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturatedGasDissolutionFactor(regionIdx, temperature, pressure, oilSaturation, maxOilSaturation)); return 0;
+    }
 
     /*!
      * \brief Returns the saturation pressure [Pa] of oil given the mass fraction of the
@@ -262,7 +377,10 @@ public:
     Evaluation saturationPressure(unsigned regionIdx,
                                   const Evaluation& temperature,
                                   const Evaluation& Rs) const
-    { OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturationPressure(regionIdx, temperature, Rs)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::saturationPressure");
+        OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.saturationPressure(regionIdx, temperature, Rs)); return 0;
+    }
 
     /*!
      * \copydoc BaseFluidSystem::diffusionCoefficient
@@ -272,6 +390,7 @@ public:
                                     const Evaluation& pressure,
                                     unsigned compIdx) const
     {
+        OPM_DENSEAD_COUNT_SCOPE("OilPvtMultiplexer::diffusionCoefficient");
       OPM_OIL_PVT_MULTIPLEXER_CALL(return pvtImpl.diffusionCoefficient(temperature, pressure, compIdx)); return 0;
     }
 
@@ -313,6 +432,34 @@ public:
     OilPvtApproach approach() const
     { return approach_; }
 
+    /*!
+     * \brief Call a functor with the PVT implementation which is used.
+     *
+     * The functor is called as visitor(pvtImpl), i.e., it must accept all PVT
+     * implementations of the oil phase.
+     */
+    template <class Visitor>
+    void visitRealPvt(Visitor&& visitor) const
+    { OPM_OIL_PVT_MULTIPLEXER_CALL(visitor(pvtImpl)); }
+
+    /*!
+     * \brief Returns the PVT implementation if it is of type RealPvt, or nullptr if
+     *        another approach is used.
+     */
+    template <class RealPvt>
+    RealPvt* realPvtIf()
+    {
+        if (approach_ == OilPvtApproach::NoOilPvt)
+            return nullptr;
+
+        OPM_OIL_PVT_MULTIPLEXER_CALL(if constexpr (std::is_same<std::decay_t<decltype(pvtImpl)>, RealPvt>::value) return &pvtImpl);
+        return nullptr;
+    }
+
+    template <class RealPvt>
+    const RealPvt* realPvtIf() const
+    { return const_cast<OilPvtMultiplexer*>(this)->template realPvtIf<RealPvt>(); }
+
     // get the concrete parameter object for the oil phase
     template <OilPvtApproach approachV>
     typename std::enable_if<approachV == OilPvtApproach::LiveOilPvt, LiveOilPvt<Scalar> >::type& getRealPvt()
@@ -412,6 +559,28 @@ public:
         }
     }
 
+    /*!
+     * \brief Write the PVT object to a snapshot or restore it from one.
+     *
+     * When reading, the multiplexer must not have been assigned a different approach
+     * before.
+     */
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        OilPvtApproach appr = approach_;
+        serializer(appr);
+        if (serializer.isReading() && appr != approach_) {
+            if (approach_ != OilPvtApproach::NoOilPvt)
+                throw std::logic_error("The approach of an initialized oil PVT object cannot be changed");
+            if (appr != OilPvtApproach::NoOilPvt)
+                setApproach(appr);
+        }
+
+        if (approach_ != OilPvtApproach::NoOilPvt)
+            OPM_OIL_PVT_MULTIPLEXER_CALL(serializer(pvtImpl));
+    }
+
     OilPvtMultiplexer<Scalar,enableThermal>& operator=(const OilPvtMultiplexer<Scalar,enableThermal>& data)
     {
         approach_ = data.approach_;
@@ -445,6 +614,12 @@ private:
 
 #undef OPM_OIL_PVT_MULTIPLEXER_CALL
 
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+// instantiated by libopmmaterial
+extern template class OilPvtMultiplexer<double, /*enableThermal=*/false>;
+extern template class OilPvtMultiplexer<double, /*enableThermal=*/true>;
+#endif
+
 } // namespace Opm
 
 #endif
@@ -0,0 +1,69 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Caller-owned lookup cursors of the tables of the black-oil PVT classes.
+ */
+#ifndef OPM_PVT_CURSOR_HPP
+#define OPM_PVT_CURSOR_HPP
+
+#include <opm/material/common/SegmentCursor.hpp>
+#include <opm/material/common/UniformXTabulated2DFunction.hpp>
+
+namespace Opm {
+
+/*!
+ * \brief The lookup cursors of the tables of a fluid phase.
+ *
+ * All tabulated black-oil PVT classes use this type, so a PVT multiplexer can pass the
+ * cursor to whichever implementation it selects. The cursor is only a hint, i.e., the
+ * results are the same as without it, but the table segments of the previous lookup
+ * are checked first if the same cursor is used for a cell in subsequent calls.
+ */
+template <class Scalar>
+struct PvtCursor
+{
+    //! The cursor of the tables of the saturated phase, i.e., the ones which only
+    //! depend on pressure
+    SegmentCursor saturated;
+
+    //! The cursor of the two-dimensional tables of the undersaturated phase
+    typename UniformXTabulated2DFunction<Scalar>::Cursor undersaturated;
+};
+
+/*!
+ * \brief Evaluate a PVT table with extrapolation, using a lookup cursor if one is
+ *        given.
+ */
+template <class Table, class TableCursor, class... Evaluation>
+auto evalPvtTable(const Table& table, TableCursor* cursor, const Evaluation&... position)
+{
+    if (cursor)
+        return table.eval(position..., *cursor, /*extrapolate=*/true);
+    return table.eval(position..., /*extrapolate=*/true);
+}
+
+} // namespace Opm
+
+#endif
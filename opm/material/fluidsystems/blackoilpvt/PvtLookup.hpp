@@ -0,0 +1,339 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Functions which determine several quantities of a black-oil PVT object at
+ *        once.
+ */
+#ifndef OPM_PVT_LOOKUP_HPP
+#define OPM_PVT_LOOKUP_HPP
+
+namespace Opm {
+namespace PvtLookup {
+
+// the overloads taking an int are selected if the PVT class provides the respective
+// method, the ones taking a long are the fallbacks
+template <class Pvt, class Visitor>
+auto visitRealPvt_(int, const Pvt& pvt, Visitor& visitor)
+    -> decltype(pvt.visitRealPvt(visitor))
+{ return pvt.visitRealPvt(visitor); }
+
+template <class Pvt, class Visitor>
+void visitRealPvt_(long, const Pvt& pvt, Visitor& visitor)
+{ visitor(pvt); }
+
+template <class Pvt, class Evaluation, class... Composition>
+auto inverseFormationVolumeFactorAndViscosity_(int,
+                                               const Pvt& pvt,
+                                               Evaluation& invB,
+                                               Evaluation& mu,
+                                               unsigned regionIdx,
+                                               const Evaluation& temperature,
+                                               const Evaluation& pressure,
+                                               const Composition&... composition)
+    -> decltype(pvt.inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure,
+                                                             composition..., invB, mu))
+{
+    return pvt.inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure,
+                                                        composition..., invB, mu);
+}
+
+template <class Pvt, class Evaluation, class... Composition>
+void inverseFormationVolumeFactorAndViscosity_(long,
+                                               const Pvt& pvt,
+                                               Evaluation& invB,
+                                               Evaluation& mu,
+                                               unsigned regionIdx,
+                                               const Evaluation& temperature,
+                                               const Evaluation& pressure,
+                                               const Composition&... composition)
+{
+    invB = pvt.inverseFormationVolumeFactor(regionIdx, temperature, pressure, composition...);
+    mu = pvt.viscosity(regionIdx, temperature, pressure, composition...);
+}
+
+template <class Pvt, class Evaluation>
+auto saturatedInverseFormationVolumeFactorAndViscosity_(int,
+                                                        const Pvt& pvt,
+                                                        Evaluation& invB,
+                                                        Evaluation& mu,
+                                                        unsigned regionIdx,
+                                                        const Evaluation& temperature,
+                                                        const Evaluation& pressure)
+    -> decltype(pvt.saturatedInverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure,
+                                                                      invB, mu))
+{
+    return pvt.saturatedInverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure,
+                                                                 invB, mu);
+}
+
+template <class Pvt, class Evaluation>
+void saturatedInverseFormationVolumeFactorAndViscosity_(long,
+                                                        const Pvt& pvt,
+                                                        Evaluation& invB,
+                                                        Evaluation& mu,
+                                                        unsigned regionIdx,
+                                                        const Evaluation& temperature,
+                                                        const Evaluation& pressure)
+{
+    invB = pvt.saturatedInverseFormationVolumeFactor(regionIdx, temperature, pressure);
+    mu = pvt.saturatedViscosity(regionIdx, temperature, pressure);
+}
+
+// the cursor is passed to the PVT object if it accepts one
+template <class Pvt, class Cursor, class Evaluation, class... Composition>
+auto inverseFormationVolumeFactorAndViscosityCursor_(int,
+                                                     const Pvt& pvt,
+                                                     Cursor& cursor,
+                                                     Evaluation& invB,
+                                                     Evaluation& mu,
+                                                     unsigned regionIdx,
+                                                     const Evaluation& temperature,
+                                                     const Evaluation& pressure,
+                                                     const Composition&... composition)
+    -> decltype(pvt.inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure,
+                                                             composition..., invB, mu, cursor))
+{
+    return pvt.inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure,
+                                                        composition..., invB, mu, cursor);
+}
+
+template <class Pvt, class Cursor, class Evaluation, class... Composition>
+void inverseFormationVolumeFactorAndViscosityCursor_(long,
+                                                     const Pvt& pvt,
+                                                     Cursor&,
+                                                     Evaluation& invB,
+                                                     Evaluation& mu,
+                                                     unsigned regionIdx,
+                                                     const Evaluation& temperature,
+                                                     const Evaluation& pressure,
+                                                     const Composition&... composition)
+{
+    inverseFormationVolumeFactorAndViscosity_(/*preferCombined=*/0, pvt, invB, mu,
+                                              regionIdx, temperature, pressure, composition...);
+}
+
+template <class Pvt, class Cursor, class Evaluation>
+auto saturatedInverseFormationVolumeFactorAndViscosityCursor_(int,
+                                                              const Pvt& pvt,
+                                                              Cursor& cursor,
+                                                              Evaluation& invB,
+                                                              Evaluation& mu,
+                                                              unsigned regionIdx,
+                                                              const Evaluation& temperature,
+                                                              const Evaluation& pressure)
+    -> decltype(pvt.saturatedInverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure,
+                                                                      invB, mu, cursor))
+{
+    return pvt.saturatedInverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure,
+                                                                 invB, mu, cursor);
+}
+
+template <class Pvt, class Cursor, class Evaluation>
+void saturatedInverseFormationVolumeFactorAndViscosityCursor_(long,
+                                                              const Pvt& pvt,
+                                                              Cursor&,
+                                                              Evaluation& invB,
+                                                              Evaluation& mu,
+                                                              unsigned regionIdx,
+                                                              const Evaluation& temperature,
+                                                              const Evaluation& pressure)
+{
+    saturatedInverseFormationVolumeFactorAndViscosity_(/*preferCombined=*/0, pvt, invB, mu,
+                                                       regionIdx, temperature, pressure);
+}
+
+template <class Pvt, class Cursor, class Evaluation>
+auto saturatedGasDissolutionFactor_(int,
+                                    const Pvt& pvt,
+                                    Cursor& cursor,
+                                    unsigned regionIdx,
+                                    const Evaluation& temperature,
+                                    const Evaluation& pressure)
+    -> decltype(pvt.saturatedGasDissolutionFactor(regionIdx, temperature, pressure, cursor))
+{ return pvt.saturatedGasDissolutionFactor(regionIdx, temperature, pressure, cursor); }
+
+template <class Pvt, class Cursor, class Evaluation>
+Evaluation saturatedGasDissolutionFactor_(long,
+                                          const Pvt& pvt,
+                                          Cursor&,
+                                          unsigned regionIdx,
+                                          const Evaluation& temperature,
+                                          const Evaluation& pressure)
+{ return pvt.saturatedGasDissolutionFactor(regionIdx, temperature, pressure); }
+
+template <class Pvt, class Cursor, class Evaluation>
+auto saturatedOilVaporizationFactor_(int,
+                                     const Pvt& pvt,
+                                     Cursor& cursor,
+                                     unsigned regionIdx,
+                                     const Evaluation& temperature,
+                                     const Evaluation& pressure)
+    -> decltype(pvt.saturatedOilVaporizationFactor(regionIdx, temperature, pressure, cursor))
+{ return pvt.saturatedOilVaporizationFactor(regionIdx, temperature, pressure, cursor); }
+
+template <class Pvt, class Cursor, class Evaluation>
+Evaluation saturatedOilVaporizationFactor_(long,
+                                           const Pvt& pvt,
+                                           Cursor&,
+                                           unsigned regionIdx,
+                                           const Evaluation& temperature,
+                                           const Evaluation& pressure)
+{ return pvt.saturatedOilVaporizationFactor(regionIdx, temperature, pressure); }
+
+/*!
+ * \brief Call a functor with the PVT implementation which is selected by a multiplexer.
+ *
+ * If the PVT object is not a multiplexer, i.e., it does not provide a visitRealPvt()
+ * method, the functor is called with the object itself. This allows to use several
+ * methods of the PVT implementation while selecting it only once.
+ */
+template <class Pvt, class Visitor>
+void visitRealPvt(const Pvt& pvt, Visitor&& visitor)
+{ visitRealPvt_(/*preferMultiplexer=*/0, pvt, visitor); }
+
+/*!
+ * \brief Compute the inverse formation volume factor [-] and the dynamic viscosity
+ *        [Pa s] of a fluid phase.
+ *
+ * If the PVT object provides an inverseFormationVolumeFactorAndViscosity() method, both
+ * quantities are determined by a single call to it. Otherwise, the
+ * inverseFormationVolumeFactor() and viscosity() methods are called. The composition
+ * arguments are the ones of these methods, e.g., R_s for oil.
+ */
+template <class Pvt, class Evaluation, class... Composition>
+void inverseFormationVolumeFactorAndViscosity(const Pvt& pvt,
+                                              Evaluation& invB,
+                                              Evaluation& mu,
+                                              unsigned regionIdx,
+                                              const Evaluation& temperature,
+                                              const Evaluation& pressure,
+                                              const Composition&... composition)
+{
+    inverseFormationVolumeFactorAndViscosity_(/*preferCombined=*/0, pvt, invB, mu,
+                                              regionIdx, temperature, pressure, composition...);
+}
+
+/*!
+ * \brief Compute the inverse formation volume factor [-] and the dynamic viscosity
+ *        [Pa s] of a saturated fluid phase.
+ *
+ * If the PVT object provides a saturatedInverseFormationVolumeFactorAndViscosity()
+ * method, both quantities are determined by a single call to it. Otherwise, the
+ * saturatedInverseFormationVolumeFactor() and saturatedViscosity() methods are called.
+ */
+template <class Pvt, class Evaluation>
+void saturatedInverseFormationVolumeFactorAndViscosity(const Pvt& pvt,
+                                                       Evaluation& invB,
+                                                       Evaluation& mu,
+                                                       unsigned regionIdx,
+                                                       const Evaluation& temperature,
+                                                       const Evaluation& pressure)
+{
+    saturatedInverseFormationVolumeFactorAndViscosity_(/*preferCombined=*/0, pvt, invB, mu,
+                                                       regionIdx, temperature, pressure);
+}
+
+/*!
+ * \brief Compute the inverse formation volume factor [-] and the dynamic viscosity
+ *        [Pa s] of a fluid phase using a caller-owned lookup cursor.
+ *
+ * The cursor is ignored if it is a null pointer or if the PVT object does not accept
+ * it, e.g., because it is not tabulated. The results do not depend on the cursor.
+ */
+template <class Pvt, class Cursor, class Evaluation, class... Composition>
+void inverseFormationVolumeFactorAndViscosity(const Pvt& pvt,
+                                              Cursor* cursor,
+                                              Evaluation& invB,
+                                              Evaluation& mu,
+                                              unsigned regionIdx,
+                                              const Evaluation& temperature,
+                                              const Evaluation& pressure,
+                                              const Composition&... composition)
+{
+    if (cursor)
+        inverseFormationVolumeFactorAndViscosityCursor_(/*preferCursor=*/0, pvt, *cursor, invB, mu,
+                                                        regionIdx, temperature, pressure, composition...);
+    else
+        inverseFormationVolumeFactorAndViscosity_(/*preferCombined=*/0, pvt, invB, mu,
+                                                  regionIdx, temperature, pressure, composition...);
+}
+
+/*!
+ * \brief Compute the inverse formation volume factor [-] and the dynamic viscosity
+ *        [Pa s] of a saturated fluid phase using a caller-owned lookup cursor.
+ */
+template <class Pvt, class Cursor, class Evaluation>
+void saturatedInverseFormationVolumeFactorAndViscosity(const Pvt& pvt,
+                                                       Cursor* cursor,
+                                                       Evaluation& invB,
+                                                       Evaluation& mu,
+                                                       unsigned regionIdx,
+                                                       const Evaluation& temperature,
+                                                       const Evaluation& pressure)
+{
+    if (cursor)
+        saturatedInverseFormationVolumeFactorAndViscosityCursor_(/*preferCursor=*/0, pvt, *cursor, invB, mu,
+                                                                 regionIdx, temperature, pressure);
+    else
+        saturatedInverseFormationVolumeFactorAndViscosity_(/*preferCombined=*/0, pvt, invB, mu,
+                                                           regionIdx, temperature, pressure);
+}
+
+/*!
+ * \brief Compute the gas dissolution factor \f$R_s\f$ [m^3/m^3] of saturated oil using a
+ *        caller-owned lookup cursor.
+ */
+template <class Pvt, class Cursor, class Evaluation>
+Evaluation saturatedGasDissolutionFactor(const Pvt& pvt,
+                                         Cursor* cursor,
+                                         unsigned regionIdx,
+                                         const Evaluation& temperature,
+                                         const Evaluation& pressure)
+{
+    if (!cursor)
+        return pvt.saturatedGasDissolutionFactor(regionIdx, temperature, pressure);
+    return saturatedGasDissolutionFactor_(/*preferCursor=*/0, pvt, *cursor, regionIdx, temperature, pressure);
+}
+
+/*!
+ * \brief Compute the oil vaporization factor \f$R_v\f$ [m^3/m^3] of saturated gas using a
+ *        caller-owned lookup cursor.
+ */
+template <class Pvt, class Cursor, class Evaluation>
+Evaluation saturatedOilVaporizationFactor(const Pvt& pvt,
+                                          Cursor* cursor,
+                                          unsigned regionIdx,
+                                          const Evaluation& temperature,
+                                          const Evaluation& pressure)
+{
+    if (!cursor)
+        return pvt.saturatedOilVaporizationFactor(regionIdx, temperature, pressure);
+    return saturatedOilVaporizationFactor_(/*preferCursor=*/0, pvt, *cursor, regionIdx, temperature, pressure);
+}
+
+} // namespace PvtLookup
+} // namespace Opm
+
+#endif
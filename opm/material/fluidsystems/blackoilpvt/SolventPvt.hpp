@@ -230,6 +230,15 @@ public:
                inverseSolventBMu_ == data.inverseSolventBMu_;
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(solventReferenceDensity_);
+        serializer(inverseSolventB_);
+        serializer(solventMu_);
+        serializer(inverseSolventBMu_);
+    }
+
 private:
     std::vector<Scalar> solventReferenceDensity_;
     std::vector<TabulatedOneDFunction> inverseSolventB_;
@@ -30,6 +30,11 @@
 #include "ConstantCompressibilityWaterPvt.hpp"
 #include "ConstantCompressibilityBrinePvt.hpp"
 #include "WaterPvtThermal.hpp"
+#include "PvtLookup.hpp"
+
+#include <opm/material/densead/OperationCounter.hpp>
+
+#include <type_traits>
 
 #if HAVE_ECL_INPUT
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
@@ -155,7 +160,10 @@ public:
                         const Evaluation& temperature,
                         const Evaluation& pressure,
                         const Evaluation& saltconcentration) const
-    { OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.internalEnergy(regionIdx, temperature, pressure, saltconcentration)); return 0; }
+    {
+        OPM_DENSEAD_COUNT_SCOPE("WaterPvtMultiplexer::internalEnergy");
+        OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.internalEnergy(regionIdx, temperature, pressure, saltconcentration)); return 0;
+    }
 
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of the fluid phase given a set of parameters.
@@ -166,6 +174,7 @@ public:
                          const Evaluation& pressure,
                          const Evaluation& saltconcentration) const
     {
+        OPM_DENSEAD_COUNT_SCOPE("WaterPvtMultiplexer::viscosity");
         OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.viscosity(regionIdx, temperature, pressure, saltconcentration));
         return 0;
     }
@@ -178,10 +187,31 @@ public:
                                             const Evaluation& temperature,
                                             const Evaluation& pressure,
                                             const Evaluation& saltconcentration) const
-    {   OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.inverseFormationVolumeFactor(regionIdx, temperature, pressure, saltconcentration));
+    {
+        OPM_DENSEAD_COUNT_SCOPE("WaterPvtMultiplexer::inverseFormationVolumeFactor");
+        OPM_WATER_PVT_MULTIPLEXER_CALL(return pvtImpl.inverseFormationVolumeFactor(regionIdx, temperature, pressure, saltconcentration));
         return 0;
     }
 
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase.
+     *
+     * The PVT implementation is only selected once and determines both quantities
+     * using a single table lookup if it supports this.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& temperature,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& saltconcentration,
+                                                  Evaluation& invBw,
+                                                  Evaluation& muw) const
+    {
+        OPM_DENSEAD_COUNT_SCOPE("WaterPvtMultiplexer::inverseFormationVolumeFactorAndViscosity");
+        OPM_WATER_PVT_MULTIPLEXER_CALL(PvtLookup::inverseFormationVolumeFactorAndViscosity(pvtImpl, invBw, muw, regionIdx, temperature, pressure, saltconcentration));
+    }
+
     void setApproach(WaterPvtApproach appr)
     {
         switch (appr) {
@@ -212,6 +242,34 @@ public:
     WaterPvtApproach approach() const
     { return approach_; }
 
+    /*!
+     * \brief Call a functor with the PVT implementation which is used.
+     *
+     * The functor is called as visitor(pvtImpl), i.e., it must accept all PVT
+     * implementations of the water phase.
+     */
+    template <class Visitor>
+    void visitRealPvt(Visitor&& visitor) const
+    { OPM_WATER_PVT_MULTIPLEXER_CALL(visitor(pvtImpl)); }
+
+    /*!
+     * \brief Returns the PVT implementation if it is of type RealPvt, or nullptr if
+     *        another approach is used.
+     */
+    template <class RealPvt>
+    RealPvt* realPvtIf()
+    {
+        if (approach_ == WaterPvtApproach::NoWaterPvt)
+            return nullptr;
+
+        OPM_WATER_PVT_MULTIPLEXER_CALL(if constexpr (std::is_same<std::decay_t<decltype(pvtImpl)>, RealPvt>::value) return &pvtImpl);
+        return nullptr;
+    }
+
+    template <class RealPvt>
+    const RealPvt* realPvtIf() const
+    { return const_cast<WaterPvtMultiplexer*>(this)->template realPvtIf<RealPvt>(); }
+
     // get the concrete parameter object for the water phase
     template <WaterPvtApproach approachV>
     typename std::enable_if<approachV == WaterPvtApproach::ConstantCompressibilityWaterPvt, ConstantCompressibilityWaterPvt<Scalar> >::type& getRealPvt()
@@ -277,6 +335,28 @@ public:
         }
     }
 
+    /*!
+     * \brief Write the PVT object to a snapshot or restore it from one.
+     *
+     * When reading, the multiplexer must not have been assigned a different approach
+     * before.
+     */
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        WaterPvtApproach appr = approach_;
+        serializer(appr);
+        if (serializer.isReading() && appr != approach_) {
+            if (approach_ != WaterPvtApproach::NoWaterPvt)
+                throw std::logic_error("The approach of an initialized water PVT object cannot be changed");
+            if (appr != WaterPvtApproach::NoWaterPvt)
+                setApproach(appr);
+        }
+
+        if (approach_ != WaterPvtApproach::NoWaterPvt)
+            OPM_WATER_PVT_MULTIPLEXER_CALL(serializer(pvtImpl));
+    }
+
     WaterPvtMultiplexer<Scalar,enableThermal,enableBrine>& operator=(const WaterPvtMultiplexer<Scalar,enableThermal,enableBrine>& data)
     {
         approach_ = data.approach_;
@@ -304,6 +384,12 @@ private:
 
 #undef OPM_WATER_PVT_MULTIPLEXER_CALL
 
+#if OPM_MATERIAL_EXTERN_TEMPLATES
+// instantiated by libopmmaterial
+extern template class WaterPvtMultiplexer<double, /*enableThermal=*/false, /*enableBrine=*/true>;
+extern template class WaterPvtMultiplexer<double, /*enableThermal=*/true, /*enableBrine=*/true>;
+#endif
+
 } // namespace Opm
 
 #endif
@@ -309,17 +309,12 @@ public:
                 Evaluation alpha = (c1T + 2 * c2T * (temperature - Tref)) /
                     (1 + c1T  *(temperature - Tref) + c2T * (temperature - Tref) * (temperature - Tref));
 
-                constexpr const int N = 100; // value is experimental
-                Evaluation deltaP = (pressure - Pref)/N;
-                Evaluation enthalpyPresPrev = 0;
-                for (size_t i = 0; i < N; ++i) {
-                    Evaluation Pnew = Pref + i * deltaP;
-                    Evaluation rho = inverseFormationVolumeFactor(regionIdx, temperature, Pnew, saltconcentration) * waterReferenceDensity(regionIdx);
-                    Evaluation jouleThomsonCoefficient = -(1.0/Cp) * (1.0 - alpha * temperature)/rho;  
-                    Evaluation deltaEnthalpyPres = -Cp * jouleThomsonCoefficient * deltaP;
-                    enthalpyPres = enthalpyPresPrev + deltaEnthalpyPres; 
-                    enthalpyPresPrev = enthalpyPres;
-                }
+                // with WATDENT, the inverse of the water density is linear in pressure.
+                // Its integral over [Pref, p] is thus exactly given by the value at the
+                // midpoint of the interval.
+                const Evaluation& Pmid = 0.5*(pressure + Pref);
+                Evaluation rhoMid = inverseFormationVolumeFactor(regionIdx, temperature, Pmid, saltconcentration) * waterReferenceDensity(regionIdx);
+                enthalpyPres = (1.0 - alpha * temperature)/rhoMid * (pressure - Pref);
             }
             else {
                   throw std::runtime_error("Requested Joule-thomson calculation but thermal water density (WATDENT) is not provided");
@@ -441,7 +436,6 @@ public:
                this->watdentCT2() == data.watdentCT2() &&
                this->watdentCT2() == data.watdentCT2() &&
                this->watJTRefPres() == data.watJTRefPres() &&
-               this->watJT() == data.watJT() &&
                this->watJTC() == data.watJTC() &&
                this->pvtwRefPress() == data.pvtwRefPress() &&
                this->pvtwRefB() == data.pvtwRefB() &&
@@ -451,11 +445,41 @@ public:
                this->watvisctCurves() == data.watvisctCurves() &&
                this->internalEnergyCurves() == data.internalEnergyCurves() &&
                this->enableThermalDensity() == data.enableThermalDensity() &&
-               this->enableJouleThomson() == data.enableJouleThomson() &&
+               this->enableJouleThomsony() == data.enableJouleThomsony() &&
                this->enableThermalViscosity() == data.enableThermalViscosity() &&
                this->enableInternalEnergy() == data.enableInternalEnergy();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        bool hasIsothermalPvt = isothermalPvt_ != nullptr;
+        serializer(hasIsothermalPvt);
+        if (serializer.isReading()) {
+            delete isothermalPvt_;
+            isothermalPvt_ = hasIsothermalPvt ? new IsothermalPvt : nullptr;
+        }
+        if (isothermalPvt_)
+            serializer(*isothermalPvt_);
+        serializer(viscrefPress_);
+        serializer(watdentRefTemp_);
+        serializer(watdentCT1_);
+        serializer(watdentCT2_);
+        serializer(watJTRefPres_);
+        serializer(watJTC_);
+        serializer(pvtwRefPress_);
+        serializer(pvtwRefB_);
+        serializer(pvtwCompressibility_);
+        serializer(pvtwViscosity_);
+        serializer(pvtwViscosibility_);
+        serializer(watvisctCurves_);
+        serializer(internalEnergyCurves_);
+        serializer(enableThermalDensity_);
+        serializer(enableJouleThomson_);
+        serializer(enableThermalViscosity_);
+        serializer(enableInternalEnergy_);
+    }
+
     WaterPvtThermal<Scalar, enableBrine>& operator=(const WaterPvtThermal<Scalar, enableBrine>& data)
     {
         if (data.isothermalPvt_)
@@ -29,7 +29,9 @@
 
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/UniformXTabulated2DFunction.hpp>
+#include <opm/material/common/UniformXTabulated2DMultiFunction.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/fluidsystems/blackoilpvt/PvtCursor.hpp>
 
 #if HAVE_ECL_INPUT
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
@@ -55,6 +57,8 @@ class WetGasPvt
 public:
     using TabulatedTwoDFunction = UniformXTabulated2DFunction<Scalar>;
     using TabulatedOneDFunction = Tabulated1DFunction<Scalar>;
+    using FusedTwoDFunction = UniformXTabulated2DMultiFunction<Scalar, 2>;
+    using Cursor = PvtCursor<Scalar>;
 
     WetGasPvt()
     {
@@ -82,6 +86,10 @@ public:
         , saturationPressure_(saturationPressure)
         , vapPar1_(vapPar1)
     {
+        inverseGasBAndBMu_.resize(inverseGasB_.size());
+        for (unsigned regionIdx = 0; regionIdx < inverseGasB_.size(); ++regionIdx)
+            updateInverseGasBAndBMu_(regionIdx);
+        updateExactSaturationPressures_();
     }
 
 
@@ -265,11 +273,13 @@ public:
         gasReferenceDensity_.resize(numRegions);
         inverseGasB_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::RightExtreme});
         inverseGasBMu_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::RightExtreme});
+        inverseGasBAndBMu_.resize(numRegions);
         inverseSaturatedGasB_.resize(numRegions);
         inverseSaturatedGasBMu_.resize(numRegions);
         gasMu_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::RightExtreme});
         saturatedOilVaporizationFactorTable_.resize(numRegions);
         saturationPressure_.resize(numRegions);
+        exactSaturationPressure_.resize(numRegions);
     }
 
     /*!
@@ -456,6 +466,7 @@ public:
             invSatGasBMu.setXYContainers(satPressuresArray, invSatGasBMuArray);
 
             updateSaturationPressure_(regionIdx);
+            updateInverseGasBAndBMu_(regionIdx);
         }
     }
 
@@ -482,17 +493,106 @@ public:
      */
     template <class Evaluation>
     Evaluation viscosity(unsigned regionIdx,
-                         const Evaluation& /*temperature*/,
+                         const Evaluation& temperature,
                          const Evaluation& pressure,
                          const Evaluation& Rv,
-                         const Evaluation& /*Rvw*/) const
+                         const Evaluation& Rvw) const
     {
-        const Evaluation& invBg = inverseGasB_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
-        const Evaluation& invMugBg = inverseGasBMu_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
+        Evaluation invBg, mug, invMugBg;
+        inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure, Rv, Rvw,
+                                                 invBg, mug, invMugBg);
+        return mug;
+    }
 
-        return invBg/invMugBg;
+    /*!
+     * \brief Returns the inverse formation volume factor [-], the dynamic viscosity [Pa s]
+     *        and the inverse of their product [1/(Pa s)] of the fluid phase.
+     *
+     * All three quantities are determined using a single lookup in the PVT table.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& /*temperature*/,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rv,
+                                                  const Evaluation& /*Rvw*/,
+                                                  Evaluation& invBg,
+                                                  Evaluation& mug,
+                                                  Evaluation& invMugBg) const
+    {
+        undersaturatedLookup_(regionIdx, pressure, Rv, invBg, mug, invMugBg,
+                              static_cast<typename TabulatedTwoDFunction::Cursor*>(nullptr));
     }
 
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase.
+     *
+     * Both quantities are determined using a single lookup in the PVT table.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& temperature,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rv,
+                                                  const Evaluation& Rvw,
+                                                  Evaluation& invBg,
+                                                  Evaluation& mug) const
+    {
+        Evaluation invMugBg;
+        inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure, Rv, Rvw,
+                                                 invBg, mug, invMugBg);
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase using a caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& /*temperature*/,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rv,
+                                                  const Evaluation& /*Rvw*/,
+                                                  Evaluation& invBg,
+                                                  Evaluation& mug,
+                                                  Cursor& cursor) const
+    {
+        Evaluation invMugBg;
+        undersaturatedLookup_(regionIdx, pressure, Rv, invBg, mug, invMugBg, &cursor.undersaturated);
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the saturated fluid phase.
+     *
+     * The tables of both quantities are looked up using the same segment cursor, so
+     * the pressure segment only needs to be searched once.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& /*temperature*/,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBg,
+                                                           Evaluation& mug) const
+    {
+        SegmentCursor cursor;
+        saturatedLookup_(regionIdx, pressure, invBg, mug, cursor);
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the saturated fluid phase using a caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& /*temperature*/,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBg,
+                                                           Evaluation& mug,
+                                                           Cursor& cursor) const
+    { saturatedLookup_(regionIdx, pressure, invBg, mug, cursor.saturated); }
+
     /*!
      * \brief Returns the dynamic viscosity [Pa s] of oil saturated gas at a given pressure.
      */
@@ -557,6 +657,20 @@ public:
         return saturatedOilVaporizationFactorTable_[regionIdx].eval(pressure, /*extrapolate=*/true);
     }
 
+    /*!
+     * \brief Returns the oil vaporization factor \f$R_v\f$ [m^3/m^3] of the gas phase using a
+     *        caller-owned lookup cursor.
+     */
+    template <class Evaluation>
+    Evaluation saturatedOilVaporizationFactor(unsigned regionIdx,
+                                              const Evaluation& /*temperature*/,
+                                              const Evaluation& pressure,
+                                              Cursor& cursor) const
+    {
+        return saturatedOilVaporizationFactorTable_[regionIdx].eval(pressure, cursor.saturated,
+                                                                   /*extrapolate=*/true);
+    }
+
     /*!
      * \brief Returns the oil vaporization factor \f$R_v\f$ [m^3/m^3] of the gas phase.
      *
@@ -603,6 +717,17 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        // if the oil vaporization factor is strictly monotonic, its inverse is
+        // tabulated exactly and the saturation pressure is a single lookup
+        const auto& exactPSat = exactSaturationPressure_[regionIdx];
+        if (exactPSat.numSamples() > 0) {
+            const Evaluation& pSat = exactPSat.eval(Rv, /*extrapolate=*/true);
+            if (pSat < 0.0)
+                return 0.0;
+
+            return pSat;
+        }
+
         const auto& RvTable = saturatedOilVaporizationFactorTable_[regionIdx];
         constexpr const Scalar eps = std::numeric_limits<typename Toolbox::Scalar>::epsilon()*1e6;
 
@@ -711,7 +836,62 @@ public:
                this->vapPar1() == data.vapPar1();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(gasReferenceDensity_);
+        serializer(oilReferenceDensity_);
+        serializer(inverseGasB_);
+        serializer(inverseSaturatedGasB_);
+        serializer(gasMu_);
+        serializer(inverseGasBMu_);
+        serializer(inverseGasBAndBMu_);
+        serializer(inverseSaturatedGasBMu_);
+        serializer(saturatedOilVaporizationFactorTable_);
+        serializer(saturationPressure_);
+        serializer(vapPar1_);
+        if (serializer.isReading())
+            updateExactSaturationPressures_();
+    }
+
 private:
+    template <class Evaluation, class TableCursor>
+    void undersaturatedLookup_(unsigned regionIdx,
+                               const Evaluation& pressure,
+                               const Evaluation& Rv,
+                               Evaluation& invBg,
+                               Evaluation& mug,
+                               Evaluation& invMugBg,
+                               TableCursor* cursor) const
+    {
+        const auto& fusedTable = inverseGasBAndBMu_[regionIdx];
+        if (fusedTable.empty()) {
+            invBg = evalPvtTable(inverseGasB_[regionIdx], cursor, pressure, Rv);
+            invMugBg = evalPvtTable(inverseGasBMu_[regionIdx], cursor, pressure, Rv);
+        }
+        else {
+            const auto& values = evalPvtTable(fusedTable, cursor, pressure, Rv);
+            invBg = values[0];
+            invMugBg = values[1];
+        }
+
+        mug = invBg/invMugBg;
+    }
+
+    // the tables of both quantities are looked up using the same segment cursor, so the
+    // pressure segment only needs to be searched once
+    template <class Evaluation>
+    void saturatedLookup_(unsigned regionIdx,
+                          const Evaluation& pressure,
+                          Evaluation& invBg,
+                          Evaluation& mug,
+                          SegmentCursor& cursor) const
+    {
+        invBg = inverseSaturatedGasB_[regionIdx].eval(pressure, cursor, /*extrapolate=*/true);
+        const Evaluation& invMugBg = inverseSaturatedGasBMu_[regionIdx].eval(pressure, cursor, /*extrapolate=*/true);
+        mug = invBg/invMugBg;
+    }
+
     void updateSaturationPressure_(unsigned regionIdx)
     {
         const auto& oilVaporizationFac = saturatedOilVaporizationFactorTable_[regionIdx];
@@ -737,6 +917,39 @@ private:
             pSatSamplePoints.erase(last, pSatSamplePoints.end());
 
         saturationPressure_[regionIdx].setContainerOfTuples(pSatSamplePoints);
+        updateExactSaturationPressure_(regionIdx);
+    }
+
+    // the inverse of a strictly monotonic Rv(p) table is again piecewise linear. if the
+    // table is not monotonic, the tabulated saturation pressure is only used as the
+    // initial guess of the Newton method.
+    void updateExactSaturationPressure_(unsigned regionIdx)
+    {
+        const auto& oilVaporizationFac = saturatedOilVaporizationFactorTable_[regionIdx];
+        if (oilVaporizationFac.isStrictlyMonotonic())
+            exactSaturationPressure_[regionIdx] = oilVaporizationFac.inverse();
+        else
+            exactSaturationPressure_[regionIdx] = TabulatedOneDFunction();
+    }
+
+    void updateExactSaturationPressures_()
+    {
+        exactSaturationPressure_.resize(saturatedOilVaporizationFactorTable_.size());
+        for (unsigned regionIdx = 0; regionIdx < exactSaturationPressure_.size(); ++regionIdx)
+            updateExactSaturationPressure_(regionIdx);
+    }
+
+    // store the inverse formation volume factor and the inverse of its product with the
+    // viscosity in a single table. this is only possible if both tables use the same
+    // sampling points, otherwise the individual tables are evaluated.
+    void updateInverseGasBAndBMu_(unsigned regionIdx)
+    {
+        const auto& invGasB = inverseGasB_[regionIdx];
+        const auto& invGasBMu = inverseGasBMu_[regionIdx];
+        if (invGasB.numX() > 1 && invGasB.hasSameSamplingPoints(invGasBMu))
+            inverseGasBAndBMu_[regionIdx].setQuantities({&invGasB, &invGasBMu});
+        else
+            inverseGasBAndBMu_[regionIdx] = FusedTwoDFunction();
     }
 
     std::vector<Scalar> gasReferenceDensity_;
@@ -745,9 +958,11 @@ private:
     std::vector<TabulatedOneDFunction> inverseSaturatedGasB_;
     std::vector<TabulatedTwoDFunction> gasMu_;
     std::vector<TabulatedTwoDFunction> inverseGasBMu_;
+    std::vector<FusedTwoDFunction> inverseGasBAndBMu_;
     std::vector<TabulatedOneDFunction> inverseSaturatedGasBMu_;
     std::vector<TabulatedOneDFunction> saturatedOilVaporizationFactorTable_;
     std::vector<TabulatedOneDFunction> saturationPressure_;
+    std::vector<TabulatedOneDFunction> exactSaturationPressure_;
 
     Scalar vapPar1_;
 };
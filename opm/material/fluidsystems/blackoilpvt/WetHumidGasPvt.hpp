@@ -29,6 +29,7 @@
 
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/UniformXTabulated2DFunction.hpp>
+#include <opm/material/common/UniformXTabulated2DMultiFunction.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
 
 #if HAVE_ECL_INPUT
@@ -55,6 +56,7 @@ class WetHumidGasPvt
 public:
     using TabulatedTwoDFunction = UniformXTabulated2DFunction<Scalar>;
     using TabulatedOneDFunction = Tabulated1DFunction<Scalar>;
+    using FusedTwoDFunction = UniformXTabulated2DMultiFunction<Scalar, 2>;
 
     WetHumidGasPvt()
     {
@@ -94,6 +96,11 @@ public:
         , saturationPressure_(saturationPressure)
         , vapPar1_(vapPar1)
     {
+        inverseGasBAndBMuRvwSat_.resize(inverseGasBRvwSat_.size());
+        inverseGasBAndBMuRvSat_.resize(inverseGasBRvSat_.size());
+        for (unsigned regionIdx = 0; regionIdx < inverseGasBRvwSat_.size(); ++regionIdx)
+            updateInverseGasBAndBMu_(regionIdx);
+        updateExactSaturationPressures_();
     }
 
 
@@ -447,6 +454,8 @@ public:
         inverseGasBRvSat_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::RightExtreme});
         inverseGasBMuRvwSat_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::RightExtreme});
         inverseGasBMuRvSat_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::RightExtreme});
+        inverseGasBAndBMuRvwSat_.resize(numRegions);
+        inverseGasBAndBMuRvSat_.resize(numRegions);
         inverseSaturatedGasB_.resize(numRegions);
         inverseSaturatedGasBMu_.resize(numRegions);
         gasMuRvwSat_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::RightExtreme});
@@ -455,6 +464,7 @@ public:
         saturatedWaterVaporizationSaltFactorTable_.resize(numRegions, TabulatedTwoDFunction{TabulatedTwoDFunction::InterpolationPolicy::RightExtreme});
         saturatedOilVaporizationFactorTable_.resize(numRegions);
         saturationPressure_.resize(numRegions);
+        exactSaturationPressure_.resize(numRegions);
     }
 
     /*!
@@ -575,6 +585,7 @@ public:
             invSatGasBMu.setXYContainers(satPressuresArray, invSatGasBMuArray);
             
             updateSaturationPressure_(regionIdx);
+            updateInverseGasBAndBMu_(regionIdx);
         }
     }
 
@@ -601,24 +612,88 @@ public:
      */
     template <class Evaluation>
     Evaluation viscosity(unsigned regionIdx,
-                         const Evaluation& /*temperature*/,
+                         const Evaluation& temperature,
                          const Evaluation& pressure,
                          const Evaluation& Rv,
                          const Evaluation& Rvw) const
+    {
+        Evaluation invBg, mug, invMugBg;
+        inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure, Rv, Rvw,
+                                                 invBg, mug, invMugBg);
+        return mug;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-], the dynamic viscosity [Pa s]
+     *        and the inverse of their product [1/(Pa s)] of the fluid phase.
+     *
+     * All three quantities are determined using a single lookup in the PVT table.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& /*temperature*/,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rv,
+                                                  const Evaluation& Rvw,
+                                                  Evaluation& invBg,
+                                                  Evaluation& mug,
+                                                  Evaluation& invMugBg) const
     {
         const Evaluation& temperature = 1E30;
 
-        if (Rv >= (1.0 - 1e-10)*saturatedOilVaporizationFactor(regionIdx, temperature, pressure)) {
-            const Evaluation& invBg = inverseGasBRvSat_[regionIdx].eval(pressure, Rvw, /*extrapolate=*/true);
-            const Evaluation& invMugBg = inverseGasBMuRvSat_[regionIdx].eval(pressure, Rvw, /*extrapolate=*/true);
-            return invBg/invMugBg;
-        }
-        else {
+        if (Rv >= (1.0 - 1e-10)*saturatedOilVaporizationFactor(regionIdx, temperature, pressure))
+            evalInverseGasBAndBMu_(inverseGasBRvSat_[regionIdx],
+                                   inverseGasBMuRvSat_[regionIdx],
+                                   inverseGasBAndBMuRvSat_[regionIdx],
+                                   pressure, Rvw, invBg, invMugBg);
+        else
             // for Rv undersaturated viscosity is evaluated at saturated Rvw values
-            const Evaluation& invBg = inverseGasBRvwSat_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
-            const Evaluation& invMugBg = inverseGasBMuRvwSat_[regionIdx].eval(pressure, Rv, /*extrapolate=*/true);
-            return invBg/invMugBg;
-        }
+            evalInverseGasBAndBMu_(inverseGasBRvwSat_[regionIdx],
+                                   inverseGasBMuRvwSat_[regionIdx],
+                                   inverseGasBAndBMuRvwSat_[regionIdx],
+                                   pressure, Rv, invBg, invMugBg);
+
+        mug = invBg/invMugBg;
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the fluid phase.
+     *
+     * Both quantities are determined using a single lookup in the PVT table.
+     */
+    template <class Evaluation>
+    void inverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                  const Evaluation& temperature,
+                                                  const Evaluation& pressure,
+                                                  const Evaluation& Rv,
+                                                  const Evaluation& Rvw,
+                                                  Evaluation& invBg,
+                                                  Evaluation& mug) const
+    {
+        Evaluation invMugBg;
+        inverseFormationVolumeFactorAndViscosity(regionIdx, temperature, pressure, Rv, Rvw,
+                                                 invBg, mug, invMugBg);
+    }
+
+    /*!
+     * \brief Returns the inverse formation volume factor [-] and the dynamic viscosity
+     *        [Pa s] of the saturated fluid phase.
+     *
+     * The tables of both quantities are looked up using the same segment cursor, so
+     * the pressure segment only needs to be searched once.
+     */
+    template <class Evaluation>
+    void saturatedInverseFormationVolumeFactorAndViscosity(unsigned regionIdx,
+                                                           const Evaluation& /*temperature*/,
+                                                           const Evaluation& pressure,
+                                                           Evaluation& invBg,
+                                                           Evaluation& mug) const
+    {
+        SegmentCursor cursor;
+        invBg = inverseSaturatedGasB_[regionIdx].eval(pressure, cursor, /*extrapolate=*/true);
+        const Evaluation& invMugBg = inverseSaturatedGasBMu_[regionIdx].eval(pressure, cursor, /*extrapolate=*/true);
+        mug = invBg/invMugBg;
     }
 
     /*!
@@ -754,6 +829,17 @@ public:
     {
         using Toolbox = MathToolbox<Evaluation>;
 
+        // if the water vaporization factor is strictly monotonic, its inverse is
+        // tabulated exactly and the saturation pressure is a single lookup
+        const auto& exactPSat = exactSaturationPressure_[regionIdx];
+        if (exactPSat.numSamples() > 0) {
+            const Evaluation& pSat = exactPSat.eval(Rw, /*extrapolate=*/true);
+            if (pSat < 0.0)
+                return 0.0;
+
+            return pSat;
+        }
+
         const auto& RwTable = saturatedWaterVaporizationFactorTable_[regionIdx];
         constexpr const Scalar eps = std::numeric_limits<typename Toolbox::Scalar>::epsilon()*1e6;
 
@@ -874,6 +960,32 @@ public:
                this->vapPar1() == data.vapPar1();
     }
 
+    template <class Serializer>
+    void serializeOp(Serializer& serializer)
+    {
+        serializer(gasReferenceDensity_);
+        serializer(waterReferenceDensity_);
+        serializer(oilReferenceDensity_);
+        serializer(inverseGasBRvwSat_);
+        serializer(inverseGasBRvSat_);
+        serializer(inverseSaturatedGasB_);
+        serializer(gasMuRvwSat_);
+        serializer(gasMuRvSat_);
+        serializer(inverseGasBMuRvwSat_);
+        serializer(inverseGasBMuRvSat_);
+        serializer(inverseGasBAndBMuRvwSat_);
+        serializer(inverseGasBAndBMuRvSat_);
+        serializer(inverseSaturatedGasBMu_);
+        serializer(saturatedWaterVaporizationFactorTable_);
+        serializer(saturatedWaterVaporizationSaltFactorTable_);
+        serializer(saturatedOilVaporizationFactorTable_);
+        serializer(saturationPressure_);
+        serializer(enableRwgSalt_);
+        serializer(vapPar1_);
+        if (serializer.isReading())
+            updateExactSaturationPressures_();
+    }
+
 private:
     void updateSaturationPressure_(unsigned regionIdx)
     {
@@ -899,6 +1011,67 @@ private:
         pSatSamplePoints.erase(last, pSatSamplePoints.end());
 
         saturationPressure_[regionIdx].setContainerOfTuples(pSatSamplePoints);
+        updateExactSaturationPressure_(regionIdx);
+    }
+
+    // saturationPressure() solves for the pressure at which the water vaporization
+    // factor takes a given value. the inverse of a strictly monotonic Rw(p) table is
+    // again piecewise linear, otherwise the Newton method is used.
+    void updateExactSaturationPressure_(unsigned regionIdx)
+    {
+        const auto& waterVaporizationFac = saturatedWaterVaporizationFactorTable_[regionIdx];
+        if (waterVaporizationFac.isStrictlyMonotonic())
+            exactSaturationPressure_[regionIdx] = waterVaporizationFac.inverse();
+        else
+            exactSaturationPressure_[regionIdx] = TabulatedOneDFunction();
+    }
+
+    void updateExactSaturationPressures_()
+    {
+        exactSaturationPressure_.resize(saturatedWaterVaporizationFactorTable_.size());
+        for (unsigned regionIdx = 0; regionIdx < exactSaturationPressure_.size(); ++regionIdx)
+            updateExactSaturationPressure_(regionIdx);
+    }
+
+    // store the inverse formation volume factors and the inverse of their products with
+    // the viscosity in a single table. this is only possible if both tables use the same
+    // sampling points, otherwise the individual tables are evaluated.
+    void updateInverseGasBAndBMu_(unsigned regionIdx)
+    {
+        const auto updateFused = [](const TabulatedTwoDFunction& invGasB,
+                                    const TabulatedTwoDFunction& invGasBMu,
+                                    FusedTwoDFunction& fused)
+        {
+            if (invGasB.numX() > 1 && invGasB.hasSameSamplingPoints(invGasBMu))
+                fused.setQuantities({&invGasB, &invGasBMu});
+            else
+                fused = FusedTwoDFunction();
+        };
+
+        updateFused(inverseGasBRvwSat_[regionIdx], inverseGasBMuRvwSat_[regionIdx],
+                    inverseGasBAndBMuRvwSat_[regionIdx]);
+        updateFused(inverseGasBRvSat_[regionIdx], inverseGasBMuRvSat_[regionIdx],
+                    inverseGasBAndBMuRvSat_[regionIdx]);
+    }
+
+    template <class Evaluation>
+    static void evalInverseGasBAndBMu_(const TabulatedTwoDFunction& invGasB,
+                                       const TabulatedTwoDFunction& invGasBMu,
+                                       const FusedTwoDFunction& fused,
+                                       const Evaluation& pressure,
+                                       const Evaluation& R,
+                                       Evaluation& invBg,
+                                       Evaluation& invMugBg)
+    {
+        if (fused.empty()) {
+            invBg = invGasB.eval(pressure, R, /*extrapolate=*/true);
+            invMugBg = invGasBMu.eval(pressure, R, /*extrapolate=*/true);
+        }
+        else {
+            const auto& values = fused.eval(pressure, R, /*extrapolate=*/true);
+            invBg = values[0];
+            invMugBg = values[1];
+        }
     }
 
     std::vector<Scalar> gasReferenceDensity_;
@@ -911,11 +1084,14 @@ private:
     std::vector<TabulatedTwoDFunction> gasMuRvSat_;
     std::vector<TabulatedTwoDFunction> inverseGasBMuRvwSat_;
     std::vector<TabulatedTwoDFunction> inverseGasBMuRvSat_;
+    std::vector<FusedTwoDFunction> inverseGasBAndBMuRvwSat_;
+    std::vector<FusedTwoDFunction> inverseGasBAndBMuRvSat_;
     std::vector<TabulatedOneDFunction> inverseSaturatedGasBMu_;
     std::vector<TabulatedOneDFunction> saturatedWaterVaporizationFactorTable_;
     std::vector<TabulatedTwoDFunction> saturatedWaterVaporizationSaltFactorTable_;
     std::vector<TabulatedOneDFunction> saturatedOilVaporizationFactorTable_;
     std::vector<TabulatedOneDFunction> saturationPressure_;
+    std::vector<TabulatedOneDFunction> exactSaturationPressure_;
 
     bool enableRwgSalt_;
     Scalar vapPar1_;
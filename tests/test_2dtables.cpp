@@ -30,14 +30,25 @@
 #include "config.h"
 
 #include <opm/material/common/UniformXTabulated2DFunction.hpp>
+#include <opm/material/common/UniformXTabulated2DMultiFunction.hpp>
 #include <opm/material/common/UniformTabulated2DFunction.hpp>
 #include <opm/material/common/IntervalTabulated2DFunction.hpp>
+#include <opm/material/common/Tabulated1DFunction.hpp>
+#include <opm/material/common/BinarySnapshot.hpp>
+#include <opm/material/densead/Evaluation.hpp>
 
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 template <class ScalarT>
 struct Test
@@ -106,7 +117,9 @@ struct Test
 
     template <class Fn>
     std::shared_ptr<Opm::UniformXTabulated2DFunction<Scalar> >
-    createUniformXTabulatedFunction2(Fn& f)
+    createUniformXTabulatedFunction2(Fn& f,
+                                     typename Opm::UniformXTabulated2DFunction<Scalar>::InterpolationPolicy policy =
+                                     Opm::UniformXTabulated2DFunction<Scalar>::InterpolationPolicy::Vertical)
     {
         Scalar xMin = -2.0;
         Scalar xMax = 3.0;
@@ -115,7 +128,7 @@ struct Test
         Scalar yMin = - 4.0;
         Scalar yMax = 5.0;
 
-        auto tab = std::make_shared<Opm::UniformXTabulated2DFunction<Scalar>>(Opm::UniformXTabulated2DFunction<Scalar>::InterpolationPolicy::Vertical);
+        auto tab = std::make_shared<Opm::UniformXTabulated2DFunction<Scalar>>(policy);
 
         for (unsigned i = 0; i < m; ++i) {
             Scalar x = xMin + Scalar(i)/(m - 1) * (xMax - xMin);
@@ -221,6 +234,201 @@ struct Test
         return true;
     }
 
+    template <class TablePtr, class... EvalArgs>
+    bool compareBatchEval(const TablePtr table,
+                          const Scalar xMin,
+                          const Scalar xMax,
+                          unsigned numX,
+                          const Scalar yMin,
+                          const Scalar yMax,
+                          unsigned numY,
+                          EvalArgs... evalArgs)
+    {
+        // make sure that evaluating a batch of points yields exactly the same results
+        // as evaluating them one by one. the trailing arguments (e.g., the extrapolate
+        // flag) are passed to both eval() flavors
+        std::vector<Scalar> xs;
+        std::vector<Scalar> ys;
+        for (unsigned i = 1; i < numX; ++i) {
+            for (unsigned j = 1; j < numY; ++j) {
+                xs.push_back(xMin + Scalar(i)/numX*(xMax - xMin));
+                ys.push_back(yMin + Scalar(j)/numY*(yMax - yMin));
+            }
+        }
+
+        std::vector<Scalar> results(xs.size());
+        table->eval(xs.data(), ys.data(), results.data(), xs.size(), evalArgs...);
+        for (size_t k = 0; k < xs.size(); ++k) {
+            Scalar result = table->eval(xs[k], ys[k], evalArgs...);
+            if (results[k] != result) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": batched table->eval("<<xs[k]<<","<<ys[k]<<") != table->eval("<<xs[k]<<","<<ys[k]<<"): " << results[k] << " != " << result << "\n";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template <class TablePtr>
+    bool compareCursorEval(const TablePtr table,
+                           const Scalar xMin,
+                           const Scalar xMax,
+                           unsigned numX,
+                           const Scalar yMin,
+                           const Scalar yMax,
+                           unsigned numY)
+    {
+        // make sure that the results do not change if a lookup cursor is used. the
+        // points are visited in a zig-zag order, so that the cursor sees both small
+        // and large jumps.
+        typename Opm::UniformXTabulated2DFunction<Scalar>::Cursor cursor;
+        for (unsigned i = 1; i < numX; ++i) {
+            Scalar x = xMin + Scalar(i)/numX*(xMax - xMin);
+            for (unsigned j = 1; j < numY; ++j) {
+                unsigned jj = (i % 2 == 0) ? j : numY - j;
+                Scalar y = yMin + Scalar(jj)/numY*(yMax - yMin);
+
+                Scalar result = table->eval(x, y, cursor);
+                if (result != table->eval(x, y)) {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": table->eval("<<x<<","<<y<<", cursor) != table->eval("<<x<<","<<y<<"): " << result << " != " << table->eval(x, y) << "\n";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template <class TablePtr>
+    bool compareMultiEval(const TablePtr table1,
+                          const TablePtr table2,
+                          const Scalar xMin,
+                          const Scalar xMax,
+                          unsigned numX,
+                          const Scalar yMin,
+                          const Scalar yMax,
+                          unsigned numY)
+    {
+        // make sure that a table which stores both quantities yields exactly the same
+        // results as the individual tables
+        Opm::UniformXTabulated2DMultiFunction<Scalar, 2> multiTable({table1.get(), table2.get()});
+        for (unsigned i = 0; i < numX; ++i) {
+            Scalar x = xMin + Scalar(i)/numX*(xMax - xMin);
+            for (unsigned j = 0; j < numY; ++j) {
+                Scalar y = yMin + Scalar(j)/numY*(yMax - yMin);
+
+                const auto& result = multiTable.eval(x, y);
+                if (result[0] != table1->eval(x, y) || result[1] != table2->eval(x, y)) {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": multiTable.eval("<<x<<","<<y<<") != (table1->eval("<<x<<","<<y<<"), table2->eval("<<x<<","<<y<<")): (" << result[0] << ", " << result[1] << ") != (" << table1->eval(x, y) << ", " << table2->eval(x, y) << ")\n";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template <class TablePtr>
+    bool compareAdEval(const TablePtr table,
+                       const Scalar xMin,
+                       const Scalar xMax,
+                       unsigned numX,
+                       const Scalar yMin,
+                       const Scalar yMax,
+                       unsigned numY,
+                       Scalar tolerance)
+    {
+        // the table is expected to represent f(x, y) = x*y, which is reproduced exactly
+        // by bilinear interpolation. thus the partial derivatives must be y and x.
+        typedef Opm::DenseAd::Evaluation<Scalar, 2> Eval;
+        for (unsigned i = 0; i < numX; ++i) {
+            Scalar x = xMin + Scalar(i)/numX*(xMax - xMin);
+            for (unsigned j = 0; j < numY; ++j) {
+                Scalar y = yMin + Scalar(j)/numY*(yMax - yMin);
+
+                const Eval& result = table->eval(Eval::createVariable(x, 0), Eval::createVariable(y, 1));
+                if (result.value() != table->eval(x, y)) {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": table->eval(Eval("<<x<<"),Eval("<<y<<")).value() != table->eval("<<x<<","<<y<<"): " << result.value() << " != " << table->eval(x, y) << "\n";
+                    return false;
+                }
+                if (std::abs(result.derivative(0) - y) > tolerance*(1 + std::abs(y))
+                    || std::abs(result.derivative(1) - x) > tolerance*(1 + std::abs(x)))
+                {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": wrong derivatives of table->eval(Eval("<<x<<"),Eval("<<y<<")): (" << result.derivative(0) << ", " << result.derivative(1) << ") != (" << y << ", " << x << ")\n";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // compare the derivatives of AD evaluations with finite differences for tables
+    // whose columns cover different y ranges. for such tables, the LeftExtreme and
+    // RightExtreme interpolation guides shift the y positions of the stencil, which
+    // leads to different partial derivatives than the vertical guide.
+    bool compareAdEvalFiniteDifferences(typename Opm::UniformXTabulated2DFunction<Scalar>::InterpolationPolicy policy) const
+    {
+        typedef Opm::UniformXTabulated2DFunction<Scalar> UniformXTable;
+        typedef Opm::DenseAd::Evaluation<Scalar, 2> Eval;
+
+        const Scalar xMin = -2.0;
+        const Scalar xMax = 3.0;
+        const unsigned m = 20;
+        UniformXTable table(policy);
+        for (unsigned i = 0; i < m; ++i) {
+            const Scalar x = xMin + Scalar(i)/(m - 1) * (xMax - xMin);
+            table.appendXPos(x);
+
+            const Scalar yMin = Scalar(-4.0) + Scalar(0.1)*i;
+            const Scalar yMax = Scalar(5.0) - Scalar(0.05)*i;
+            const unsigned n = 10 + i % 3;
+            for (unsigned j = 0; j < n; ++j) {
+                const Scalar y = yMin + Scalar(j)/(n - 1) * (yMax - yMin);
+                table.appendSamplePoint(i, y, x*y + y*y/4);
+            }
+        }
+
+        const Scalar h = std::sqrt(std::numeric_limits<Scalar>::epsilon());
+        const Scalar tolerance = 100*h;
+        unsigned numChecked = 0;
+        const unsigned numX = 37;
+        const unsigned numY = 41;
+        for (unsigned i = 0; i < numX; ++i) {
+            const Scalar x = xMin + (Scalar(i) + Scalar(0.3))/numX * (xMax - xMin);
+            for (unsigned j = 0; j < numY; ++j) {
+                const Scalar y = Scalar(-3.5) + (Scalar(j) + Scalar(0.6))/numY * Scalar(8.0);
+
+                const Eval& result = table.eval(Eval::createVariable(x, 0), Eval::createVariable(y, 1), /*extrapolate=*/true);
+                const Scalar f = table.eval(x, y, /*extrapolate=*/true);
+                for (unsigned dirIdx = 0; dirIdx < 2; ++dirIdx) {
+                    const Scalar dx = (dirIdx == 0) ? h : 0;
+                    const Scalar dy = (dirIdx == 1) ? h : 0;
+                    const Scalar forward = (table.eval(x + dx, y + dy, /*extrapolate=*/true) - f)/h;
+                    const Scalar backward = (f - table.eval(x - dx, y - dy, /*extrapolate=*/true))/h;
+
+                    // the function is not differentiable at segment boundaries
+                    if (std::abs(forward - backward) > tolerance*(1 + std::abs(forward)))
+                        continue;
+
+                    ++numChecked;
+                    const Scalar ref = (forward + backward)/2;
+                    if (std::abs(result.derivative(dirIdx) - ref) > tolerance*(1 + std::abs(ref))) {
+                        std::cerr << __FILE__ << ":" << __LINE__ << ": derivative " << dirIdx << " of table.eval(Eval("<<x<<"),Eval("<<y<<")) for interpolation guide " << policy << ": " << result.derivative(dirIdx) << " != " << ref << "\n";
+                        return false;
+                    }
+                }
+            }
+        }
+
+        if (numChecked < numX*numY) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": too few derivatives checked for interpolation guide " << policy << ": " << numChecked << "\n";
+            return false;
+        }
+
+        return true;
+    }
+
     template <class UniformTablePtr, class UniformXTablePtr, class Fn>
     bool compareTables(const UniformTablePtr uTable,
                        const UniformXTablePtr uXTable,
@@ -387,6 +595,193 @@ struct Test
 
         return true;
     }
+
+    // make sure that tables using the clamped range check policy are continued by their
+    // values at the closest boundary point
+    template <class Fn>
+    bool checkClampedTables(Fn& f) const
+    {
+        typedef Opm::UniformTabulated2DFunction<Scalar, Opm::RangeCheck::Clamped> UniformTable;
+        typedef Opm::UniformXTabulated2DFunction<Scalar, Opm::RangeCheck::Clamped> UniformXTable;
+        typedef Opm::IntervalTabulated2DFunction<Scalar, Opm::RangeCheck::Clamped> IntervalTable;
+
+        const Scalar xMin = -2.0;
+        const Scalar xMax = 3.0;
+        const unsigned m = 6;
+
+        const Scalar yMin = -1.0;
+        const Scalar yMax = 4.0;
+        const unsigned n = 6;
+
+        UniformTable uTable(xMin, xMax, m, yMin, yMax, n);
+        UniformXTable uXTable(UniformXTable::InterpolationPolicy::Vertical);
+        std::vector<Scalar> xSamples(m);
+        std::vector<Scalar> ySamples(n);
+        std::vector<std::vector<Scalar>> data(m, std::vector<Scalar>(n));
+        for (unsigned i = 0; i < m; ++i) {
+            xSamples[i] = xMin + Scalar(i)/(m - 1) * (xMax - xMin);
+            uXTable.appendXPos(xSamples[i]);
+            for (unsigned j = 0; j < n; ++j) {
+                ySamples[j] = yMin + Scalar(j)/(n - 1) * (yMax - yMin);
+                data[i][j] = f(xSamples[i], ySamples[j]);
+                uTable.setSamplePoint(i, j, data[i][j]);
+                uXTable.appendSamplePoint(i, ySamples[j], data[i][j]);
+            }
+        }
+        IntervalTable iTable(xSamples, ySamples, data);
+
+        const std::array<std::array<Scalar, 4>, 4> points = {{
+            // x, y, closest x, closest y
+            {xMin - 1, yMin - 1, xMin, yMin},
+            {xMax + 1, yMax + 2, xMax, yMax},
+            {xMin - 3, Scalar(0.5), xMin, Scalar(0.5)},
+            {Scalar(1.0), yMax + 1, Scalar(1.0), yMax},
+        }};
+        for (const auto& pt : points) {
+            const Scalar ref = f(pt[2], pt[3]);
+            const Scalar tol = 1e-5;
+            if (std::abs(uTable.eval(pt[0], pt[1], /*extrapolate=*/false) - ref) > tol) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": uTable.eval("<<pt[0]<<","<<pt[1]<<") != " << ref << "\n";
+                return false;
+            }
+            if (std::abs(uXTable.eval(pt[0], pt[1]) - ref) > tol) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": uXTable.eval("<<pt[0]<<","<<pt[1]<<") != " << ref << "\n";
+                return false;
+            }
+            if (std::abs(iTable.eval(pt[0], pt[1]) - ref) > tol) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": iTable.eval("<<pt[0]<<","<<pt[1]<<") != " << ref << "\n";
+                return false;
+            }
+        }
+
+        // unchecked tables do not reject non-finite arguments, but these must not be
+        // used to compute the index of a lookup bucket
+        const Opm::Tabulated1DFunction<Scalar, Opm::RangeCheck::Unchecked> table1D(xSamples, ySamples);
+        if (!std::isnan(table1D.eval(std::numeric_limits<Scalar>::quiet_NaN(), /*extrapolate=*/true))) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": table1D.eval(NaN) is not NaN\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    // make sure that tables which are restored from a snapshot are identical to the
+    // original ones
+    template <class TablePtr>
+    bool checkSnapshot(const TablePtr table1, const TablePtr table2) const
+    {
+        typedef typename TablePtr::element_type UniformXTable;
+        typedef Opm::UniformXTabulated2DMultiFunction<Scalar, 2> MultiTable;
+        typedef Opm::Tabulated1DFunction<Scalar> Table1D;
+
+        std::vector<Scalar> xSamples;
+        std::vector<Scalar> ySamples;
+        for (unsigned i = 0; i < 20; ++i) {
+            xSamples.push_back(Scalar(i*i));
+            ySamples.push_back(std::sqrt(Scalar(i)));
+        }
+        const Table1D table1D(xSamples.size(), xSamples, ySamples);
+        const MultiTable multiTable({table1.get(), table2.get()});
+
+        const std::string fileName = "test_2dtables.snapshot";
+        const std::string tag = "test_2dtables<" + Opm::snapshotScalarName<Scalar>() + ">";
+
+        Opm::SnapshotWriter writer;
+        writer(*table1);
+        writer(multiTable);
+        writer(table1D);
+        writer.writeFile(fileName, tag);
+
+        UniformXTable table1Restored;
+        MultiTable multiTableRestored;
+        Table1D table1DRestored;
+        {
+            Opm::SnapshotReader reader(fileName, tag);
+            reader(table1Restored);
+            reader(multiTableRestored);
+            reader(table1DRestored);
+            reader.checkEnd();
+        }
+
+        bool ok = true;
+        if (!(table1Restored == *table1) || !(multiTableRestored == multiTable) || !(table1DRestored == table1D)) {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": tables restored from a snapshot differ from the original ones\n";
+            ok = false;
+        }
+
+        for (unsigned k = 0; ok && k < 100; ++k) {
+            const Scalar x = xSamples.back()*k/100;
+            if (table1DRestored.eval(x) != table1D.eval(x)) {
+                std::cerr << __FILE__ << ":" << __LINE__ << ": table1DRestored.eval("<<x<<") != table1D.eval("<<x<<")\n";
+                ok = false;
+            }
+        }
+
+        // snapshots cannot be read using a different content tag
+        try {
+            Opm::SnapshotReader reader(fileName, tag + "x");
+            std::cerr << __FILE__ << ":" << __LINE__ << ": snapshot was read using a wrong content tag\n";
+            ok = false;
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        std::remove(fileName.c_str());
+        return ok;
+    }
+
+    // the inverse of a strictly monotonic 1D table must undo the table exactly, also
+    // if extrapolation is involved, and must yield the reciprocal derivative
+    bool checkInverse1D(Scalar tolerance) const
+    {
+        typedef Opm::Tabulated1DFunction<Scalar> Table1D;
+        typedef Opm::DenseAd::Evaluation<Scalar, 1> Eval;
+
+        std::vector<Scalar> xSamples;
+        std::vector<Scalar> ySamples;
+        for (unsigned i = 0; i < 20; ++i) {
+            xSamples.push_back(Scalar(i));
+            ySamples.push_back(std::sqrt(Scalar(i)) + Scalar(i)/10);
+        }
+        const Table1D increasing(xSamples, ySamples);
+        std::transform(ySamples.begin(), ySamples.end(), ySamples.begin(),
+                       [](Scalar y) { return -y; });
+        const Table1D decreasing(xSamples, ySamples);
+        ySamples[10] = ySamples[9];
+        const Table1D notStrictlyMonotonic(xSamples, ySamples);
+
+        if (!increasing.isStrictlyMonotonic() || !decreasing.isStrictlyMonotonic()
+            || notStrictlyMonotonic.isStrictlyMonotonic())
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << ": wrong result of isStrictlyMonotonic()\n";
+            return false;
+        }
+
+        try {
+            notStrictlyMonotonic.inverse();
+            std::cerr << __FILE__ << ":" << __LINE__ << ": a function which is not strictly monotonic was inverted\n";
+            return false;
+        }
+        catch (const std::logic_error&) {
+        }
+
+        for (const Table1D* table : {&increasing, &decreasing}) {
+            const Table1D inverse = table->inverse();
+            for (unsigned k = 0; k <= 100; ++k) {
+                const Scalar x = Scalar(-2.0) + Scalar(k)/100*(xSamples.back() + 4);
+                const Eval& y = table->eval(Eval::createVariable(x, 0), /*extrapolate=*/true);
+                const Eval& xInv = inverse.eval(y, /*extrapolate=*/true);
+                if (std::abs(xInv.value() - x) > tolerance*(1 + std::abs(x))
+                    || std::abs(xInv.derivative(0) - 1) > tolerance)
+                {
+                    std::cerr << __FILE__ << ":" << __LINE__ << ": inverse.eval(table.eval("<<x<<")) = (" << xInv.value() << ", " << xInv.derivative(0) << ") != (" << x << ", 1)\n";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
 };
 
 
@@ -416,6 +811,32 @@ inline int testAll(const typename TestType::Scalar tolerance = 1e-6)
                                          TestType::testFn3,
                                          /*tolerance=*/1e-2))
         return 1;
+    if (!test.compareBatchEval(uniformXTab, -2.0, 3.0, 100, -4.0, 5.0, 100))
+        return 1;
+    if (!test.compareCursorEval(uniformXTab, -2.0, 3.0, 100, -4.0, 5.0, 100))
+        return 1;
+    if (!test.compareMultiEval(uniformXTab, test.createUniformXTabulatedFunction2(TestType::testFn2),
+                               -2.0, 3.0, 100, -4.0, 5.0, 100))
+        return 1;
+    if (!test.compareAdEval(uniformXTab, -2.0, 3.0, 100, -4.0, 5.0, 100, 1000*tolerance))
+        return 1;
+    using UniformXTable = Opm::UniformXTabulated2DFunction<typename TestType::Scalar>;
+    for (auto policy : {UniformXTable::InterpolationPolicy::Vertical,
+                        UniformXTable::InterpolationPolicy::LeftExtreme,
+                        UniformXTable::InterpolationPolicy::RightExtreme})
+    {
+        if (!test.compareAdEvalFiniteDifferences(policy))
+            return 1;
+        if (!test.compareBatchEval(test.createUniformXTabulatedFunction2(TestType::testFn3, policy),
+                                   -2.5, 3.5, 60, -4.5, 5.5, 60, /*extrapolate=*/true))
+            return 1;
+    }
+    if (!test.checkClampedTables(TestType::testFn3))
+        return 1;
+    if (!test.checkSnapshot(uniformXTab, test.createUniformXTabulatedFunction2(TestType::testFn2)))
+        return 1;
+    if (!test.checkInverse1D(1000*tolerance))
+        return 1;
 
     {
         using ScalarType = typename TestType::Scalar;
@@ -444,6 +865,9 @@ inline int testAll(const typename TestType::Scalar tolerance = 1e-6)
 
         if (!test.compareTableWithAnalyticFn2(xytab, xMin, xMax, m, yMin, yMax, n, TestType::testFn3, tmpTolerance))
             return 1;
+
+        if (!test.compareBatchEval(xytab, xMin, xMax, m, yMin, yMax, n))
+            return 1;
     }
 
     // CSV output for debugging
@@ -36,6 +36,12 @@
 
 #include <opm/material/densead/Evaluation.hpp>
 #include <opm/material/densead/Math.hpp>
+#include <opm/material/densead/SparseEvaluation.hpp>
+#include <opm/material/densead/MixedPrecisionEvaluation.hpp>
+#include <opm/material/densead/EvaluationBlock.hpp>
+#include <opm/material/densead/BatchMath.hpp>
+#include <opm/material/densead/OperationCounter.hpp>
+#include <opm/material/common/FastSmallVector.hpp>
 
 #include <dune/common/parallel/mpihelper.hh>
 
@@ -45,6 +51,9 @@
 #include <algorithm>
 #include <cassert>
 #include <stdexcept>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 template <class Eval, int numVars, int staticSize, class Scalar, class Implementation>
 struct TestEnvBase
@@ -480,6 +489,49 @@ struct TestEnvBase
         }
     }
 
+    void testExpressions()
+    {
+        typedef Opm::MathToolbox<Eval> EvalToolbox;
+        const Scalar tolerance = std::numeric_limits<Scalar>::epsilon()*1e3;
+
+        const Scalar c = 1.234;
+        const Eval xEval = asImp_().createVariable(4.567, 0);
+        const Eval yEval = asImp_().createVariable(8.910, 1);
+        const Eval zEval = asImp_().createVariable(-2.345, 0)*yEval;
+
+        using Opm::lazy;
+
+        // the formulas used by BlackOilFluidSystem::density()
+        const Eval a1 = xEval*c + yEval*xEval*(2*c);
+        const Eval a2 = lazy(xEval)*c + lazy(yEval)*lazy(xEval)*(2*c);
+        if (!EvalToolbox::isSame(a1, a2, tolerance*std::abs(a1.value())))
+            throw std::logic_error("oops: lazy sum of products");
+
+        const Eval b1 = (xEval - yEval)/(zEval + c) - (c - xEval)*zEval;
+        const Eval b2 = (lazy(xEval) - yEval)/(lazy(zEval) + c) - (c - lazy(xEval))*zEval;
+        if (!EvalToolbox::isSame(b1, b2, tolerance*std::abs(b1.value())))
+            throw std::logic_error("oops: lazy quotient and differences");
+
+        const Eval cEval = asImp_().createConstant(c);
+        const Eval d1 = -xEval*c/yEval + cEval/zEval - yEval/c;
+        const Eval d2 = -lazy(xEval)*c/yEval + c/lazy(zEval) - lazy(yEval)/c;
+        if (!EvalToolbox::isSame(d1, d2, tolerance*std::abs(d1.value())))
+            throw std::logic_error("oops: lazy expressions involving constants");
+
+        // assigning an expression to one of its operands
+        Eval e1 = xEval;
+        e1 = e1*yEval/(e1 + zEval);
+        Eval e2 = xEval;
+        e2 = lazy(e2)*yEval/(lazy(e2) + zEval);
+        if (!EvalToolbox::isSame(e1, e2, tolerance*std::abs(e1.value())))
+            throw std::logic_error("oops: aliased lazy expression");
+
+        // for non-Evaluations, lazy() is the identity
+        const Scalar f = lazy(c)*c + c;
+        if (f != c*c + c)
+            throw std::logic_error("oops: lazy scalar");
+    }
+
 // prototypes
     static double myScalarMin(double a, double b)
     { return std::min(a, b); }
@@ -560,6 +612,9 @@ struct TestEnvBase
         std::cout << "  Testing atan2()\n";
         testAtan2();
 
+        std::cout << "  Testing lazily evaluated expressions\n";
+        testExpressions();
+
         std::cout << "  Testing exp()\n";
         test1DFunction(Opm::DenseAd::exp<Scalar, numVars, staticSize>,
                        static_cast<Scalar (*)(Scalar)>(std::exp),
@@ -682,6 +737,502 @@ private:
     int numDerivs_;
 };
 
+// compare the results of sparse evaluations with the ones of their dense counterparts
+template <class Scalar, int numDerivs>
+void testSparseEvaluation()
+{
+    typedef Opm::DenseAd::Evaluation<Scalar, numDerivs> Eval;
+    typedef Opm::DenseAd::SparseEvaluation<Scalar, numDerivs> SparseEval;
+    typedef Opm::MathToolbox<Eval> EvalToolbox;
+    const Scalar tolerance = std::numeric_limits<Scalar>::epsilon()*1e3;
+
+    const auto check = [&](const SparseEval& sparse, const Eval& dense, const std::string& what) {
+        if (!EvalToolbox::isSame(sparse.toDense(), dense, tolerance*std::max<Scalar>(1.0, std::abs(dense.value()))))
+            throw std::logic_error("oops: sparse "+what);
+    };
+
+    // variables which depend on the first, second and last primary variable
+    const Eval xEval = Eval::createVariable(1.234, 0);
+    const Eval yEval = Eval::createVariable(2.345, 1)*xEval + 0.5;
+    const Eval zEval = Eval::createVariable(3.456, numDerivs - 1);
+    const SparseEval x = SparseEval::createVariable(1.234, 0);
+    const SparseEval y = SparseEval::createVariable(2.345, 1)*x + 0.5;
+    const SparseEval z = SparseEval::createVariable(3.456, numDerivs - 1);
+    const Scalar c = 0.789;
+
+    if (!y.mayBeNonZero(0) || !y.mayBeNonZero(1) || y.mayBeNonZero(numDerivs - 1))
+        throw std::logic_error("oops: non-zero blocks of sparse evaluation");
+    if (SparseEval(zEval).mayBeNonZero(0) || !SparseEval(zEval).mayBeNonZero(numDerivs - 1))
+        throw std::logic_error("oops: conversion of dense evaluation");
+
+    check(x + z, xEval + zEval, "operator+");
+    check(z - y, zEval - yEval, "operator-");
+    check(y*z, yEval*zEval, "operator*");
+    check(y/z, yEval/zEval, "operator/");
+    check(z/y, zEval/yEval, "operator/");
+    check(y/c + c*z - c, yEval/c + c*zEval - c, "operators with constants");
+    check(c/y - (c - z), c/yEval - (c - zEval), "operators with constants");
+    check(-y, -yEval, "negation");
+
+    SparseEval a = z;
+    a *= y;
+    a /= x;
+    a += c;
+    a -= z;
+    check(a, (zEval*yEval)/xEval + c - zEval, "inplace operators");
+
+    check(Opm::exp(y), Opm::exp(yEval), "exp()");
+    check(Opm::log(z), Opm::log(zEval), "log()");
+    check(Opm::log10(z), Opm::log10(zEval), "log10()");
+    check(Opm::sqrt(y), Opm::sqrt(yEval), "sqrt()");
+    check(Opm::sin(y), Opm::sin(yEval), "sin()");
+    check(Opm::cos(y), Opm::cos(yEval), "cos()");
+    check(Opm::tan(x), Opm::tan(xEval), "tan()");
+    check(Opm::atan(y), Opm::atan(yEval), "atan()");
+    check(Opm::pow(y, c), Opm::pow(yEval, c), "pow(Eval, Scalar)");
+    check(Opm::pow(c, y), Opm::pow(c, yEval), "pow(Scalar, Eval)");
+    check(Opm::pow(y, z), Opm::pow(yEval, zEval), "pow(Eval, Eval)");
+    check(Opm::max(y, z), Opm::max(yEval, zEval), "max()");
+    check(Opm::min(y, c), Opm::min(yEval, c), "min()");
+
+    // mixed operations produce dense results
+    const Eval b1 = xEval*y + z - zEval/y;
+    Eval b2 = xEval;
+    b2 *= y;
+    b2 += z;
+    b2 -= zEval/y;
+    const Eval b3 = xEval*yEval + zEval - zEval/yEval;
+    check(SparseEval(b1), b3, "mixed operators");
+    check(SparseEval(b2), b3, "mixed inplace operators");
+
+    Eval d = y;
+    d = z;
+    if (d != zEval)
+        throw std::logic_error("oops: assignment of sparse evaluation");
+}
+
+// compare the results of mixed precision evaluations with the ones of their full
+// precision counterparts: the values must match to the full precision, the
+// derivatives to the one of the derivatives.
+template <int numDerivs>
+void testMixedPrecisionEvaluation()
+{
+    typedef Opm::DenseAd::Evaluation<double, numDerivs> Eval;
+    typedef Opm::DenseAd::MixedPrecisionEvaluation<double, numDerivs, float> MixedEval;
+    typedef Opm::MathToolbox<Eval> EvalToolbox;
+    typedef Opm::MathToolbox<MixedEval> MixedToolbox;
+
+    static_assert(sizeof(MixedEval) < sizeof(Eval),
+                  "mixed precision evaluations are supposed to be smaller");
+
+    const double valueTolerance = std::numeric_limits<double>::epsilon()*1e3;
+    const double derivTolerance = std::numeric_limits<float>::epsilon()*1e2;
+
+    const auto check = [&](const MixedEval& mixed, const Eval& full, const std::string& what) {
+        if (!Opm::MathToolbox<double>::isSame(mixed.value(), full.value(), valueTolerance))
+            throw std::logic_error("oops: value of mixed precision "+what);
+        Eval tmp = full;
+        tmp.setValue(mixed.value());
+        if (!EvalToolbox::isSame(mixed.toFull(), tmp, derivTolerance))
+            throw std::logic_error("oops: derivatives of mixed precision "+what);
+    };
+
+    const Eval xEval = Eval::createVariable(1.234, 0);
+    const Eval yEval = Eval::createVariable(2.345, 1)*xEval + 0.5;
+    const Eval zEval = Eval::createVariable(3.456, numDerivs - 1);
+    const MixedEval x = MixedEval::createVariable(1.234, 0);
+    const MixedEval y = MixedEval::createVariable(2.345, 1)*x + 0.5;
+    const MixedEval z = MixedEval::createVariable(3.456, numDerivs - 1);
+    const double c = 0.789;
+
+    check(x + z, xEval + zEval, "operator+");
+    check(z - y, zEval - yEval, "operator-");
+    check(y*z, yEval*zEval, "operator*");
+    check(y/z, yEval/zEval, "operator/");
+    check(y/c + c*z - c, yEval/c + c*zEval - c, "operators with constants");
+    check(c/y - (c - z), c/yEval - (c - zEval), "operators with constants");
+    check(-y, -yEval, "negation");
+
+    MixedEval a = z;
+    a *= y;
+    a /= x;
+    a += c;
+    a -= z;
+    check(a, (zEval*yEval)/xEval + c - zEval, "inplace operators");
+
+    check(Opm::exp(y), Opm::exp(yEval), "exp()");
+    check(Opm::log(z), Opm::log(zEval), "log()");
+    check(Opm::sqrt(y), Opm::sqrt(yEval), "sqrt()");
+    check(Opm::sin(y), Opm::sin(yEval), "sin()");
+    check(Opm::atan(y), Opm::atan(yEval), "atan()");
+    check(Opm::pow(y, c), Opm::pow(yEval, c), "pow(Eval, Scalar)");
+    check(Opm::pow(c, y), Opm::pow(c, yEval), "pow(Scalar, Eval)");
+    check(Opm::pow(y, z), Opm::pow(yEval, zEval), "pow(Eval, Eval)");
+    check(Opm::max(y, z), Opm::max(yEval, zEval), "max()");
+    check(MixedToolbox::exp(y), EvalToolbox::exp(yEval), "MathToolbox::exp()");
+
+    // conversions and mixed operations produce full precision results
+    const Eval b1 = xEval*y + z - zEval/y;
+    const Eval b2 = MixedToolbox::template decay<Eval>(x*y + z - z/y);
+    const Eval b3 = xEval*yEval + zEval - zEval/yEval;
+    check(MixedEval(b1), b3, "mixed operators");
+    check(MixedEval(b2), b3, "decay()");
+    if (MixedToolbox::template decay<double>(y) != y.value())
+        throw std::logic_error("oops: decay of mixed precision evaluation to a scalar");
+}
+
+// each lane of an evaluation block must behave like an Evaluation
+template <class Scalar, int numDerivs, int width>
+void testEvaluationBlock()
+{
+    typedef Opm::DenseAd::Evaluation<Scalar, numDerivs> Eval;
+    typedef Opm::DenseAd::EvaluationBlock<Scalar, numDerivs, width> Block;
+    typedef Opm::MathToolbox<Eval> EvalToolbox;
+    typedef Opm::MathToolbox<Block> BlockToolbox;
+    const Scalar tolerance = std::numeric_limits<Scalar>::epsilon()*1e3;
+
+    // the lanes have different values, so that comparisons differ between lanes
+    std::array<Eval, width> xEval, yEval, zEval;
+    Block x, y, z;
+    for (int lane = 0; lane < width; ++lane) {
+        xEval[lane] = Eval::createVariable(0.5 + 0.05*lane, 0);
+        yEval[lane] = Eval::createVariable(1.2 - 0.05*lane, 1)*xEval[lane] + 0.5;
+        zEval[lane] = Eval::createVariable(0.3 + 0.2*lane, numDerivs - 1);
+        x.setLane(lane, xEval[lane]);
+        y.setLane(lane, yEval[lane]);
+        z.setLane(lane, zEval[lane]);
+    }
+    const Scalar c = 0.789;
+
+    const auto check = [&](const Block& block, const auto& fn, const std::string& what) {
+        for (int lane = 0; lane < width; ++lane) {
+            const Eval ref = fn(xEval[lane], yEval[lane], zEval[lane]);
+            if (!EvalToolbox::isSame(block.lane(lane), ref, tolerance))
+                throw std::logic_error("oops: evaluation block "+what);
+        }
+    };
+
+    check(x + z, [](auto a, auto, auto c) { return a + c; }, "operator+");
+    check(z - y, [](auto, auto b, auto c) { return c - b; }, "operator-");
+    check(y*z, [](auto, auto b, auto c) { return b*c; }, "operator*");
+    check(y/z, [](auto, auto b, auto c) { return b/c; }, "operator/");
+    check(y/c + c*z - c, [=](auto, auto b, auto d) { return b/c + c*d - c; }, "operators with constants");
+    check(c/y - (c - z), [=](auto, auto b, auto d) { return c/b - (c - d); }, "operators with constants");
+    check(-y, [](auto, auto b, auto) { return -b; }, "negation");
+
+    Block a = z;
+    a *= y;
+    a /= x;
+    a += c;
+    a -= z;
+    check(a, [=](auto p, auto q, auto r) { return r*q/p + c - r; }, "inplace operators");
+
+    check(Opm::exp(y), [](auto, auto b, auto) { return Opm::exp(b); }, "exp()");
+    check(Opm::log(z), [](auto, auto, auto d) { return Opm::log(d); }, "log()");
+    check(Opm::log10(z), [](auto, auto, auto d) { return Opm::log10(d); }, "log10()");
+    check(Opm::sqrt(y), [](auto, auto b, auto) { return Opm::sqrt(b); }, "sqrt()");
+    check(Opm::sin(y), [](auto, auto b, auto) { return Opm::sin(b); }, "sin()");
+    check(Opm::cos(y), [](auto, auto b, auto) { return Opm::cos(b); }, "cos()");
+    check(Opm::tan(x), [](auto a, auto, auto) { return Opm::tan(a); }, "tan()");
+    check(Opm::atan(y), [](auto, auto b, auto) { return Opm::atan(b); }, "atan()");
+    check(Opm::atan2(y, z), [](auto, auto b, auto d) { return Opm::atan2(b, d); }, "atan2()");
+    check(Opm::pow(y, c), [=](auto, auto b, auto) { return Opm::pow(b, c); }, "pow(Eval, Scalar)");
+    check(Opm::pow(c, y), [=](auto, auto b, auto) { return Opm::pow(c, b); }, "pow(Scalar, Eval)");
+    check(Opm::pow(y, z), [](auto, auto b, auto d) { return Opm::pow(b, d); }, "pow(Eval, Eval)");
+    check(Opm::max(x, z), [](auto a, auto, auto d) { return Opm::max(a, d); }, "max()");
+    check(Opm::min(x, z), [](auto a, auto, auto d) { return Opm::min(a, d); }, "min()");
+    check(Opm::min(z, c), [=](auto, auto, auto d) { return Opm::min(d, c); }, "min()");
+    check(Opm::abs(x - z), [](auto a, auto, auto d) { return Opm::abs(a - d); }, "abs()");
+    check(BlockToolbox::exp(y), [](auto, auto b, auto) { return Opm::exp(b); }, "MathToolbox::exp()");
+
+    const auto mask = x < z;
+    for (int lane = 0; lane < width; ++lane)
+        if (mask[lane] != (xEval[lane] < zEval[lane]))
+            throw std::logic_error("oops: comparison of evaluation blocks");
+    check(select(mask, x, y), [](auto a, auto b, auto d) { return (a < d)?a:b; }, "select()");
+    if (mask.all() || !mask.any())
+        throw std::logic_error("oops: the lanes of the test are supposed to differ");
+
+    if (!BlockToolbox::isfinite(y) || BlockToolbox::isnan(y))
+        throw std::logic_error("oops: isfinite()/isnan() of evaluation blocks");
+}
+
+// the batched functions must agree with the ones of the C library up to the
+// requested accuracy, also for the special values
+template <class Scalar, Opm::DenseAd::BatchAccuracy accuracy>
+void testBatchMath()
+{
+    typedef Opm::DenseAd::Evaluation<Scalar, 3> Eval;
+    typedef Opm::MathToolbox<Eval> EvalToolbox;
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    const Scalar tolerance =
+        (accuracy == Opm::DenseAd::BatchAccuracy::full) ? 64*eps : 10*std::sqrt(eps);
+
+    const auto relErr = [](Scalar a, Scalar b)
+    { return std::abs(a - b)/std::max<Scalar>(std::abs(b), std::numeric_limits<Scalar>::min()); };
+
+    // an odd number of values, so that the last vector is incomplete
+    const std::size_t n = 1001;
+    std::vector<Scalar> x(n);
+    std::vector<Scalar> result(n);
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = -30 + 60*Scalar(i)/(n - 1);
+
+    Opm::DenseAd::batchExp<accuracy>(x.data(), result.data(), n);
+    for (std::size_t i = 0; i < n; ++i)
+        if (relErr(result[i], std::exp(x[i])) > tolerance)
+            throw std::logic_error("oops: batchExp()");
+
+    for (auto& v : x)
+        v = std::exp(v/3);
+    Opm::DenseAd::batchLog<accuracy>(x.data(), result.data(), n);
+    for (std::size_t i = 0; i < n; ++i)
+        if (std::abs(result[i] - std::log(x[i])) > tolerance*std::max<Scalar>(1, std::abs(std::log(x[i]))))
+            throw std::logic_error("oops: batchLog()");
+
+    Opm::DenseAd::batchPow<accuracy>(x.data(), Scalar(1.7), result.data(), n);
+    for (std::size_t i = 0; i < n; ++i)
+        if (relErr(result[i], std::pow(x[i], Scalar(1.7))) > 32*tolerance)
+            throw std::logic_error("oops: batchPow()");
+
+    Opm::DenseAd::batchSqrt<accuracy>(x.data(), result.data(), n);
+    for (std::size_t i = 0; i < n; ++i)
+        if (result[i] != std::sqrt(x[i]))
+            throw std::logic_error("oops: batchSqrt()");
+
+    // special values. the results are computed in place.
+    const Scalar inf = std::numeric_limits<Scalar>::infinity();
+    const Scalar nan = std::numeric_limits<Scalar>::quiet_NaN();
+    const Scalar denormMin = std::numeric_limits<Scalar>::denorm_min();
+    std::vector<Scalar> special = { 0, -inf, inf, nan, 1e4, -1e4, -1, 1, denormMin };
+    Opm::DenseAd::batchExp<accuracy>(special.data(), special.data(), special.size());
+    if (special[0] != 1 || special[1] != 0 || special[2] != inf || !std::isnan(special[3])
+        || special[4] != inf || special[5] != 0 || relErr(special[6], std::exp(Scalar(-1))) > tolerance
+        || relErr(special[7], std::exp(Scalar(1))) > tolerance || special[8] != 1)
+        throw std::logic_error("oops: special values of batchExp()");
+
+    special = { 0, -inf, inf, nan, -1, 1, denormMin };
+    Opm::DenseAd::batchLog<accuracy>(special.data(), special.data(), special.size());
+    if (special[0] != -inf || !std::isnan(special[1]) || special[2] != inf || !std::isnan(special[3])
+        || !std::isnan(special[4]) || special[5] != 0
+        || relErr(special[6], std::log(denormMin)) > tolerance)
+        throw std::logic_error("oops: special values of batchLog()");
+
+    special = { 0, 1, 2 };
+    Opm::DenseAd::batchPow<accuracy>(special.data(), Scalar(0.0), special.data(), special.size());
+    if (special[0] != 1 || special[1] != 1 || special[2] != 1)
+        throw std::logic_error("oops: batchPow() with a zero exponent");
+
+    // evaluations: the derivatives follow from the chain rule. one of the bases of
+    // pow() is zero.
+    std::vector<Eval> xEval(n);
+    std::vector<Eval> resultEval(n);
+    for (std::size_t i = 0; i < n; ++i)
+        xEval[i] = Eval::createVariable(Scalar(i)/(n - 1), i % 3)*Scalar(2.0) + Eval::createVariable(0.0, (i + 1) % 3);
+
+    Opm::DenseAd::batchExp<accuracy>(xEval.data(), resultEval.data(), n);
+    for (std::size_t i = 0; i < n; ++i)
+        if (!EvalToolbox::isSame(resultEval[i], Opm::exp(xEval[i]), tolerance))
+            throw std::logic_error("oops: batchExp() for evaluations");
+
+    Opm::DenseAd::batchPow<accuracy>(xEval.data(), Scalar(1.7), resultEval.data(), n);
+    for (std::size_t i = 0; i < n; ++i)
+        if (!EvalToolbox::isSame(resultEval[i], Opm::pow(xEval[i], Scalar(1.7)), 32*tolerance))
+            throw std::logic_error("oops: batchPow() for evaluations");
+
+    Opm::DenseAd::batchSqrt<accuracy>(xEval.data() + 1, resultEval.data() + 1, n - 1);
+    for (std::size_t i = 1; i < n; ++i)
+        if (!EvalToolbox::isSame(resultEval[i], Opm::sqrt(xEval[i]), tolerance))
+            throw std::logic_error("oops: batchSqrt() for evaluations");
+
+    resultEval = xEval;
+    Opm::DenseAd::batchLog<accuracy>(resultEval.data() + 1, resultEval.data() + 1, n - 1);
+    for (std::size_t i = 1; i < n; ++i)
+        if (!EvalToolbox::isSame(resultEval[i], Opm::log(xEval[i]), tolerance))
+            throw std::logic_error("oops: in-place batchLog() for evaluations");
+}
+
+// computations inside a ValueOnlyScope must produce exactly the same values as the
+// ones with derivatives. (if OPM_DENSEAD_VALUE_ONLY_MODE is disabled, the scope does
+// nothing and the test is trivially fulfilled.)
+template <class Scalar, int numDerivs>
+void testValueOnlyMode()
+{
+    typedef Opm::DenseAd::Evaluation<Scalar, numDerivs> Eval;
+
+    const auto compute = [](const Eval& x, const Eval& y, const Eval& z) {
+        Eval a = x*y + z/x - 2.0*y;
+        a *= z;
+        a /= y;
+        a += x;
+        a -= 0.5;
+        a *= 3.0;
+        a /= 7.0;
+        a = a + Opm::exp(x) + Opm::log(y) + Opm::sqrt(z) + Opm::sin(x)*Opm::cos(y);
+        a += Opm::pow(y, 1.5) + Opm::pow(2.0, x) + Opm::pow(y, z);
+        a += Opm::atan2(x, y) + Opm::atan(z) + Opm::tan(x) + Opm::log10(z);
+        return a;
+    };
+
+    const Eval x = Eval::createVariable(1.234, 0);
+    const Eval y = Eval::createVariable(2.345, numDerivs - 1)*x + 0.5;
+    const Eval z = Eval::createVariable(0.456, numDerivs/2);
+
+    const Eval full = compute(x, y, z);
+    if (!Opm::DenseAd::derivativesEnabled())
+        throw std::logic_error("oops: derivatives are disabled by default");
+
+    Scalar valueOnly;
+    {
+        Opm::DenseAd::ValueOnlyScope scope;
+        if (Opm::DenseAd::derivativesEnabled() == bool(OPM_DENSEAD_VALUE_ONLY_MODE))
+            throw std::logic_error("oops: ValueOnlyScope did not change the mode");
+        {
+            Opm::DenseAd::ValueOnlyScope nestedScope;
+        }
+        if (Opm::DenseAd::derivativesEnabled() == bool(OPM_DENSEAD_VALUE_ONLY_MODE))
+            throw std::logic_error("oops: nested ValueOnlyScope did not restore the mode");
+
+        valueOnly = compute(x, y, z).value();
+    }
+    if (!Opm::DenseAd::derivativesEnabled())
+        throw std::logic_error("oops: ValueOnlyScope did not restore the mode");
+
+    if (valueOnly != full.value())
+        throw std::logic_error("oops: value only mode changes the values");
+
+    // the derivatives are computed again after the scope has ended
+    const Eval full2 = compute(x, y, z);
+    for (int i = 0; i < numDerivs; ++i)
+        if (full2.derivative(i) != full.derivative(i))
+            throw std::logic_error("oops: derivatives after leaving the value only mode");
+}
+
+template <class Scalar, int numDerivs>
+void testOperationCounter()
+{
+    typedef Opm::DenseAd::Evaluation<Scalar, numDerivs> Eval;
+
+    const Eval x = Eval::createVariable(1.5, 0);
+    const Eval y = Eval::createVariable(2.5, numDerivs - 1);
+    const Eval z = Eval::createVariable(0.5, numDerivs/2);
+
+    Opm::DenseAd::resetOperationCounts();
+    Eval a;
+    for (int i = 0; i < 2; ++i) {
+        OPM_DENSEAD_COUNT_SCOPE("outer");
+        a = x*y;
+        a /= z;
+        {
+            // the operations of nested scopes are only attributed to the innermost tag
+            OPM_DENSEAD_COUNT_SCOPE("inner");
+            Eval b = Opm::exp(a);
+            a = b + 1.0;
+        }
+        a *= 2.0;
+    }
+    a = a/x;
+
+    const auto counts = Opm::DenseAd::operationCounts();
+    if (!OPM_DENSEAD_COUNT_OPERATIONS) {
+        if (!counts.empty())
+            throw std::logic_error("oops: operations are counted although the counter is disabled");
+        return;
+    }
+
+    const auto check = [&counts](const std::string& tag,
+                                 std::uint64_t calls,
+                                 std::uint64_t multiplications,
+                                 std::uint64_t divisions,
+                                 std::uint64_t transcendentals,
+                                 std::uint64_t temporaries)
+    {
+        const auto it = counts.find(tag);
+        if (it == counts.end())
+            throw std::logic_error("oops: no operation counts for tag '"+tag+"'");
+
+        const auto& c = it->second;
+        if (c.calls != calls || c.multiplications != multiplications || c.divisions != divisions
+            || c.transcendentals != transcendentals || c.temporaries != temporaries)
+            throw std::logic_error("oops: wrong operation counts for tag '"+tag+"'");
+    };
+
+    // x*y is a temporary plus a multiplication. the second multiplication is the
+    // scaling by 2.
+    check("outer", 2, 4, 2, 0, 2);
+    // the chain rule of exp() multiplies the derivatives. b + 1.0 is a temporary.
+    check("inner", 2, 2, 0, 2, 4);
+    check(Opm::DenseAd::untaggedOperationsName, 0, 0, 1, 0, 1);
+
+    // resetting keeps the tags but zeros their counts
+    Opm::DenseAd::resetOperationCounts();
+    const auto resetCounts = Opm::DenseAd::operationCounts();
+    const auto it = resetCounts.find("outer");
+    if (it == resetCounts.end() || it->second.calls != 0 || it->second.multiplications != 0)
+        throw std::logic_error("oops: resetting the operation counts");
+}
+
+// the storage of dynamic evaluations: switching between the inline buffer and the
+// heap, and reusing the memory of the pool
+template <class Allocator>
+void testFastSmallVector()
+{
+    typedef Opm::FastSmallVector<double, 4, Allocator> Vector;
+
+    const auto check = [](const Vector& v, std::size_t size, double value, const std::string& what) {
+        if (v.size() != size || v.capacity() < size)
+            throw std::logic_error("oops: size of FastSmallVector after "+what);
+        for (std::size_t i = 0; i < size; ++i)
+            if (v[i] != value + i)
+                throw std::logic_error("oops: contents of FastSmallVector after "+what);
+    };
+    const auto fill = [](Vector& v, double value) {
+        for (std::size_t i = 0; i < v.size(); ++i)
+            v[i] = value + i;
+    };
+
+    Vector small(3);
+    fill(small, 1.0);
+    Vector large(20);
+    fill(large, 2.0);
+
+    Vector a(small);
+    check(a, 3, 1.0, "copy construction");
+    a = large;
+    check(a, 20, 2.0, "copy assignment");
+    const double* heapData = &a[0];
+    a = small;
+    Vector e(a);
+    check(e, 3, 1.0, "copy construction");
+    a = large;
+    if (&a[0] != heapData)
+        throw std::logic_error("oops: FastSmallVector did not reuse its buffer");
+    check(a, 20, 2.0, "copy assignment");
+
+    Vector b(std::move(a));
+    check(b, 20, 2.0, "move construction");
+    if (&b[0] != heapData || a.size() != 0)
+        throw std::logic_error("oops: FastSmallVector did not steal the buffer");
+    a = std::move(b);
+    check(a, 20, 2.0, "move assignment");
+    b = small;
+    a = std::move(b);
+    check(a, 3, 1.0, "move assignment");
+
+    // the buffer of a destroyed vector is handed out again
+    const double* recycledData;
+    {
+        Vector c(30);
+        recycledData = &c[0];
+    }
+    Vector d(30, 5.0);
+    if (std::is_same<Allocator, Opm::FastSmallVectorPoolAllocator<double>>::value && &d[0] != recycledData)
+        throw std::logic_error("oops: the pool did not recycle a buffer");
+    for (std::size_t i = 0; i < d.size(); ++i)
+        if (d[i] != 5.0)
+            throw std::logic_error("oops: contents of FastSmallVector");
+}
+
 int main(int argc, char **argv)
 {
     Dune::MPIHelper::instance(argc, argv);
@@ -702,11 +1253,45 @@ int main(int argc, char **argv)
     DynamicTestEnv<double, 0>(5).testAll();
     DynamicTestEnv<double, 4>(8).testAll();
     DynamicTestEnv<double, 4>(2).testAll();
+    DynamicTestEnv<double, 0>(40).testAll();
     std::cout << " -> Scalar == float\n";
     DynamicTestEnv<float, 6>(5).testAll();
     DynamicTestEnv<float, 0>(5).testAll();
     DynamicTestEnv<float, 4>(8).testAll();
     DynamicTestEnv<float, 4>(2).testAll();
 
+    std::cout << "Testing sparse evaluations\n";
+    testSparseEvaluation<double, 8>();
+    testSparseEvaluation<double, 12>();
+    testSparseEvaluation<float, 8>();
+
+    std::cout << "Testing mixed precision evaluations\n";
+    testMixedPrecisionEvaluation<3>();
+    testMixedPrecisionEvaluation<8>();
+
+    std::cout << "Testing evaluation blocks\n";
+    testEvaluationBlock<double, 3, 8>();
+    testEvaluationBlock<float, 5, 16>();
+
+    std::cout << "Testing batched functions\n";
+    testBatchMath<double, Opm::DenseAd::BatchAccuracy::full>();
+    testBatchMath<double, Opm::DenseAd::BatchAccuracy::reduced>();
+    testBatchMath<float, Opm::DenseAd::BatchAccuracy::full>();
+    testBatchMath<float, Opm::DenseAd::BatchAccuracy::reduced>();
+
+    std::cout << "Testing the value only mode\n";
+    testValueOnlyMode<double, 4>();
+    testValueOnlyMode<double, 12>();
+    testValueOnlyMode<float, 3>();
+
+    std::cout << "Testing operation counter\n";
+    testOperationCounter<double, 3>();
+    testOperationCounter<double, 8>();
+    testOperationCounter<float, 5>();
+
+    std::cout << "Testing the storage of dynamic evaluations\n";
+    testFastSmallVector<Opm::FastSmallVectorPoolAllocator<double>>();
+    testFastSmallVector<Opm::FastSmallVectorHeapAllocator<double>>();
+
     return 0;
 }
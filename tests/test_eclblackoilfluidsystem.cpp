@@ -34,6 +34,9 @@
 #endif
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
+#include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
+#include <opm/material/fluidstates/SimpleModularFluidState.hpp>
+#include <opm/material/fluidsystems/PvtRegionSchedule.hpp>
 #include <opm/material/fluidstates/BlackOilFluidState.hpp>
 #include <opm/material/densead/Evaluation.hpp>
 
@@ -42,12 +45,20 @@
 #include <opm/input/eclipse/Parser/Parser.hpp>
 #include <opm/input/eclipse/Deck/Deck.hpp>
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/input/eclipse/EclipseState/Grid/EclipseGrid.hpp>
 #include <opm/input/eclipse/Python/Python.hpp>
 
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <random>
 #include <type_traits>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 // values of strings based on the SPE1 and NORNE cases of opm-data.
 static const char* deckString1 =
@@ -607,6 +618,20 @@ static const char* deckString1 =
     "DENSITY\n"
     "      859.5  1033.0    0.854  /\n"
     "      860.04 1033.0    0.853  /\n"
+    "\n"
+    "SWOF\n"
+    "0.12   0       1       0\n"
+    "0.3    0.01    0.98    0\n"
+    "0.6    0.2     0.021   0\n"
+    "0.84   0.6     0       0\n"
+    "1      1       0       0 /\n"
+    "\n"
+    "SGOF\n"
+    "0      0       1       0\n"
+    "0.05   0.005   0.98    0\n"
+    "0.3    0.19    0.09    0\n"
+    "0.6    0.87    0.0001  0\n"
+    "0.88   0.984   0       0 /\n"
     "\n";
 
 template <class Evaluation>
@@ -738,6 +763,36 @@ inline void testAll()
                 std::abort();
         }
 
+        // ensure that the batched evaluation of all phases is consistent with the
+        // per-phase methods
+        typename FluidSystem::template PhaseProperties<Scalar> phaseProps;
+        FluidSystem::computePhaseProperties(phaseProps, fluidState, regionIdx);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (Opm::abs(phaseProps.invB[phaseIdx]
+                         - FluidSystem::inverseFormationVolumeFactor(fluidState, phaseIdx, regionIdx)) > eps)
+                std::abort();
+
+            if (Opm::abs(phaseProps.viscosity[phaseIdx]
+                         - FluidSystem::viscosity(fluidState, phaseIdx, regionIdx)) > 1e-10)
+                std::abort();
+        }
+
+        const Scalar& bo = phaseProps.invB[oilPhaseIdx];
+        if (Opm::abs(phaseProps.density[oilPhaseIdx]
+                     - bo*(FluidSystem::referenceDensity(oilPhaseIdx, regionIdx)
+                           + fluidState.Rs()*FluidSystem::referenceDensity(gasPhaseIdx, regionIdx))) > eps)
+            std::abort();
+
+        if (Opm::abs(phaseProps.density[waterPhaseIdx]
+                     - FluidSystem::density(fluidState, waterPhaseIdx, regionIdx)) > eps)
+            std::abort();
+
+        if (Opm::abs(phaseProps.saturatedRs - RsSat) > eps)
+            std::abort();
+
+        if (Opm::abs(phaseProps.saturatedRv - RvSat) > eps)
+            std::abort();
+
         if (Opm::abs(FluidSystem::bubblePointPressure(fluidState, regionIdx) - p) > eps*p)
             std::abort();
 
@@ -750,6 +805,383 @@ inline void testAll()
     [[maybe_unused]] const auto& gPvt = FluidSystem::gasPvt();
     [[maybe_unused]] const auto& oPvt = FluidSystem::oilPvt();
     [[maybe_unused]] const auto& wPvt = FluidSystem::waterPvt();
+
+    // evaluate cells of interleaved PVT regions grouped by region and make sure that
+    // the results end up in the original cell order
+    {
+        using PhaseProperties = typename FluidSystem::template PhaseProperties<Scalar>;
+        constexpr unsigned numCells = 10;
+        std::vector<Opm::BlackOilFluidState<Scalar, FluidSystem>> cellFluidStates(numCells, fluidState);
+        std::vector<unsigned> cellRegions(numCells);
+        for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            Scalar p = Scalar(cellIdx)/numCells*350e5 + 100e5;
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                cellFluidStates[cellIdx].setPressure(phaseIdx, p);
+            cellRegions[cellIdx] = (cellIdx*7) % FluidSystem::numRegions();
+        }
+
+        Opm::PvtRegionSchedule schedule(cellRegions);
+        if (schedule.numCells() != numCells || schedule.numRegions() != FluidSystem::numRegions())
+            std::abort();
+
+        for (unsigned regionIdx = 0; regionIdx < schedule.numRegions(); ++regionIdx)
+            for (const unsigned* cellIt = schedule.regionBegin(regionIdx); cellIt != schedule.regionEnd(regionIdx); ++cellIt)
+                if (cellRegions[*cellIt] != regionIdx)
+                    std::abort();
+
+        std::vector<PhaseProperties> scheduledProps(numCells);
+        FluidSystem::computePhaseProperties(scheduledProps.data(), cellFluidStates.data(), schedule);
+        for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            PhaseProperties cellProps;
+            FluidSystem::computePhaseProperties(cellProps, cellFluidStates[cellIdx], cellRegions[cellIdx]);
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (Opm::abs(cellProps.density[phaseIdx] - scheduledProps[cellIdx].density[phaseIdx]) > 1e-10)
+                    std::abort();
+                if (Opm::abs(cellProps.viscosity[phaseIdx] - scheduledProps[cellIdx].viscosity[phaseIdx]) > 1e-10)
+                    std::abort();
+            }
+        }
+    }
+
+    // make sure that the lookup cursors of a cell do not change the results, both if
+    // the pressure sweeps through the segments of the PVT tables and if it jumps
+    // around randomly. the phases are alternately saturated and undersaturated.
+    {
+        using PhaseProperties = typename FluidSystem::template PhaseProperties<Evaluation>;
+        Opm::BlackOilFluidState<Evaluation, FluidSystem> evalFluidState;
+        Opm::Valgrind::SetUndefined(evalFluidState);
+
+        std::vector<Scalar> pressures;
+        for (unsigned i = 0; i < 1000; ++i)
+            pressures.push_back(Scalar(i)/1000*350e5 + 100e5);
+        std::vector<Scalar> randomPressures(pressures);
+        std::shuffle(randomPressures.begin(), randomPressures.end(), std::mt19937(42));
+        pressures.insert(pressures.end(), randomPressures.begin(), randomPressures.end());
+
+        typename FluidSystem::Cursor cursor;
+        for (unsigned i = 0; i < pressures.size(); ++i) {
+            Evaluation p = pressures[i];
+            if constexpr (!std::is_same<Evaluation, Scalar>::value)
+                p = Evaluation::createVariable(pressures[i], 0);
+
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                evalFluidState.setPressure(phaseIdx, p);
+                evalFluidState.setSaturation(phaseIdx, 1.0/numPhases);
+            }
+
+            const Scalar saturationFraction = (i % 2 == 0) ? 1.0 : 0.5;
+            evalFluidState.setRs(saturationFraction
+                                 *FluidSystem::saturatedDissolutionFactor(evalFluidState, oilPhaseIdx, regionIdx));
+            evalFluidState.setRv(saturationFraction
+                                 *FluidSystem::saturatedDissolutionFactor(evalFluidState, gasPhaseIdx, regionIdx));
+
+            PhaseProperties props;
+            PhaseProperties cursorProps;
+            FluidSystem::computePhaseProperties(props, evalFluidState, regionIdx);
+            FluidSystem::computePhaseProperties(cursorProps, evalFluidState, regionIdx, cursor);
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (Opm::abs(props.invB[phaseIdx] - cursorProps.invB[phaseIdx]) > 1e-10)
+                    std::abort();
+                if (Opm::abs(props.density[phaseIdx] - cursorProps.density[phaseIdx]) > 1e-10)
+                    std::abort();
+                if (Opm::abs(props.viscosity[phaseIdx] - cursorProps.viscosity[phaseIdx]) > 1e-10)
+                    std::abort();
+            }
+            if (Opm::abs(props.saturatedRs - cursorProps.saturatedRs) > 1e-10)
+                std::abort();
+            if (Opm::abs(props.saturatedRv - cursorProps.saturatedRv) > 1e-10)
+                std::abort();
+        }
+    }
+
+    // the deck uses live oil, wet gas and water of constant compressibility, so the
+    // fluid system specialized for these PVT classes must be picked and yield the same
+    // results as the generic one
+    {
+        using SpecializedFluidSystem =
+            typename FluidSystem::NonStatic::template WithPvt<Opm::LiveOilPvt<double>,
+                                                             Opm::WetGasPvt<double>,
+                                                             Opm::ConstantCompressibilityWaterPvt<double>>;
+        using DeadOilFluidSystem =
+            typename FluidSystem::NonStatic::template WithPvt<Opm::DeadOilPvt<double>,
+                                                             Opm::DryGasPvt<double>,
+                                                             Opm::ConstantCompressibilityWaterPvt<double>>;
+
+        const auto& fluidSystem = FluidSystem::defaultInstance();
+        if (!fluidSystem.template hasPvtTypes<Opm::LiveOilPvt<double>,
+                                              Opm::WetGasPvt<double>,
+                                              Opm::ConstantCompressibilityWaterPvt<double>>())
+            std::abort();
+
+        bool isSpecialized = false;
+        Opm::dispatchBlackOilFluidSystem<Opm::BlackOilPvtTypes<Opm::DeadOilPvt<double>,
+                                                               Opm::DryGasPvt<double>,
+                                                               Opm::ConstantCompressibilityWaterPvt<double>>,
+                                         Opm::BlackOilPvtTypes<Opm::LiveOilPvt<double>,
+                                                               Opm::WetGasPvt<double>,
+                                                               Opm::ConstantCompressibilityWaterPvt<double>>>(
+            fluidSystem,
+            [&](const auto& fs) {
+                using FS = std::decay_t<decltype(fs)>;
+                isSpecialized = std::is_same<FS, SpecializedFluidSystem>::value;
+
+                for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                    if (Opm::abs(fs.density(fluidState, phaseIdx, regionIdx)
+                                 - FluidSystem::density(fluidState, phaseIdx, regionIdx)) > 1e-10)
+                        std::abort();
+                    if (Opm::abs(fs.viscosity(fluidState, phaseIdx, regionIdx)
+                                 - FluidSystem::viscosity(fluidState, phaseIdx, regionIdx)) > 1e-10)
+                        std::abort();
+                }
+            });
+        if (!isSpecialized)
+            std::abort();
+
+        bool hasThrown = false;
+        try {
+            DeadOilFluidSystem deadOilFluidSystem(fluidSystem);
+        }
+        catch (const std::invalid_argument&) {
+            hasThrown = true;
+        }
+        if (!hasThrown)
+            std::abort();
+    }
+
+    // make sure that modifying a copy of the default instance does not affect the
+    // static fluid system
+    auto otherFluidSystem = FluidSystem::defaultInstance();
+    otherFluidSystem.setReferenceDensities(2*860.04, 1033.0, 0.853, /*regionIdx=*/1);
+    otherFluidSystem.initEnd();
+
+    if (std::abs(FluidSystem::referenceDensity(oilPhaseIdx, /*regionIdx=*/1) - 860.04) > 1e-10)
+        std::abort();
+    if (std::abs(otherFluidSystem.referenceDensity(oilPhaseIdx, /*regionIdx=*/1) - 2*860.04) > 1e-10)
+        std::abort();
+
+    Scalar rhoOil = FluidSystem::density(fluidState, oilPhaseIdx, regionIdx);
+    Scalar rhoOilOther = otherFluidSystem.density(fluidState, oilPhaseIdx, regionIdx);
+    if (!(rhoOilOther > rhoOil))
+        std::abort();
+
+    Scalar rhoWater = FluidSystem::density(fluidState, waterPhaseIdx, regionIdx);
+    Scalar rhoWaterOther = otherFluidSystem.density(fluidState, waterPhaseIdx, regionIdx);
+    if (Opm::abs(rhoWater - rhoWaterOther) > eps)
+        std::abort();
+}
+
+// returns true iff calling fn() throws a std::runtime_error
+template <class Fn>
+inline bool throwsRuntimeError(Fn fn)
+{
+    try {
+        fn();
+    }
+    catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// flip one bit of the payload of a snapshot file
+inline void corruptSnapshot(const std::string& fileName)
+{
+    std::fstream file(fileName, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(0, std::ios::end);
+    const auto pos = file.tellg() - std::streamoff(8);
+    char c;
+    file.seekg(pos);
+    file.read(&c, 1);
+    c ^= 1;
+    file.seekp(pos);
+    file.write(&c, 1);
+}
+
+// make sure that the fluid system and the saturation functions survive a round trip
+// through a snapshot file and that broken snapshots are rejected
+inline void testSnapshots()
+{
+    typedef Opm::BlackOilFluidSystem<double> FluidSystem;
+
+    enum { numPhases = 3 };
+    enum { waterPhaseIdx = 0 };
+    enum { oilPhaseIdx = 1 };
+    enum { gasPhaseIdx = 2 };
+    typedef Opm::ThreePhaseMaterialTraits<double,
+                                          /*wettingPhaseIdx=*/waterPhaseIdx,
+                                          /*nonWettingPhaseIdx=*/oilPhaseIdx,
+                                          /*gasPhaseIdx=*/gasPhaseIdx> MaterialTraits;
+    typedef Opm::EclMaterialLawManager<MaterialTraits> MaterialLawManager;
+    typedef MaterialLawManager::MaterialLaw MaterialLaw;
+
+    typedef Opm::SimpleModularFluidState<double,
+                                         /*numPhases=*/3,
+                                         /*numComponents=*/3,
+                                         void,
+                                         /*storePressure=*/false,
+                                         /*storeTemperature=*/false,
+                                         /*storeComposition=*/false,
+                                         /*storeFugacity=*/false,
+                                         /*storeSaturation=*/true,
+                                         /*storeDensity=*/false,
+                                         /*storeViscosity=*/false,
+                                         /*storeEnthalpy=*/false> FluidState;
+
+    const std::string fluidSystemFile = "test_eclblackoilfluidsystem_fs.snapshot";
+    const std::string satFuncFile = "test_eclblackoilfluidsystem_satfunc.snapshot";
+
+    Opm::Parser parser;
+
+    auto deck = parser.parseString(deckString1);
+    auto python = std::make_shared<Opm::Python>();
+    Opm::EclipseState eclState(deck);
+    Opm::Schedule schedule(deck, eclState, python);
+    const std::size_t numElems = eclState.getInputGrid().getCartesianSize();
+
+    // fluid system
+    FluidSystem::initFromState(eclState, schedule);
+    FluidSystem::writeSnapshot(fluidSystemFile);
+
+    Opm::BlackOilFluidSystemNonStatic<double> restoredFluidSystem;
+    restoredFluidSystem.initFromSnapshot(fluidSystemFile);
+    if (!(restoredFluidSystem == FluidSystem::defaultInstance()))
+        std::abort();
+
+    auto otherFluidSystem = FluidSystem::defaultInstance();
+    otherFluidSystem.setReferenceDensities(2*860.04, 1033.0, 0.853, /*regionIdx=*/1);
+    otherFluidSystem.initEnd();
+    if (otherFluidSystem == FluidSystem::defaultInstance())
+        std::abort();
+
+    FluidSystem::initFromSnapshot(fluidSystemFile);
+    if (!(restoredFluidSystem == FluidSystem::defaultInstance()))
+        std::abort();
+
+    // saturation functions
+    MaterialLawManager materialLawManager;
+    materialLawManager.initFromState(eclState);
+    materialLawManager.initParamsForElements(eclState, numElems);
+    materialLawManager.writeSatRegionSnapshot(satFuncFile);
+
+    MaterialLawManager restoredMaterialLawManager;
+    restoredMaterialLawManager.loadSatRegionSnapshot(satFuncFile);
+    restoredMaterialLawManager.initFromState(eclState);
+    restoredMaterialLawManager.initParamsForElements(eclState, numElems);
+    if (!restoredMaterialLawManager.hasSameSatRegions(materialLawManager))
+        std::abort();
+
+    for (unsigned elemIdx = 0; elemIdx < numElems; ++elemIdx) {
+        const auto& params = materialLawManager.materialLawParams(elemIdx);
+        const auto& restoredParams = restoredMaterialLawManager.materialLawParams(elemIdx);
+        for (int i = 0; i <= 10; ++i) {
+            for (int j = 0; j <= 10 - i; ++j) {
+                FluidState fs;
+                fs.setSaturation(waterPhaseIdx, i/10.0);
+                fs.setSaturation(gasPhaseIdx, j/10.0);
+                fs.setSaturation(oilPhaseIdx, 1.0 - i/10.0 - j/10.0);
+
+                double pc[numPhases], restoredPc[numPhases];
+                double kr[numPhases], restoredKr[numPhases];
+                MaterialLaw::capillaryPressures(pc, params, fs);
+                MaterialLaw::capillaryPressures(restoredPc, restoredParams, fs);
+                MaterialLaw::relativePermeabilities(kr, params, fs);
+                MaterialLaw::relativePermeabilities(restoredKr, restoredParams, fs);
+                for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                    if (pc[phaseIdx] != restoredPc[phaseIdx] || kr[phaseIdx] != restoredKr[phaseIdx])
+                        std::abort();
+            }
+        }
+    }
+
+    // snapshots of the wrong kind are rejected
+    if (!throwsRuntimeError([&]() { restoredFluidSystem.initFromSnapshot(satFuncFile); }))
+        std::abort();
+    if (!throwsRuntimeError([&]() { MaterialLawManager m; m.loadSatRegionSnapshot(fluidSystemFile); }))
+        std::abort();
+
+    // corrupted snapshots are rejected
+    corruptSnapshot(fluidSystemFile);
+    if (!throwsRuntimeError([&]() { restoredFluidSystem.initFromSnapshot(fluidSystemFile); }))
+        std::abort();
+    corruptSnapshot(satFuncFile);
+    if (!throwsRuntimeError([&]() { MaterialLawManager m; m.loadSatRegionSnapshot(satFuncFile); }))
+        std::abort();
+
+    std::remove(fluidSystemFile.c_str());
+    std::remove(satFuncFile.c_str());
+}
+
+// make sure that the surface conditions of the static fluid systems agree with the ones
+// of their default instances, also for a specialized fluid system
+inline void testSurfaceConditions()
+{
+    typedef Opm::BlackOilFluidSystem<double> FluidSystem;
+    typedef Opm::BlackOilFluidSystem<double,
+                                     Opm::BlackOilDefaultIndexTraits,
+                                     Opm::LiveOilPvt<double>,
+                                     Opm::WetGasPvt<double>,
+                                     Opm::ConstantCompressibilityWaterPvt<double>> SpecializedFluidSystem;
+
+    Opm::Parser parser;
+
+    auto deck = parser.parseString(deckString1);
+    auto python = std::make_shared<Opm::Python>();
+    Opm::EclipseState eclState(deck);
+    Opm::Schedule schedule(deck, eclState, python);
+
+    FluidSystem::initFromState(eclState, schedule);
+
+    const double surfacePressure = eclState.getTableManager().stCond().pressure;
+    const double surfaceTemperature = eclState.getTableManager().stCond().temperature;
+    if (FluidSystem::surfacePressure != surfacePressure
+        || FluidSystem::surfaceTemperature != surfaceTemperature)
+        std::abort();
+
+    SpecializedFluidSystem::defaultInstance() =
+        SpecializedFluidSystem::NonStatic(FluidSystem::defaultInstance());
+
+    // handing out the default instance again must not overwrite its surface conditions
+    for (int i = 0; i < 2; ++i) {
+        const auto& fluidSystem = SpecializedFluidSystem::defaultInstance();
+        if (fluidSystem.surfacePressure != surfacePressure
+            || fluidSystem.surfaceTemperature != surfaceTemperature)
+            std::abort();
+        if (SpecializedFluidSystem::surfacePressure != surfacePressure
+            || SpecializedFluidSystem::surfaceTemperature != surfaceTemperature)
+            std::abort();
+    }
+
+    // the same via initFrom(), which also replaces surface conditions assigned to the
+    // static members before
+    SpecializedFluidSystem::surfacePressure = 0.0;
+    SpecializedFluidSystem::surfaceTemperature = 0.0;
+    SpecializedFluidSystem::initFrom(FluidSystem::defaultInstance());
+    if (SpecializedFluidSystem::surfacePressure != surfacePressure
+        || SpecializedFluidSystem::surfaceTemperature != surfaceTemperature)
+        std::abort();
+    if (SpecializedFluidSystem::defaultInstance().surfacePressure != surfacePressure
+        || SpecializedFluidSystem::defaultInstance().surfaceTemperature != surfaceTemperature)
+        std::abort();
+    if (!(SpecializedFluidSystem::defaultInstance()
+          == SpecializedFluidSystem::NonStatic(FluidSystem::defaultInstance())))
+        std::abort();
+
+    // values assigned to the static members take effect in the default instance
+    FluidSystem::surfacePressure = 2e5;
+    FluidSystem::surfaceTemperature = 300.0;
+    if (FluidSystem::defaultInstance().surfacePressure != 2e5
+        || FluidSystem::defaultInstance().surfaceTemperature != 300.0)
+        std::abort();
+    if (FluidSystem::surfacePressure != 2e5 || FluidSystem::surfaceTemperature != 300.0)
+        std::abort();
+
+    // ... and values assigned to the default instance show up in the static members
+    FluidSystem::defaultInstance().surfacePressure = surfacePressure;
+    FluidSystem::defaultInstance().surfaceTemperature = surfaceTemperature;
+    FluidSystem::initEnd();
+    if (FluidSystem::surfacePressure != surfacePressure
+        || FluidSystem::surfaceTemperature != surfaceTemperature)
+        std::abort();
 }
 
 int main(int argc, char **argv)
@@ -761,6 +1193,8 @@ int main(int argc, char **argv)
     testAll<double>();
     //testAll<float>();
     testAll<TestEval>();
+    testSnapshots();
+    testSurfaceConditions();
 
     return 0;
 }
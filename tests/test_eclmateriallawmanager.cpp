@@ -44,6 +44,13 @@
 
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 // values of strings taken from the SPE1 test case1 of opm-data
 static const char* fam1DeckString =
     "RUNSPEC\n"
@@ -469,6 +476,63 @@ inline Scalar computeLetCurve(const Scalar S, const Scalar L, const Scalar E, co
         return powS/(powS+pow1mS*E);
 }
 
+// make sure that the saturation functions of all elements yield the same results if they
+// are evaluated with lookup cursors. each element keeps its cursor while the saturations
+// first sweep through the segments of the tables and are then visited in random order.
+template <class FluidState, class MaterialLawManager>
+inline void checkCursors(const MaterialLawManager& materialLawManager,
+                         unsigned numElems,
+                         Opm::EclMultiplexerApproach approach)
+{
+    typedef typename MaterialLawManager::MaterialLaw MaterialLaw;
+    typedef typename MaterialLaw::Scalar Scalar;
+    typedef typename MaterialLawManager::Cursor Cursor;
+
+    enum { numPhases = MaterialLaw::numPhases };
+    enum { waterPhaseIdx = MaterialLaw::waterPhaseIdx };
+    enum { oilPhaseIdx = MaterialLaw::oilPhaseIdx };
+    enum { gasPhaseIdx = MaterialLaw::gasPhaseIdx };
+
+    std::vector<std::pair<Scalar, Scalar>> saturations;
+    for (int i = 0; i <= 40; ++ i)
+        for (int j = 0; j <= 40 - i; ++ j)
+            saturations.emplace_back(Scalar(i)/40, Scalar(j)/40);
+    std::vector<std::pair<Scalar, Scalar>> randomSaturations(saturations);
+    std::shuffle(randomSaturations.begin(), randomSaturations.end(), std::mt19937(42));
+    saturations.insert(saturations.end(), randomSaturations.begin(), randomSaturations.end());
+
+    std::vector<Cursor> cursors(numElems);
+    for (unsigned elemIdx = 0; elemIdx < numElems; ++ elemIdx) {
+        const auto& params = materialLawManager.materialLawParams(elemIdx);
+        if (params.approach() != approach)
+            throw std::logic_error("Discrepancy between the deck and the EclMaterialLawManager");
+
+        for (const auto& [Sw, Sg] : saturations) {
+            FluidState fs;
+            fs.setSaturation(waterPhaseIdx, Sw);
+            fs.setSaturation(oilPhaseIdx, 1 - Sw - Sg);
+            fs.setSaturation(gasPhaseIdx, Sg);
+
+            Scalar pc[numPhases] = { 0.0, 0.0, 0.0 };
+            Scalar pcCursor[numPhases] = { 0.0, 0.0, 0.0 };
+            MaterialLaw::capillaryPressures(pc, params, fs);
+            materialLawManager.capillaryPressures(pcCursor, elemIdx, fs, cursors[elemIdx]);
+
+            Scalar kr[numPhases] = { 0.0, 0.0, 0.0 };
+            Scalar krCursor[numPhases] = { 0.0, 0.0, 0.0 };
+            MaterialLaw::relativePermeabilities(kr, params, fs);
+            materialLawManager.relativePermeabilities(krCursor, elemIdx, fs, cursors[elemIdx]);
+
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+                if (pc[phaseIdx] != pcCursor[phaseIdx])
+                    throw std::logic_error("Discrepancy between capillary pressures with and without lookup cursor");
+                if (kr[phaseIdx] != krCursor[phaseIdx])
+                    throw std::logic_error("Discrepancy between relative permeabilities with and without lookup cursor");
+            }
+        }
+    }
+}
+
 
 template <class Scalar>
 inline void testAll()
@@ -517,6 +581,26 @@ inline void testAll()
         if (materialLawManager.enableHysteresis())
             throw std::logic_error("Discrepancy between the deck and the EclMaterialLawManager");
 
+        checkCursors<FluidState>(materialLawManager, n, Opm::EclMultiplexerApproach::EclDefaultApproach);
+
+        // the same saturation functions with the Stone models for the oil relative
+        // permeability
+        for (const auto& [keyword, approach] :
+                 { std::make_pair(std::string("STONE1"), Opm::EclMultiplexerApproach::EclStone1Approach),
+                   std::make_pair(std::string("STONE2"), Opm::EclMultiplexerApproach::EclStone2Approach) })
+        {
+            std::string stoneDeckString(fam1DeckString);
+            stoneDeckString.replace(stoneDeckString.find("PROPS\n"), 6, "PROPS\n\n" + keyword + "\n");
+            const auto stoneDeck = parser.parseString(stoneDeckString);
+            const Opm::EclipseState stoneEclState(stoneDeck);
+
+            MaterialLawManager stoneMaterialLawManager;
+            stoneMaterialLawManager.initFromState(stoneEclState);
+            stoneMaterialLawManager.initParamsForElements(stoneEclState, n);
+
+            checkCursors<FluidState>(stoneMaterialLawManager, n, approach);
+        }
+
         {
             const auto fam2Deck = parser.parseString(fam2DeckString);
             const Opm::EclipseState fam2EclState(fam2Deck);
@@ -531,6 +615,8 @@ inline void testAll()
             if (fam2MaterialLawManager.enableHysteresis())
                 throw std::logic_error("Discrepancy between the deck and the EclMaterialLawManager");
 
+            checkCursors<FluidState>(fam2MaterialLawManager, n, Opm::EclMultiplexerApproach::EclDefaultApproach);
+
             const auto hysterDeck = parser.parseString(hysterDeckString);
             const Opm::EclipseState hysterEclState(hysterDeck);
 
@@ -620,6 +706,10 @@ inline void testAll()
                     }
                 }
             }
+
+            // the hysteresis parameters set above make the saturation functions use
+            // the imbibition curves
+            checkCursors<FluidState>(hysterMaterialLawManager, n, Opm::EclMultiplexerApproach::EclDefaultApproach);
         }
 
         // Gas oil
@@ -638,6 +728,9 @@ inline void testAll()
             fam2MaterialLawManager.initFromState(fam2EclState);
             fam2MaterialLawManager.initParamsForElements(fam2EclState, n);
 
+            checkCursors<FluidState>(fam1materialLawManager, n, Opm::EclMultiplexerApproach::EclTwoPhaseApproach);
+            checkCursors<FluidState>(fam2MaterialLawManager, n, Opm::EclMultiplexerApproach::EclTwoPhaseApproach);
+
             for (unsigned elemIdx = 0; elemIdx < n; ++ elemIdx) {
                 for (int i = 0; i < 100; ++ i) {
                     Scalar Sw = 0;
@@ -686,6 +779,8 @@ inline void testAll()
             letmaterialLawManager.initFromState(letEclState);
             letmaterialLawManager.initParamsForElements(letEclState, n);
 
+            checkCursors<FluidState>(letmaterialLawManager, n, Opm::EclMultiplexerApproach::EclDefaultApproach);
+
             Scalar Swco = 0.1;
             Scalar psi2Pa = 6894.7573;
 